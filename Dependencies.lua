@@ -10,8 +10,9 @@ IncludeDir["stb_image"] = "%{wks.location}/HRealEngine/vendor/stb_image"
 IncludeDir["entt"] = "%{wks.location}/HRealEngine/vendor/entt/include"
 IncludeDir["yaml-cpp"] = "%{wks.location}/HRealEngine/vendor/yaml-cpp/include"
 IncludeDir["ImGuizmo"] = "%{wks.location}/HRealEngine/vendor/ImGuizmo"
-IncludeDir["Box2D"] = "%{wks.location}/HRealEngine/vendor/Box2D/include"
+IncludeDir["Box2D"] = "%{wks.location}/HRealEngine/vendor/box2d/include"
 IncludeDir["mono"] = "%{wks.location}/HRealEngine/vendor/mono/include"
+IncludeDir["mono_linux"] = "/usr/include/mono-2.0"
 IncludeDir["filewatch"] = "%{wks.location}/HRealEngine/vendor/filewatch"
 IncludeDir["JoltPhysics"] = "%{wks.location}/HRealEngine/vendor/JoltPhysics"
 IncludeDir["Jolt"] = "%{wks.location}/HRealEngine/vendor/JoltPhysics/Jolt"
@@ -27,6 +28,10 @@ LibraryDir["mono"] = "%{wks.location}/HRealEngine/vendor/mono/lib/%{cfg.buildcfg
 Library = {}
 Library["mono"] = "%{LibraryDir.mono}/libmono-static-sgen.lib"
  
+--Linux system libraries
+Library["MonoLinux"] = "monosgen-2.0"
+Library["LinuxSystem"] = { "GL", "X11", "pthread", "dl", "m" }
+
 --Windows DLLs
 Library["WinSock"] = "Ws2_32.lib"
 Library["WinMM"] = "Winmm.lib"
@@ -46,6 +46,9 @@ void main()
 
 #type fragment
 #version 450 core
+#ifdef USE_BINDLESS
+#extension GL_ARB_bindless_texture : require
+#endif
 
 layout(location = 0) out vec4 v_color;
 layout(location = 1) out int objectID;
@@ -60,89 +63,128 @@ struct VertexOut
     vec3 normal;
 };
 
+#ifdef DEBUG_VIEW
 uniform int u_DebugView; 
 // 0 = normal render
 // 1 = UV debug
+#endif
 
 layout (location = 0) in VertexOut Input;
 layout (location = 6) in flat int v_EntityIDOut;
 
+#ifdef USE_BINDLESS
+// One handle per texture of the batch, Renderer3D fills it when the driver has bindless textures
+layout(std430, binding = 4) readonly buffer TextureHandleBuffer { sampler2D u_TextureHandles[]; };
+#else
 layout (binding = 0) uniform sampler2D u_textureSamplers[30];
+#endif
 
-#define MAX_LIGHTS 16
+#define MAX_POINT_SHADOWS 8
 struct Light
 {
-    int Type; // 0 dir, 1 point, 2 spot
-    vec3 Position;
-    vec3 Direction;
-    vec3 Color;
-    float Intensity;
-    float Radius;
-    int CastShadows;
+    vec4 PositionType;//xyz position, w type 0 dir, 1 point, 2 spot
+    vec4 DirectionRadius;
+    vec4 ColorIntensity;
+    ivec4 Flags;//x cast shadows, y point shadow slot
 };
-
-uniform int u_LightCount;
-uniform Light u_Lights[MAX_LIGHTS];
+layout(std430, binding = 0) readonly buffer LightBuffer { Light u_LightData[]; };
+layout(std430, binding = 1) readonly buffer ClusterBuffer { uvec2 u_Clusters[]; };//offset, count into u_LightIndices
+layout(std430, binding = 2) readonly buffer LightIndexBuffer { uint u_LightIndices[]; };//global lights first, then per cluster lists
+
+#define CLUSTER_TILES_X 16//grid size must match LightClusterGrid
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+uniform int u_GlobalLightCount;
+uniform mat4 u_View;
+uniform vec4 u_ClusterViewport;//x, y, width, height in pixels
+uniform vec3 u_ClusterDepthParams;//x scale, y bias, z 1 = log depth slices
 uniform vec3 u_ViewPos;
+
+//lights that reach this fragment: u_GlobalLightCount global ones followed by the cluster's list
+uvec2 GetLightCluster(vec3 worldPos)
+{
+    vec2 tile = (gl_FragCoord.xy - u_ClusterViewport.xy) / u_ClusterViewport.zw * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y);
+    float depth = max(-(u_View * vec4(worldPos, 1.0)).z, 0.0001);
+    float z = u_ClusterDepthParams.z > 0.5 ? log(depth) : depth;
+    int slice = clamp(int(z * u_ClusterDepthParams.x + u_ClusterDepthParams.y), 0, CLUSTER_SLICES - 1);
+    ivec2 t = clamp(ivec2(tile), ivec2(0), ivec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+    return u_Clusters[(slice * CLUSTER_TILES_Y + t.y) * CLUSTER_TILES_X + t.x];
+}
+uint GetLightIndex(int n, uvec2 cluster)
+{
+    return n < u_GlobalLightCount ? u_LightIndices[n] : u_LightIndices[cluster.x + uint(n - u_GlobalLightCount)];
+}
 uniform float u_Shininess;
 
 
-uniform int u_HasShadowMap = 0;
-uniform sampler2D u_ShadowMap;
-uniform mat4 u_LightSpaceMatrix;
+#ifdef HAS_SHADOW_MAP
+#define MAX_CASCADES 4
+uniform sampler2DArray u_ShadowMap;//one depth layer per cascade
+uniform mat4 u_LightSpaceMatrices[MAX_CASCADES];
+uniform int u_CascadeCount;
 uniform float u_ShadowBias;
 
 float ComputeShadow(vec3 worldPos, vec3 normal, vec3 lightDir)
 {
-    vec4 lightClip = u_LightSpaceMatrix * vec4(worldPos, 1.0);
-    vec3 proj = lightClip.xyz / lightClip.w;//make 3D, w is perspective
-    proj = proj * 0.5 + 0.5;//to 0-1 range from -1 to 1 // (x - (-1)) / (1 - (-1)) * (1 - 0) + 0 y = (x - minA) / (maxA - minA) * (maxB - minB) + minB
-
-    if (proj.z > 1.0)//proj.z is depth in light space
-         return 0.0;
-        
-    float currentDepth = proj.z;
-    float bias = max(u_ShadowBias * (1.0 - dot(normal, lightDir)), u_ShadowBias * 0.1);
-
-    float shadow = 0.0;
-    vec2 texturePixelSize = 1.0 / textureSize(u_ShadowMap, 0);
-    
-    for(int x = -1; x <= 1; ++x)
-        for(int y = -1; y <= 1; ++y)
-        {
-            float pcfDepth = texture(u_ShadowMap, proj.xy + vec2(x, y) * texturePixelSize).r;//depth from shadow map. texture(u_ShadowMap, coords) gives uv coords from texture
-            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;        
-        }
-    shadow /= 9.0;
-    return shadow;
+    //cascades are ordered near to far, the first one that contains the point has the sharpest texels
+    for (int cascade = 0; cascade < u_CascadeCount; cascade++)
+    {
+        vec4 lightClip = u_LightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
+        vec3 proj = lightClip.xyz / lightClip.w;//make 3D, w is perspective
+        proj = proj * 0.5 + 0.5;//to 0-1 range from -1 to 1
+
+        if (proj.x < 0.0 || proj.x > 1.0 || proj.y < 0.0 || proj.y > 1.0 || proj.z > 1.0)
+            continue;
+
+        float currentDepth = proj.z;
+        //far cascades cover more world space per texel so they need a larger bias
+        float cascadeBias = u_ShadowBias * float(1 << cascade);
+        float bias = max(cascadeBias * (1.0 - dot(normal, lightDir)), cascadeBias * 0.1);
+
+        float shadow = 0.0;
+        vec2 texturePixelSize = 1.0 / vec2(textureSize(u_ShadowMap, 0).xy);
+
+        for(int x = -1; x <= 1; ++x)
+            for(int y = -1; y <= 1; ++y)
+            {
+                float pcfDepth = texture(u_ShadowMap, vec3(proj.xy + vec2(x, y) * texturePixelSize, float(cascade))).r;
+                shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+            }
+        shadow /= 9.0;
+        return shadow;
+    }
+    return 0.0;
 }
+#endif
 
-uniform int u_HasPointShadowMap = 0;
+#ifdef HAS_POINT_SHADOW_MAP
 uniform samplerCubeArray u_PointShadowMaps;
-uniform vec3  u_PointShadowLightPos[MAX_LIGHTS];
-uniform float u_PointShadowFarPlane[MAX_LIGHTS];
-uniform int   u_PointShadowIndex[MAX_LIGHTS];
+uniform vec3  u_PointShadowLightPos[MAX_POINT_SHADOWS];
+uniform float u_PointShadowFarPlane[MAX_POINT_SHADOWS];
 
-float ComputePointShadow(vec3 worldPos, int lightIndex)
+float ComputePointShadow(vec3 worldPos, int shadowIdx)
 {
-    int shadowIdx = u_PointShadowIndex[lightIndex];
     if (shadowIdx < 0) 
         return 0.0;
 
-    vec3 fragToLight = worldPos - u_PointShadowLightPos[lightIndex];
+    vec3 fragToLight = worldPos - u_PointShadowLightPos[shadowIdx];
     float currentDepth = length(fragToLight);
 
     float closestDepth = texture(u_PointShadowMaps, vec4(fragToLight, float(shadowIdx))).r
-                         * u_PointShadowFarPlane[lightIndex];
+                         * u_PointShadowFarPlane[shadowIdx];
 
     float bias = 0.05;
     return (currentDepth - bias > closestDepth) ? 1.0 : 0.0;
 }
+#endif
 
 
 void main()
 {
     vec4 texColor = Input.color;
+#ifdef USE_BINDLESS
+    texColor *= texture(u_TextureHandles[int(Input.texIndex)], Input.texCoord * Input.tilingFactor);
+#else
     switch(int(Input.texIndex))
     {
         case 0: texColor *= texture(u_textureSamplers[0], Input.texCoord * Input.tilingFactor); break;
@@ -178,6 +220,7 @@ void main()
         //case 30: texColor *= texture(u_textureSamplers[30], Input.texCoord * Input.tilingFactor); break;
         //case 31: texColor *= texture(u_textureSamplers[31], Input.texCoord * Input.tilingFactor); break;
     }
+#endif
 
     if(texColor.a < 0.1)
         discard;
@@ -188,6 +231,7 @@ void main()
     if (!gl_FrontFacing)
 		 normal = -normal;
 
+#ifdef DEBUG_VIEW
     if (u_DebugView == 1)
     {
         v_color = vec4(fract(Input.texCoord), 0.0, 1.0);
@@ -198,6 +242,7 @@ void main()
         v_color = vec4(normal * 0.5 + 0.5, 1.0);
         return;
     }
+#endif
 
     vec3 baseColor = texColor.rgb;
     vec3 viewDirection = normalize(u_ViewPos - Input.worldPos);
@@ -205,24 +250,30 @@ void main()
     float shininess = max(u_Shininess, 1.0);
     vec3 lit = 0.05 * baseColor;
 
-    for (int i = 0; i < u_LightCount; i++)
+    uvec2 cluster = GetLightCluster(Input.worldPos);
+    int lightCount = u_GlobalLightCount + int(cluster.y);
+    for (int n = 0; n < lightCount; n++)
     {
-        Light light = u_Lights[i];
+        Light data = u_LightData[GetLightIndex(n, cluster)];
+        int lightType = int(data.PositionType.w);
+        vec3 lightPosition = data.PositionType.xyz;
+        float lightRadius = data.DirectionRadius.w;
+        bool castShadows = data.Flags.x == 1;
 
         vec3 lightDirection;
         float atten = 1.0;
 
-        if (light.Type == 0)
-			 lightDirection = normalize(-light.Direction);
+        if (lightType == 0)
+			 lightDirection = normalize(-data.DirectionRadius.xyz);
         else
         {
-            vec3 toLight = light.Position - Input.worldPos;
+            vec3 toLight = lightPosition - Input.worldPos;
             float dist = length(toLight);
             lightDirection = (dist > 0.0001) ? (toLight / dist) : vec3(0, 1, 0);
 
-            if (light.Radius > 0.0)
+            if (lightRadius > 0.0)
             {
-                float t = clamp(1.0 - dist / light.Radius, 0.0, 1.0);
+                float t = clamp(1.0 - dist / lightRadius, 0.0, 1.0);
                 atten = t * t;
             }
         }
@@ -234,15 +285,17 @@ void main()
         vec3 diffuse  = baseColor * NdotL;
         vec3 specular = vec3(specPow);
 
-        vec3 lightColor = light.Color * light.Intensity;
+        vec3 lightColor = data.ColorIntensity.rgb * data.ColorIntensity.a;
 
         float shadow = 0.0;
-        if (u_HasShadowMap == 1 && light.Type == 0 && light.CastShadows == 1)
+#ifdef HAS_SHADOW_MAP
+        if (lightType == 0 && castShadows)
             shadow = ComputeShadow(Input.worldPos, normal, lightDirection);
-        if (u_HasPointShadowMap == 1 && light.Type == 1 && light.CastShadows == 1)
-        {
-            shadow = max(shadow, ComputePointShadow(Input.worldPos, i));
-        }
+#endif
+#ifdef HAS_POINT_SHADOW_MAP
+        if (lightType == 1 && castShadows)
+            shadow = max(shadow, ComputePointShadow(Input.worldPos, data.Flags.y));
+#endif
 
 		lit += (diffuse + specular) * lightColor * atten * (1.0 - shadow);
     }
@@ -24,11 +24,15 @@ out vec3 g_WorldPos;
 
 uniform mat4 u_ShadowMatrices[6];
 uniform int  u_LayerOffset;//cubemap array layer offset (casterIndex * 6)
+uniform int  u_FaceMask;//only faces with their bit set are rendered
 
 void main()
 {
     for (int face = 0; face < 6; face++)
     {
+        if ((u_FaceMask & (1 << face)) == 0)
+            continue;
+
         gl_Layer = u_LayerOffset + face;
 
         for (int i = 0; i < 3; i++)
@@ -3,12 +3,38 @@
 
 layout(location = 0) in vec3 a_Position;
 
-uniform mat4 u_LightSpaceMatrix;
 uniform mat4 u_Transform;
 
 void main()
 {
-    gl_Position = u_LightSpaceMatrix * u_Transform * vec4(a_Position, 1.0);
+    gl_Position = u_Transform * vec4(a_Position, 1.0);
+}
+
+#type geometry
+#version 450 core
+#define MAX_CASCADES 4
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 12) out;//3 * MAX_CASCADES
+
+uniform mat4 u_LightSpaceMatrices[MAX_CASCADES];
+uniform int u_CascadeCount;
+uniform int u_CascadeMask;//only cascades with their bit set are rendered
+
+void main()
+{
+    for (int cascade = 0; cascade < u_CascadeCount; cascade++)
+    {
+        if ((u_CascadeMask & (1 << cascade)) == 0)
+            continue;
+
+        gl_Layer = cascade;
+        for (int i = 0; i < 3; i++)
+        {
+            gl_Position = u_LightSpaceMatrices[cascade] * gl_in[i].gl_Position;
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
 }
 
 #type fragment
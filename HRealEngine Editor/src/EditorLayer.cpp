@@ -405,7 +405,20 @@ namespace HRealEngine
         Input::SetViewportMousePos(mx, my);
         if (mouseX >= 0 && mouseY >= 0 && mouseX < (int)viewportSize.x && mouseY < (int)viewportSize.y)
         {
-            int pixelData = m_Framebuffer->ReadPixel(1, mouseX, mouseY);
+            m_HoverReadbacks.push_back(m_Framebuffer->RequestReadback(1, mouseX, mouseY, 1, 1));
+            if (m_HoverReadbacks.size() > 3)
+                m_HoverReadbacks.pop_front();
+        }
+        // Entity ids come back a frame or two late, fences finish in order so stop at the first pending one
+        std::vector<uint8_t> pixels;
+        while (!m_HoverReadbacks.empty() && m_Framebuffer->TryGetReadback(m_HoverReadbacks.front(), pixels))
+        {
+            m_HoverReadbacks.pop_front();
+            int pixelData;
+            std::memcpy(&pixelData, pixels.data(), sizeof(int));
+            // The entity may have been destroyed since the frame was drawn
+            if (pixelData != -1 && !m_ActiveScene->GetRegistry().valid((entt::entity)pixelData))
+                pixelData = -1;
             m_HoveredEntity = pixelData == -1 ? Entity() : Entity((entt::entity)pixelData, m_ActiveScene.get());
             //LOG_CORE_INFO("Pixel data = {0}", pixelData);
             if (pixelData == -1)
@@ -604,6 +617,15 @@ namespace HRealEngine
         ImGui::Text("Vertices: %d", stats.GetTotalVertexCount());
         ImGui::Text("Indices: %d", stats.GetTotalIndexCount());
 
+        auto stats3D = Renderer3D::GetStats();
+        ImGui::Text("Lights: %d Max Per Cluster: %d", stats3D.LightCount, stats3D.MaxLightsPerCluster);
+        ImGui::Text("Occluders: %d Culled: %d Visible: %d", stats3D.OccluderCount, stats3D.CulledMeshes, stats3D.VisibleMeshes);
+        ImGui::Text("Mesh Triangles: %d", stats3D.MeshTriangles);
+        ImGui::Text("Point Shadows:");
+        ImGui::Text("Faces Rendered: %d Cached: %d", stats3D.PointShadowFacesRendered, stats3D.PointShadowFacesCached);
+        for (uint32_t i = 0; i < stats3D.PointShadowLights; i++)
+            ImGui::Text("Light %d Casters: %d", i, stats3D.PointShadowCasterCounts[i]);
+
         static const char* s_MinFilters[] =
         {
             "Linear",
@@ -652,6 +674,9 @@ namespace HRealEngine
         {
             m_ActiveScene->Set2DPhysicsEnabled(m_bSetPhysics2DEnabled);
         }
+        float lodBias = Renderer3D::GetLodBias();
+        if (ImGui::DragFloat("LOD Bias", &lodBias, 0.05f, 0.1f, 8.0f))
+            Renderer3D::SetLodBias(lodBias);
         ImGui::Checkbox("Snap Transform", &m_bSnapTransform);
         ImGui::DragFloat("Snap Translation", &m_SnapValueForTransform, 0.1f);
         ImGui::DragFloat("Snap Rotation", &m_SnapValueForRotation, 1.0f);
@@ -804,6 +829,7 @@ namespace HRealEngine
                 glm::vec3 deltaRotation = rotation - transformComponent.Rotation;
                 transformComponent.Rotation += deltaRotation;
                 transformComponent.Scale = scale;
+                selectedEntity.PatchComponent<TransformComponent>();
             }
         }
         
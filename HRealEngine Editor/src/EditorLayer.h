@@ -1,4 +1,5 @@
 
+#include <deque>
 
 #pragma once
 #include "ParticleSystem.h"
@@ -85,6 +86,7 @@ namespace HRealEngine
 
         Entity m_CameraEntity;
         Entity m_HoveredEntity;
+        std::deque<uint64_t> m_HoverReadbacks;
         EditorCamera m_EditorCamera;
 
         glm::vec2 m_ViewportSize = {0.0f, 0.0f};
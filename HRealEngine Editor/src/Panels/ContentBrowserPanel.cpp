@@ -109,6 +109,25 @@ namespace HRealEngine
                     if (ImGui::MenuItem("Delete"))
                     {
                     }
+                    AssetHandle handle = m_TreeNodes[treeNodeIndex].Handle;
+                    auto assetManager = Project::GetActive()->GetEditorAssetManager();
+                    if (!bisDir && assetManager->GetAssetType(handle) == AssetType::Texture && ImGui::BeginMenu("Texture Import"))
+                    {
+                        TextureImportSettings settings = assetManager->GetAssetMetadata(handle).Texture;
+                        bool bChanged = ImGui::MenuItem("Nearest Filter", nullptr, &settings.bNearestFilter);
+                        for (TextureCompression compression : { TextureCompression::Auto, TextureCompression::None, TextureCompression::BC1, TextureCompression::BC3 })
+                        {
+                            std::string label = std::string(TextureCompressionToString(compression));
+                            if (ImGui::MenuItem(label.c_str(), nullptr, settings.Compression == compression))
+                            {
+                                settings.Compression = compression;
+                                bChanged = true;
+                            }
+                        }
+                        if (bChanged)
+                            assetManager->SetTextureImportSettings(handle, settings);
+                        ImGui::EndMenu();
+                    }
                     ImGui::EndPopup();
                 }
                 if (ImGui::BeginDragDropSource())
@@ -175,6 +194,7 @@ namespace HRealEngine
 
         ImGui::SliderFloat("Size", &sizeOfImages, 16, 512);
         ImGui::SliderFloat("Distance", &distance, 0, 32);
+        ImGui::Checkbox("Quantize Imported Meshes", &m_bQuantizeImportedMeshes);
         
         ImGui::End();
 
@@ -385,21 +405,9 @@ namespace HRealEngine
             return;
         }       
 
-        std::filesystem::path cookedPath = Project::GetAssetDirectory() / "cache";
-        std::filesystem::create_directories(cookedPath);        
-        cookedPath /= dstObj.stem();
-        cookedPath += ".hmeshbin";      
-        if (!MeshLoader::WriteHMeshBin(cookedPath, verts, inds, submeshes, bMin, bMax))
-        {
-            LOG_CORE_INFO("Cook write failed: {}", cookedPath.string());
-            return;
-        }       
-        LOG_CORE_INFO("Cooked mesh: {} (V={}, I={})", cookedPath.string(), verts.size(), inds.size());      
-
-        std::filesystem::path outMesh = m_CurrentDirectory / (dstObj.stem().string() + ".hmesh");
-        outMesh = MakeUniquePath(outMesh);      
-        auto sourceRel = std::filesystem::relative(dstObj, Project::GetAssetDirectory()).generic_string();
-        auto cookedRel = std::filesystem::relative(cookedPath, Project::GetAssetDirectory()).generic_string();     
+        std::vector<HMeshBinLod> lods;
+        MeshLoader::GenerateLods(verts, inds, submeshes, lods, bMin, bMax);
+        MeshLoader::OptimizeMesh(verts, inds, submeshes);
 
         //auto materials = MeshLoader::ImportObjMaterialsToHMat(dstObj, m_CurrentDirectory, lastCopiedTexAbs, texturePaths);
         auto assetsRoot = Project::GetAssetDirectory();
@@ -419,6 +427,22 @@ namespace HRealEngine
             materialHandles.push_back(eam->GetHandleFromPath(std::filesystem::path(m)));
         }
 
+        std::filesystem::path outMesh = m_CurrentDirectory / (dstObj.stem().string() + ".hmesh");
+        outMesh = MakeUniquePath(outMesh);
+
+        // Cooked at the path the loader derives from the .hmesh, with the material handles inside, so loading opens one file
+        std::filesystem::path cookedPath = assetsRoot / MeshLoader::GetCookedPath(std::filesystem::relative(outMesh, assetsRoot));
+        if (!MeshLoader::WriteHMeshBin(cookedPath, verts, inds, submeshes, bMin, bMax, lods,
+            m_bQuantizeImportedMeshes ? HMeshBinVertexFormat::Quantized : HMeshBinVertexFormat::Float, materialHandles))
+        {
+            LOG_CORE_INFO("Cook write failed: {}", cookedPath.string());
+            return;
+        }       
+        LOG_CORE_INFO("Cooked mesh: {} (V={}, I={}, LODs={})", cookedPath.string(), verts.size(), inds.size(), lods.size());      
+
+        auto sourceRel = std::filesystem::relative(dstObj, assetsRoot).generic_string();
+        auto cookedRel = std::filesystem::relative(cookedPath, assetsRoot).generic_string();     
+
         std::ofstream out(outMesh);
         out << "Type: StaticMesh\n";
         out << "Source: " << sourceRel << "\n";
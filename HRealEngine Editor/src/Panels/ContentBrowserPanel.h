@@ -32,6 +32,7 @@ namespace HRealEngine
 
         std::string m_LastError;
         bool m_OpenErrorPopup = false;
+        bool m_bQuantizeImportedMeshes = true;
 
         struct TreeNode
         {
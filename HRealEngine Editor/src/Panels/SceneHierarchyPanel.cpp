@@ -7,6 +7,7 @@
 #include <imgui/misc/cpp/imgui_stdlib.h>
 
 #include "HRealEngine/Asset/AssetManager.h"
+#include "HRealEngine/Asset/PrefabImporter.h"
 #include "HRealEngine/Core/Logger.h"
 #include "HRealEngine/Core/MeshLoader.h"
 #include "HRealEngine/Renderer/Material.h"
@@ -63,6 +64,22 @@ namespace HRealEngine
                 if (droppedEntity)
                     m_Context->RemoveParent(droppedEntity);
             }
+            if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("CONTENT_BROWSER_ITEM"))
+            {
+                AssetHandle handle = *(AssetHandle*)payload->Data;
+                if (AssetManager::GetAssetType(handle) == AssetType::Prefab)
+                {
+                    // Dropped prefabs keep the transform they were saved with
+                    Ref<Prefab> prefab = AssetManager::GetAsset<Prefab>(handle);
+                    if (prefab && !prefab->GetEntities().empty())
+                    {
+                        TransformComponent transform = prefab->GetScene()->GetRegistry().get<TransformComponent>(prefab->GetEntities().front());
+                        std::vector<Entity> roots = m_Context->InstantiatePrefab(prefab, { transform });
+                        if (!roots.empty())
+                            m_SelectedEntity = roots.front();
+                    }
+                }
+            }
             ImGui::EndDragDropTarget();
             
         }
@@ -142,6 +159,8 @@ namespace HRealEngine
                 Entity child = m_Context->CreateEntity("Child Entity");
                 m_Context->SetParent(child, entity);
             }
+            if (ImGui::MenuItem("Create Prefab"))
+                CreatePrefab(entity);
             if (entity.HasComponent<ChildrenManagerComponent>() && entity.GetComponent<ChildrenManagerComponent>().ParentHandle != 0)
                 if (ImGui::MenuItem("Unparent"))
                     m_Context->RemoveParent(entity);
@@ -262,7 +281,12 @@ namespace HRealEngine
             
             if (bOpen)
             {
+                // Grouped so an edit to any field marks the whole group as edited, the scene's caches only see patched components
+                ImGui::BeginGroup();
                 uiFunction(component);
+                ImGui::EndGroup();
+                if (ImGui::IsItemEdited())
+                    entity.PatchComponent<T>();
                 ImGui::TreePop();
             }
             
@@ -271,6 +295,21 @@ namespace HRealEngine
         }
     }
 
+    void SceneHierarchyPanel::CreatePrefab(Entity entity)
+    {
+        std::filesystem::path relativePath = std::filesystem::path("Prefabs") / (entity.GetName() + ".hprefab");
+        std::filesystem::create_directories(Project::GetAssetDirectory() / relativePath.parent_path());
+        PrefabImporter::SavePrefab(m_Context->CreatePrefab(entity), relativePath);
+
+        auto assetManager = Project::GetActive()->GetEditorAssetManager();
+        AssetHandle handle = assetManager->GetHandleFromPath(relativePath);
+        if (handle != 0)
+            assetManager->ReloadAsset(handle);
+        else
+            assetManager->ImportAsset(Project::GetAssetDirectory() / relativePath);
+        LOG_CORE_INFO("Saved prefab {}", relativePath.string());
+    }
+
     void SceneHierarchyPanel::DrawComponents(Entity entity)
     {
         if (entity.HasComponent<EntityNameComponent>())
@@ -282,7 +321,7 @@ namespace HRealEngine
             strcpy_s(extraSpace, sizeof(extraSpace), tag.c_str());
             if (ImGui::InputText("##Tag", extraSpace, sizeof(extraSpace)))
             {
-                tag = std::string(extraSpace);
+                entity.SetName(std::string(extraSpace));
             }
         }
         ImGui::SameLine();
@@ -304,6 +343,7 @@ namespace HRealEngine
             ShowAddComponentEntry<AIControllerComponent>("AI Controller Component");
             ShowAddComponentEntry<PerceivableComponent>("Perceivable Component");
             ShowAddComponentEntry<CircleRendererComponent>("Circle Renderer");
+            ShowAddComponentEntry<ParticleEmitterComponent>("Particle Emitter");
             ShowAddComponentEntry<Rigidbody2DComponent>("Rigidbody 2D");
             ShowAddComponentEntry<Rigidbody3DComponent>("Rigidbody 3D");
             ShowAddComponentEntry<BoxCollider3DComponent>("Box Collider 3D");
@@ -314,7 +354,7 @@ namespace HRealEngine
 
         ImGui::PopItemWidth();
 
-        DrawComponent<TagComponent>("Tag", entity, [](auto& component)
+        DrawComponent<TagComponent>("Tag", entity, [entity](auto& component) mutable
         {
             ImGui::Text("Tags");
             ImGui::Separator();
@@ -323,12 +363,13 @@ namespace HRealEngine
             {
                 ImGui::PushID(i);
 
-                ImGui::TextUnformatted(component.Tags[i].c_str());
+                const std::string& tagName = TagRegistry::GetName(component.Tags[i]);
+                ImGui::TextUnformatted(tagName.c_str());
                 ImGui::SameLine();
 
                 if (ImGui::SmallButton("X"))
                 {
-                    component.Tags.erase(component.Tags.begin() + i);
+                    entity.RemoveTag(tagName);
                     ImGui::PopID();
                     break;
                 }
@@ -350,9 +391,7 @@ namespace HRealEngine
             {
                 if (!newTag.empty())
                 {
-                    bool exists = std::find(component.Tags.begin(), component.Tags.end(), newTag) != component.Tags.end();
-                    if (!exists)
-                        component.Tags.push_back(newTag);
+                    entity.AddTag(newTag);
 
                     newTag.clear();
                 }
@@ -940,6 +979,10 @@ namespace HRealEngine
                                 //meshGPUAsset->MaterialPaths = meshGPU->MaterialPaths;
                                 meshGPUAsset->MaterialHandles = meshGPU->MaterialHandles;
                                 meshGPUAsset->Submeshes = meshGPU->Submeshes;
+                                meshGPUAsset->Lods = meshGPU->Lods;
+                                meshGPUAsset->VertexFormat = meshGPU->VertexFormat;
+                                meshGPUAsset->BoundsMin = meshGPU->BoundsMin;
+                                meshGPUAsset->BoundsMax = meshGPU->BoundsMax;
                             }
                         }
                     }
@@ -981,6 +1024,7 @@ namespace HRealEngine
                 ImGui::Text("Loaded");
             }
             ImGui::DragFloat("Tiling Factor", &component.TilingFactor, 0.1f, 0.0f, 100.0f);
+            ImGui::Checkbox("Occluder", &component.bOccluder);
 
             if (component.Mesh)
             {
@@ -1319,6 +1363,24 @@ namespace HRealEngine
             ImGui::DragFloat("Thickness", &component.Thickness, 0.01f, 0.0f, 1.0f);
             ImGui::DragFloat("Fade", &component.Fade, 0.01f, 0.0f, 1.0f);
         });
+        DrawComponent<ParticleEmitterComponent>("Particle Emitter", entity, [](auto& component)
+        {
+            auto& props = component.Props;
+            int maxParticles = (int)props.MaxParticles;
+            if (ImGui::DragInt("Max Particles", &maxParticles, 10.0f, 1, 1000000))
+                props.MaxParticles = (uint32_t)std::max(maxParticles, 1);
+            ImGui::DragFloat("Emission Rate", &props.EmissionRate, 1.0f, 0.0f, 100000.0f);
+            ImGui::DragFloat("Life Time", &props.LifeTime, 0.01f, 0.01f, 100.0f);
+            ImGui::DragFloat3("Velocity", glm::value_ptr(props.Velocity), 0.05f);
+            ImGui::DragFloat3("Velocity Variation", glm::value_ptr(props.VelocityVariation), 0.05f, 0.0f, 100.0f);
+            ImGui::DragFloat3("Acceleration", glm::value_ptr(props.Acceleration), 0.05f);
+            ImGui::DragFloat("Angular Velocity", &props.AngularVelocity, 0.05f);
+            ImGui::ColorEdit4("Color Begin", glm::value_ptr(props.ColorBegin));
+            ImGui::ColorEdit4("Color End", glm::value_ptr(props.ColorEnd));
+            ImGui::DragFloat("Size Begin", &props.SizeBegin, 0.01f, 0.0f, 100.0f);
+            ImGui::DragFloat("Size End", &props.SizeEnd, 0.01f, 0.0f, 100.0f);
+            ImGui::DragFloat("Size Variation", &props.SizeVariation, 0.01f, 0.0f, 100.0f);
+        });
         DrawComponent<Rigidbody2DComponent>("Rigidbody 2D", entity, [](auto& component)
         {
             const char* bodyTypeStrings[] = { "Static", "Dynamic", "Kinematic" };
@@ -19,6 +19,8 @@ namespace HRealEngine
     private:
         void DrawEntityNode(Entity entity);
         void DrawComponents(Entity entity);
+        // Saves entity and its children to Prefabs/<name>.hprefab and registers it as an asset
+        void CreatePrefab(Entity entity);
         
         template<typename Component>
         void ShowAddComponentEntry(const std::string& name);
@@ -0,0 +1,46 @@
+
+#type vertex
+#version 450 core
+
+layout(location = 0) in vec2 a_Corner;
+// Per instance
+layout(location = 1) in vec3 a_Position;
+layout(location = 2) in float a_Rotation;
+layout(location = 3) in vec4 a_Color;
+layout(location = 4) in float a_Size;
+
+layout(std140, binding = 0) uniform u_Camera
+{
+    mat4 u_ViewProjectionMatrix;
+};
+
+layout (location = 0) out vec4 v_Color;
+
+void main()
+{
+    float s = sin(a_Rotation);
+    float c = cos(a_Rotation);
+    vec2 corner = vec2(a_Corner.x * c - a_Corner.y * s, a_Corner.x * s + a_Corner.y * c) * a_Size;
+
+    v_Color = a_Color;
+    gl_Position = u_ViewProjectionMatrix * vec4(a_Position + vec3(corner, 0.0), 1.0);
+}
+
+#type fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+layout(location = 1) out int objectID;
+
+layout (location = 0) in vec4 v_Color;
+
+uniform int u_EntityID;
+
+void main()
+{
+    if (v_Color.a == 0.0)
+        discard;
+
+    color = v_Color;
+    objectID = u_EntityID;
+}
@@ -39,6 +39,9 @@ void main()
 
 #type fragment
 #version 450 core
+#ifdef USE_BINDLESS
+#extension GL_ARB_bindless_texture : require
+#endif
 
 layout(location = 0) out vec4 v_color;
 layout(location = 1) out int objectID;
@@ -54,12 +57,20 @@ struct VertexOut
 layout (location = 0) in VertexOut Input;
 layout (location = 4) in flat int v_EntityIDOut;
 
+#ifdef USE_BINDLESS
+// One handle per texture of the batch, Renderer2D fills it when the driver has bindless textures
+layout(std430, binding = 3) readonly buffer TextureHandleBuffer { sampler2D u_TextureHandles[]; };
+#else
 layout (binding = 0) uniform sampler2D u_textureSamplers[32];
+#endif
 
 void main()
 {
     vec4 texColor = Input.color;
 
+#ifdef USE_BINDLESS
+    texColor *= texture(u_TextureHandles[int(Input.texIndex)], Input.texCoord * Input.tilingFactor);
+#else
     switch(int(Input.texIndex))
     {
         case 0: texColor *= texture(u_textureSamplers[0], Input.texCoord * Input.tilingFactor); break;
@@ -95,6 +106,7 @@ void main()
         case 30: texColor *= texture(u_textureSamplers[30], Input.texCoord * Input.tilingFactor); break;
         case 31: texColor *= texture(u_textureSamplers[31], Input.texCoord * Input.tilingFactor); break;
     }
+#endif
     if(texColor.a < 0.0)
         discard;
     v_color = texColor;
@@ -26,15 +26,8 @@ project "HRealEngine Runtime"
         "%{IncludeDir.ImGui}"
     }
 
-    buildoptions { "/utf-8" }
-
     links{
-        "HRealEngine",
-        "opengl32.lib",
-        "%{Library.WinSock}",
-        "%{Library.WinMM}",
-        "%{Library.WinVersion}",
-        "%{Library.Bcrypt}"
+        "HRealEngine"
     }
 
     defines{
@@ -50,11 +43,37 @@ project "HRealEngine Runtime"
     filter "system:windows"
     	systemversion "latest"
     	defines { "HREALENGINE_PLATFORM_WINDOWS" }
+        buildoptions { "/utf-8" }
+        links {
+            "opengl32.lib",
+            "%{Library.WinSock}",
+            "%{Library.WinMM}",
+            "%{Library.WinVersion}",
+            "%{Library.Bcrypt}"
+        }
             linkoptions {
                 "/IGNORE:4099", -- PDB not found (Mono)
                 "/IGNORE:4098"  -- CRT conflict
             }
 
+    filter "system:linux"
+        defines { "HREALENGINE_PLATFORM_LINUX" }
+        includedirs { "%{IncludeDir.mono_linux}" }
+        -- gmake links static libraries in order, so the engine's dependencies are listed again after it
+        links {
+            "BehaviorTreeLibrary",
+            "JoltPhysics",
+            "assimp",
+            "Box2D",
+            "msdf-atlas-gen",
+            "yaml-cpp",
+            "ImGui",
+            "Glad",
+            "GLFW",
+            "%{Library.MonoLinux}",
+            "%{Library.LinuxSystem}"
+        }
+
     filter "configurations:Debug"
     	defines { "HREALENGINE_DEBUG", "JPH_DEBUG", "JPH_ENABLE_ASSERTS" }
     	runtime "Debug"
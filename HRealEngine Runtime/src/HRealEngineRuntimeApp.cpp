@@ -28,9 +28,20 @@ namespace HRealEngine
             auto args = GetSpecification().CommandLineArgs;
             std::filesystem::path projectPath;
             
-            if (args.Count > 1)
+            for (int i = 1; i < args.Count; i++)
+            {
+                std::string_view arg = args[i];
+                if (arg.rfind("--", 0) == 0)
+                {
+                    if (arg == "--tick-rate" || arg == "--target-fps")
+                        i++;
+                    continue;
+                }
+                projectPath = args[i];
+                break;
+            }
+            if (!projectPath.empty())
             {
-                projectPath = args[1];
                 LOG_CORE_INFO("[Runtime] Using command line project: {}", projectPath.string());
             }
             else
@@ -83,12 +94,41 @@ namespace HRealEngine
         }
     };
     
+    static void ParseRateFlag(const AppCommandLineArgs& args, int& index, float& outRate)
+    {
+        try
+        {
+            outRate = std::stof(args[++index]);
+        }
+        catch (const std::exception&)
+        {
+            LOG_CORE_ERROR("[Runtime] Invalid {} value: {}", args[index - 1], args[index]);
+        }
+    }
+    
+    // --headless runs the game without a window or renderer, --tick-rate <n> sets its fixed simulation rate
+    // --target-fps <n> paces windowed frames to n per second
+    static void ParseRuntimeFlags(const AppCommandLineArgs& args, ApplicationSpecification& spec)
+    {
+        for (int i = 1; i < args.Count; i++)
+        {
+            std::string_view arg = args[i];
+            if (arg == "--headless")
+                spec.bHeadless = true;
+            else if (arg == "--tick-rate" && i + 1 < args.Count)
+                ParseRateFlag(args, i, spec.HeadlessTickRate);
+            else if (arg == "--target-fps" && i + 1 < args.Count)
+                ParseRateFlag(args, i, spec.TargetFrameRate);
+        }
+    }
+    
     Application* CreateApplication(AppCommandLineArgs args)
     {
         ApplicationSpecification spec;
         spec.Name = "HRealEngine Runtime";
         spec.CommandLineArgs = args;
         spec.EditorAssetsPath = "assets";
+        ParseRuntimeFlags(args, spec);
 
         return new HRealEngineRuntimeApp(spec);
     }
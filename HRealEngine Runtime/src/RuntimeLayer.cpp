@@ -55,11 +55,15 @@ namespace HRealEngine
     
     void RuntimeLayer::OnAttach()
     {
-        FramebufferSpecification fbSpec;
-        fbSpec.Attachments = { FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER, FramebufferTextureFormat::Depth };
-        fbSpec.Width = 1280;
-        fbSpec.Height = 720;
-        m_Framebuffer = Framebuffer::Create(fbSpec);
+        m_bHeadless = Application::Get().IsHeadless();
+        if (!m_bHeadless)
+        {
+            FramebufferSpecification fbSpec;
+            fbSpec.Attachments = { FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER, FramebufferTextureFormat::Depth };
+            fbSpec.Width = 1280;
+            fbSpec.Height = 720;
+            m_Framebuffer = Framebuffer::Create(fbSpec);
+        }
 
         if (!Project::GetActive())
         {
@@ -127,6 +131,12 @@ namespace HRealEngine
             return;
         }
         
+        if (m_bHeadless)
+        {
+            m_ActiveScene->OnUpdateRuntime(ts);
+            return;
+        }
+        
         m_ActiveScene->OnViewportResize((uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y);
         if (FramebufferSpecification spec = m_Framebuffer->GetSpecification();
             m_ViewportSize.x > 0 && m_ViewportSize.y > 0 &&
@@ -151,7 +161,20 @@ namespace HRealEngine
         Input::SetViewportMousePos(mx, my);
         if (mouseX >= 0 && mouseY >= 0 && mouseX < (int)viewportSize.x && mouseY < (int)viewportSize.y)
         {
-            int pixelData = m_Framebuffer->ReadPixel(1, mouseX, mouseY);
+            m_HoverReadbacks.push_back(m_Framebuffer->RequestReadback(1, mouseX, mouseY, 1, 1));
+            if (m_HoverReadbacks.size() > 3)
+                m_HoverReadbacks.pop_front();
+        }
+        // Entity ids come back a frame or two late, fences finish in order so stop at the first pending one
+        std::vector<uint8_t> pixels;
+        while (!m_HoverReadbacks.empty() && m_Framebuffer->TryGetReadback(m_HoverReadbacks.front(), pixels))
+        {
+            m_HoverReadbacks.pop_front();
+            int pixelData;
+            std::memcpy(&pixelData, pixels.data(), sizeof(int));
+            // The entity may have been destroyed since the frame was drawn
+            if (pixelData != -1 && !m_ActiveScene->GetRegistry().valid((entt::entity)pixelData))
+                pixelData = -1;
             m_HoveredEntity = pixelData == -1 ? Entity() : Entity((entt::entity)pixelData, m_ActiveScene.get());
             //LOG_CORE_INFO("Pixel data = {0}", pixelData);
             if (pixelData == -1)
@@ -1,4 +1,5 @@
 #pragma once
+#include <deque>
 #include "glm/vec2.hpp"
 #include "HRealEngine/Core/Entity.h"
 #include "HRealEngine/Core/Layer.h"
@@ -27,11 +28,13 @@ namespace HRealEngine
         Ref<Framebuffer> m_Framebuffer;
         Ref<Scene> m_ActiveScene;
         Entity m_HoveredEntity;
+        std::deque<uint64_t> m_HoverReadbacks;
         AssetHandle m_PendingSceneHandle = 0;
         
         glm::vec2 m_ViewportSize = {1920.f, 1080.f};
         glm::vec2 m_ViewportBounds[2];
         
         bool m_ProjectLoaded = false; 
+        bool m_bHeadless = false;
     };
 }
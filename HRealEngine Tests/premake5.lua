@@ -0,0 +1,49 @@
+-- HRealEngine Tests premake5.lua
+-- Headless unit tests for the CPU only engine systems (light clustering, occlusion culling). The sources under test are compiled in directly,
+-- so the tests need no window, GL context or Mono runtime and run on build machines.
+project "HRealEngine Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    staticruntime "off"
+    
+    targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+    
+    files{
+        "src/**.h",
+        "src/**.cpp",
+        
+        "%{wks.location}/HRealEngine/src/HRealEngine/Renderer/LightClusterGrid.cpp",
+        "%{wks.location}/HRealEngine/src/HRealEngine/Renderer/OcclusionCuller.cpp"
+    }
+    includedirs{
+        "src",
+        "%{wks.location}/HRealEngine/vendor/spdlog/include",
+        "%{wks.location}/HRealEngine/src",
+        "%{IncludeDir.glm}",
+        "%{IncludeDir.JoltPhysics}"
+    }
+
+    filter "system:windows"
+    	systemversion "latest"
+    	defines { "HREALENGINE_PLATFORM_WINDOWS" }
+        buildoptions { "/utf-8" }
+
+    filter "system:linux"
+        defines { "HREALENGINE_PLATFORM_LINUX" }
+
+    filter "configurations:Debug"
+    	defines { "HREALENGINE_DEBUG", "JPH_DEBUG", "JPH_ENABLE_ASSERTS" }
+    	runtime "Debug"
+    	symbols "on"
+    
+    filter "configurations:Release"
+    	defines { "HREALENGINE_RELEASE", "JPH_RELEASE" }
+    	runtime "Release"
+    	optimize "on"
+    
+    filter "configurations:Dist"
+    	defines { "HREALENGINE_DIST", "JPH_DIST" }
+    	runtime "Release"
+    	optimize "on"
@@ -0,0 +1,135 @@
+#include "TestFramework.h"
+#include "HRealEngine/Renderer/LightClusterGrid.h"
+
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace HRealEngine;
+
+namespace
+{
+    const glm::mat4 s_Projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    const glm::mat4 s_View = glm::lookAt(glm::vec3(0.0f, 5.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // Same lookup as the lit shaders, false when the point is outside the view
+    bool FindCluster(const LightClusterGrid& grid, const glm::vec3& worldPosition, uint32_t& outCluster)
+    {
+        const glm::vec4 clip = s_Projection * s_View * glm::vec4(worldPosition, 1.0f);
+        if (clip.w <= 0.0f)
+            return false;
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        if (glm::any(glm::greaterThan(glm::abs(ndc), glm::vec3(1.0f))))
+            return false;
+
+        const float viewDepth = -(s_View * glm::vec4(worldPosition, 1.0f)).z;
+        const uint32_t x = glm::min(LightClusterGrid::TilesX - 1, (uint32_t)((ndc.x * 0.5f + 0.5f) * LightClusterGrid::TilesX));
+        const uint32_t y = glm::min(LightClusterGrid::TilesY - 1, (uint32_t)((ndc.y * 0.5f + 0.5f) * LightClusterGrid::TilesY));
+        outCluster = LightClusterGrid::GetClusterIndex(x, y, grid.GetSlice(viewDepth));
+        return true;
+    }
+
+    bool ClusterContains(const LightClusterGrid& grid, uint32_t cluster, uint32_t light)
+    {
+        const LightClusterGrid::ClusterRange& range = grid.GetClusters()[cluster];
+        for (uint32_t i = 0; i < range.Count; i++)
+            if (grid.GetLightIndices()[range.Offset + i] == light)
+                return true;
+        return false;
+    }
+}
+
+HRE_TEST(LightClusterGrid_EveryLitPointFindsItsLights)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coordinate(-60.0f, 60.0f);
+    std::vector<glm::vec4> lights;
+    for (int i = 0; i < 500; i++)
+        lights.emplace_back(coordinate(rng), coordinate(rng) * 0.1f, coordinate(rng), 3.0f);
+
+    LightClusterGrid grid;
+    grid.Build(s_View, s_Projection, lights);
+
+    int checks = 0, misses = 0;
+    for (int sample = 0; sample < 50000; sample++)
+    {
+        const glm::vec3 p(coordinate(rng), coordinate(rng) * 0.1f, coordinate(rng));
+        uint32_t cluster;
+        if (!FindCluster(grid, p, cluster))
+            continue;
+        for (uint32_t light = 0; light < (uint32_t)lights.size(); light++)
+        {
+            if (glm::length(glm::vec3(lights[light]) - p) >= lights[light].w)
+                continue;
+            checks++;
+            if (!ClusterContains(grid, cluster, light))
+                misses++;
+        }
+    }
+    HRE_CHECK(checks > 0);
+    HRE_CHECK(misses == 0);
+}
+
+HRE_TEST(LightClusterGrid_UnboundedLightsAreGlobal)
+{
+    const std::vector<glm::vec4> lights = { { 0.0f, 0.0f, 0.0f, 2.0f }, { 0.0f, 0.0f, 0.0f, 0.0f }, { 5.0f, 0.0f, 0.0f, -1.0f } };
+    LightClusterGrid grid;
+    grid.Build(s_View, s_Projection, lights);
+
+    HRE_CHECK(grid.GetGlobalLightCount() == 2);
+    HRE_CHECK(grid.GetLightIndices().size() >= 2);
+    HRE_CHECK(grid.GetLightIndices()[0] == 1);
+    HRE_CHECK(grid.GetLightIndices()[1] == 2);
+    for (uint32_t cluster = 0; cluster < LightClusterGrid::ClusterCount; cluster++)
+    {
+        HRE_CHECK(!ClusterContains(grid, cluster, 1));
+        HRE_CHECK(!ClusterContains(grid, cluster, 2));
+    }
+
+    uint32_t cluster;
+    HRE_CHECK(FindCluster(grid, glm::vec3(0.0f), cluster));
+    HRE_CHECK(ClusterContains(grid, cluster, 0));
+}
+
+HRE_TEST(LightClusterGrid_LightsOutsideTheViewAreSkipped)
+{
+    // Behind the camera and beyond the far plane
+    const std::vector<glm::vec4> lights = { { 0.0f, 5.0f, 30.0f, 2.0f }, { 0.0f, 0.0f, -1000.0f, 2.0f } };
+    LightClusterGrid grid;
+    grid.Build(s_View, s_Projection, lights);
+
+    HRE_CHECK(grid.GetGlobalLightCount() == 0);
+    HRE_CHECK(grid.GetLightIndices().empty());
+    HRE_CHECK(grid.GetMaxLightsPerCluster() == 0);
+}
+
+HRE_TEST(LightClusterGrid_PerspectiveSlicesAreLogarithmic)
+{
+    LightClusterGrid grid;
+    grid.Build(s_View, s_Projection, {});
+
+    HRE_CHECK(grid.IsLogDepth());
+    HRE_CHECK(grid.GetSlice(0.1f) == 0);
+    HRE_CHECK(grid.GetSlice(499.0f) == LightClusterGrid::Slices - 1);
+    // Geometric mean of near and far lands in the middle slice
+    HRE_CHECK(grid.GetSlice(glm::sqrt(0.1f * 500.0f) * 1.01f) == LightClusterGrid::Slices / 2);
+
+    uint32_t previous = 0;
+    for (float depth = 0.1f; depth < 500.0f; depth *= 1.1f)
+    {
+        const uint32_t slice = grid.GetSlice(depth);
+        HRE_CHECK(slice >= previous);
+        previous = slice;
+    }
+}
+
+HRE_TEST(LightClusterGrid_OrthographicSlicesAreLinear)
+{
+    const glm::mat4 projection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.0f, 240.0f);
+    LightClusterGrid grid;
+    grid.Build(s_View, projection, {});
+
+    HRE_CHECK(!grid.IsLogDepth());
+    HRE_CHECK(grid.GetSlice(0.0f) == 0);
+    HRE_CHECK(grid.GetSlice(125.0f) == 12);
+    HRE_CHECK(grid.GetSlice(239.0f) == LightClusterGrid::Slices - 1);
+}
@@ -0,0 +1,122 @@
+#include "TestFramework.h"
+#include "HRealEngine/Renderer/OcclusionCuller.h"
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace HRealEngine;
+
+namespace
+{
+    // Camera at the origin looking down -Z
+    const glm::mat4 s_ViewProjection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+    const glm::vec3 s_BoxMin(-0.5f);
+    const glm::vec3 s_BoxMax(0.5f);
+
+    // Wall facing the camera at z = -5, spanning [minX, maxX] and 10 units up and down
+    void RasterizeWall(OcclusionCuller& culler, float minX, float maxX)
+    {
+        const glm::vec3 positions[] = { { minX, -10.0f, -5.0f }, { maxX, -10.0f, -5.0f }, { maxX, 10.0f, -5.0f }, { minX, 10.0f, -5.0f } };
+        const uint32_t indices[] = { 0, 1, 2, 2, 3, 0 };
+        culler.RasterizeOccluder(glm::mat4(1.0f), positions, indices, 6);
+    }
+
+    bool IsBoxVisible(OcclusionCuller& culler, const glm::vec3& position)
+    {
+        return culler.IsVisible(glm::translate(glm::mat4(1.0f), position), s_BoxMin, s_BoxMax);
+    }
+}
+
+HRE_TEST(OcclusionCuller_RasterizerWritesOnlyCoveredPixels)
+{
+    OcclusionCuller culler;
+    culler.Begin(s_ViewProjection);
+    RasterizeWall(culler, -10.0f, 0.0f);
+    HRE_CHECK(culler.HasOccluders());
+
+    const glm::vec4 clip = s_ViewProjection * glm::vec4(0.0f, 0.0f, -5.0f, 1.0f);
+    const float wallDepth = clip.z / clip.w;
+    const uint32_t halfWidth = OcclusionCuller::Width / 2;
+    for (uint32_t y = 0; y < OcclusionCuller::Height; y += 7)
+    {
+        HRE_CHECK(glm::abs(culler.GetDepth(0, 0, y) - wallDepth) < 0.0001f);
+        HRE_CHECK(glm::abs(culler.GetDepth(0, halfWidth - 2, y) - wallDepth) < 0.0001f);
+        HRE_CHECK(culler.GetDepth(0, halfWidth + 1, y) == 1.0f);
+        HRE_CHECK(culler.GetDepth(0, OcclusionCuller::Width - 1, y) == 1.0f);
+    }
+
+    culler.Begin(s_ViewProjection);
+    HRE_CHECK(!culler.HasOccluders());
+    HRE_CHECK(culler.GetDepth(0, 0, 0) == 1.0f);
+}
+
+HRE_TEST(OcclusionCuller_HiZKeepsTheFarthestDepth)
+{
+    OcclusionCuller culler;
+    culler.Begin(s_ViewProjection);
+    RasterizeWall(culler, -10.0f, 0.3f);
+    // The pyramid is built lazily by the first query after rasterizing
+    IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -10.0f));
+
+    uint32_t width = OcclusionCuller::Width, height = OcclusionCuller::Height;
+    HRE_CHECK(culler.GetLevelCount() > 1);
+    for (uint32_t level = 1; level < culler.GetLevelCount(); level++)
+    {
+        const uint32_t srcWidth = width, srcHeight = height;
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint32_t sx1 = std::min(x * 2 + 1, srcWidth - 1), sy1 = std::min(y * 2 + 1, srcHeight - 1);
+                const float farthest = std::max({ culler.GetDepth(level - 1, x * 2, y * 2), culler.GetDepth(level - 1, sx1, y * 2),
+                    culler.GetDepth(level - 1, x * 2, sy1), culler.GetDepth(level - 1, sx1, sy1) });
+                HRE_CHECK(culler.GetDepth(level, x, y) == farthest);
+            }
+        }
+    }
+    HRE_CHECK(width == 1 && height == 1);
+    // Half the screen is empty, so the whole screen is not known to be covered
+    HRE_CHECK(culler.GetDepth(culler.GetLevelCount() - 1, 0, 0) == 1.0f);
+}
+
+HRE_TEST(OcclusionCuller_BoxesBehindTheWallAreHidden)
+{
+    OcclusionCuller culler;
+    culler.Begin(s_ViewProjection);
+    RasterizeWall(culler, -10.0f, 10.0f);
+
+    HRE_CHECK(!IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -10.0f)));
+    HRE_CHECK(!IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -50.0f)));
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -3.0f)));
+    // Straddling the wall, the near half is in front of it
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -5.2f)));
+}
+
+HRE_TEST(OcclusionCuller_PartialWallOnlyHidesWhatItCovers)
+{
+    OcclusionCuller culler;
+    culler.Begin(s_ViewProjection);
+    RasterizeWall(culler, -10.0f, 0.0f);
+
+    HRE_CHECK(!IsBoxVisible(culler, glm::vec3(-5.0f, 0.0f, -10.0f)));
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(5.0f, 0.0f, -10.0f)));
+    // Crossing the wall edge on screen
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -10.0f)));
+}
+
+HRE_TEST(OcclusionCuller_FrustumRejectsWithoutOccluders)
+{
+    OcclusionCuller culler;
+    culler.Begin(s_ViewProjection);
+    HRE_CHECK(!culler.HasOccluders());
+
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -10.0f)));
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -50.0f)));
+    HRE_CHECK(!IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, 5.0f)));
+    HRE_CHECK(!IsBoxVisible(culler, glm::vec3(100.0f, 0.0f, -10.0f)));
+    HRE_CHECK(!IsBoxVisible(culler, glm::vec3(0.0f, 0.0f, -200.0f)));
+    // Around the camera, part of it is always on screen
+    HRE_CHECK(IsBoxVisible(culler, glm::vec3(0.0f)));
+}
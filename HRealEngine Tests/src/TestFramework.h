@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdio>
+#include <vector>
+
+namespace HRealEngine::Tests
+{
+    struct TestCase
+    {
+        const char* Name;
+        void (*Run)();
+    };
+
+    inline std::vector<TestCase>& GetTestCases()
+    {
+        static std::vector<TestCase> s_TestCases;
+        return s_TestCases;
+    }
+
+    // Failed checks of the test that is running, reset by the runner before each test
+    inline int& GetFailedChecks()
+    {
+        static int s_FailedChecks = 0;
+        return s_FailedChecks;
+    }
+
+    struct TestRegistrar
+    {
+        TestRegistrar(const char* name, void (*run)()) { GetTestCases().push_back({ name, run }); }
+    };
+}
+
+#define HRE_TEST(name) \
+    static void name(); \
+    static HRealEngine::Tests::TestRegistrar s_##name##Registrar(#name, name); \
+    static void name()
+
+#define HRE_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("    %s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            HRealEngine::Tests::GetFailedChecks()++; \
+        } \
+    } while (0)
@@ -0,0 +1,19 @@
+#include "TestFramework.h"
+
+int main()
+{
+    using namespace HRealEngine::Tests;
+
+    int failedTests = 0;
+    for (const TestCase& test : GetTestCases())
+    {
+        GetFailedChecks() = 0;
+        test.Run();
+        const bool bPassed = GetFailedChecks() == 0;
+        std::printf("[%s] %s\n", bPassed ? "PASS" : "FAIL", test.Name);
+        if (!bPassed)
+            failedTests++;
+    }
+    std::printf("%d of %d tests failed\n", failedTests, (int)GetTestCases().size());
+    return failedTests == 0 ? 0 : 1;
+}
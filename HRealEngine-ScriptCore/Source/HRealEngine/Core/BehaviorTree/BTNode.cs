@@ -58,9 +58,10 @@ namespace HRealEngine.BehaviorTree
         {
             return GlobalFunctions.FromID(entityID);
         }
+        // Time since this tree last ticked, larger than the frame delta when the frame governor spreads BT ticks
         public float GetDeltaTime()
         {
-            return GlobalFunctions.GetDeltaTime();
+            return InternalCalls_BehaviorTree.BehaviorTree_GetDeltaTime();
         }
         public void OpenScene(string scenePath)
         {
@@ -86,6 +87,10 @@ namespace HRealEngine.BehaviorTree
         {
             return GlobalFunctions.Raycast3DAll(origin, direction, maxDistance, ignoreEntities, debugDraw, debugDrawDuration);
         }
+        public int QueryBatch3D(PhysicsQuery[] queries, PhysicsQueryHit[] results, ulong[] ignoreEntities = null)
+        {
+            return GlobalFunctions.QueryBatch3D(queries, results, ignoreEntities);
+        }
 
         public void ReportNoiseEvent(ulong SourceEntityID, Vector3 position, float loudness, float maxRange, int sourceType)
         {
@@ -10,5 +10,7 @@ namespace HRealEngine.Calls
         internal extern static BTBlackboard BehaviorTreeComponent_GetBlackboard(ulong entityID);
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static void Blackboard_NotifyValuesChanged(ulong entityID);
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static float BehaviorTree_GetDeltaTime();
     }
 }
\ No newline at end of file
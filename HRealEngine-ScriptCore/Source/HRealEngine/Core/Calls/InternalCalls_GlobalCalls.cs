@@ -17,6 +17,10 @@ namespace HRealEngine.Calls
         internal extern static ulong SpawnEntity(string name, string tag, ref Vector3 translation, ref Vector3 rotation, ref Vector3 scale);
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static ulong FindEntityByName(string name);
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static ulong[] FindEntitiesWithTag(string tag);
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static ulong[] InstantiatePrefab(string prefabPath, Vector3[] positions, Vector3[] rotations, Vector3[] scales);
         
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static object GetScriptInstance(ulong entityID);
@@ -25,6 +29,8 @@ namespace HRealEngine.Calls
         internal extern static bool Raycast3D(ref Vector3 origin, ref Vector3 direction, ulong[] ignoreEntitiesIDs, float maxDistance, out ulong entityID, out Vector3 point, out Vector3 normal, out float distance, bool debugDraw, float debugDrawDuration);
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static RaycastHit[] Raycast3DArray(ref Vector3 origin, ref Vector3 direction, ulong[] ignoreEntitiesIDs, float maxDistance, bool debugDraw, float debugDrawDuration);
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal extern static int PhysicsQueryBatch3D(PhysicsQuery[] queries, ulong[] ignoreEntitiesIDs, PhysicsQueryHit[] outHits);
 
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal extern static void ReportNoiseEvent(ulong sourceEntityID, Vector3 position, float intensity, float maxRange, int sourceType);
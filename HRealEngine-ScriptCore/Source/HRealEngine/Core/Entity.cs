@@ -173,6 +173,10 @@ namespace HRealEngine
         {
             return GlobalFunctions.Raycast3DAll(origin, direction, maxDistance, ignoreEntities, debugDraw, debugDrawDuration);
         }
+        public int QueryBatch3D(PhysicsQuery[] queries, PhysicsQueryHit[] results, ulong[] ignoreEntities = null)
+        {
+            return GlobalFunctions.QueryBatch3D(queries, results, ignoreEntities);
+        }
         public void ReportNoiseEvent(ulong sourceEntityID, Vector3 position, float intensity, float maxRange, int sourceType)
         {
             GlobalFunctions.ReportNoiseEvent(sourceEntityID, position, intensity, maxRange, sourceType);
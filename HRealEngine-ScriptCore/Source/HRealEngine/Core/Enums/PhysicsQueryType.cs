@@ -0,0 +1,9 @@
+namespace HRealEngine
+{
+    public enum PhysicsQueryType
+    {
+        Raycast = 0,
+        SphereCast = 1,
+        SphereOverlap = 2
+    }
+}
@@ -12,6 +12,44 @@ namespace HRealEngine
         public Vector3 Normal;
         public float Distance;
     }
+
+    // Layout must match PhysicsQuery3D in JoltWorld.h
+    [System.Runtime.InteropServices.StructLayout(System.Runtime.InteropServices.LayoutKind.Sequential)]
+    public struct PhysicsQuery
+    {
+        public PhysicsQueryType Type;
+        public Vector3 Origin;
+        public Vector3 Direction;
+        public float MaxDistance;
+        public float Radius;
+        public ulong IgnoreEntityID;
+
+        public static PhysicsQuery Ray(Vector3 origin, Vector3 direction, float maxDistance, ulong ignoreEntityID = 0)
+        {
+            return new PhysicsQuery { Type = PhysicsQueryType.Raycast, Origin = origin, Direction = direction, MaxDistance = maxDistance, IgnoreEntityID = ignoreEntityID };
+        }
+        public static PhysicsQuery SphereCast(Vector3 origin, Vector3 direction, float radius, float maxDistance, ulong ignoreEntityID = 0)
+        {
+            return new PhysicsQuery { Type = PhysicsQueryType.SphereCast, Origin = origin, Direction = direction, Radius = radius, MaxDistance = maxDistance, IgnoreEntityID = ignoreEntityID };
+        }
+        public static PhysicsQuery SphereOverlap(Vector3 center, float radius, ulong ignoreEntityID = 0)
+        {
+            return new PhysicsQuery { Type = PhysicsQueryType.SphereOverlap, Origin = center, Radius = radius, IgnoreEntityID = ignoreEntityID };
+        }
+    }
+
+    // Layout must match PhysicsQueryHit3D in JoltWorld.h
+    [System.Runtime.InteropServices.StructLayout(System.Runtime.InteropServices.LayoutKind.Sequential)]
+    public struct PhysicsQueryHit
+    {
+        public ulong EntityID;
+        public Vector3 Point;
+        public Vector3 Normal;
+        public float Distance;
+        private int hit;
+
+        public bool Hit => hit != 0;
+    }
     
     public static class GlobalFunctions
     {
@@ -41,6 +79,23 @@ namespace HRealEngine
                 return null;
             return new Entity(entityID);
         }
+        // Spawns one clone of the prefab per position in a single call and returns the clone roots.
+        // rotations and scales are optional, missing entries fall back to zero rotation and unit scale.
+        public static Entity[] Instantiate(string prefabPath, Vector3[] positions, Vector3[] rotations = null, Vector3[] scales = null)
+        {
+            ulong[] entityIDs = InternalCalls_GlobalCalls.InstantiatePrefab(prefabPath, positions, rotations, scales);
+            if (entityIDs == null)
+                return new Entity[0];
+            Entity[] entities = new Entity[entityIDs.Length];
+            for (int i = 0; i < entityIDs.Length; i++)
+                entities[i] = new Entity(entityIDs[i]);
+            return entities;
+        }
+        public static Entity Instantiate(string prefabPath, Vector3 position)
+        {
+            Entity[] entities = Instantiate(prefabPath, new Vector3[] { position });
+            return entities.Length > 0 ? entities[0] : null;
+        }
         public static Entity FindEntityByName(string name)
         {
             ulong entityID = InternalCalls_GlobalCalls.FindEntityByName(name);
@@ -48,6 +103,16 @@ namespace HRealEngine
                 return null;
             return new Entity(entityID);
         }
+        public static Entity[] FindEntitiesWithTag(string tag)
+        {
+            ulong[] entityIDs = InternalCalls_GlobalCalls.FindEntitiesWithTag(tag);
+            if (entityIDs == null)
+                return new Entity[0];
+            Entity[] entities = new Entity[entityIDs.Length];
+            for (int i = 0; i < entityIDs.Length; i++)
+                entities[i] = new Entity(entityIDs[i]);
+            return entities;
+        }
         public static bool Raycast3D(Vector3 origin, Vector3 direction, float maxDistance, out RaycastHit hit, ulong[] ignoreEntities = null, bool debugDraw = false, float debugDrawDuration = 0.0f)
         {
             hit = new RaycastHit();
@@ -58,6 +123,13 @@ namespace HRealEngine
         {
             return InternalCalls_GlobalCalls.Raycast3DArray(ref origin, ref direction, ignoreEntities, maxDistance, debugDraw, debugDrawDuration);
         }
+        // Runs all queries in one call, results[i] receives the closest hit of queries[i]. Reuse the results buffer between frames.
+        public static int QueryBatch3D(PhysicsQuery[] queries, PhysicsQueryHit[] results, ulong[] ignoreEntities = null)
+        {
+            if (queries == null || results == null || results.Length < queries.Length)
+                return 0;
+            return InternalCalls_GlobalCalls.PhysicsQueryBatch3D(queries, ignoreEntities, results);
+        }
         
         public static void ReportNoiseEvent(ulong SourceEntityID, Vector3 position, float loudness, float maxRange, int sourceType)
         {
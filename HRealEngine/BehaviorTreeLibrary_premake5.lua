@@ -52,8 +52,7 @@ project "BehaviorTreeLibrary"
         "yaml-cpp",
         "ImGui",
         "Glad",
-        "GLFW",
-        "opengl32.lib"
+        "GLFW"
     }
 
     
@@ -61,6 +60,11 @@ project "BehaviorTreeLibrary"
     filter "system:windows"
         systemversion "latest"
         defines { "HREALENGINE_PLATFORM_WINDOWS" }
+        links { "opengl32.lib" }
+
+    filter "system:linux"
+        pic "On"
+        defines { "HREALENGINE_PLATFORM_LINUX" }
 
     filter "configurations:Debug"
         runtime "Debug"
@@ -67,18 +67,24 @@ project "HRealEngine"
         "msdf-atlas-gen",
         "yaml-cpp",
         "Box2D",
-        "%{Library.mono}",
         "JoltPhysics",
         "assimp",
         "BehaviorTreeLibrary"
     }
 
-    buildoptions { "/utf-8" }
-
     filter "system:windows"
         systemversion "latest"
         defines { "HREALENGINE_PLATFORM_WINDOWS" }
         disablewarnings { "4068" }
+        buildoptions { "/utf-8" }
+        links { "%{Library.mono}" }
+        removefiles { "src/Platform/Linux/**" }
+
+    filter "system:linux"
+        pic "On"
+        defines { "HREALENGINE_PLATFORM_LINUX" }
+        includedirs { "%{IncludeDir.mono_linux}" }
+        removefiles { "src/Platform/Windows/**" }
     
     filter "configurations:Debug"
         defines { "HREALENGINE_DEBUG", "JPH_DEBUG", "JPH_ENABLE_ASSERTS" }
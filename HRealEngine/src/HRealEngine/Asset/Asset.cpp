@@ -19,6 +19,8 @@ namespace HRealEngine
                 return "AssetType::Material";
             case AssetType::BehaviorTree:
                 return "AssetType::BehaviorTree";
+            case AssetType::Prefab:
+                return "AssetType::Prefab";
         }
 
         return "AssetType::<Invalid>";
@@ -38,7 +40,38 @@ namespace HRealEngine
             return AssetType::Material;
         if (assetType == "AssetType::BehaviorTree")
             return AssetType::BehaviorTree;
+        if (assetType == "AssetType::Prefab")
+            return AssetType::Prefab;
 
         return AssetType::None;
     }
+
+    std::string_view TextureCompressionToString(TextureCompression compression)
+    {
+        switch (compression)
+        {
+            case TextureCompression::Auto:
+                return "Auto";
+            case TextureCompression::None:
+                return "None";
+            case TextureCompression::BC1:
+                return "BC1";
+            case TextureCompression::BC3:
+                return "BC3";
+        }
+
+        return "Auto";
+    }
+
+    TextureCompression TextureCompressionFromString(std::string_view compression)
+    {
+        if (compression == "None")
+            return TextureCompression::None;
+        if (compression == "BC1")
+            return TextureCompression::BC1;
+        if (compression == "BC3")
+            return TextureCompression::BC3;
+
+        return TextureCompression::Auto;
+    }
 }
@@ -6,6 +6,8 @@ namespace HRealEngine
 {
     std::string_view AssetTypeToString(AssetType type);
     AssetType AssetTypeFromString(std::string_view assetType);
+    std::string_view TextureCompressionToString(TextureCompression compression);
+    TextureCompression TextureCompressionFromString(std::string_view compression);
     
     class Asset
     {
@@ -4,8 +4,10 @@
 #include "BehaviorTreeImporter.h"
 #include "MaterialImporter.h"
 #include "MeshImporter.h"
+#include "PrefabImporter.h"
 #include "SceneImporter.h"
 #include "TextureImporter.h"
+#include "HRealEngine/Renderer/RendererAPI.h"
 
 namespace HRealEngine
 {
@@ -14,7 +16,8 @@ namespace HRealEngine
         { AssetType::Scene, SceneImporter::ImportScene },
         { AssetType::Mesh, MeshImporter::ImportMesh },
         { AssetType::Material, MaterialImporter::ImportMaterial },
-        {AssetType::BehaviorTree, BehaviorTreeImporter::ImportBehaviorTree }
+        {AssetType::BehaviorTree, BehaviorTreeImporter::ImportBehaviorTree },
+        {AssetType::Prefab, PrefabImporter::ImportPrefab }
     };
     
     Ref<Asset> AssetImporter::ImportAsset(AssetHandle assetHandle, const AssetMetadata& metaData)
@@ -24,6 +27,13 @@ namespace HRealEngine
             LOG_CORE_ERROR("No importer registered for asset type {}", static_cast<int>(metaData.Type));
             return nullptr;
         }
+        if (RendererAPI::GetAPI() == RendererAPI::API::None && RequiresRenderer(metaData.Type))
+            return nullptr;
         return s_AssetImporters[metaData.Type](assetHandle, metaData);
     }
+
+    bool AssetImporter::RequiresRenderer(AssetType type)
+    {
+        return type == AssetType::Texture || type == AssetType::Mesh || type == AssetType::Material;
+    }
 }
@@ -8,5 +8,7 @@ namespace HRealEngine
     {
     public:
         static Ref<Asset> ImportAsset(AssetHandle assetHandle, const AssetMetadata& metaData);
+        // Asset types that only exist as GPU resources, they are not imported when running headless
+        static bool RequiresRenderer(AssetType type);
     };
 }
@@ -22,7 +22,23 @@ namespace HRealEngine
         Scene,
         Mesh,
         Material,
-        BehaviorTree
+        BehaviorTree,
+        Prefab
+    };
+
+    // How a project texture is cooked; Auto keeps nearest filtered textures uncompressed and picks BC1/BC3 otherwise
+    enum class TextureCompression
+    {
+        Auto = 0,
+        None,
+        BC1,
+        BC3
+    };
+
+    struct TextureImportSettings
+    {
+        bool bNearestFilter = false;
+        TextureCompression Compression = TextureCompression::Auto;
     };
 
     struct AssetMetadata
@@ -30,6 +46,8 @@ namespace HRealEngine
         AssetType Type = AssetType::None;
 
         std::filesystem::path FilePath;
+        // Only read for AssetType::Texture
+        TextureImportSettings Texture;
 
         operator bool() const { return Type != AssetType::None; }
     };
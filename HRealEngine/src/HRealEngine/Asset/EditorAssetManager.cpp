@@ -5,6 +5,7 @@
 #include <yaml-cpp/yaml.h>
 
 #include "HRealEngine/Project/Project.h"
+#include "HRealEngine/Renderer/RendererAPI.h"
 
 namespace HRealEngine
 {
@@ -17,7 +18,8 @@ namespace HRealEngine
         {".hmesh", AssetType::Mesh },
         {".hmat", AssetType::Material},
         {".mtl", AssetType::Material},
-        {".btree", AssetType::BehaviorTree}
+        {".btree", AssetType::BehaviorTree},
+        {".hprefab", AssetType::Prefab}
     };
     static AssetType GetAssetTypeFromFileExtension(const std::filesystem::path& extension)
     {
@@ -50,7 +52,8 @@ namespace HRealEngine
         {
             const AssetMetadata& metaData = GetAssetMetadata(assetHandle);
             asset = AssetImporter::ImportAsset(assetHandle, metaData);
-            if (!asset)
+            bool bSkippedHeadless = RendererAPI::GetAPI() == RendererAPI::API::None && AssetImporter::RequiresRenderer(metaData.Type);
+            if (!asset && !bSkippedHeadless)
                 LOG_CORE_ERROR("Failed to load asset: {}", metaData.FilePath.string());
             m_LoadedAssets[assetHandle] = asset;
         }
@@ -92,6 +95,18 @@ namespace HRealEngine
         return reloaded;
     }
 
+    void EditorAssetManager::SetTextureImportSettings(AssetHandle handle, const TextureImportSettings& settings)
+    {
+        auto it = m_AssetRegistry.find(handle);
+        if (it == m_AssetRegistry.end() || it->second.Type != AssetType::Texture)
+            return;
+
+        it->second.Texture = settings;
+        SerializeAssetRegistry();
+        if (IsAssetLoaded(handle))
+            ReloadAsset(handle);
+    }
+
     void EditorAssetManager::ImportAsset(const std::filesystem::path& filePath)
     {
         const std::filesystem::path assetRoot = Project::GetAssetDirectory();
@@ -172,6 +187,11 @@ namespace HRealEngine
                 std::string filePath = metadata.FilePath.generic_string();
                 out << YAML::Key << "FilePath" << YAML::Value << filePath;
                 out << YAML::Key << "Type" << YAML::Value << AssetTypeToString(metadata.Type);
+                if (metadata.Type == AssetType::Texture)
+                {
+                    out << YAML::Key << "NearestFilter" << YAML::Value << metadata.Texture.bNearestFilter;
+                    out << YAML::Key << "Compression" << YAML::Value << std::string(TextureCompressionToString(metadata.Texture.Compression));
+                }
                 out << YAML::EndMap;
             }
             out << YAML::EndSeq;
@@ -205,6 +225,10 @@ namespace HRealEngine
             std::string filePath = assetNode["FilePath"].as<std::string>();
             metadata.FilePath = filePath;
             metadata.Type = AssetTypeFromString(assetNode["Type"].as<std::string>());
+            if (auto nearestNode = assetNode["NearestFilter"])
+                metadata.Texture.bNearestFilter = nearestNode.as<bool>();
+            if (auto compressionNode = assetNode["Compression"])
+                metadata.Texture.Compression = TextureCompressionFromString(compressionNode.as<std::string>());
         }
         return true;
     }
@@ -15,6 +15,8 @@ namespace HRealEngine
         AssetHandle GetHandleFromPath(const std::filesystem::path& relPath) const;
 
         Ref<Asset> ReloadAsset(AssetHandle handle);
+        // Stores the settings in the registry and recooks the texture if it is loaded
+        void SetTextureImportSettings(AssetHandle handle, const TextureImportSettings& settings);
 
         void ImportAsset(const std::filesystem::path& filePath);
         void SerializeAssetRegistry();
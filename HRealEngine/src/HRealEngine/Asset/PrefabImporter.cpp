@@ -0,0 +1,35 @@
+#include "HRpch.h"
+#include "PrefabImporter.h"
+
+#include "HRealEngine/Project/Project.h"
+#include "HRealEngine/Scene/SceneSerializer.h"
+
+namespace HRealEngine
+{
+    Ref<Prefab> PrefabImporter::ImportPrefab(AssetHandle handle, const AssetMetadata& metadata)
+    {
+        Ref<Prefab> prefab = LoadPrefab(Project::GetAssetDirectory() / metadata.FilePath);
+        if (prefab)
+            prefab->Handle = handle;
+        return prefab;
+    }
+
+    // A prefab file is a scene file holding only the prefab entities
+    Ref<Prefab> PrefabImporter::LoadPrefab(const std::filesystem::path& path)
+    {
+        Ref<Scene> scene = CreateRef<Scene>();
+        SceneSerializer serializer(scene);
+        if (!serializer.Deserialize(path))
+        {
+            LOG_CORE_ERROR("Failed to load prefab {}", path.string());
+            return nullptr;
+        }
+        return CreateRef<Prefab>(scene);
+    }
+
+    void PrefabImporter::SavePrefab(Ref<Prefab> prefab, const std::filesystem::path& path)
+    {
+        SceneSerializer serializer(prefab->GetScene());
+        serializer.Serialize(Project::GetAssetDirectory() / path);
+    }
+}
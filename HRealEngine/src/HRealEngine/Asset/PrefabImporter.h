@@ -0,0 +1,15 @@
+#pragma once
+#include "HRealEngine/Scene/Prefab.h"
+
+namespace HRealEngine
+{
+    class PrefabImporter
+    {
+    public:
+        static Ref<Prefab> ImportPrefab(AssetHandle handle, const AssetMetadata& metadata);
+        static Ref<Prefab> LoadPrefab(const std::filesystem::path& path);
+
+        // path is relative to the asset directory
+        static void SavePrefab(Ref<Prefab> prefab, const std::filesystem::path& path);
+    };
+}
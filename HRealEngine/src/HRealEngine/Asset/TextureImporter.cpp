@@ -1,14 +1,75 @@
 #include "HRpch.h"
 #include "TextureImporter.h"
 
+#include <fstream>
+
 #include "stb_image.h"
+#include "HRealEngine/Core/FileSystem.h"
 #include "HRealEngine/Project/Project.h"
 #include "HRealEngine/Renderer/Texture.h"
+#include "HRealEngine/Renderer/TextureCompressor.h"
 
 
 namespace HRealEngine
 {
-    Ref<Texture2D> TextureImporter::LoadTexture(const std::filesystem::path& path)
+    static ImageFormat ResolveCookedFormat(const TextureImportSettings& settings, bool bHasAlpha)
+    {
+        switch (settings.Compression)
+        {
+            case TextureCompression::None:
+                return ImageFormat::RGBA8;
+            case TextureCompression::BC1:
+                return ImageFormat::BC1;
+            case TextureCompression::BC3:
+                return ImageFormat::BC3;
+            case TextureCompression::Auto:
+                break;
+        }
+        // Block compression smears pixel art, so nearest filtered textures stay raw unless asked otherwise
+        if (settings.bNearestFilter)
+            return ImageFormat::RGBA8;
+        return bHasAlpha ? ImageFormat::BC3 : ImageFormat::BC1;
+    }
+
+    // Bytes the header's mip chain takes, 0 when the header can not describe a cooked texture
+    static uint64_t GetCookedDataSize(const HTexBinHeader& header)
+    {
+        if (header.Format != ImageFormat::RGBA8 && header.Format != ImageFormat::BC1 && header.Format != ImageFormat::BC3)
+            return 0;
+        if (header.Width == 0 || header.Height == 0 || header.MipLevels == 0
+            || header.MipLevels > TextureCompressor::GetMipCount(header.Width, header.Height))
+            return 0;
+
+        uint64_t size = 0;
+        uint32_t levelWidth = header.Width, levelHeight = header.Height;
+        for (uint32_t mip = 0; mip < header.MipLevels; mip++)
+        {
+            size += TextureCompressor::GetLevelSize(header.Format, levelWidth, levelHeight);
+            levelWidth = std::max(levelWidth / 2, 1u);
+            levelHeight = std::max(levelHeight / 2, 1u);
+        }
+        return size;
+    }
+
+    static void ApplyImportFilter(TextureSpecification& spec, const TextureImportSettings& settings)
+    {
+        if (!settings.bNearestFilter)
+            return;
+        spec.MinFilter = TextureFilter::Nearest;
+        spec.MagFilter = TextureFilter::Nearest;
+    }
+
+    static bool IsCookedUpToDate(const std::filesystem::path& cookedPath, const TextureImportSettings& settings)
+    {
+        std::ifstream in(cookedPath, std::ios::binary);
+        HTexBinHeader header;
+        if (!in.read((char*)&header, sizeof(header)))
+            return false;
+        return header.Magic == HTexBinHeader().Magic && header.Version == HTexBinHeader().Version
+            && header.Compression == settings.Compression && (header.NearestFilter != 0) == settings.bNearestFilter;
+    }
+
+    Ref<Texture2D> TextureImporter::LoadTexture(const std::filesystem::path& path, const TextureImportSettings& settings)
     {
         std::filesystem::path finalPath = path;
 
@@ -16,15 +77,148 @@ namespace HRealEngine
             finalPath = Project::GetAssetDirectory() / finalPath; // assets root + relative
 
         finalPath = std::filesystem::weakly_canonical(finalPath);
-        
+
+        // Only textures inside the project get a cooked copy
+        const std::filesystem::path assetDirectory = std::filesystem::weakly_canonical(Project::GetAssetDirectory());
+        const std::filesystem::path relativePath = finalPath.lexically_relative(assetDirectory);
+        if (relativePath.empty() || *relativePath.begin() == "..")
+            return LoadSourceTexture(finalPath, settings);
+
+        const std::filesystem::path cookedPath = assetDirectory / GetCookedPath(relativePath);
+        std::error_code ec;
+        const bool bSourceExists = std::filesystem::exists(finalPath, ec);
+        bool bCookedValid = std::filesystem::exists(cookedPath, ec);
+        if (bCookedValid && bSourceExists)
+            bCookedValid = std::filesystem::last_write_time(cookedPath, ec) >= std::filesystem::last_write_time(finalPath, ec);
+        if (bCookedValid && bSourceExists)
+            bCookedValid = IsCookedUpToDate(cookedPath, settings);
+
+        if (!bCookedValid && bSourceExists && !CookTexture(finalPath, cookedPath, settings))
+            return LoadSourceTexture(finalPath, settings);
+
+        Ref<Texture2D> texture = LoadCookedTexture(cookedPath, settings);
+        if (!texture && bSourceExists)
+            return LoadSourceTexture(finalPath, settings);
+        return texture;
+    }
+
+    bool TextureImporter::CookTexture(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const TextureImportSettings& settings)
+    {
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(true);
+        // Always expand to RGBA so grey and grey alpha images take the same path
+        stbi_uc* pixels = stbi_load(sourcePath.string().c_str(), &width, &height, &channels, 4);
+        if (pixels == nullptr)
+        {
+            LOG_CORE_ERROR("Failed to load texture image from path: {}", sourcePath.string());
+            return false;
+        }
+
+        bool bHasAlpha = false;
+        if (channels == 2 || channels == 4)
+        {
+            for (size_t i = 0; i < (size_t)width * height && !bHasAlpha; i++)
+                bHasAlpha = pixels[i * 4 + 3] != 255;
+        }
+
+        HTexBinHeader header;
+        header.Width = (uint32_t)width;
+        header.Height = (uint32_t)height;
+        header.Format = ResolveCookedFormat(settings, bHasAlpha);
+        header.MipLevels = TextureCompressor::GetMipCount(header.Width, header.Height);
+        header.Compression = settings.Compression;
+        header.NearestFilter = settings.bNearestFilter ? 1 : 0;
+        const bool bCompressed = TextureCompressor::IsCompressed(header.Format);
+
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> level(pixels, pixels + (size_t)width * height * 4);
+        stbi_image_free(pixels);
+        uint32_t levelWidth = header.Width, levelHeight = header.Height;
+        for (uint32_t mip = 0; mip < header.MipLevels; mip++)
+        {
+            const size_t offset = data.size();
+            data.resize(offset + TextureCompressor::GetLevelSize(header.Format, levelWidth, levelHeight));
+            if (bCompressed)
+                TextureCompressor::Compress(header.Format, level.data(), levelWidth, levelHeight, data.data() + offset);
+            else
+                std::memcpy(data.data() + offset, level.data(), level.size());
+            if (mip + 1 == header.MipLevels)
+                break;
+            level = TextureCompressor::Downsample(level.data(), levelWidth, levelHeight);
+            levelWidth = std::max(levelWidth / 2, 1u);
+            levelHeight = std::max(levelHeight / 2, 1u);
+        }
+        header.DataSize = data.size();
+
+        std::filesystem::create_directories(cookedPath.parent_path());
+        std::ofstream out(cookedPath, std::ios::binary);
+        if (!out)
+        {
+            LOG_CORE_ERROR("Failed to write cooked texture: {}", cookedPath.string());
+            return false;
+        }
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)data.data(), data.size());
+        LOG_CORE_INFO("Cooked texture: {} ({}x{}, {} mips, {})", cookedPath.string(), width, height, header.MipLevels,
+            header.Format == ImageFormat::BC3 ? "BC3" : header.Format == ImageFormat::BC1 ? "BC1" : "RGBA8");
+        return true;
+    }
+
+    std::filesystem::path TextureImporter::GetCookedPath(const std::filesystem::path& textureRel)
+    {
+        // The source extension stays in the name so a.png and a.jpg do not share a cooked file
+        std::filesystem::path cooked = std::filesystem::path("cache") / textureRel;
+        cooked += ".htex";
+        return cooked;
+    }
+
+    Ref<Texture2D> TextureImporter::LoadCookedTexture(const std::filesystem::path& cookedPath, const TextureImportSettings& settings)
+    {
+        MappedFile file;
+        if (!file.Open(cookedPath))
+        {
+            LOG_CORE_ERROR("Failed to open cooked texture: {}", cookedPath.string());
+            return nullptr;
+        }
+
+        HTexBinHeader header;
+        if (file.Size() < sizeof(header))
+        {
+            LOG_CORE_ERROR("Truncated cooked texture: {}", cookedPath.string());
+            return nullptr;
+        }
+        std::memcpy(&header, file.Data(), sizeof(header));
+        // The data is uploaded level by level, so its size has to match the mip chain exactly
+        const uint64_t expectedSize = GetCookedDataSize(header);
+        if (header.Magic != HTexBinHeader().Magic || header.Version != HTexBinHeader().Version
+            || expectedSize == 0 || header.DataSize != expectedSize || file.Size() < sizeof(header) + header.DataSize)
+        {
+            LOG_CORE_ERROR("Invalid cooked texture: {}", cookedPath.string());
+            return nullptr;
+        }
+
+        TextureSpecification spec;
+        spec.Width = header.Width;
+        spec.Height = header.Height;
+        spec.Format = header.Format;
+        spec.MipLevels = header.MipLevels;
+        ApplyImportFilter(spec, settings);
+        // Uploaded straight from the mapping
+        Ref<Texture2D> textureAsset = Texture2D::Create(spec, Buffer(file.Data() + sizeof(header), header.DataSize));
+        LOG_CORE_INFO("Loaded texture: {} ({}x{}, {} mips)", cookedPath.filename().string(), header.Width, header.Height, header.MipLevels);
+        return textureAsset;
+    }
+
+    Ref<Texture2D> TextureImporter::LoadSourceTexture(const std::filesystem::path& path, const TextureImportSettings& settings)
+    {
         int width, height, channels;
         stbi_set_flip_vertically_on_load(true);
         Buffer data;
-        data.Data = stbi_load(finalPath.string().c_str(), &width, &height, &channels, 0);
+        data.Data = stbi_load(path.string().c_str(), &width, &height, &channels, 0);
         
         if (data.Data == nullptr)
         {
-            LOG_CORE_ERROR("Failed to load texture image from path: {}", finalPath.string());
+            LOG_CORE_ERROR("Failed to load texture image from path: {}", path.string());
             return nullptr;
         }
         data.Size = width * height * channels;
@@ -41,9 +235,10 @@ namespace HRealEngine
                 spec.Format = ImageFormat::RGBA8;
                 break;
         }
+        ApplyImportFilter(spec, settings);
         Ref<Texture2D> textureAsset = Texture2D::Create(spec, data);
         data.Release();
-        LOG_CORE_INFO("Loaded texture: {} ({}x{}, {} channels)", finalPath.filename().string(), width, height, channels);
+        LOG_CORE_INFO("Loaded texture: {} ({}x{}, {} channels)", path.filename().string(), width, height, channels);
         return textureAsset;
     }
 }
@@ -5,10 +5,32 @@
 
 namespace HRealEngine
 {
+    // Cooked texture: the header, then MipLevels levels back to back (largest first) in Format.
+    // Compression and NearestFilter record the import settings it was cooked with so a settings change recooks it
+    struct HTexBinHeader
+    {
+        uint32_t Magic = 0x58544848;
+        uint32_t Version = 2;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        ImageFormat Format = ImageFormat::None;
+        uint32_t MipLevels = 0;
+        TextureCompression Compression = TextureCompression::Auto;
+        uint32_t NearestFilter = 0;
+        uint64_t DataSize = 0;
+    };
+
     class TextureImporter
     {
     public:
-        static Ref<Asset> ImportTexture(AssetHandle assetHandle, const AssetMetadata& metaData) { return LoadTexture(metaData.FilePath); }
-        static Ref<Texture2D> LoadTexture(const std::filesystem::path& path);
+        static Ref<Asset> ImportTexture(AssetHandle assetHandle, const AssetMetadata& metaData) { return LoadTexture(metaData.FilePath, metaData.Texture); }
+        // Loads the cooked copy, cooking it first when it is missing, older than the source image or cooked with other settings
+        static Ref<Texture2D> LoadTexture(const std::filesystem::path& path, const TextureImportSettings& settings = {});
+        // Decodes the source and builds the mip chain on the CPU, block compressed (BC1/BC3) or raw RGBA8 depending on settings
+        static bool CookTexture(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const TextureImportSettings& settings = {});
+        static std::filesystem::path GetCookedPath(const std::filesystem::path& textureRel);
+    private:
+        static Ref<Texture2D> LoadCookedTexture(const std::filesystem::path& cookedPath, const TextureImportSettings& settings);
+        static Ref<Texture2D> LoadSourceTexture(const std::filesystem::path& path, const TextureImportSettings& settings);
     };
 }
@@ -3,14 +3,18 @@
 #include "HRpch.h"
 #include "Application.h"
 
+#include <chrono>
 #include <filesystem>
+#include <thread>
 
 #include "BehaviorTreeThings/Core/PlatformUtilsBT.h"
 #include "HRealEngine/Asset/TextureImporter.h"
+#include "FrameGovernor.h"
 #include "HRealEngine/Project/Project.h"
 #include "HRealEngine/Renderer/Renderer.h"
 #include "HRealEngine/Scripting/ScriptEngine.h"
 #include "HRealEngine/Utils/PlatformUtils.h"
+#include "Platform/Null/NullWindow.h"
 
 namespace HRealEngine
 {
@@ -28,25 +32,52 @@ namespace HRealEngine
 		/*if (!m_ApplicationSpecification.WorkingDirectory.empty())
 			std::filesystem::current_path(m_ApplicationSpecification.WorkingDirectory);*/
 		
-		m_Window = Window::Create(WindowSettings(m_ApplicationSpecification.Name));
-		m_Window->SetEventCallback(BIND_EVENT_FN(Application::OnEvent));
-		PlatformUtilsBT::SetWindow((GLFWwindow*)m_Window->GetNativeWindow());
+		if (m_ApplicationSpecification.bHeadless)
+		{
+			RendererAPI::SetAPI(RendererAPI::API::None);
+			m_Window = CreateScope<NullWindow>(WindowSettings(m_ApplicationSpecification.Name));
+			m_Window->SetEventCallback(BIND_EVENT_FN(Application::OnEvent));
+		}
+		else
+		{
+			m_Window = Window::Create(WindowSettings(m_ApplicationSpecification.Name));
+			m_Window->SetEventCallback(BIND_EVENT_FN(Application::OnEvent));
+			PlatformUtilsBT::SetWindow((GLFWwindow*)m_Window->GetNativeWindow());
+		}
 
 		Renderer::Init();
 		//ScriptEngine::Init();
 		LOG_CORE_INFO("HRealEngine initialized!");
-		m_ImGuiLayer = new ImGuiLayer();
-		PushOverlay(m_ImGuiLayer);
+		if (!m_ApplicationSpecification.bHeadless)
+		{
+			m_ImGuiLayer = new ImGuiLayer();
+			PushOverlay(m_ImGuiLayer);
+		}
+
+		FrameGovernor::SetTargetFrameRate(m_ApplicationSpecification.bHeadless ? m_ApplicationSpecification.HeadlessTickRate : m_ApplicationSpecification.TargetFrameRate);
+#ifdef HREALENGINE_PLATFORM_WINDOWS
+		// Default timer resolution is ~15 ms, far too coarse for sleeping inside a frame
+		timeBeginPeriod(1);
+#endif
 	}
 	Application::~Application()
 	{
+#ifdef HREALENGINE_PLATFORM_WINDOWS
+		timeEndPeriod(1);
+#endif
 		ScriptEngine::Shutdown();
 		Renderer::Shutdown();
 	}
 	void Application::Run()
 	{
+		if (m_ApplicationSpecification.bHeadless)
+		{
+			RunHeadless();
+			return;
+		}
 		while (m_bRunning)
 		{
+			std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
 			float time = Time::GetTime();
 			Timestep timeStep = time - m_LastFrameTime;
 			m_LastFrameTime = time;
@@ -58,12 +89,84 @@ namespace HRealEngine
 			{
 				for (Layer* layer : m_LayerStack)
 					layer->OnUpdate(timeStep);
+				for (Layer* layer : m_LayerStack)
+					layer->OnLateUpdate(timeStep);
 				m_ImGuiLayer->Begin();
 				for (Layer* layer : m_LayerStack)	
 					layer->OnImGuiRender();
 				m_ImGuiLayer->End();
 			}
+			// Measured before the swap, with VSync the swap blocks and would always look like a full budget
+			FrameGovernor::EndFrame(std::chrono::duration<float>(std::chrono::steady_clock::now() - frameStart).count());
 			m_Window->OnUpdate();
+			WaitForNextFrame(frameStart);
+		}
+	}
+
+	void Application::WaitForNextFrame(std::chrono::steady_clock::time_point frameStart)
+	{
+		using Clock = std::chrono::steady_clock;
+		if (m_ApplicationSpecification.TargetFrameRate <= 0.0f)
+			return;
+
+		// Sleeping can wake up late, so it stops short of the deadline and the rest is spun
+		constexpr Clock::duration spinThreshold = std::chrono::microseconds(1500);
+		const Clock::time_point deadline = frameStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_ApplicationSpecification.TargetFrameRate));
+		
+		Clock::time_point now = Clock::now();
+		if (deadline - now > spinThreshold)
+			std::this_thread::sleep_for(deadline - now - spinThreshold);
+		while (Clock::now() < deadline)
+			std::this_thread::yield();
+	}
+	void Application::RunHeadless()
+	{
+		using Clock = std::chrono::steady_clock;
+		
+		float tickRate = m_ApplicationSpecification.HeadlessTickRate;
+		if (tickRate <= 0.0f)
+		{
+			LOG_CORE_WARN("Invalid headless tick rate {}, falling back to 60", tickRate);
+			tickRate = 60.0f;
+		}
+		const Timestep fixedStep = 1.0f / tickRate;
+		const Clock::duration tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / tickRate));
+		// If the simulation falls further behind than this we drop the missed ticks instead of bursting to catch up
+		const Clock::duration maxLag = tickDuration * 8;
+		LOG_CORE_INFO("Running headless at {} ticks per second", tickRate);
+
+		Clock::time_point nextTick = Clock::now();
+		Clock::time_point reportStart = nextTick;
+		uint32_t ticksSinceReport = 0;
+		while (m_bRunning)
+		{
+			Time::SetDeltaTime(fixedStep);
+			ExecuteMainThreadQueue();
+
+			Clock::time_point tickStart = Clock::now();
+			for (Layer* layer : m_LayerStack)
+				layer->OnUpdate(fixedStep);
+			for (Layer* layer : m_LayerStack)
+				layer->OnLateUpdate(fixedStep);
+			m_Window->OnUpdate();
+			ticksSinceReport++;
+
+			Clock::time_point now = Clock::now();
+			FrameGovernor::EndFrame(std::chrono::duration<float>(now - tickStart).count());
+			double reportElapsed = std::chrono::duration<double>(now - reportStart).count();
+			if (reportElapsed >= 1.0)
+			{
+				m_TicksPerSecond = (float)(ticksSinceReport / reportElapsed);
+				LOG_CORE_INFO("[Headless] {:.1f} ticks/s (target {})", m_TicksPerSecond, tickRate);
+				reportStart = now;
+				ticksSinceReport = 0;
+			}
+
+			nextTick += tickDuration;
+			if (now < nextTick)
+				std::this_thread::sleep_until(nextTick);
+			else if (now - nextTick > maxLag)
+				nextTick = now;
 		}
 	}
 	void Application::OnEvent(EventBase& eventRef)
@@ -7,6 +7,7 @@
 #include "HRealEngine/ImGui/ImGuiLayer.h"
 #include "HRealEngine/Renderer/VertexArray.h"
 
+#include <chrono>
 #include <vector>
 #include <functional>
 #include <mutex>
@@ -33,6 +34,13 @@ namespace HRealEngine
 		AppCommandLineArgs CommandLineArgs;
 
 		std::filesystem::path EditorAssetsPath = "assets";
+
+		// Headless runs without a window or graphics context and updates the layers at a fixed tick instead of per frame
+		bool bHeadless = false;
+		float HeadlessTickRate = 60.0f;
+
+		// Frames are paced to this rate with a sleep followed by a short spin, 0 leaves pacing to VSync
+		float TargetFrameRate = 0.0f;
 	};
 	class HREALENGINE_API Application
 	{
@@ -54,6 +62,8 @@ namespace HRealEngine
 
 		Window& GetWindow() { return *m_Window; }
 		ImGuiLayer* GetImGuiLayer() { return m_ImGuiLayer; }
+		bool IsHeadless() const { return m_ApplicationSpecification.bHeadless; }
+		float GetTicksPerSecond() const { return m_TicksPerSecond; }
 		static Application& Get() { return *s_InstanceOfApp; }
 
 		const ApplicationSpecification& GetSpecification() const { return m_ApplicationSpecification; }
@@ -61,6 +71,8 @@ namespace HRealEngine
 		void SubmitToMainThread(const std::function<void()>& function);
 		
 	private:
+		void RunHeadless();
+		void WaitForNextFrame(std::chrono::steady_clock::time_point frameStart);
 		bool OnWindowClose(WindowCloseEvent& eventRef);
 		bool OnWindowResize(WindowResizeEvent& eventRef);
 
@@ -69,7 +81,7 @@ namespace HRealEngine
 		ApplicationSpecification m_ApplicationSpecification;
 		LayerStack m_LayerStack;
 
-		ImGuiLayer* m_ImGuiLayer;
+		ImGuiLayer* m_ImGuiLayer = nullptr;
 		static Application* s_InstanceOfApp;
 
 		Scope<Window> m_Window;
@@ -79,6 +91,7 @@ namespace HRealEngine
 		bool m_bMinimized = false;
 
 		float m_LastFrameTime = 0.0f;
+		float m_TicksPerSecond = 0.0f;
 
 		std::vector<std::function<void()>> m_MainThreadQueue;
 		std::mutex m_MainThreadQueueMutex;
@@ -4,10 +4,12 @@
 #include "HRealEngine/Camera/SceneCamera.h"
 #include "glm/glm.hpp"
 #include "HRealEngine/Core/UUID.h"
+#include "HRealEngine/Core/TagRegistry.h"
 #include "HRealEngine/Renderer/Texture.h"
 #include <filesystem>
 #include <unordered_set>
 #include "HRealEngine/Renderer/Font.h"
+#include "HRealEngine/Particles/ParticlePool.h"
 
 #include "glm/ext/matrix_transform.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
@@ -68,6 +70,8 @@ namespace HRealEngine
         glm::vec4 Color{ 1.0f };
         float Kerning = 0.0f;
         float LineSpacing = 0.0f;
+
+        TextLayout Layout; // cache, Renderer2D rebuilds it when the text or the settings above change
     };
 
     struct SpriteRendererComponent
@@ -98,6 +102,8 @@ namespace HRealEngine
         //std::vector<std::string> MaterialOverrides;
         std::vector<AssetHandle> MaterialHandleOverrides;
         float TilingFactor = 1.0f;
+        // Large meshes flagged here are rasterized into the occlusion buffer and hide what is behind them
+        bool bOccluder = false;
         
         MeshRendererComponent() = default;
         MeshRendererComponent(const MeshRendererComponent&) = default;
@@ -212,6 +218,7 @@ namespace HRealEngine
         PerceivableComponent(const PerceivableComponent&) = default;
     };
 
+    // Rename through Entity::SetName, the scene name index follows registry.patch
     struct EntityNameComponent
     {
         std::string Name;
@@ -221,13 +228,16 @@ namespace HRealEngine
         EntityNameComponent(const std::string& name) : Name(name) {}
     };
 
+    // Changes have to go through registry.patch (Entity::AddTag/RemoveTag do) so the scene tag index sees them
     struct TagComponent
     {
-        std::vector<std::string> Tags;
+        std::vector<TagID> Tags; // interned through TagRegistry
 
         TagComponent() = default;
         TagComponent(const TagComponent&) = default;
-        TagComponent(const std::vector<std::string>& tags) : Tags(tags) {}
+        TagComponent(const std::vector<TagID>& tags) : Tags(tags) {}
+
+        bool Has(TagID tag) const { return std::find(Tags.begin(), Tags.end(), tag) != Tags.end(); }
     };
 
     struct CameraComponent
@@ -341,6 +351,23 @@ namespace HRealEngine
         CircleRendererComponent(const CircleRendererComponent&) = default;
     };
 
+    struct ParticleEmitterComponent
+    {
+        ParticleEmitterProps Props;
+
+        // Runtime, a copied emitter starts with no particles of its own
+        Ref<ParticlePool> Pool;
+        float EmitAccumulator = 0.0f;
+
+        ParticleEmitterComponent() = default;
+        ParticleEmitterComponent(const ParticleEmitterComponent& other) : Props(other.Props) {}
+        ParticleEmitterComponent& operator=(const ParticleEmitterComponent& other)
+        {
+            Props = other.Props;
+            return *this;
+        }
+    };
+
     struct CircleCollider2DComponent
     {
         glm::vec2 Offset = {0.0f, 0.0f};
@@ -375,6 +402,7 @@ namespace HRealEngine
         AIControllerComponent,
         PerceivableComponent,
         CircleRendererComponent,
+        ParticleEmitterComponent,
         NativeScriptComponent,
         ScriptComponent,
         Rigidbody2DComponent,
@@ -12,13 +12,18 @@
 #else
 	#define HREALENGINE_API
 #endif
+	#define HREALENGINE_DEBUGBREAK() __debugbreak()
+#elif defined(HREALENGINE_PLATFORM_LINUX)
+	#include <signal.h>
+	#define HREALENGINE_API
+	#define HREALENGINE_DEBUGBREAK() raise(SIGTRAP)
 #else
-	#error HRealEngine only supports Windows!
+	#error HRealEngine only supports Windows and Linux!
 #endif
 
 #ifdef HREALENGINE_ENABLE_DEBUGBREAKS
-	#define HREALENGINE_CLIENT_DEBUGBREAK(x, ...) { if(!(x)) { LOG_CLIENT_ERROR("Assertion Failed: {0}", __VA_ARGS__); __debugbreak()} }
-	#define HREALENGINE_CORE_CLIENT_DEBUGBREAK(x, ...) { if(!(x)) { LOG_CORE_ERROR("Assertion Failed: {0}", __VA_ARGS__); __debugbreak() } }
+	#define HREALENGINE_CLIENT_DEBUGBREAK(x, ...) { if(!(x)) { LOG_CLIENT_ERROR("Assertion Failed: {0}", __VA_ARGS__); HREALENGINE_DEBUGBREAK(); } }
+	#define HREALENGINE_CORE_CLIENT_DEBUGBREAK(x, ...) { if(!(x)) { LOG_CORE_ERROR("Assertion Failed: {0}", __VA_ARGS__); HREALENGINE_DEBUGBREAK(); } }
 #else
 	#define HREALENGINE_CLIENT_DEBUGBREAK(x, ...)
 	#define HREALENGINE_CORE_DEBUGBREAK(x, ...)
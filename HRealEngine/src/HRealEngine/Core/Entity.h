@@ -42,6 +42,12 @@ namespace HRealEngine
                 return false;
             return m_Scene->GetRegistry().all_of<T>(m_EntityHandle);
         }
+        // Edits the component through the registry so the scene's on_update listeners see it, no functions just signals the change
+        template<typename T, typename... Func>
+        void PatchComponent(Func&&... func)
+        {
+            m_Scene->GetRegistry().patch<T>(m_EntityHandle, std::forward<Func>(func)...);
+        }
         template<typename T>
         void RemoveComponent()
         {
@@ -55,28 +61,38 @@ namespace HRealEngine
             return GetComponent<EntityIDComponent>().ID;
         }
         const std::string& GetName() { return GetComponent<EntityNameComponent>().Name; }
+        void SetName(const std::string& name)
+        {
+            m_Scene->GetRegistry().patch<EntityNameComponent>(m_EntityHandle, [&name](EntityNameComponent& component) { component.Name = name; });
+        }
         void Destroy() { m_Scene->DestroyEntity(*this); }
-        bool HasTag(const std::string& tag) 
+        bool HasTag(TagID tag) 
         {
-            if (!HasComponent<TagComponent>())
+            if (tag == InvalidTagID || !HasComponent<TagComponent>())
                 return false;
-            const auto& tags = GetComponent<TagComponent>().Tags;
-            return std::find(tags.begin(), tags.end(), tag) != tags.end();
+            return GetComponent<TagComponent>().Has(tag);
         }
+        bool HasTag(const std::string& tag) { return HasTag(TagRegistry::Find(tag)); }
         void AddTag(const std::string& tag)
         {
+            TagID id = TagRegistry::Intern(tag);
             if (!HasComponent<TagComponent>())
-                AddComponent<TagComponent>();
-            auto& tags = GetComponent<TagComponent>().Tags;
-            if (std::find(tags.begin(), tags.end(), tag) == tags.end())
-                tags.push_back(tag);
+            {
+                AddComponent<TagComponent>(std::vector<TagID>{ id });
+                return;
+            }
+            if (!HasTag(id))
+                m_Scene->GetRegistry().patch<TagComponent>(m_EntityHandle, [id](TagComponent& component) { component.Tags.push_back(id); });
         }
         void RemoveTag(const std::string& tag)
         {
-            if (!HasComponent<TagComponent>())                
+            TagID id = TagRegistry::Find(tag);
+            if (!HasTag(id))
                 return;
-            auto& tags = GetComponent<TagComponent>().Tags;
-            tags.erase(std::remove(tags.begin(), tags.end(), tag), tags.end());
+            m_Scene->GetRegistry().patch<TagComponent>(m_EntityHandle, [id](TagComponent& component)
+            {
+                component.Tags.erase(std::remove(component.Tags.begin(), component.Tags.end(), id), component.Tags.end());
+            });
         }
         
         operator bool() const { return m_EntityHandle != entt::null; }
@@ -1,7 +1,7 @@
 
 #pragma once
 
-#ifdef HREALENGINE_PLATFORM_WINDOWS
+#if defined(HREALENGINE_PLATFORM_WINDOWS) || defined(HREALENGINE_PLATFORM_LINUX)
 
 extern HRealEngine::Application* HRealEngine::CreateApplication(AppCommandLineArgs args);/*This function is not defined here, but trust me, it will be defined in another compilation unit.
 when you build the whole solution (engine + Sandbox), the linker finds Sandbox’s definition and connects it.*/
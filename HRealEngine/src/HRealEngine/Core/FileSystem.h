@@ -10,4 +10,27 @@ namespace HRealEngine
     public:
         static Buffer ReadFileBinary(const std::filesystem::path& filepath);
     };
+
+    // Read only view of a whole file, the OS pages it in as it is touched instead of copying it into a buffer.
+    // Implemented per platform.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::filesystem::path& filepath);
+        void Close();
+
+        const uint8_t* Data() const { return m_Data; }
+        uint64_t Size() const { return m_Size; }
+
+        operator bool() const { return m_Data != nullptr; }
+    private:
+        const uint8_t* m_Data = nullptr;
+        uint64_t m_Size = 0;
+        void* m_MappingHandle = nullptr;
+    };
 }
@@ -0,0 +1,85 @@
+#include "HRpch.h"
+#include "FrameGovernor.h"
+
+namespace HRealEngine
+{
+    float FrameGovernor::s_TargetFrameRate = 0.0f;
+    float FrameGovernor::s_FrameBudget = 1.0f / 60.0f;
+    float FrameGovernor::s_AverageWorkTime = 0.0f;
+    uint64_t FrameGovernor::s_FrameIndex = 0;
+    int FrameGovernor::s_Level = 0;
+    int FrameGovernor::s_FramesOverBudget = 0;
+    int FrameGovernor::s_FramesUnderBudget = 0;
+    bool FrameGovernor::s_bEnabled = true;
+
+    // Frames in a row needed before the level changes, raising reacts fast, lowering waits so it does not oscillate
+    static constexpr int s_FramesToRaiseLevel = 10;
+    static constexpr int s_FramesToLowerLevel = 120;
+    // Work has to drop below this part of the budget before the level is lowered again
+    static constexpr float s_LowerThreshold = 0.7f;
+    static constexpr float s_AverageWeight = 0.1f;
+    
+    static constexpr uint32_t s_BehaviorTreeTickIntervals[FrameGovernor::MaxLevel + 1] = { 1, 2, 3, 4 };
+    static constexpr uint32_t s_ShadowUpdateIntervals[FrameGovernor::MaxLevel + 1] = { 1, 2, 4, 8 };
+
+    void FrameGovernor::SetTargetFrameRate(float framesPerSecond)
+    {
+        s_TargetFrameRate = framesPerSecond > 0.0f ? framesPerSecond : 0.0f;
+        s_FrameBudget = 1.0f / (s_TargetFrameRate > 0.0f ? s_TargetFrameRate : 60.0f);
+    }
+
+    void FrameGovernor::EndFrame(float workTime)
+    {
+        s_FrameIndex++;
+        s_AverageWorkTime = s_AverageWorkTime == 0.0f ? workTime : s_AverageWorkTime + (workTime - s_AverageWorkTime) * s_AverageWeight;
+        if (!s_bEnabled)
+            return;
+
+        if (s_AverageWorkTime > s_FrameBudget)
+        {
+            s_FramesUnderBudget = 0;
+            if (++s_FramesOverBudget >= s_FramesToRaiseLevel && s_Level < MaxLevel)
+            {
+                s_Level++;
+                s_FramesOverBudget = 0;
+                LOG_CORE_WARN("[FrameGovernor] Frame over budget ({:.2f} ms / {:.2f} ms), level {}", s_AverageWorkTime * 1000.0f, s_FrameBudget * 1000.0f, s_Level);
+            }
+        }
+        else if (s_AverageWorkTime < s_FrameBudget * s_LowerThreshold)
+        {
+            s_FramesOverBudget = 0;
+            if (++s_FramesUnderBudget >= s_FramesToLowerLevel && s_Level > 0)
+            {
+                s_Level--;
+                s_FramesUnderBudget = 0;
+                LOG_CORE_INFO("[FrameGovernor] Frame back within budget, level {}", s_Level);
+            }
+        }
+        else
+        {
+            s_FramesOverBudget = 0;
+            s_FramesUnderBudget = 0;
+        }
+    }
+
+    void FrameGovernor::SetEnabled(bool enabled)
+    {
+        s_bEnabled = enabled;
+        if (!enabled)
+        {
+            s_Level = 0;
+            s_FramesOverBudget = 0;
+            s_FramesUnderBudget = 0;
+        }
+    }
+
+    uint32_t FrameGovernor::GetBehaviorTreeTickInterval()
+    {
+        return s_BehaviorTreeTickIntervals[s_Level];
+    }
+
+    uint32_t FrameGovernor::GetShadowUpdateInterval()
+    {
+        return s_ShadowUpdateIntervals[s_Level];
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+
+namespace HRealEngine
+{
+    // Watches how long the CPU side of each frame takes compared to the frame budget and, when frames keep running over,
+    // lowers the rate of work that can be spread over several frames (behavior tree ticks, shadow map updates).
+    class FrameGovernor
+    {
+    public:
+        static constexpr int MaxLevel = 3;
+        
+        // 0 means no target, the budget then falls back to 60 Hz for the governor
+        static void SetTargetFrameRate(float framesPerSecond);
+        static float GetTargetFrameRate() { return s_TargetFrameRate; }
+        static float GetFrameBudget() { return s_FrameBudget; }
+
+        // Called once per frame with the time spent working, pacing/sleeping excluded
+        static void EndFrame(float workTime);
+
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled() { return s_bEnabled; }
+        
+        static int GetLevel() { return s_Level; }
+        static float GetAverageWorkTime() { return s_AverageWorkTime; }
+        static uint64_t GetFrameIndex() { return s_FrameIndex; }
+
+        static uint32_t GetBehaviorTreeTickInterval();
+        static uint32_t GetShadowUpdateInterval();
+        static bool ShouldUpdateShadows() { return s_FrameIndex % GetShadowUpdateInterval() == 0; }
+    private:
+        static float s_TargetFrameRate;
+        static float s_FrameBudget;
+        static float s_AverageWorkTime;
+        static uint64_t s_FrameIndex;
+        static int s_Level;
+        static int s_FramesOverBudget;
+        static int s_FramesUnderBudget;
+        static bool s_bEnabled;
+    };
+}
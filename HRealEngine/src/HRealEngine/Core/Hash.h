@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace HRealEngine
+{
+    // Mixes value into seed, order dependent. Only for in-memory change detection, never persisted.
+    inline void HashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    static constexpr uint64_t s_HashBytesSeed = 0xcbf29ce484222325ull;
+
+    // FNV-1a over raw bytes, start from s_HashBytesSeed. Stable across runs and platforms, safe for on-disk cache keys.
+    inline uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
@@ -17,6 +17,8 @@ namespace HRealEngine
 		virtual void OnAttach() {}
 		virtual void OnDetach() {}
 		virtual void OnUpdate(Timestep timestep) {}
+		// Runs after every layer has finished OnUpdate for the frame
+		virtual void OnLateUpdate(Timestep timestep) {}
 		virtual void OnImGuiRender() {}
 		virtual void OnEvent(EventBase& eventRef) {}
 
@@ -7,8 +7,11 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <glm/gtc/packing.hpp>
 
 #include "BehaviorTreeThings/Core/Nodes.h"
+#include "HRealEngine/Core/MeshOptimizer.h"
+#include "HRealEngine/Core/MeshSimplifier.h"
 #include "HRealEngine/Project/Project.h"
 #include "HRealEngine/Renderer/Renderer3D.h"
 
@@ -90,6 +93,49 @@ namespace HRealEngine
     }
 
 
+    static glm::vec2 OctahedralEncode(glm::vec3 n)
+    {
+        const float sum = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+        if (sum <= 0.0f)
+            return glm::vec2(0.0f, 1.0f);// MeshVertex default up
+        n /= sum;
+        if (n.z >= 0.0f)
+            return glm::vec2(n.x, n.y);
+        return (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    static glm::vec3 OctahedralDecode(const glm::vec2& e)
+    {
+        glm::vec3 n(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+        const float t = glm::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+    static QuantizedMeshVertex QuantizeVertex(const MeshVertex& v, const glm::vec3& boundsMin, const glm::vec3& boundsExtent)
+    {
+        QuantizedMeshVertex q;
+        for (int i = 0; i < 3; i++)
+        {
+            const float t = boundsExtent[i] > 0.0f ? glm::clamp((v.Position[i] - boundsMin[i]) / boundsExtent[i], 0.0f, 1.0f) : 0.0f;
+            q.Position[i] = (uint16_t)glm::round(t * 65535.0f);
+        }
+        const glm::vec2 n = OctahedralEncode(v.Normal);
+        q.Normal[0] = (int16_t)glm::round(glm::clamp(n.x, -1.0f, 1.0f) * 32767.0f);
+        q.Normal[1] = (int16_t)glm::round(glm::clamp(n.y, -1.0f, 1.0f) * 32767.0f);
+        q.UV[0] = glm::packHalf1x16(v.UV.x);
+        q.UV[1] = glm::packHalf1x16(v.UV.y);
+        return q;
+    }
+    static MeshVertex DequantizeVertex(const QuantizedMeshVertex& q, const glm::vec3& boundsMin, const glm::vec3& boundsExtent)
+    {
+        MeshVertex v;
+        for (int i = 0; i < 3; i++)
+            v.Position[i] = boundsMin[i] + (float)q.Position[i] / 65535.0f * boundsExtent[i];
+        v.Normal = OctahedralDecode(glm::max(glm::vec2(q.Normal[0], q.Normal[1]) / 32767.0f, glm::vec2(-1.0f)));
+        v.UV = glm::vec2(glm::unpackHalf1x16(q.UV[0]), glm::unpackHalf1x16(q.UV[1]));
+        return v;
+    }
+
     bool MeshLoader::LoadMeshFromFile(const std::string& path,
         std::vector<MeshVertex>& outVertices, std::vector<uint32_t>& outIndices, std::vector<HMeshBinSubmesh>* outSubmeshes, glm::vec3& outBoundsMin, glm::vec3& outBoundsMax)
     {
@@ -289,9 +335,167 @@ namespace HRealEngine
         return materialRelPaths;
     }
 
+    void MeshLoader::GenerateLods(const std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices, std::vector<HMeshBinSubmesh>& submeshes,
+        std::vector<HMeshBinLod>& outLods, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        // Screen height fraction one unit of simplification error may cover, about a pixel at 1080p
+        constexpr float screenErrorTolerance = 0.001f;
+
+        if (submeshes.empty())
+            submeshes.push_back({ 0, (uint32_t)indices.size(), 0 });
+
+        outLods.clear();
+        outLods.push_back({ std::numeric_limits<float>::max(), 0, (uint32_t)indices.size() });
+
+        const float radius = glm::length(boundsMax - boundsMin) * 0.5f;
+        if (radius <= 0.0f)
+            return;
+
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertices.size());
+        for (const MeshVertex& v : vertices)
+            positions.push_back(v.Position);
+
+        std::vector<HMeshBinSubmesh> previousSubmeshes = submeshes;
+        for (uint32_t level = 1; level < MaxMeshLods; level++)
+        {
+            const HMeshBinLod& previous = outLods.back();
+            const uint32_t levelOffset = (uint32_t)indices.size();
+            std::vector<HMeshBinSubmesh> levelSubmeshes;
+            float levelError = 0.0f;
+            for (const HMeshBinSubmesh& sm : previousSubmeshes)
+            {
+                std::vector<uint32_t> source(indices.begin() + sm.IndexOffset, indices.begin() + sm.IndexOffset + sm.IndexCount);
+                float error = 0.0f;
+                std::vector<uint32_t> simplified = MeshSimplifier::Simplify(positions, source, source.size() / 6 * 3, error);
+                levelError = std::max(levelError, error);
+
+                levelSubmeshes.push_back({ (uint32_t)indices.size(), (uint32_t)simplified.size(), sm.MaterialIndex });
+                indices.insert(indices.end(), simplified.begin(), simplified.end());
+            }
+
+            // Stop once locked seams and borders keep the simplifier from making real progress
+            const uint32_t levelCount = (uint32_t)indices.size() - levelOffset;
+            if (levelCount == 0 || levelCount > previous.IndexCount * 4 / 5)
+            {
+                indices.resize(levelOffset);
+                break;
+            }
+
+            // The error projects to levelError / (2 * radius) of the bounds' screen size, pick the size where that hits the tolerance
+            float screenSize = previous.ScreenSize;
+            if (levelError > 0.0f)
+                screenSize = std::min(screenSize, screenErrorTolerance * 2.0f * radius / levelError);
+
+            outLods.push_back({ screenSize, levelOffset, levelCount });
+            submeshes.insert(submeshes.end(), levelSubmeshes.begin(), levelSubmeshes.end());
+            previousSubmeshes = std::move(levelSubmeshes);
+        }
+    }
+
+    void MeshLoader::OptimizeMesh(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices, const std::vector<HMeshBinSubmesh>& submeshes)
+    {
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertices.size());
+        for (const MeshVertex& v : vertices)
+            positions.push_back(v.Position);
+
+        auto optimizeRange = [&](uint32_t offset, uint32_t count)
+        {
+            MeshOptimizer::OptimizeVertexCache(indices.data() + offset, count, vertices.size());
+            MeshOptimizer::OptimizeOverdraw(indices.data() + offset, count, positions);
+        };
+        if (submeshes.empty())
+            optimizeRange(0, (uint32_t)indices.size());
+        for (const HMeshBinSubmesh& sm : submeshes)
+            optimizeRange(sm.IndexOffset, sm.IndexCount);
+
+        const std::vector<uint32_t> order = MeshOptimizer::OptimizeVertexFetch(indices, vertices.size());
+        std::vector<MeshVertex> reordered;
+        reordered.reserve(order.size());
+        for (uint32_t oldIndex : order)
+            reordered.push_back(vertices[oldIndex]);
+        vertices = std::move(reordered);
+    }
+
+    uint32_t MeshLoader::GetVertexStride(HMeshBinVertexFormat format)
+    {
+        return format == HMeshBinVertexFormat::Quantized ? (uint32_t)sizeof(QuantizedMeshVertex) : (uint32_t)sizeof(MeshVertex);
+    }
+
+    void MeshLoader::DecodeVertices(const HMeshBinData& data, std::vector<MeshVertex>& outVertices)
+    {
+        const uint32_t count = data.Header.VertexCount;
+        outVertices.resize(count);
+        if (data.Header.VertexFormat == HMeshBinVertexFormat::Float)
+        {
+            std::memcpy(outVertices.data(), data.VertexData, sizeof(MeshVertex) * count);
+            return;
+        }
+        const QuantizedMeshVertex* quantized = (const QuantizedMeshVertex*)data.VertexData;
+        const glm::vec3 extent = data.Header.BoundsMax - data.Header.BoundsMin;
+        for (uint32_t i = 0; i < count; i++)
+            outVertices[i] = DequantizeVertex(quantized[i], data.Header.BoundsMin, extent);
+    }
+
+    bool MeshLoader::BuildOccluder(MeshGPU& mesh)
+    {
+        if (mesh.bOccluderBuilt)
+            return !mesh.OccluderIndices.empty();
+        mesh.bOccluderBuilt = true;
+
+        HMeshBinData data;
+        if (mesh.CookedPath.empty() || !ReadHMeshBin(mesh.CookedPath, data))
+            return false;
+
+        // The coarsest level makes the cheapest occluder
+        const HMeshBinLod& lod = data.Lods.back();
+        if (lod.IndexCount / 3 > MeshGPU::MaxOccluderTriangles)
+            return false;
+
+        // Renumber the referenced vertices in first use order so the copy is bounded by the triangle cap, not the full mesh
+        const glm::vec3 extent = data.Header.BoundsMax - data.Header.BoundsMin;
+        std::unordered_map<uint32_t, uint32_t> remap;
+        remap.reserve(lod.IndexCount);
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+        indices.reserve(lod.IndexCount);
+        for (uint32_t i = 0; i < lod.IndexCount; i++)
+        {
+            const uint32_t index = data.Indices[lod.IndexOffset + i];
+            if (index >= data.Header.VertexCount)
+            {
+                LOG_CORE_ERROR("Occluder index out of range in cooked mesh: {}", mesh.CookedPath.string());
+                return false;
+            }
+            auto [it, bInserted] = remap.try_emplace(index, (uint32_t)positions.size());
+            if (bInserted)
+            {
+                if (data.Header.VertexFormat == HMeshBinVertexFormat::Quantized)
+                    positions.push_back(DequantizeVertex(((const QuantizedMeshVertex*)data.VertexData)[index], data.Header.BoundsMin, extent).Position);
+                else
+                    positions.push_back(((const MeshVertex*)data.VertexData)[index].Position);
+            }
+            indices.push_back(it->second);
+        }
+        mesh.OccluderPositions = std::move(positions);
+        mesh.OccluderIndices = std::move(indices);
+        return !mesh.OccluderIndices.empty();
+    }
+
     bool MeshLoader::WriteHMeshBin(const std::filesystem::path& path, const std::vector<MeshVertex>& vertices,
-        const std::vector<uint32_t>& indices, const std::vector<HMeshBinSubmesh>& submeshes, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+        const std::vector<uint32_t>& indices, const std::vector<HMeshBinSubmesh>& submeshes, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+        const std::vector<HMeshBinLod>& lods, HMeshBinVertexFormat vertexFormat, const std::vector<AssetHandle>& materialHandles)
     {
+        std::vector<HMeshBinLod> levels = lods;
+        if (levels.empty())
+            levels.push_back({ std::numeric_limits<float>::max(), 0, (uint32_t)indices.size() });
+        if (submeshes.size() % levels.size() != 0)
+        {
+            LOG_CORE_ERROR("HMeshBin submesh table does not match the lod count: {}", path.string());
+            return false;
+        }
+
         std::filesystem::create_directories(path.parent_path());
 
         std::ofstream out(path, std::ios::binary);
@@ -299,52 +503,167 @@ namespace HRealEngine
             return false;
 
         HMeshBinHeader header;
-        header.Version = 2;
+        header.Version = 5;
         header.VertexCount = (uint32_t)vertices.size();
         header.IndexCount  = (uint32_t)indices.size();
-        header.SubmeshCount = (uint32_t)submeshes.size();
+        header.SubmeshCount = (uint32_t)(submeshes.size() / levels.size());
         header.BoundsMin = boundsMin;
         header.BoundsMax = boundsMax;
+        header.LodCount = (uint32_t)levels.size();
+        header.VertexFormat = vertexFormat;
+        header.MaterialCount = (uint32_t)materialHandles.size();
+        const size_t tablesEnd = sizeof(header) + sizeof(HMeshBinLod) * levels.size() + sizeof(HMeshBinSubmesh) * submeshes.size()
+            + sizeof(uint64_t) * materialHandles.size();
+        header.VertexDataOffset = (uint32_t)((tablesEnd + 15) & ~(size_t)15);
 
         out.write((const char*)&header, sizeof(header));
+        out.write((const char*)levels.data(), sizeof(HMeshBinLod) * levels.size());
         if (!submeshes.empty())
             out.write((const char*)submeshes.data(), sizeof(HMeshBinSubmesh) * submeshes.size());
-        out.write((const char*)vertices.data(), sizeof(MeshVertex) * vertices.size());
+        for (AssetHandle handle : materialHandles)
+        {
+            const uint64_t id = (uint64_t)handle;
+            out.write((const char*)&id, sizeof(id));
+        }
+        const char padding[16] = {};
+        out.write(padding, header.VertexDataOffset - tablesEnd);
+        if (vertexFormat == HMeshBinVertexFormat::Quantized)
+        {
+            const glm::vec3 extent = boundsMax - boundsMin;
+            std::vector<QuantizedMeshVertex> quantized;
+            quantized.reserve(vertices.size());
+            for (const MeshVertex& v : vertices)
+                quantized.push_back(QuantizeVertex(v, boundsMin, extent));
+            out.write((const char*)quantized.data(), sizeof(QuantizedMeshVertex) * quantized.size());
+        }
+        else
+            out.write((const char*)vertices.data(), sizeof(MeshVertex) * vertices.size());
         out.write((const char*)indices.data(),  sizeof(uint32_t) * indices.size());
         return true;
     }
 
-    bool MeshLoader::ReadHMeshBin(const std::filesystem::path& path, std::vector<MeshVertex>& outVertices,
-        std::vector<uint32_t>& outIndices, std::vector<HMeshBinSubmesh>* outSubmeshes, glm::vec3& outBoundsMin, glm::vec3& outBoundsMax)
+    bool MeshLoader::ReadHMeshBin(const std::filesystem::path& path, HMeshBinData& outData)
     {
-        std::ifstream in(path, std::ios::binary);
-        if (!in)
+        MappedFile& file = outData.File;
+        if (!file.Open(path))
         {
             LOG_CORE_ERROR("Failed to open HMeshBin: {}", path.string());
             return false;
         }
+        const uint8_t* bytes = file.Data();
+        const uint64_t fileSize = file.Size();
 
-        HMeshBinHeader header;
-        in.read((char*)&header, sizeof(header));
+        // Older headers are prefixes of the current one, the fields they lack keep their defaults
+        HMeshBinHeader& header = outData.Header;
+        header = HMeshBinHeader();
+        if (fileSize < offsetof(HMeshBinHeader, LodCount))
+        {
+            LOG_CORE_ERROR("Truncated HMeshBin: {}", path.string());
+            return false;
+        }
+        std::memcpy(&header, bytes, offsetof(HMeshBinHeader, LodCount));
+        if (header.Magic != 0x48534D48 || header.Version < 2 || header.Version > 5)
+            return false;
 
-        if (header.Magic != 0x48534D48 || header.Version != 2)
+        size_t headerSize = offsetof(HMeshBinHeader, LodCount);
+        if (header.Version == 3)
+            headerSize = offsetof(HMeshBinHeader, VertexFormat);
+        else if (header.Version == 4)
+            headerSize = offsetof(HMeshBinHeader, MaterialCount);
+        else if (header.Version == 5)
+            headerSize = sizeof(HMeshBinHeader);
+        if (fileSize < headerSize)
+        {
+            LOG_CORE_ERROR("Truncated HMeshBin: {}", path.string());
             return false;
+        }
+        std::memcpy((uint8_t*)&header + offsetof(HMeshBinHeader, LodCount), bytes + offsetof(HMeshBinHeader, LodCount),
+            headerSize - offsetof(HMeshBinHeader, LodCount));
+        if (header.LodCount == 0 || (header.VertexFormat != HMeshBinVertexFormat::Float && header.VertexFormat != HMeshBinVertexFormat::Quantized))
+        {
+            LOG_CORE_ERROR("Invalid HMeshBin header: {}", path.string());
+            return false;
+        }
 
-        outBoundsMin = header.BoundsMin;
-        outBoundsMax = header.BoundsMax;
+        const uint64_t lodBytes = header.Version >= 3 ? sizeof(HMeshBinLod) * (uint64_t)header.LodCount : 0;
+        const uint64_t submeshBytes = sizeof(HMeshBinSubmesh) * (uint64_t)header.SubmeshCount * header.LodCount;
+        const uint64_t materialBytes = sizeof(uint64_t) * (uint64_t)header.MaterialCount;
+        const uint64_t tablesEnd = headerSize + lodBytes + submeshBytes + materialBytes;
+        const uint64_t vertexOffset = header.Version >= 5 ? header.VertexDataOffset : tablesEnd;
+        const uint64_t vertexBytes = (uint64_t)header.VertexCount * GetVertexStride(header.VertexFormat);
+        const uint64_t indexBytes = sizeof(uint32_t) * (uint64_t)header.IndexCount;
+        if (vertexOffset < tablesEnd || vertexOffset % 4 != 0 || vertexOffset + vertexBytes + indexBytes > fileSize)
+        {
+            LOG_CORE_ERROR("Truncated HMeshBin: {}", path.string());
+            return false;
+        }
 
-        std::vector<HMeshBinSubmesh> localSubmeshes;
-        localSubmeshes.resize(header.SubmeshCount);
-        if (header.SubmeshCount > 0)
-            in.read((char*)localSubmeshes.data(), sizeof(HMeshBinSubmesh) * localSubmeshes.size());
+        // The tables are small, copy them out. Vertices and indices stay in the mapping
+        const uint8_t* cursor = bytes + headerSize;
+        outData.Lods.clear();
+        if (header.Version >= 3)
+        {
+            outData.Lods.resize(header.LodCount);
+            std::memcpy(outData.Lods.data(), cursor, lodBytes);
+        }
+        else
+            outData.Lods.push_back({ std::numeric_limits<float>::max(), 0, header.IndexCount });
+        cursor += lodBytes;
 
-        outVertices.resize(header.VertexCount);
-        outIndices.resize(header.IndexCount);
+        outData.Submeshes.resize((size_t)header.SubmeshCount * header.LodCount);
+        if (!outData.Submeshes.empty())
+            std::memcpy(outData.Submeshes.data(), cursor, submeshBytes);
+        cursor += submeshBytes;
 
-        in.read((char*)outVertices.data(), sizeof(MeshVertex) * outVertices.size());
-        in.read((char*)outIndices.data(),  sizeof(uint32_t) * outIndices.size());
+        // Every range is drawn straight from the index buffer, one past its end would read outside the mapping
+        auto isInIndexBuffer = [&header](uint32_t offset, uint32_t count) { return (uint64_t)offset + count <= header.IndexCount; };
+        for (const HMeshBinLod& lod : outData.Lods)
+        {
+            if (!isInIndexBuffer(lod.IndexOffset, lod.IndexCount))
+            {
+                LOG_CORE_ERROR("Invalid HMeshBin lod range: {}", path.string());
+                return false;
+            }
+        }
+        for (const HMeshBinSubmesh& submesh : outData.Submeshes)
+        {
+            if (!isInIndexBuffer(submesh.IndexOffset, submesh.IndexCount))
+            {
+                LOG_CORE_ERROR("Invalid HMeshBin submesh range: {}", path.string());
+                return false;
+            }
+        }
+
+        outData.MaterialHandles.clear();
+        outData.MaterialHandles.reserve(header.MaterialCount);
+        for (uint32_t i = 0; i < header.MaterialCount; i++)
+        {
+            uint64_t id = 0;
+            std::memcpy(&id, cursor + i * sizeof(uint64_t), sizeof(uint64_t));
+            outData.MaterialHandles.push_back((AssetHandle)id);
+        }
+
+        outData.VertexData = bytes + vertexOffset;
+        outData.Indices = (const uint32_t*)(bytes + vertexOffset + vertexBytes);
+        return true;
+    }
+
+    bool MeshLoader::ReadHMeshBin(const std::filesystem::path& path, std::vector<MeshVertex>& outVertices,
+        std::vector<uint32_t>& outIndices, std::vector<HMeshBinSubmesh>* outSubmeshes, glm::vec3& outBoundsMin, glm::vec3& outBoundsMax,
+        std::vector<HMeshBinLod>* outLods)
+    {
+        HMeshBinData data;
+        if (!ReadHMeshBin(path, data))
+            return false;
+
+        DecodeVertices(data, outVertices);
+        outIndices.assign(data.Indices, data.Indices + data.Header.IndexCount);
+        outBoundsMin = data.Header.BoundsMin;
+        outBoundsMax = data.Header.BoundsMax;
         if (outSubmeshes)
-            *outSubmeshes = std::move(localSubmeshes);
+            *outSubmeshes = std::move(data.Submeshes);
+        if (outLods)
+            *outLods = std::move(data.Lods);
         return true;
     }
 
@@ -481,32 +800,56 @@ namespace HRealEngine
     {
         std::filesystem::path hmeshAbs = assetsRoot / hmeshPath;
 
-        std::string cookedRel;
-        if (!ExtractCookedRelativePath(hmeshAbs, cookedRel))
+        // Meshes cooked next to their asset path carry everything in the binary, older imports name it in the .hmesh
+        std::filesystem::path cookedAbs = assetsRoot / GetCookedPath(hmeshAbs.lexically_relative(assetsRoot));
+        if (!std::filesystem::exists(cookedAbs))
         {
-            LOG_CORE_ERROR("Failed to parse Cooked path from: {}", hmeshAbs.string());
-            return nullptr;
+            std::string cookedRel;
+            if (!ExtractCookedRelativePath(hmeshAbs, cookedRel))
+            {
+                LOG_CORE_ERROR("Failed to parse Cooked path from: {}", hmeshAbs.string());
+                return nullptr;
+            }
+            cookedAbs = assetsRoot / cookedRel;
         }
 
-        std::filesystem::path cookedAbs = assetsRoot / cookedRel;
-
-        std::vector<MeshVertex> verts;
-        std::vector<uint32_t> inds;
-        std::vector<HMeshBinSubmesh> submeshes;
-        glm::vec3 bMin, bMax;
-        
-        if (!ReadHMeshBin(cookedAbs, verts, inds, &submeshes, bMin, bMax))
+        HMeshBinData data;
+        if (!ReadHMeshBin(cookedAbs, data))
         {
             LOG_CORE_ERROR("Failed to read cooked mesh: {}", cookedAbs.string());
             return nullptr;
         }
+        const std::vector<HMeshBinLod>& lods = data.Lods;
+        std::vector<HMeshBinSubmesh>& submeshes = data.Submeshes;
 
-        LOG_CORE_INFO("Loaded cooked mesh: {} (V={}, I={})", cookedAbs.string(), verts.size(), inds.size());
+        LOG_CORE_INFO("Loaded cooked mesh: {} (V={}, I={})", cookedAbs.string(), data.Header.VertexCount, data.Header.IndexCount);
 
-        Ref<MeshGPU> mesh = Renderer3D::BuildStaticMeshGPU(verts, inds, shader, bMin, bMax);
+        Ref<MeshGPU> mesh = Renderer3D::BuildStaticMeshGPU(data.VertexData, data.Header.VertexCount, data.Header.VertexFormat,
+            data.Indices, data.Header.IndexCount, shader, data.Header.BoundsMin, data.Header.BoundsMax);
+        mesh->IndexCount = lods[0].IndexCount;
+
+        // Submeshes are stored level major, the first block belongs to the full mesh
+        const size_t submeshesPerLod = submeshes.size() / lods.size();
+        for (size_t level = 1; level < lods.size(); level++)
+        {
+            MeshGPULod lod;
+            lod.ScreenSize = lods[level].ScreenSize;
+            lod.IndexOffset = lods[level].IndexOffset;
+            lod.IndexCount = lods[level].IndexCount;
+            lod.Submeshes.assign(submeshes.begin() + level * submeshesPerLod, submeshes.begin() + (level + 1) * submeshesPerLod);
+            mesh->Lods.push_back(std::move(lod));
+        }
+        submeshes.resize(submeshesPerLod);
+
+        // The occluder copy is only read back for meshes that are actually submitted as occluders
+        mesh->CookedPath = cookedAbs;
 
         std::vector<AssetHandle> handles;
-        if (ParseHMeshMaterialHandles(hmeshAbs, handles))
+        if (data.Header.Version >= 5)
+        {
+            mesh->MaterialHandles = std::move(data.MaterialHandles);
+        }
+        else if (ParseHMeshMaterialHandles(hmeshAbs, handles))
         {
             mesh->MaterialHandles = std::move(handles);
         }
@@ -568,6 +911,13 @@ namespace HRealEngine
         return false;
     }
 
+    std::filesystem::path MeshLoader::GetCookedPath(const std::filesystem::path& hmeshRel)
+    {
+        std::filesystem::path cooked = std::filesystem::path("cache") / hmeshRel;
+        cooked.replace_extension(".hmeshbin");
+        return cooked;
+    }
+
     bool MeshLoader::TryResolveTexturePath(const std::filesystem::path& objAbs, const std::string& texRelOrAbs,
         std::filesystem::path& outAbs)
     {
@@ -1,10 +1,12 @@
 #pragma once
 #include <filesystem>
+#include <limits>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 #include "HRealEngine/Asset/Asset.h"
 #include "HRealEngine/Core/Core.h"
+#include "HRealEngine/Core/FileSystem.h"
 #include "HRealEngine/Renderer/Shader.h"
 #include "HRealEngine/Renderer/VertexArray.h"
 
@@ -22,15 +24,60 @@ namespace HRealEngine
         glm::vec3 Normal {0.0f, 1.0f, 0.0f};
         glm::vec2 UV {0.0f};
     };
+    // 16 bytes: position in 16 bit steps across the mesh bounds (w unused), octahedral normal, half float UV
+    struct QuantizedMeshVertex
+    {
+        uint16_t Position[4] = { 0, 0, 0, 0 };
+        int16_t Normal[2] = { 0, 0 };
+        uint16_t UV[2] = { 0, 0 };
+    };
+    enum class HMeshBinVertexFormat : uint32_t
+    {
+        Float = 0,    // MeshVertex
+        Quantized = 1 // QuantizedMeshVertex
+    };
+    // Version 3 adds the LOD table: LodCount HMeshBinLod entries follow the header, the submesh table holds SubmeshCount
+    // entries per level (level major) and IndexCount covers the index ranges of every level.
+    // Version 4 adds VertexFormat, the vertex block is stored exactly as it is uploaded.
+    // Version 5 adds the material handle table (MaterialCount uint64 handles after the submesh table) and VertexDataOffset,
+    // the vertex block starts 16 byte aligned and the index block follows it, so both are uploaded straight from the mapped file.
     struct HMeshBinHeader
     {
         uint32_t Magic = 0x48534D48;
-        uint32_t Version = 2;
+        uint32_t Version = 5;
         uint32_t VertexCount = 0;
         uint32_t IndexCount = 0;
         uint32_t SubmeshCount = 0;
         glm::vec3 BoundsMin = { 0,0,0 };
         glm::vec3 BoundsMax = { 0,0,0 };
+        uint32_t LodCount = 1;
+        HMeshBinVertexFormat VertexFormat = HMeshBinVertexFormat::Float;
+        uint32_t MaterialCount = 0;
+        uint32_t VertexDataOffset = 0; // from the start of the file
+    };
+    struct HMeshBinLod
+    {
+        float ScreenSize = std::numeric_limits<float>::max(); // level is used while the bounds cover less than this fraction of the screen height
+        uint32_t IndexOffset = 0;
+        uint32_t IndexCount = 0;
+    };
+    // VertexData and Indices point into File and stay valid while the data is alive
+    struct HMeshBinData
+    {
+        HMeshBinHeader Header;
+        std::vector<HMeshBinLod> Lods;
+        std::vector<HMeshBinSubmesh> Submeshes; // level major, Header.SubmeshCount per level
+        std::vector<AssetHandle> MaterialHandles; // empty before version 5
+        const uint8_t* VertexData = nullptr; // Header.VertexCount vertices in Header.VertexFormat
+        const uint32_t* Indices = nullptr; // Header.IndexCount
+        MappedFile File;
+    };
+    struct MeshGPULod
+    {
+        float ScreenSize = 0.0f;
+        uint32_t IndexOffset = 0;
+        uint32_t IndexCount = 0;
+        std::vector<HMeshBinSubmesh> Submeshes;
     };
     class MeshGPU : public Asset
     {
@@ -43,12 +90,24 @@ namespace HRealEngine
         Ref<VertexArray> VAO;
         Ref<Shader> Shader;
         uint32_t IndexCount = 0;
+        // Quantized positions are relative to the bounds, the renderer dequantizes them in the vertex shader
+        HMeshBinVertexFormat VertexFormat = HMeshBinVertexFormat::Float;
         std::vector<HMeshBinSubmesh> Submeshes;
+        // Coarser levels after the full mesh, ordered by decreasing detail, they share the vertex and index buffers
+        std::vector<MeshGPULod> Lods;
         //std::vector<std::string> MaterialPaths;
         std::vector<AssetHandle> MaterialHandles;
 
         glm::vec3 BoundsMin = { 0,0,0 };
         glm::vec3 BoundsMax = { 0,0,0 };
+
+        // CPU copy of the coarsest level for occlusion culling, built by MeshLoader::BuildOccluder the first time the mesh
+        // is submitted as an occluder. Stays empty when the level is too dense to be a cheap occluder
+        static constexpr uint32_t MaxOccluderTriangles = 8192;
+        std::filesystem::path CookedPath;
+        bool bOccluderBuilt = false;
+        std::vector<glm::vec3> OccluderPositions;
+        std::vector<uint32_t> OccluderIndices;
     };
     class MeshLoader
     {
@@ -58,14 +117,31 @@ namespace HRealEngine
         static std::vector<std::string> ImportObjMaterialsToHMat(const std::filesystem::path& objPathInAssets, const std::filesystem::path& assetsRoot,
             const std::filesystem::path& lastCopiedTexAbs, const std::vector<std::filesystem::path>& texturePaths);
         static Ref<MeshGPU> LoadHMeshAsset(const std::filesystem::path& hmeshPath, const std::filesystem::path& assetsRoot, const Ref<Shader>& shader);
+        static constexpr uint32_t MaxMeshLods = 4;
+        // Cache and overdraw orders every submesh range, then renumbers the vertices in first use order
+        static void OptimizeMesh(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices, const std::vector<HMeshBinSubmesh>& submeshes);
+        // Appends simplified levels to indices and submeshes, outLods[0] is the input mesh
+        static void GenerateLods(const std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices, std::vector<HMeshBinSubmesh>& submeshes,
+            std::vector<HMeshBinLod>& outLods, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+        // Without lods the file gets a single level, with lods the submeshes are level major as GenerateLods leaves them
         static bool WriteHMeshBin(const std::filesystem::path& path,
-            const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<HMeshBinSubmesh>& submeshes, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+            const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<HMeshBinSubmesh>& submeshes, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+            const std::vector<HMeshBinLod>& lods = {}, HMeshBinVertexFormat vertexFormat = HMeshBinVertexFormat::Float,
+            const std::vector<AssetHandle>& materialHandles = {});
+        static bool ReadHMeshBin(const std::filesystem::path& path, HMeshBinData& outData);
+        static uint32_t GetVertexStride(HMeshBinVertexFormat format);
+        static void DecodeVertices(const HMeshBinData& data, std::vector<MeshVertex>& outVertices);
+        // Reads the coarsest level back from the cooked file once, keeping only the vertices it references. False when the mesh has no occluder
+        static bool BuildOccluder(MeshGPU& mesh);
         static bool ReadHMeshBin(const std::filesystem::path& path, std::vector<MeshVertex>& outVertices, std::vector<uint32_t>& outIndices,
-            std::vector<HMeshBinSubmesh>* outSubmeshes = nullptr, glm::vec3& outBoundsMin = glm::vec3(0), glm::vec3& outBoundsMax = glm::vec3(0));
+            std::vector<HMeshBinSubmesh>* outSubmeshes = nullptr, glm::vec3& outBoundsMin = glm::vec3(0), glm::vec3& outBoundsMax = glm::vec3(0),
+            std::vector<HMeshBinLod>* outLods = nullptr);
         static Ref<MeshGPU> GetOrLoad(const std::filesystem::path& hmeshPath, const std::filesystem::path& assetsRoot, const Ref<Shader>& shader);
         static bool ParseHMeshMaterials(const std::filesystem::path& hmeshAbs, std::vector<std::string>& outMaterials);
         static bool ParseHMeshMaterialHandles(const std::filesystem::path& hmeshAbs, std::vector<AssetHandle>& outHandles);
         static bool ExtractCookedRelativePath(const std::filesystem::path& hmeshPath, std::string& outCookedRel);
+        // Where the importer cooks a .hmesh, relative to the asset directory. Files cooked there load without reading the .hmesh
+        static std::filesystem::path GetCookedPath(const std::filesystem::path& hmeshRel);
         static bool TryResolveTexturePath(const std::filesystem::path& objAbs, const std::string& texRelOrAbs,std::filesystem::path& outAbs);
         static void Clear();
         static std::string SanitizeName(std::string s);
@@ -0,0 +1,255 @@
+#include "HRpch.h"
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+namespace HRealEngine
+{
+    static constexpr int s_VertexCacheSize = 32;
+    static constexpr uint32_t s_MaxValenceScored = 32;
+    // FIFO size used to find locality restarts when cutting the overdraw clusters
+    static constexpr uint32_t s_OverdrawCacheSize = 16;
+
+    struct VertexScoreTable
+    {
+        float Cache[s_VertexCacheSize];
+        float Valence[s_MaxValenceScored + 1];
+
+        VertexScoreTable()
+        {
+            for (int i = 0; i < s_VertexCacheSize; i++)
+                Cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (float)(i - 3) / (float)(s_VertexCacheSize - 3), 1.5f);
+            Valence[0] = 0.0f;
+            for (uint32_t i = 1; i <= s_MaxValenceScored; i++)
+                Valence[i] = 2.0f / std::sqrt((float)i);
+        }
+    };
+    static const VertexScoreTable s_ScoreTable;
+
+    static float GetVertexScore(int cachePosition, uint32_t remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return -1.0f;
+        const float cacheScore = cachePosition >= 0 ? s_ScoreTable.Cache[cachePosition] : 0.0f;
+        return cacheScore + s_ScoreTable.Valence[std::min(remainingTriangles, s_MaxValenceScored)];
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+    {
+        const size_t triangleCount = indexCount / 3;
+        if (triangleCount < 2)
+            return;
+
+        // Work on range local vertex ids, the range usually touches a small part of the shared vertex buffer
+        std::vector<uint32_t> localIds(vertexCount, UINT32_MAX);
+        std::vector<uint32_t> globalIds;
+        std::vector<uint32_t> local(indexCount);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t& id = localIds[indices[i]];
+            if (id == UINT32_MAX)
+            {
+                id = (uint32_t)globalIds.size();
+                globalIds.push_back(indices[i]);
+            }
+            local[i] = id;
+        }
+        const size_t localVertexCount = globalIds.size();
+
+        std::vector<uint32_t> remaining(localVertexCount, 0);
+        std::vector<uint32_t> offsets(localVertexCount + 1, 0);
+        for (uint32_t v : local)
+            remaining[v]++;
+        for (size_t v = 0; v < localVertexCount; v++)
+            offsets[v + 1] = offsets[v] + remaining[v];
+        std::vector<uint32_t> adjacency(indexCount);
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indexCount; i++)
+                adjacency[cursor[local[i]]++] = (uint32_t)(i / 3);
+        }
+
+        std::vector<int> cachePosition(localVertexCount, -1);
+        std::vector<float> vertexScores(localVertexCount);
+        for (size_t v = 0; v < localVertexCount; v++)
+            vertexScores[v] = GetVertexScore(-1, remaining[v]);
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        size_t best = 0;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            triangleScores[t] = vertexScores[local[t * 3]] + vertexScores[local[t * 3 + 1]] + vertexScores[local[t * 3 + 2]];
+            if (triangleScores[t] > triangleScores[best])
+                best = t;
+        }
+
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        uint32_t cache[s_VertexCacheSize + 3];
+        int cacheCount = 0;
+        size_t fallbackCursor = 0;
+
+        for (size_t n = 0; n < triangleCount; n++)
+        {
+            // Nothing in the cache has triangles left, continue with the next unused triangle
+            if (best == SIZE_MAX)
+            {
+                while (emitted[fallbackCursor])
+                    fallbackCursor++;
+                best = fallbackCursor;
+            }
+
+            const uint32_t* tri = &local[best * 3];
+            emitted[best] = 1;
+            for (int k = 0; k < 3; k++)
+            {
+                const uint32_t v = tri[k];
+                output.push_back(globalIds[v]);
+
+                uint32_t* begin = &adjacency[offsets[v]];
+                for (uint32_t i = 0; i < remaining[v]; i++)
+                {
+                    if (begin[i] == (uint32_t)best)
+                    {
+                        begin[i] = begin[remaining[v] - 1];
+                        break;
+                    }
+                }
+                remaining[v]--;
+            }
+
+            uint32_t newCache[s_VertexCacheSize + 3];
+            int newCount = 0;
+            for (int k = 0; k < 3; k++)
+                newCache[newCount++] = tri[k];
+            for (int i = 0; i < cacheCount; i++)
+                if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+                    newCache[newCount++] = cache[i];
+
+            for (int i = 0; i < newCount; i++)
+            {
+                const uint32_t v = newCache[i];
+                cachePosition[v] = i < s_VertexCacheSize ? i : -1;
+                vertexScores[v] = GetVertexScore(cachePosition[v], remaining[v]);
+            }
+
+            // Only triangles around the cache (and what just fell out of it) changed score
+            best = SIZE_MAX;
+            float bestScore = -1.0f;
+            for (int i = 0; i < newCount; i++)
+            {
+                const uint32_t v = newCache[i];
+                for (uint32_t j = 0; j < remaining[v]; j++)
+                {
+                    const uint32_t t = adjacency[offsets[v] + j];
+                    const float score = vertexScores[local[t * 3]] + vertexScores[local[t * 3 + 1]] + vertexScores[local[t * 3 + 2]];
+                    triangleScores[t] = score;
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        best = t;
+                    }
+                }
+            }
+
+            cacheCount = std::min(newCount, s_VertexCacheSize);
+            std::copy(newCache, newCache + cacheCount, cache);
+        }
+
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const std::vector<glm::vec3>& positions)
+    {
+        const size_t triangleCount = indexCount / 3;
+        if (triangleCount < 2)
+            return;
+
+        // A triangle missing all three vertices starts a new cluster, the cache order restarted there anyway
+        std::vector<uint32_t> clusterStarts;
+        std::vector<uint32_t> timestamps(positions.size(), 0);
+        uint32_t time = s_OverdrawCacheSize + 1;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            int misses = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                const uint32_t v = indices[t * 3 + k];
+                if (time - timestamps[v] > s_OverdrawCacheSize)
+                {
+                    timestamps[v] = time++;
+                    misses++;
+                }
+            }
+            if (t == 0 || misses == 3)
+                clusterStarts.push_back((uint32_t)t);
+        }
+        if (clusterStarts.size() < 2)
+            return;
+        clusterStarts.push_back((uint32_t)triangleCount);
+
+        const size_t clusterCount = clusterStarts.size() - 1;
+        std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+        std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+        std::vector<float> areas(clusterCount, 0.0f);
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+            {
+                const glm::vec3& p0 = positions[indices[t * 3]];
+                const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+                const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+                normals[c] += normal;
+                areas[c] += area;
+            }
+            meshCentroid += centroids[c];
+            meshArea += areas[c];
+            if (areas[c] > 0.0f)
+                centroids[c] /= areas[c];
+        }
+        if (meshArea > 0.0f)
+            meshCentroid /= meshArea;
+
+        // Clusters facing away from the middle are the outer surface, drawing them first lets depth testing reject the inside
+        std::vector<float> sortKeys(clusterCount, 0.0f);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            const float length = glm::length(normals[c]);
+            if (length > 0.0f)
+                sortKeys[c] = glm::dot(centroids[c] - meshCentroid, normals[c] / length);
+        }
+        std::vector<uint32_t> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++)
+            order[c] = (uint32_t)c;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        for (uint32_t c : order)
+            output.insert(output.end(), indices + (size_t)clusterStarts[c] * 3, indices + (size_t)clusterStarts[c + 1] * 3);
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+        std::vector<uint32_t> order;
+        order.reserve(vertexCount);
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == UINT32_MAX)
+            {
+                remap[index] = (uint32_t)order.size();
+                order.push_back(index);
+            }
+            index = remap[index];
+        }
+        return order;
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+
+namespace HRealEngine
+{
+    // Import time index and vertex reordering, none of it changes what the mesh looks like
+    class MeshOptimizer
+    {
+    public:
+        // Reorders the triangles of one index range for the post transform vertex cache (Forsyth)
+        static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+        // Splits a cache optimized range into clusters and draws outward facing clusters first so they occlude the rest
+        static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const std::vector<glm::vec3>& positions);
+        // Renumbers vertices in first use order and drops unreferenced ones, returns old index per new vertex
+        static std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount);
+    };
+}
@@ -0,0 +1,224 @@
+#include "HRpch.h"
+#include "MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+
+namespace HRealEngine
+{
+    // Sum of squared distances to a set of planes, symmetric so only the upper triangle is kept
+    struct SimplifierQuadric
+    {
+        double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+        double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+        double C = 0.0;
+
+        void AddPlane(const glm::dvec3& n, double d)
+        {
+            A00 += n.x * n.x; A01 += n.x * n.y; A02 += n.x * n.z;
+            A11 += n.y * n.y; A12 += n.y * n.z; A22 += n.z * n.z;
+            B0 += n.x * d; B1 += n.y * d; B2 += n.z * d;
+            C += d * d;
+        }
+        void Add(const SimplifierQuadric& o)
+        {
+            A00 += o.A00; A01 += o.A01; A02 += o.A02;
+            A11 += o.A11; A12 += o.A12; A22 += o.A22;
+            B0 += o.B0; B1 += o.B1; B2 += o.B2;
+            C += o.C;
+        }
+        double Evaluate(const glm::vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z)
+                + 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+            return error > 0.0 ? error : 0.0;
+        }
+    };
+    struct SimplifierCollapse
+    {
+        uint32_t From;
+        uint32_t To;
+        double Cost;
+    };
+
+    static bool PositionLess(const glm::vec3& a, const glm::vec3& b)
+    {
+        if (a.x != b.x) return a.x < b.x;
+        if (a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    }
+
+    // Vertices that must not move: seams, where another vertex shares the position, and open or non manifold edges
+    static std::vector<uint8_t> FindLockedVertices(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices)
+    {
+        std::vector<uint8_t> locked(positions.size(), 0);
+
+        std::vector<uint32_t> used(indices);
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        std::sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) { return PositionLess(positions[a], positions[b]); });
+        for (size_t i = 1; i < used.size(); i++)
+        {
+            if (positions[used[i]] == positions[used[i - 1]])
+            {
+                locked[used[i]] = 1;
+                locked[used[i - 1]] = 1;
+            }
+        }
+
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                const uint32_t a = indices[i + e];
+                const uint32_t b = indices[i + (e + 1) % 3];
+                edges.push_back({ std::min(a, b), std::max(a, b) });
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i])
+                j++;
+            if (j - i != 2)
+            {
+                locked[edges[i].first] = 1;
+                locked[edges[i].second] = 1;
+            }
+            i = j;
+        }
+        return locked;
+    }
+
+    static bool CollapseFlipsTriangle(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+        const std::vector<uint32_t>& triangleOffsets, const std::vector<uint32_t>& triangles, uint32_t from, uint32_t to)
+    {
+        for (uint32_t i = triangleOffsets[from]; i < triangleOffsets[from + 1]; i++)
+        {
+            const uint32_t* tri = &indices[(size_t)triangles[i] * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;// this one collapses away
+
+            glm::vec3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+            const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            for (int k = 0; k < 3; k++)
+                if (tri[k] == from)
+                    p[k] = positions[to];
+            const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(before, after) <= 0.0f)
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+        size_t targetIndexCount, float& outError)
+    {
+        outError = 0.0f;
+        std::vector<uint32_t> result = indices;
+        if (result.size() <= targetIndexCount || result.size() % 3 != 0)
+            return result;
+
+        const size_t vertexCount = positions.size();
+        const std::vector<uint8_t> locked = FindLockedVertices(positions, result);
+
+        std::vector<SimplifierQuadric> quadrics(vertexCount);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const glm::dvec3 p0 = positions[result[i]], p1 = positions[result[i + 1]], p2 = positions[result[i + 2]];
+            const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const double length = glm::length(normal);
+            if (length <= 0.0)
+                continue;
+            const glm::dvec3 n = normal / length;
+            const double d = -glm::dot(n, p0);
+            for (int k = 0; k < 3; k++)
+                quadrics[result[i + k]].AddPlane(n, d);
+        }
+
+        std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+        std::vector<uint32_t> triangles;
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<SimplifierCollapse> collapses;
+        double maxCost = 0.0;
+
+        // Each pass collapses the cheapest independent edges, a collapse freezes its neighbourhood until the next pass
+        for (int pass = 0; pass < 64 && result.size() > targetIndexCount; pass++)
+        {
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (uint32_t index : result)
+                triangleOffsets[index + 1]++;
+            for (size_t v = 0; v < vertexCount; v++)
+                triangleOffsets[v + 1] += triangleOffsets[v];
+            triangles.resize(result.size());
+            std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+                triangles[cursor[result[i]]++] = (uint32_t)(i / 3);
+
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int e = 0; e < 3; e++)
+                {
+                    const uint32_t a = result[i + e];
+                    const uint32_t b = result[i + (e + 1) % 3];
+                    SimplifierQuadric q = quadrics[a];
+                    q.Add(quadrics[b]);
+                    if (!locked[a])
+                        collapses.push_back({ a, b, q.Evaluate(positions[b]) });
+                    if (!locked[b])
+                        collapses.push_back({ b, a, q.Evaluate(positions[a]) });
+                }
+            }
+            if (collapses.empty())
+                break;
+            std::sort(collapses.begin(), collapses.end(), [](const SimplifierCollapse& a, const SimplifierCollapse& b) { return a.Cost < b.Cost; });
+
+            // An interior collapse removes two triangles
+            const size_t budget = (result.size() - targetIndexCount) / 6 + 1;
+            size_t applied = 0;
+            std::fill(touched.begin(), touched.end(), 0);
+            for (size_t v = 0; v < vertexCount; v++)
+                remap[v] = (uint32_t)v;
+
+            for (const SimplifierCollapse& collapse : collapses)
+            {
+                if (applied >= budget)
+                    break;
+                if (touched[collapse.From] || touched[collapse.To])
+                    continue;
+                if (CollapseFlipsTriangle(positions, result, triangleOffsets, triangles, collapse.From, collapse.To))
+                    continue;
+
+                remap[collapse.From] = collapse.To;
+                quadrics[collapse.To].Add(quadrics[collapse.From]);
+                for (uint32_t i = triangleOffsets[collapse.From]; i < triangleOffsets[collapse.From + 1]; i++)
+                    for (int k = 0; k < 3; k++)
+                        touched[result[(size_t)triangles[i] * 3 + k]] = 1;
+                maxCost = std::max(maxCost, collapse.Cost);
+                applied++;
+            }
+            if (applied == 0)
+                break;
+
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        outError = (float)glm::sqrt(maxCost);
+        return result;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+
+namespace HRealEngine
+{
+    // Quadric error simplification by edge collapse onto existing vertices, so every level can share one vertex buffer.
+    // Border and seam vertices (same position, different attributes) are locked to keep submeshes and UVs closed.
+    class MeshSimplifier
+    {
+    public:
+        // indices is one triangle list into positions, returns at most targetIndexCount indices when it can get there.
+        // outError receives the largest collapse error in position units.
+        static std::vector<uint32_t> Simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+            size_t targetIndexCount, float& outError);
+    };
+}
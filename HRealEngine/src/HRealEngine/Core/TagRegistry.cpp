@@ -0,0 +1,32 @@
+#include "HRpch.h"
+#include "TagRegistry.h"
+
+#include <deque>
+
+namespace HRealEngine
+{
+    static std::unordered_map<std::string, TagID> s_TagIDs;
+    static std::deque<std::string> s_TagNames; // indexed by id - 1, deque keeps returned references stable
+
+    TagID TagRegistry::Intern(std::string_view tag)
+    {
+        auto [it, inserted] = s_TagIDs.try_emplace(std::string(tag), (TagID)s_TagNames.size() + 1);
+        if (inserted)
+            s_TagNames.emplace_back(tag);
+        return it->second;
+    }
+
+    TagID TagRegistry::Find(std::string_view tag)
+    {
+        auto it = s_TagIDs.find(std::string(tag));
+        return it != s_TagIDs.end() ? it->second : InvalidTagID;
+    }
+
+    const std::string& TagRegistry::GetName(TagID id)
+    {
+        static const std::string s_Empty;
+        if (id == InvalidTagID || id > s_TagNames.size())
+            return s_Empty;
+        return s_TagNames[id - 1];
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace HRealEngine
+{
+    using TagID = uint32_t;
+    static constexpr TagID InvalidTagID = 0;
+
+    // Process wide tag interning, TagComponent stores the IDs so tag checks compare integers instead of strings.
+    // IDs never change once handed out, which keeps them valid when components are copied between scenes.
+    class TagRegistry
+    {
+    public:
+        // Returns the ID of tag, registering it on first use
+        static TagID Intern(std::string_view tag);
+        // InvalidTagID when tag was never interned, no entity can carry it then
+        static TagID Find(std::string_view tag);
+        static const std::string& GetName(TagID id);
+    };
+}
@@ -0,0 +1,173 @@
+#include "HRpch.h"
+#include "ParticlePool.h"
+
+#include <cfloat>
+#include <glm/gtc/constants.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define HREALENGINE_PARTICLES_SSE 1
+#endif
+
+namespace HRealEngine
+{
+    // Stateless random in [0, 1), every spawned particle hashes its own seed so the spawn loop has no carried state
+    static float RandomFloat(uint32_t seed)
+    {
+        seed = seed * 747796405u + 2891336453u;
+        uint32_t word = ((seed >> ((seed >> 28u) + 4u)) ^ seed) * 277803737u;
+        word = (word >> 22u) ^ word;
+        return (float)(word >> 8) * (1.0f / 16777216.0f);
+    }
+
+    ParticlePool::ParticlePool(uint32_t capacity) : m_Capacity(capacity)
+    {
+        for (std::vector<float>* stream : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ,
+            &m_Rotation, &m_Age, &m_InvLifeTime, &m_SizeBegin })
+            stream->resize(capacity);
+    }
+
+    void ParticlePool::Emit(const ParticleEmitterProps& props, const glm::vec3& origin, uint32_t count)
+    {
+        count = std::min(count, m_Capacity - m_AliveCount);
+        if (count == 0)
+            return;
+
+        const float invLifeTime = props.LifeTime > 0.0f ? 1.0f / props.LifeTime : FLT_MAX;
+        const uint32_t first = m_AliveCount;
+        const uint32_t seedBase = m_SpawnCounter * 5u;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t index = first + i;
+            const uint32_t seed = seedBase + i * 5u;
+            m_PositionX[index] = origin.x;
+            m_PositionY[index] = origin.y;
+            m_PositionZ[index] = origin.z;
+            m_VelocityX[index] = props.Velocity.x + props.VelocityVariation.x * (RandomFloat(seed) - 0.5f);
+            m_VelocityY[index] = props.Velocity.y + props.VelocityVariation.y * (RandomFloat(seed + 1u) - 0.5f);
+            m_VelocityZ[index] = props.Velocity.z + props.VelocityVariation.z * (RandomFloat(seed + 2u) - 0.5f);
+            m_Rotation[index] = RandomFloat(seed + 3u) * glm::two_pi<float>();
+            m_SizeBegin[index] = props.SizeBegin + props.SizeVariation * (RandomFloat(seed + 4u) - 0.5f);
+            m_Age[index] = 0.0f;
+            m_InvLifeTime[index] = invLifeTime;
+        }
+        m_AliveCount += count;
+        m_SpawnCounter += count;
+    }
+
+    void ParticlePool::Update(const ParticleEmitterProps& props, float deltaTime)
+    {
+        float* px = m_PositionX.data();
+        float* py = m_PositionY.data();
+        float* pz = m_PositionZ.data();
+        float* vx = m_VelocityX.data();
+        float* vy = m_VelocityY.data();
+        float* vz = m_VelocityZ.data();
+        float* rotation = m_Rotation.data();
+        float* age = m_Age.data();
+
+        const glm::vec3 deltaVelocity = props.Acceleration * deltaTime;
+        const float deltaRotation = props.AngularVelocity * deltaTime;
+        const uint32_t count = m_AliveCount;
+        uint32_t i = 0;
+#ifdef HREALENGINE_PARTICLES_SSE
+        const __m128 dt = _mm_set1_ps(deltaTime);
+        const __m128 dvx = _mm_set1_ps(deltaVelocity.x), dvy = _mm_set1_ps(deltaVelocity.y), dvz = _mm_set1_ps(deltaVelocity.z);
+        const __m128 dr = _mm_set1_ps(deltaRotation);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 newVx = _mm_add_ps(_mm_loadu_ps(vx + i), dvx);
+            const __m128 newVy = _mm_add_ps(_mm_loadu_ps(vy + i), dvy);
+            const __m128 newVz = _mm_add_ps(_mm_loadu_ps(vz + i), dvz);
+            _mm_storeu_ps(vx + i, newVx);
+            _mm_storeu_ps(vy + i, newVy);
+            _mm_storeu_ps(vz + i, newVz);
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(newVx, dt)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(newVy, dt)));
+            _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(newVz, dt)));
+            _mm_storeu_ps(rotation + i, _mm_add_ps(_mm_loadu_ps(rotation + i), dr));
+            _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            vx[i] += deltaVelocity.x;
+            vy[i] += deltaVelocity.y;
+            vz[i] += deltaVelocity.z;
+            px[i] += vx[i] * deltaTime;
+            py[i] += vy[i] * deltaTime;
+            pz[i] += vz[i] * deltaTime;
+            rotation[i] += deltaRotation;
+            age[i] += deltaTime;
+        }
+
+        for (uint32_t index = 0; index < m_AliveCount;)
+        {
+            if (age[index] * m_InvLifeTime[index] >= 1.0f)
+                Kill(index); // the last alive particle moved into index, look at it next
+            else
+                index++;
+        }
+    }
+
+    void ParticlePool::Kill(uint32_t index)
+    {
+        const uint32_t last = --m_AliveCount;
+        m_PositionX[index] = m_PositionX[last];
+        m_PositionY[index] = m_PositionY[last];
+        m_PositionZ[index] = m_PositionZ[last];
+        m_VelocityX[index] = m_VelocityX[last];
+        m_VelocityY[index] = m_VelocityY[last];
+        m_VelocityZ[index] = m_VelocityZ[last];
+        m_Rotation[index] = m_Rotation[last];
+        m_Age[index] = m_Age[last];
+        m_InvLifeTime[index] = m_InvLifeTime[last];
+        m_SizeBegin[index] = m_SizeBegin[last];
+    }
+
+    void ParticlePool::WriteInstances(const ParticleEmitterProps& props, uint32_t first, uint32_t count, ParticleInstance* outInstances) const
+    {
+        const float* age = m_Age.data() + first;
+        const float* invLifeTime = m_InvLifeTime.data() + first;
+        const float* sizeBegin = m_SizeBegin.data() + first;
+        const glm::vec4 colorDelta = props.ColorEnd - props.ColorBegin;
+
+        uint32_t i = 0;
+#ifdef HREALENGINE_PARTICLES_SSE
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 sizeEnd = _mm_set1_ps(props.SizeEnd);
+        const __m128 colorBegin = _mm_loadu_ps(&props.ColorBegin.x);
+        const __m128 colorStep = _mm_loadu_ps(&colorDelta.x);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 t = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(age + i), _mm_loadu_ps(invLifeTime + i)), one);
+            const __m128 begin = _mm_loadu_ps(sizeBegin + i);
+            float sizes[4];
+            _mm_storeu_ps(sizes, _mm_add_ps(begin, _mm_mul_ps(_mm_sub_ps(sizeEnd, begin), t)));
+
+            ParticleInstance* out = outInstances + i;
+            _mm_storeu_ps(&out[0].Color.x, _mm_add_ps(colorBegin, _mm_mul_ps(colorStep, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)))));
+            _mm_storeu_ps(&out[1].Color.x, _mm_add_ps(colorBegin, _mm_mul_ps(colorStep, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)))));
+            _mm_storeu_ps(&out[2].Color.x, _mm_add_ps(colorBegin, _mm_mul_ps(colorStep, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2)))));
+            _mm_storeu_ps(&out[3].Color.x, _mm_add_ps(colorBegin, _mm_mul_ps(colorStep, _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 3)))));
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                const uint32_t index = first + i + lane;
+                out[lane].Position = { m_PositionX[index], m_PositionY[index], m_PositionZ[index] };
+                out[lane].Rotation = m_Rotation[index];
+                out[lane].Size = sizes[lane];
+            }
+        }
+#endif
+        for (; i < count; i++)
+        {
+            const uint32_t index = first + i;
+            const float t = std::min(age[i] * invLifeTime[i], 1.0f);
+            ParticleInstance& out = outInstances[i];
+            out.Position = { m_PositionX[index], m_PositionY[index], m_PositionZ[index] };
+            out.Rotation = m_Rotation[index];
+            out.Color = props.ColorBegin + colorDelta * t;
+            out.Size = sizeBegin[i] + (props.SizeEnd - sizeBegin[i]) * t;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace HRealEngine
+{
+    // Emitter settings, shared by every particle the emitter spawns
+    struct ParticleEmitterProps
+    {
+        uint32_t MaxParticles = 10000;
+        float EmissionRate = 100.0f; // particles per second
+        float LifeTime = 1.0f;
+
+        glm::vec3 Velocity { 0.0f, 1.0f, 0.0f };
+        glm::vec3 VelocityVariation { 1.0f, 1.0f, 0.0f };
+        glm::vec3 Acceleration { 0.0f, 0.0f, 0.0f };
+        float AngularVelocity = 0.0f; // radians per second
+
+        glm::vec4 ColorBegin { 1.0f, 1.0f, 1.0f, 1.0f };
+        glm::vec4 ColorEnd { 1.0f, 1.0f, 1.0f, 0.0f };
+        float SizeBegin = 0.1f;
+        float SizeEnd = 0.0f;
+        float SizeVariation = 0.05f;
+    };
+
+    // One instance of the particle quad stream, the layout matches the instance buffer in Renderer2D
+    struct ParticleInstance
+    {
+        glm::vec3 Position;
+        float Rotation;
+        glm::vec4 Color;
+        float Size;
+    };
+
+    // Structure of arrays particle storage. Alive particles are packed at the front, a dying particle is swap removed
+    // with the last alive one, so updates and rendering only ever walk [0, GetAliveCount()).
+    class ParticlePool
+    {
+    public:
+        ParticlePool(uint32_t capacity);
+
+        // Spawns up to count particles at origin, spawning stops silently when the pool is full
+        void Emit(const ParticleEmitterProps& props, const glm::vec3& origin, uint32_t count);
+        // Integrates position, velocity, rotation and age of every alive particle and removes the expired ones
+        void Update(const ParticleEmitterProps& props, float deltaTime);
+        // Writes count instances starting at alive particle first, color and size are interpolated over the lifetime
+        void WriteInstances(const ParticleEmitterProps& props, uint32_t first, uint32_t count, ParticleInstance* outInstances) const;
+
+        void Clear() { m_AliveCount = 0; }
+        uint32_t GetAliveCount() const { return m_AliveCount; }
+        uint32_t GetCapacity() const { return m_Capacity; }
+    private:
+        void Kill(uint32_t index);
+    private:
+        uint32_t m_Capacity;
+        uint32_t m_AliveCount = 0;
+        uint32_t m_SpawnCounter = 0; // seeds the per particle random numbers
+
+        std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+        std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;
+        std::vector<float> m_Rotation;
+        std::vector<float> m_Age;
+        std::vector<float> m_InvLifeTime;
+        std::vector<float> m_SizeBegin;
+    };
+}
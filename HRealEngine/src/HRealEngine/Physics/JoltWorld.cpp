@@ -13,6 +13,9 @@
 #include "Physics/Collision/CastResult.h"
 #include "Physics/Collision/CollisionCollectorImpl.h"
 #include "Physics/Collision/RayCast.h"
+#include "Physics/Collision/ShapeCast.h"
+#include "Physics/Collision/CollideShape.h"
+#include "Physics/Collision/NarrowPhaseQuery.h"
 #include "Physics/Collision/Shape/BoxShape.h"
 #include "Physics/Collision/Shape/SphereShape.h"
 #include "Physics/Collision/Shape/EmptyShape.h"
@@ -40,9 +43,73 @@ namespace HRealEngine
         return dofs;
     }
     
+    // Body settings for an entity, shared by CreateBodyForEntity and CreateBodiesForEntities. Rigidbody and box collider are both optional
+    static JPH::BodyCreationSettings MakeBodySettings(Entity entity)
+    {
+        auto& transform = entity.GetComponent<TransformComponent>();
+        const bool bHasCollider = entity.HasComponent<BoxCollider3DComponent>();
+        const Rigidbody3DComponent* rb3d = entity.HasComponent<Rigidbody3DComponent>() ? &entity.GetComponent<Rigidbody3DComponent>() : nullptr;
+
+        JPH::ShapeRefC shape;
+        if (bHasCollider)
+        {
+            auto& boxCollider = entity.GetComponent<BoxCollider3DComponent>();
+            glm::vec3 halfExtents = glm::abs(transform.Scale) * boxCollider.Size;
+            JPH::BoxShapeSettings boxShapeSettings({ halfExtents.x, halfExtents.y, halfExtents.z });
+            if (rb3d)
+                boxShapeSettings.mConvexRadius = rb3d->ConvexRadius;
+            boxShapeSettings.SetEmbedded();
+            shape = boxShapeSettings.Create().Get();
+
+            glm::vec3 localOffset = glm::abs(transform.Scale) * boxCollider.Offset;
+            if (glm::length(localOffset) > 0.0001f)
+                shape = new JPH::RotatedTranslatedShape(JPH::Vec3(localOffset.x, localOffset.y, localOffset.z), JPH::Quat::sIdentity(), shape);
+        }
+        else
+        {
+            JPH::EmptyShapeSettings emptyShapeSettings;
+            emptyShapeSettings.SetEmbedded();
+            shape = emptyShapeSettings.Create().Get();
+        }
+
+        JPH::EMotionType motionType = JPH::EMotionType::Static;
+        auto layer = Layers::NON_MOVING;
+        if (rb3d && rb3d->Type != Rigidbody3DComponent::BodyType::Static)
+        {
+            motionType = rb3d->Type == Rigidbody3DComponent::BodyType::Dynamic ? JPH::EMotionType::Dynamic : JPH::EMotionType::Kinematic;
+            layer = Layers::MOVING;
+        }
+
+        glm::quat q = glm::quat(transform.Rotation);
+        JPH::BodyCreationSettings bodySettings(shape, JPH::RVec3(transform.Position.x, transform.Position.y, transform.Position.z),
+            JPH::Quat(q.x, q.y, q.z, q.w), motionType, layer);
+        bodySettings.mAllowSleeping = motionType == JPH::EMotionType::Static;
+        bodySettings.mAllowDynamicOrKinematic = true;
+        if (rb3d)
+        {
+            bodySettings.mAllowedDOFs = GetAllowedDOFs(*rb3d);
+            if (bHasCollider)
+            {
+                bodySettings.mFriction = rb3d->Friction;
+                bodySettings.mRestitution = rb3d->Restitution;
+            }
+        }
+        else
+        {
+            bodySettings.mFriction = 0.05f;
+            bodySettings.mRestitution = 0.0f;
+        }
+        return bodySettings;
+    }
+    
+    static std::atomic<uint64_t> s_NextJoltWorldID = 1;
+    
     JoltWorld::JoltWorld(Scene* scene) : m_Scene(scene), m_ContactListener(scene, this)
     {
         m_JoltWorldHelper = CreateScope<JoltWorldHelper>(this);
+        m_WorldID = s_NextJoltWorldID.fetch_add(1, std::memory_order_relaxed);
+        // One buffer per job system worker plus the main thread, which also runs physics jobs while it waits on them
+        m_ThreadContactEventBuffers.resize(std::max(1u, std::thread::hardware_concurrency()) + 1);
     }
 
     JoltWorld::~JoltWorld()
@@ -235,180 +302,109 @@ namespace HRealEngine
         }
     }
 
-    void JoltWorld::CreateBodyForEntity(Entity entity)
+    void JoltWorld::CreateBodiesForEntities(const std::vector<Entity>& entities)
     {
-        if (entity.HasComponent<BoxCollider3DComponent>())
+        std::vector<JPH::BodyID> activeBodies, inactiveBodies;
+        for (Entity entity : entities)
         {
-            auto& boxCollider = entity.GetComponent<BoxCollider3DComponent>();
-            auto& transform = entity.GetComponent<TransformComponent>();
-            
-            if (entity.HasComponent<Rigidbody3DComponent>())
-            {
-                auto& rb3d = entity.GetComponent<Rigidbody3DComponent>();
-                JPH::Vec3 savedVelocity = JPH::Vec3::sZero();
-                if (rb3d.RuntimeBody)
-                {
-                    JPH::Body* oldBody = (JPH::Body*)rb3d.RuntimeBody;
-                    savedVelocity = oldBody->GetLinearVelocity();
-                    oldBody->SetUserData(0);
-                    body_interface->RemoveBody(oldBody->GetID());
-                    body_interface->DestroyBody(oldBody->GetID());
-                    rb3d.RuntimeBody = nullptr;
-                }
-                if (boxCollider.RuntimeBody)
-                {
-                    JPH::Body* oldBody = (JPH::Body*)boxCollider.RuntimeBody;
-                    oldBody->SetUserData(0);
-                    body_interface->RemoveBody(oldBody->GetID());
-                    body_interface->DestroyBody(oldBody->GetID());
-                    boxCollider.RuntimeBody = nullptr;
-                }
-                
-                glm::vec3 halfExtents = glm::abs(transform.Scale) * boxCollider.Size;
-                JPH::BoxShapeSettings boxShapeSettings({ halfExtents.x, halfExtents.y, halfExtents.z });
-                boxShapeSettings.mConvexRadius = rb3d.ConvexRadius;
-                boxShapeSettings.SetEmbedded(); // A ref counted object on the stack (base class RefTarget) should be marked as such to prevent it from being freed when its reference count goes to 0.
-
-                JPH::ShapeSettings::ShapeResult boxShapeResult = boxShapeSettings.Create();
-                JPH::ShapeRefC boxShape = boxShapeResult.Get(); // We don't expect an error here, but you can check boxShapeResult for HasError() / GetError()
-                glm::vec3 localOffset = glm::abs(transform.Scale) * boxCollider.Offset;
-                if (glm::length(localOffset) > 0.0001f)
-                    boxShape = new JPH::RotatedTranslatedShape(JPH::Vec3(localOffset.x, localOffset.y, localOffset.z), JPH::Quat::sIdentity(), boxShape);
-                
-                JPH::EMotionType motionType = JPH::EMotionType::Static;
-                auto layer = Layers::NON_MOVING;
-                bool bAllowSleep = false;
-                switch (rb3d.Type)
-                {
-                case Rigidbody3DComponent::BodyType::Static:
-                    motionType = JPH::EMotionType::Static;
-                    layer = Layers::NON_MOVING;
-                    bAllowSleep = true;
-                    break;
-                case Rigidbody3DComponent::BodyType::Dynamic:
-                    motionType = JPH::EMotionType::Dynamic;
-                    layer = Layers::MOVING;
-                    bAllowSleep = false;
-                    break;
-                case Rigidbody3DComponent::BodyType::Kinematic:
-                    motionType = JPH::EMotionType::Kinematic;
-                    layer = Layers::MOVING;
-                    bAllowSleep = false;
-                    break;
-                }
-                glm::quat q = glm::quat(transform.Rotation); // (pitch/yaw/roll) rad
-                JPH::Quat joltRot(q.x, q.y, q.z, q.w);
-
-                JPH::BodyCreationSettings bodySettings(boxShape, JPH::RVec3(transform.Position.x, transform.Position.y, transform.Position.z),
-                    joltRot, motionType, layer);
-                bodySettings.mAllowedDOFs = GetAllowedDOFs(rb3d);
+            const bool bHasCollider = entity.HasComponent<BoxCollider3DComponent>();
+            const bool bHasRigidbody = entity.HasComponent<Rigidbody3DComponent>();
+            if (!bHasCollider && !bHasRigidbody)
+                continue;
+            if (!bHasCollider)
+                LOG_CORE_WARN("Rigidbody3D without collider, emptyShapeBody created: Entity UUID {}", (uint32_t)entity.GetUUID());
 
-                bodySettings.mAllowSleeping = bAllowSleep;
-                bodySettings.mFriction = rb3d.Friction;
-                bodySettings.mRestitution = rb3d.Restitution;
-                bodySettings.mAllowDynamicOrKinematic = true; // Allow this body to be changed to dynamic or kinematic at runtime (by default only static bodies can be changed to dynamic/kinematic and not the other way around)
-                JPH::Body* body = body_interface->CreateBody(bodySettings); // Note that if we run out of bodies this can return nullptr
-                body->SetUserData(entity.GetUUID());
-                if (boxCollider.bIsTrigger)
-                    body->SetIsSensor(true);
-                auto activation = motionType == JPH::EMotionType::Dynamic || motionType == JPH::EMotionType::Kinematic ? JPH::EActivation::Activate : JPH::EActivation::DontActivate;
-                body_interface->AddBody(body->GetID(), activation);
-                
-                if (savedVelocity.LengthSq() > 0.0f)
-                    body_interface->SetLinearVelocity(body->GetID(), savedVelocity);
-                
-                rb3d.RuntimeBody = body;
-                boxCollider.RuntimeBody = body;
+            JPH::Body* body = body_interface->CreateBody(MakeBodySettings(entity));
+            if (!body)
+            {
+                LOG_CORE_ERROR("Out of physics bodies, entity {} gets none", (uint64_t)entity.GetUUID());
+                break;
             }
-            else
+            body->SetUserData(entity.GetUUID());
+            if (bHasCollider)
             {
-                if (boxCollider.RuntimeBody)
-                    return;
-
-                glm::vec3 halfExtents = glm::abs(transform.Scale) * boxCollider.Size;
-                JPH::BoxShapeSettings boxShapeSettings({ halfExtents.x, halfExtents.y, halfExtents.z });
-                //boxShapeSettings.mConvexRadius = 0.0f;
-                boxShapeSettings.SetEmbedded(); // A ref counted object on the stack (base class RefTarget) should be marked as such to prevent it from being freed when its reference count goes to 0.
-                
-                JPH::ShapeSettings::ShapeResult boxShapeResult = boxShapeSettings.Create();
-                JPH::ShapeRefC boxShape = boxShapeResult.Get(); // We don't expect an error here, but you can check boxShapeResult for HasError() / GetError()
-                
-                glm::vec3 localOffset = glm::abs(transform.Scale) * boxCollider.Offset;
-                if (glm::length(localOffset) > 0.0001f)
-                    boxShape = new JPH::RotatedTranslatedShape(JPH::Vec3(localOffset.x, localOffset.y, localOffset.z), JPH::Quat::sIdentity(), boxShape);
-                
-                JPH::EMotionType motionType = JPH::EMotionType::Static;
-                auto layer = Layers::NON_MOVING;
-                bool bAllowSleep = true;
-                
-                glm::quat q = glm::quat(transform.Rotation); // (pitch/yaw/roll) rad
-                JPH::Quat joltRot(q.x, q.y, q.z, q.w);
-                
-                JPH::BodyCreationSettings bodySettings(boxShape, JPH::RVec3(transform.Position.x, transform.Position.y, transform.Position.z),
-                    joltRot, motionType, layer);
-                
-                bodySettings.mAllowSleeping = bAllowSleep;
-                bodySettings.mFriction = 0.05f;
-                bodySettings.mRestitution = 0.0f;
-                bodySettings.mAllowDynamicOrKinematic = true; // Allow this body to be changed to dynamic or kinematic at runtime (by default only static bodies can be changed to dynamic/kinematic and not the other way around)
-                JPH::Body* body = body_interface->CreateBody(bodySettings); // Note that if we run out of bodies this can return nullptr
-                body->SetUserData(entity.GetUUID());
+                auto& boxCollider = entity.GetComponent<BoxCollider3DComponent>();
                 if (boxCollider.bIsTrigger)
                     body->SetIsSensor(true);
-                auto activation = motionType == JPH::EMotionType::Dynamic || motionType == JPH::EMotionType::Kinematic ? JPH::EActivation::Activate : JPH::EActivation::DontActivate;
-                body_interface->AddBody(body->GetID(), activation);     
-                
                 boxCollider.RuntimeBody = body;
             }
+            if (bHasRigidbody)
+                entity.GetComponent<Rigidbody3DComponent>().RuntimeBody = body;
+
+            (body->IsStatic() ? inactiveBodies : activeBodies).push_back(body->GetID());
         }
-        else if (entity.HasComponent<Rigidbody3DComponent>())
+
+        auto addBatch = [this](std::vector<JPH::BodyID>& bodies, JPH::EActivation activation)
         {
+            if (bodies.empty())
+                return;
+            JPH::BodyInterface::AddState state = body_interface->AddBodiesPrepare(bodies.data(), (int)bodies.size());
+            body_interface->AddBodiesFinalize(bodies.data(), (int)bodies.size(), state, activation);
+        };
+        addBatch(activeBodies, JPH::EActivation::Activate);
+        addBatch(inactiveBodies, JPH::EActivation::DontActivate);
+    }
+
+    void JoltWorld::CreateBodyForEntity(Entity entity)
+    {
+        const bool bHasCollider = entity.HasComponent<BoxCollider3DComponent>();
+        const bool bHasRigidbody = entity.HasComponent<Rigidbody3DComponent>();
+        if (!bHasCollider && !bHasRigidbody)
+            return;
+
+        JPH::Vec3 savedVelocity = JPH::Vec3::sZero();
+        if (bHasCollider && bHasRigidbody)
+        {
+            // Rebuilt whenever the collider or rigidbody changes, the new body keeps the old one's velocity
             auto& rb3d = entity.GetComponent<Rigidbody3DComponent>();
-            auto& transform = entity.GetComponent<TransformComponent>();
+            auto& boxCollider = entity.GetComponent<BoxCollider3DComponent>();
             if (rb3d.RuntimeBody)
-                return;
-            JPH::EmptyShapeSettings emptyShapeSettings;
-            emptyShapeSettings.SetEmbedded();
-            JPH::ShapeSettings::ShapeResult emptyShapeResult = emptyShapeSettings.Create();
-            JPH::ShapeRefC emptyShape = emptyShapeResult.Get();
-            LOG_CORE_WARN("Rigidbody3D without collider, emptyShapeBody created: Entity UUID {}", (uint32_t)entity.GetUUID());
-            
-            JPH::EMotionType motionType = JPH::EMotionType::Static;
-            auto layer = Layers::NON_MOVING;
-            bool bAllowSleep = false;
-            switch (rb3d.Type)
             {
-            case Rigidbody3DComponent::BodyType::Static:
-                motionType = JPH::EMotionType::Static;
-                layer = Layers::NON_MOVING;
-                bAllowSleep = true;
-                break;
-            case Rigidbody3DComponent::BodyType::Dynamic:
-                motionType = JPH::EMotionType::Dynamic;
-                layer = Layers::MOVING;
-                bAllowSleep = false;
-                break;
-            case Rigidbody3DComponent::BodyType::Kinematic:
-                motionType = JPH::EMotionType::Kinematic;
-                layer = Layers::MOVING;
-                bAllowSleep = false;
-                break;
+                JPH::Body* oldBody = (JPH::Body*)rb3d.RuntimeBody;
+                savedVelocity = oldBody->GetLinearVelocity();
+                oldBody->SetUserData(0);
+                body_interface->RemoveBody(oldBody->GetID());
+                body_interface->DestroyBody(oldBody->GetID());
+                rb3d.RuntimeBody = nullptr;
             }
-            
-            glm::quat q = glm::quat(transform.Rotation);
-            JPH::Quat joltRot(q.x, q.y, q.z, q.w);
-            
-            JPH::BodyCreationSettings bodySettings(emptyShape, JPH::RVec3(transform.Position.x, transform.Position.y, transform.Position.z),
-                joltRot, motionType, layer);
-            bodySettings.mAllowedDOFs = GetAllowedDOFs(rb3d);
-            bodySettings.mAllowSleeping = bAllowSleep;
-            bodySettings.mAllowDynamicOrKinematic = true; // Allow this body to be changed to dynamic or kinematic at runtime (by default only static bodies can be changed to dynamic/kinematic and not the other way around)
-            JPH::Body* body = body_interface->CreateBody(bodySettings);
-            body->SetUserData(entity.GetUUID());
-            auto activation = motionType == JPH::EMotionType::Dynamic || motionType == JPH::EMotionType::Kinematic ? JPH::EActivation::Activate : JPH::EActivation::DontActivate;
-            body_interface->AddBody(body->GetID(), activation);         
-            rb3d.RuntimeBody = body;
+            if (boxCollider.RuntimeBody)
+            {
+                JPH::Body* oldBody = (JPH::Body*)boxCollider.RuntimeBody;
+                oldBody->SetUserData(0);
+                body_interface->RemoveBody(oldBody->GetID());
+                body_interface->DestroyBody(oldBody->GetID());
+                boxCollider.RuntimeBody = nullptr;
+            }
+        }
+        else
+        {
+            void* existingBody = bHasCollider ? entity.GetComponent<BoxCollider3DComponent>().RuntimeBody : entity.GetComponent<Rigidbody3DComponent>().RuntimeBody;
+            if (existingBody)
+                return;
+            if (!bHasCollider)
+                LOG_CORE_WARN("Rigidbody3D without collider, emptyShapeBody created: Entity UUID {}", (uint32_t)entity.GetUUID());
+        }
+
+        JPH::Body* body = body_interface->CreateBody(MakeBodySettings(entity));
+        if (!body)
+        {
+            LOG_CORE_ERROR("Out of physics bodies, entity {} gets none", (uint64_t)entity.GetUUID());
+            return;
         }
+        body->SetUserData(entity.GetUUID());
+        if (bHasCollider)
+        {
+            auto& boxCollider = entity.GetComponent<BoxCollider3DComponent>();
+            if (boxCollider.bIsTrigger)
+                body->SetIsSensor(true);
+            boxCollider.RuntimeBody = body;
+        }
+        if (bHasRigidbody)
+            entity.GetComponent<Rigidbody3DComponent>().RuntimeBody = body;
+
+        body_interface->AddBody(body->GetID(), body->IsStatic() ? JPH::EActivation::DontActivate : JPH::EActivation::Activate);
+        if (savedVelocity.LengthSq() > 0.0f)
+            body_interface->SetLinearVelocity(body->GetID(), savedVelocity);
     }
 
     void JoltWorld::SetBodyTypeForEntity(Entity entity)
@@ -542,6 +538,8 @@ namespace HRealEngine
         {
             UpdateSimulation3DForKinematicBodies(deltaTime);
             m_JoltWorldHelper->StepWorld(deltaTime, physics_system);
+            // Scripts don't run while simulating, nobody consumes the contact events
+            DiscardContactEvents();
             UpdateSimulation3DForNonKinematicBodies();
         }
     }
@@ -609,75 +607,134 @@ namespace HRealEngine
         }
     }
     
-    void JoltWorld::UpdateRuntime3D()
+    JoltWorld::ContactEventBuffer* JoltWorld::GetThreadContactEventBuffer()
     {
-        std::vector<CollisionEvent> beginEvents, endEvents;
-        std::vector<PerceptionOverlapEvent> perceptionEvents;
+        // A thread keeps its slot for one step of one world, stepping another world or the next step hands out a new one
+        thread_local uint64_t t_WorldID = 0;
+        thread_local uint64_t t_Step = 0;
+        thread_local uint32_t t_Slot = 0;
+        if (t_WorldID != m_WorldID || t_Step != m_ContactEventStep)
         {
-            std::lock_guard<std::mutex> lock(m_EventQueueMutex);
-            beginEvents = std::move(m_CollisionBeginEvents);
-            endEvents = std::move(m_CollisionEndEvents);
-            perceptionEvents = std::move(m_PerceptionOverlapEvents);
-            
-            m_CollisionBeginEvents.clear();
-            m_CollisionEndEvents.clear();
-            m_PerceptionOverlapEvents.clear();
+            t_Slot = m_NextContactEventBufferSlot.fetch_add(1, std::memory_order_relaxed);
+            t_WorldID = m_WorldID;
+            t_Step = m_ContactEventStep;
         }
-        
-        for (const auto& ev : beginEvents)
+        return t_Slot < m_ThreadContactEventBuffers.size() ? &m_ThreadContactEventBuffers[t_Slot] : nullptr;
+    }
+
+    void JoltWorld::AppendCollisionEvent(const CollisionEvent& event, bool bIsBegin)
+    {
+        if (ContactEventBuffer* buffer = GetThreadContactEventBuffer())
         {
-            Entity a = m_Scene->GetEntityByUUID(ev.EntityA);
-            Entity b = m_Scene->GetEntityByUUID(ev.EntityB);
+            (bIsBegin ? buffer->BeginEvents : buffer->EndEvents).push_back(event);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_OverflowContactEventMutex);
+        (bIsBegin ? m_OverflowContactEventBuffer.BeginEvents : m_OverflowContactEventBuffer.EndEvents).push_back(event);
+    }
 
-            if (a && b)
-            {
-                if (m_Scene->GetRegistry().any_of<ScriptComponent>(a))
-                    ScriptEngine::OnCollisionBegin(a, b);
-            
-                if (m_Scene->GetRegistry().any_of<ScriptComponent>(b))
-                    ScriptEngine::OnCollisionBegin(b, a);
-                
-                if (a.HasComponent<NativeScriptComponent>())
-                {
-                    auto& nsc = a.GetComponent<NativeScriptComponent>();
-                    if (nsc.Instance) 
-                        nsc.Instance->OnCollisionBegin(b);
-                }
-                if (b.HasComponent<NativeScriptComponent>())
-                    {
-                    auto& nsc = b.GetComponent<NativeScriptComponent>();
-                    if (nsc.Instance) 
-                        nsc.Instance->OnCollisionBegin(a);
-                }
-            }
+    void JoltWorld::AppendPerceptionEvent(const PerceptionOverlapEvent& event)
+    {
+        if (ContactEventBuffer* buffer = GetThreadContactEventBuffer())
+        {
+            buffer->PerceptionEvents.push_back(event);
+            return;
         }
-        for (const auto& ev : endEvents)
+        std::lock_guard<std::mutex> lock(m_OverflowContactEventMutex);
+        m_OverflowContactEventBuffer.PerceptionEvents.push_back(event);
+    }
+
+    void JoltWorld::GatherContactEvents()
+    {
+        auto gather = [this](ContactEventBuffer& buffer)
+        {
+            m_CollisionBeginEvents.insert(m_CollisionBeginEvents.end(), buffer.BeginEvents.begin(), buffer.BeginEvents.end());
+            m_CollisionEndEvents.insert(m_CollisionEndEvents.end(), buffer.EndEvents.begin(), buffer.EndEvents.end());
+            m_PerceptionOverlapEvents.insert(m_PerceptionOverlapEvents.end(), buffer.PerceptionEvents.begin(), buffer.PerceptionEvents.end());
+            buffer.BeginEvents.clear();
+            buffer.EndEvents.clear();
+            buffer.PerceptionEvents.clear();
+        };
+        for (auto& buffer : m_ThreadContactEventBuffers)
+            gather(buffer);
+        gather(m_OverflowContactEventBuffer);
+        m_NextContactEventBufferSlot.store(0, std::memory_order_relaxed);
+        m_ContactEventStep++;
+    }
+
+    void JoltWorld::DiscardContactEvents()
+    {
+        for (auto& buffer : m_ThreadContactEventBuffers)
+        {
+            buffer.BeginEvents.clear();
+            buffer.EndEvents.clear();
+            buffer.PerceptionEvents.clear();
+        }
+        m_OverflowContactEventBuffer.BeginEvents.clear();
+        m_OverflowContactEventBuffer.EndEvents.clear();
+        m_OverflowContactEventBuffer.PerceptionEvents.clear();
+        m_NextContactEventBufferSlot.store(0, std::memory_order_relaxed);
+        m_ContactEventStep++;
+    }
+
+    void JoltWorld::DispatchCollisionEvents(std::vector<CollisionEvent>& events, bool bIsBegin)
+    {
+        // Compound shapes report one contact per sub shape, only dispatch once per body pair
+        for (auto& ev : events)
+            if (ev.EntityB < ev.EntityA)
+                std::swap(ev.EntityA, ev.EntityB);
+        std::sort(events.begin(), events.end(), [](const CollisionEvent& l, const CollisionEvent& r)
+        {
+            return l.EntityA != r.EntityA ? l.EntityA < r.EntityA : l.EntityB < r.EntityB;
+        });
+        events.erase(std::unique(events.begin(), events.end(), [](const CollisionEvent& l, const CollisionEvent& r)
+        {
+            return l.EntityA == r.EntityA && l.EntityB == r.EntityB;
+        }), events.end());
+
+        std::vector<std::pair<UUID, UUID>> scriptPairs;
+        scriptPairs.reserve(events.size());
+        for (const auto& ev : events)
         {
             Entity a = m_Scene->GetEntityByUUID(ev.EntityA);
             Entity b = m_Scene->GetEntityByUUID(ev.EntityB);
-            if (a && b)
-            {
-                if (m_Scene->GetRegistry().any_of<ScriptComponent>(a))
-                    ScriptEngine::OnCollisionEnd(a, b);
+            if (!a || !b)
+                continue;
             
-                if (m_Scene->GetRegistry().any_of<ScriptComponent>(b))
-                    ScriptEngine::OnCollisionEnd(b, a);
+            if (a.HasComponent<ScriptComponent>() || b.HasComponent<ScriptComponent>())
+                scriptPairs.emplace_back(ev.EntityA, ev.EntityB);
 
-                if (a.HasComponent<NativeScriptComponent>())
-                {
-                    auto& nsc = a.GetComponent<NativeScriptComponent>();
-                    if (nsc.Instance)
-                        nsc.Instance->OnCollisionEnd(b);
-                }
-                if (b.HasComponent<NativeScriptComponent>())
-                {
-                    auto& nsc = b.GetComponent<NativeScriptComponent>();
-                    if (nsc.Instance)
-                        nsc.Instance->OnCollisionEnd(a);
-                }
+            if (a.HasComponent<NativeScriptComponent>())
+            {
+                auto& nsc = a.GetComponent<NativeScriptComponent>();
+                if (nsc.Instance && bIsBegin)
+                    nsc.Instance->OnCollisionBegin(b);
+                else if (nsc.Instance)
+                    nsc.Instance->OnCollisionEnd(b);
+            }
+            if (b.HasComponent<NativeScriptComponent>())
+            {
+                auto& nsc = b.GetComponent<NativeScriptComponent>();
+                if (nsc.Instance && bIsBegin)
+                    nsc.Instance->OnCollisionBegin(a);
+                else if (nsc.Instance)
+                    nsc.Instance->OnCollisionEnd(a);
             }
         }
-        for (const auto& ev : perceptionEvents)
+        
+        if (bIsBegin)
+            ScriptEngine::OnCollisionBeginBatch(scriptPairs);
+        else
+            ScriptEngine::OnCollisionEndBatch(scriptPairs);
+        events.clear();
+    }
+    
+    void JoltWorld::UpdateRuntime3D()
+    {
+        DispatchCollisionEvents(m_CollisionBeginEvents, true);
+        DispatchCollisionEvents(m_CollisionEndEvents, false);
+
+        for (const auto& ev : m_PerceptionOverlapEvents)
         {
             Entity perceiver = m_Scene->GetEntityByUUID(ev.EntityA);
             if (!perceiver || !perceiver.HasComponent<AIControllerComponent>())
@@ -703,6 +760,7 @@ namespace HRealEngine
                 }
             }
         }
+        m_PerceptionOverlapEvents.clear();
         UpdatePercaptionBodies();
     }
     
@@ -734,6 +792,26 @@ namespace HRealEngine
     {
         Step3DWorldForKinematicBodies(deltaTime);
         m_JoltWorldHelper->StepWorld(deltaTime, physics_system);
+        GatherContactEvents();
+        Step3DWorldForNonKinematicBodies();
+    }
+
+    void JoltWorld::BeginStep3DWorld(Timestep deltaTime)
+    {
+        Step3DWorldForKinematicBodies(deltaTime);
+        // The update only touches Jolt state and the contact event buffers, never the registry
+        m_StepFuture = std::async(std::launch::async, [this, deltaTime]()
+        {
+            m_JoltWorldHelper->StepWorld(deltaTime, physics_system);
+        });
+    }
+
+    void JoltWorld::EndStep3DWorld()
+    {
+        if (!m_StepFuture.valid())
+            return;
+        m_StepFuture.get();
+        GatherContactEvents();
         Step3DWorldForNonKinematicBodies();
     }
 
@@ -851,6 +929,8 @@ namespace HRealEngine
 
     void JoltWorld::Stop3DPhysics()
     {
+        if (m_StepFuture.valid())
+            m_StepFuture.wait();
         DestroyPercaptionBodies();
         ScriptEngine::SetBodyInterface(nullptr);
         m_JoltWorldHelper = nullptr;
@@ -865,60 +945,25 @@ namespace HRealEngine
         ray.mOrigin = JPH::RVec3(origin.x, origin.y, origin.z);
         ray.mDirection = JPH::Vec3(dir.x, dir.y, dir.z) * maxDistance;
 
-        if (ignoreEntities.empty())
-        {
-            JPH::RayCastResult hit;
-        
-            if (physics_system.GetNarrowPhaseQuery().CastRay(ray, hit))
-            {
-                result.Hit = true;
-                result.Distance = hit.mFraction * maxDistance;
-                result.HitPoint = origin + dir * result.Distance;
-            
-                JPH::BodyLockRead lock(physics_system.GetBodyLockInterface(), hit.mBodyID);
-                if (lock.Succeeded())
-                {
-                    const JPH::Body& body = lock.GetBody();
-                    result.HitEntityID = (UUID)body.GetUserData();
+        std::vector<uint64_t> sortedIgnore = ignoreEntities;
+        std::sort(sortedIgnore.begin(), sortedIgnore.end());
+        IgnoreEntitiesBodyFilter bodyFilter(sortedIgnore);
 
-                    JPH::Vec3 normal = body.GetWorldSpaceSurfaceNormal(hit.mSubShapeID2,ray.GetPointOnRay(hit.mFraction));
-                    result.HitNormal = glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ());
-                }
-            }
-        }
-        else
+        JPH::RayCastResult hit;
+        if (physics_system.GetNarrowPhaseQuery().CastRay(ray, hit, m_QueryBroadPhaseLayerFilter, m_QueryObjectLayerFilter, bodyFilter))
         {
-            JPH::AllHitCollisionCollector<JPH::CastRayCollector> collector;
-            JPH::RayCastSettings settings;
-            physics_system.GetNarrowPhaseQuery().CastRay(ray, settings, collector);
-            collector.Sort();
-
-            for (auto& hit : collector.mHits)
+            result.Hit = true;
+            result.Distance = hit.mFraction * maxDistance;
+            result.HitPoint = origin + dir * result.Distance;
+        
+            JPH::BodyLockRead lock(physics_system.GetBodyLockInterface(), hit.mBodyID);
+            if (lock.Succeeded())
             {
-                JPH::BodyLockRead lock(physics_system.GetBodyLockInterface(), hit.mBodyID);
-                if (!lock.Succeeded())
-                    continue;
-
                 const JPH::Body& body = lock.GetBody();
-                uint64_t entityID = body.GetUserData();
-                
-                bool shouldIgnore = false;
-                for (uint64_t ignoreID : ignoreEntities)
-                    if (entityID == ignoreID)
-                    {
-                        shouldIgnore = true;
-                        break;
-                    }
-                if (shouldIgnore)
-                    continue;
+                result.HitEntityID = (UUID)body.GetUserData();
 
-                result.Hit = true;
-                result.Distance = hit.mFraction * maxDistance;
-                result.HitPoint = origin + dir * result.Distance;
-                result.HitEntityID = (UUID)entityID;
                 JPH::Vec3 normal = body.GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, ray.GetPointOnRay(hit.mFraction));
                 result.HitNormal = glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ());
-                break;
             }
         }
         
@@ -947,12 +992,17 @@ namespace HRealEngine
         JPH::RRayCast ray;
         ray.mOrigin = JPH::RVec3(origin.x, origin.y, origin.z);
         ray.mDirection = JPH::Vec3(dir.x, dir.y, dir.z) * maxDistance;
+
+        std::vector<uint64_t> sortedIgnore = ignoreEntities;
+        std::sort(sortedIgnore.begin(), sortedIgnore.end());
+        IgnoreEntitiesBodyFilter bodyFilter(sortedIgnore);
     
         JPH::AllHitCollisionCollector<JPH::CastRayCollector> collector;
         JPH::RayCastSettings settings;
-        physics_system.GetNarrowPhaseQuery().CastRay(ray, settings, collector);
+        physics_system.GetNarrowPhaseQuery().CastRay(ray, settings, collector, m_QueryBroadPhaseLayerFilter, m_QueryObjectLayerFilter, bodyFilter);
         collector.Sort();
 
+        results.reserve(collector.mHits.size());
         for (auto& hit : collector.mHits)
         {
             JPH::BodyLockRead lock(physics_system.GetBodyLockInterface(), hit.mBodyID);
@@ -960,23 +1010,12 @@ namespace HRealEngine
                 continue;
 
             const JPH::Body& body = lock.GetBody();
-            uint64_t entityID = body.GetUserData();
-            
-            bool shouldIgnore = false;
-            for (uint64_t ignoreID : ignoreEntities)
-                if (entityID == ignoreID)
-                {
-                    shouldIgnore = true;
-                    break;
-                }
-            if (shouldIgnore)
-                continue;
 
             RaycastHit3D r;
             r.Hit = true;
             r.Distance = hit.mFraction * maxDistance;
             r.HitPoint = origin + dir * r.Distance;
-            r.HitEntityID = (UUID)entityID;
+            r.HitEntityID = (UUID)body.GetUserData();
             JPH::Vec3 normal = body.GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, ray.GetPointOnRay(hit.mFraction));
             r.HitNormal = glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ());
             results.push_back(r);
@@ -997,6 +1036,127 @@ namespace HRealEngine
         return results;
     }
 
+    void JoltWorld::QueryBatch(const PhysicsQuery3D* queries, size_t count, PhysicsQueryHit3D* outHits, const std::vector<uint64_t>& ignoreEntities)
+    {
+        if (count == 0)
+            return;
+
+        std::vector<uint64_t> sortedIgnore = ignoreEntities;
+        std::sort(sortedIgnore.begin(), sortedIgnore.end());
+
+        // Small batches are cheaper to run inline than to hand over to the worker threads
+        const size_t queriesPerJob = 32;
+        JPH::JobSystem* jobSystem = m_JoltWorldHelper ? m_JoltWorldHelper->GetJobSystem() : nullptr;
+        if (!jobSystem || count <= queriesPerJob)
+        {
+            for (size_t i = 0; i < count; i++)
+                outHits[i] = RunQuery(queries[i], sortedIgnore);
+            return;
+        }
+
+        JPH::JobSystem::Barrier* barrier = jobSystem->CreateBarrier();
+        for (size_t begin = 0; begin < count; begin += queriesPerJob)
+        {
+            size_t end = std::min(begin + queriesPerJob, count);
+            JPH::JobHandle job = jobSystem->CreateJob("PhysicsQueryBatch", JPH::Color::sCyan, [this, queries, outHits, begin, end, &sortedIgnore]()
+            {
+                for (size_t i = begin; i < end; i++)
+                    outHits[i] = RunQuery(queries[i], sortedIgnore);
+            });
+            barrier->AddJob(job);
+        }
+        jobSystem->WaitForJobs(barrier);
+        jobSystem->DestroyBarrier(barrier);
+    }
+
+    PhysicsQueryHit3D JoltWorld::RunQuery(const PhysicsQuery3D& query, const std::vector<uint64_t>& sortedIgnoreEntities)
+    {
+        PhysicsQueryHit3D result;
+        IgnoreEntitiesBodyFilter bodyFilter(sortedIgnoreEntities, query.IgnoreEntityID);
+        const JPH::NarrowPhaseQuery& narrowPhase = physics_system.GetNarrowPhaseQuery();
+
+        float dirLength = glm::length(query.Direction);
+        glm::vec3 dir = dirLength > 0.0001f ? query.Direction / dirLength : glm::vec3(0.0f, 0.0f, -1.0f);
+        JPH::RVec3 origin(query.Origin.x, query.Origin.y, query.Origin.z);
+        JPH::Vec3 castVector = JPH::Vec3(dir.x, dir.y, dir.z) * query.MaxDistance;
+
+        bool bIsSphereQuery = query.Type != PhysicsQueryType3D::Raycast && query.Radius > 0.0f;
+        if (!bIsSphereQuery)
+        {
+            JPH::RRayCast ray;
+            ray.mOrigin = origin;
+            ray.mDirection = castVector;
+
+            JPH::RayCastResult hit;
+            if (!narrowPhase.CastRay(ray, hit, m_QueryBroadPhaseLayerFilter, m_QueryObjectLayerFilter, bodyFilter))
+                return result;
+
+            JPH::BodyLockRead lock(physics_system.GetBodyLockInterface(), hit.mBodyID);
+            if (!lock.Succeeded())
+                return result;
+
+            const JPH::Body& body = lock.GetBody();
+            JPH::Vec3 normal = body.GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, ray.GetPointOnRay(hit.mFraction));
+            result.Hit = 1;
+            result.HitEntityID = body.GetUserData();
+            result.Distance = hit.mFraction * query.MaxDistance;
+            result.HitPoint = query.Origin + dir * result.Distance;
+            result.HitNormal = glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ());
+            return result;
+        }
+
+        JPH::SphereShape sphere(query.Radius);
+        sphere.SetEmbedded();
+
+        JPH::BodyID hitBodyID;
+        JPH::Vec3 contactPoint;
+        JPH::Vec3 penetrationAxis;
+        float fraction = 0.0f;
+        if (query.Type == PhysicsQueryType3D::SphereCast)
+        {
+            JPH::RShapeCast shapeCast(&sphere, JPH::Vec3::sReplicate(1.0f), JPH::RMat44::sTranslation(origin), castVector);
+            JPH::ShapeCastSettings settings;
+            JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector;
+            narrowPhase.CastShape(shapeCast, settings, origin, collector, m_QueryBroadPhaseLayerFilter, m_QueryObjectLayerFilter, bodyFilter);
+            if (!collector.HadHit())
+                return result;
+
+            hitBodyID = collector.mHit.mBodyID2;
+            contactPoint = collector.mHit.mContactPointOn2;
+            penetrationAxis = collector.mHit.mPenetrationAxis;
+            fraction = collector.mHit.mFraction;
+        }
+        else
+        {
+            JPH::CollideShapeSettings settings;
+            JPH::AnyHitCollisionCollector<JPH::CollideShapeCollector> collector;
+            narrowPhase.CollideShape(&sphere, JPH::Vec3::sReplicate(1.0f), JPH::RMat44::sTranslation(origin), settings, origin, collector,
+                m_QueryBroadPhaseLayerFilter, m_QueryObjectLayerFilter, bodyFilter);
+            if (!collector.HadHit())
+                return result;
+
+            hitBodyID = collector.mHit.mBodyID2;
+            contactPoint = collector.mHit.mContactPointOn2;
+            penetrationAxis = collector.mHit.mPenetrationAxis;
+        }
+
+        JPH::BodyLockRead lock(physics_system.GetBodyLockInterface(), hitBodyID);
+        if (!lock.Succeeded())
+            return result;
+
+        result.Hit = 1;
+        result.HitEntityID = lock.GetBody().GetUserData();
+        result.Distance = fraction * query.MaxDistance;
+        // Contact points are relative to the base offset, which is the query origin
+        result.HitPoint = query.Origin + glm::vec3(contactPoint.GetX(), contactPoint.GetY(), contactPoint.GetZ());
+        if (penetrationAxis.LengthSq() > 1.0e-12f)
+        {
+            JPH::Vec3 normal = -penetrationAxis.Normalized();
+            result.HitNormal = glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ());
+        }
+        return result;
+    }
+
     void JoltWorld::UpdateDebugLines(float deltaTime)
     {
         for (auto& line : m_DebugLines)
@@ -1311,6 +1471,22 @@ namespace HRealEngine
     void JoltWorld::SightPercaptionsUpdate(AIControllerComponent& ai, const TransformComponent& tc,
         const glm::vec3& forward)
     {
+        if (!ai.IsSightEnabled())
+            return;
+
+        struct SightCandidate
+        {
+            UUID TargetID;
+            PerceivableType Type;
+            glm::vec3 Position;
+            size_t FirstQuery;
+            size_t QueryCount;
+        };
+        std::vector<SightCandidate> candidates;
+        std::vector<PhysicsQuery3D> queries;
+
+        float halfFOVcos = glm::cos(glm::radians(ai.SightSettings.FieldOfView * 0.5f));
+        glm::vec3 forwardDir = glm::normalize(forward);
         for (const auto& [targetID, count] : ai.OverlappingEntities)
         {
             Entity targetEntity = m_Scene->GetEntityByUUID(targetID);
@@ -1324,60 +1500,71 @@ namespace HRealEngine
             auto& targetTC = targetEntity.GetComponent<TransformComponent>();
             glm::vec3 toTarget = targetTC.Position - tc.Position;
             float distance = glm::length(toTarget);
-            if (distance < 0.001f)
+            if (distance < 0.001f || distance > ai.SightSettings.SightRadius)
+                continue;       
+            
+            bool typeMatch = ai.SightSettings.DetectableTypes.empty();
+            for (auto& dt : ai.SightSettings.DetectableTypes)
+                for (auto& pt : percComp.Types)
+                    if (dt == pt)
+                    {
+                        typeMatch = true;
+                        break;
+                    }
+            if (!typeMatch)
                 continue;       
             
             glm::vec3 dirToTarget = toTarget / distance;        
-            if (ai.IsSightEnabled() && distance <= ai.SightSettings.SightRadius)
+            if (glm::dot(forwardDir, dirToTarget) < halfFOVcos)
+                continue;
+
+            SightCandidate candidate;
+            candidate.TargetID = targetID;
+            candidate.Type = percComp.Types.empty() ? PerceivableType::Neutral : percComp.Types[0];
+            candidate.Position = targetTC.Position;
+            candidate.FirstQuery = queries.size();
+
+            PhysicsQuery3D query;
+            query.Origin = tc.Position;
+            query.Direction = dirToTarget;
+            query.MaxDistance = distance + 0.1f;
+            query.IgnoreEntityID = ai.OwnerEntityID;
+            queries.push_back(query);
+            for (auto& offset : percComp.DetectablePointsOffsets)
             {
-                bool typeMatch = ai.SightSettings.DetectableTypes.empty();
-                for (auto& dt : ai.SightSettings.DetectableTypes)
-                    for (auto& pt : percComp.Types)
-                        if (dt == pt)
-                        {
-                            typeMatch = true;
-                            break;
-                        }
-                
-                if (!typeMatch)
-                    continue;       
-                
-                float dotProduct = glm::dot(glm::normalize(forward), dirToTarget);
-                float halfFOVcos = glm::cos(glm::radians(ai.SightSettings.FieldOfView * 0.5f));
-                if (dotProduct < halfFOVcos)
-                    continue;       
-                
-                std::vector<uint64_t> ignoreList = { (uint64_t)ai.OwnerEntityID };
-                RaycastHit3D losHit = Raycast(tc.Position, dirToTarget, distance + 0.1f, false, 0.0f, ignoreList);      
-                bool hasLOS = false;
-                
-                if (losHit.Hit && losHit.HitEntityID == targetID)
-                    hasLOS = true;
-                else if (!percComp.DetectablePointsOffsets.empty())
-                    for (auto& offset : percComp.DetectablePointsOffsets)
-                    {
-                        glm::vec3 targetPoint = targetTC.Position + offset;
-                        glm::vec3 dir = glm::normalize(targetPoint - tc.Position);
-                        float dist = glm::length(targetPoint - tc.Position);
-                        RaycastHit3D pointHit = Raycast(tc.Position, dir, dist + 0.1f, false, 0.0f, ignoreList);
-                        if (pointHit.Hit && pointHit.HitEntityID == targetID)
-                        {
-                            hasLOS = true;
-                            break;
-                        }
-                    }       
-                
-                if (hasLOS)
+                glm::vec3 toPoint = targetTC.Position + offset - tc.Position;
+                query.Direction = toPoint;
+                query.MaxDistance = glm::length(toPoint) + 0.1f;
+                queries.push_back(query);
+            }
+            candidate.QueryCount = queries.size() - candidate.FirstQuery;
+            candidates.push_back(candidate);
+        }
+        if (candidates.empty())
+            return;
+
+        std::vector<PhysicsQueryHit3D> hits(queries.size());
+        QueryBatch(queries.data(), queries.size(), hits.data());
+
+        for (const auto& candidate : candidates)
+        {
+            bool hasLOS = false;
+            for (size_t i = candidate.FirstQuery; i < candidate.FirstQuery + candidate.QueryCount; i++)
+                if (hits[i].Hit && hits[i].HitEntityID == candidate.TargetID)
                 {
-                    PercaptionResult result;
-                    result.EntityID.ID = targetID;
-                    result.Type = percComp.Types.empty() ? PerceivableType::Neutral : percComp.Types[0];
-                    result.PercaptionMethod = PercaptionType::Sight;
-                    result.SensedPosition = targetTC.Position;
-                    result.TimeSinceLastSensed = 0.0f;
-                    ai.CurrentPerceptions.push_back(result);
+                    hasLOS = true;
+                    break;
                 }
-            }
+            if (!hasLOS)
+                continue;
+
+            PercaptionResult result;
+            result.EntityID.ID = candidate.TargetID;
+            result.Type = candidate.Type;
+            result.PercaptionMethod = PercaptionType::Sight;
+            result.SensedPosition = candidate.Position;
+            result.TimeSinceLastSensed = 0.0f;
+            ai.CurrentPerceptions.push_back(result);
         }
     }
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "JoltWorldHelper.h"
 #include "HRealEngine/Core/Entity.h"
+#include <atomic>
+#include <future>
 #include <mutex>
 
 namespace HRealEngine
@@ -16,6 +18,31 @@ namespace HRealEngine
         float Distance = 0.0f;
         bool Hit = false;
     };
+    enum class PhysicsQueryType3D : int
+    {
+        Raycast = 0,
+        SphereCast = 1,
+        SphereOverlap = 2
+    };
+    // Blittable, mirrored by HRealEngine.PhysicsQuery in the script core
+    struct PhysicsQuery3D
+    {
+        PhysicsQueryType3D Type = PhysicsQueryType3D::Raycast;
+        glm::vec3 Origin = glm::vec3(0.0f);
+        glm::vec3 Direction = glm::vec3(0.0f, 0.0f, -1.0f);
+        float MaxDistance = 0.0f;
+        float Radius = 0.0f;
+        uint64_t IgnoreEntityID = 0;
+    };
+    // Blittable, mirrored by HRealEngine.PhysicsQueryHit in the script core
+    struct PhysicsQueryHit3D
+    {
+        uint64_t HitEntityID = 0;
+        glm::vec3 HitPoint = glm::vec3(0.0f);
+        glm::vec3 HitNormal = glm::vec3(0.0f);
+        float Distance = 0.0f;
+        int32_t Hit = 0;
+    };
     struct DebugLine
     {
         glm::vec3 Start;
@@ -36,6 +63,9 @@ namespace HRealEngine
         void CreateEmptyBody();
 
         void CreateBodyForEntity(Entity entity);
+        // For entities that have no body yet, e.g. fresh prefab clones. All bodies enter the broad phase in one batch
+        // instead of one AddBody call each.
+        void CreateBodiesForEntities(const std::vector<Entity>& entities);
         void SetBodyTypeForEntity(Entity entity);
         void SetIsTriggerForEntity(Entity entity, bool isTrigger);
         void SetBoxColliderSizeForEntity(Entity entity, const glm::vec3& size);
@@ -47,12 +77,18 @@ namespace HRealEngine
         void UpdateRuntime3D();
         void Step3DWorldForKinematicBodies(Timestep deltaTime);
         void Step3DWorld(Timestep deltaTime);
+        // Step3DWorld split in two: Begin moves the kinematic bodies and runs the Jolt update on a worker thread, End waits for it,
+        // gathers the contact events and writes the bodies back into the transforms. Nothing in between may touch the physics system.
+        void BeginStep3DWorld(Timestep deltaTime);
+        void EndStep3DWorld();
         void Step3DWorldForNonKinematicBodies();
         void DestroyEntityPhysics(Entity entity);
         void Stop3DPhysics();
         
         RaycastHit3D Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool debugDraw = false, float debugLifetime = 0.0f, const std::vector<uint64_t>& ignoreEntities = {});
         std::vector<RaycastHit3D> RaycastAll(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool debugDraw = false, float debugLifetime = 0.0f, const std::vector<uint64_t>& ignoreEntities = {});
+        // Runs every query and writes one result per query into outHits, large batches are spread over the physics job system
+        void QueryBatch(const PhysicsQuery3D* queries, size_t count, PhysicsQueryHit3D* outHits, const std::vector<uint64_t>& ignoreEntities = {});
         
         std::vector<DebugLine>& GetDebugLines() { return m_DebugLines; }
         void UpdateDebugLines(float deltaTime);
@@ -68,7 +104,11 @@ namespace HRealEngine
         
         void ReportNoise(const NoiseEvent& event);
     private:
+        PhysicsQueryHit3D RunQuery(const PhysicsQuery3D& query, const std::vector<uint64_t>& sortedIgnoreEntities);
+        
         std::vector<DebugLine> m_DebugLines;
+        SceneQueryBroadPhaseLayerFilter m_QueryBroadPhaseLayerFilter;
+        SceneQueryObjectLayerFilter m_QueryObjectLayerFilter;
         
         struct CollisionEvent
         {
@@ -83,6 +123,21 @@ namespace HRealEngine
             UUID EntityB;
             bool bIsBegin; // true for begin, false for end
         };
+        // Contact callbacks run on the Jolt worker threads, every thread appends to its own buffer so the contact path never locks.
+        // The buffers are merged on the main thread once PhysicsSystem::Update has returned.
+        struct alignas(64) ContactEventBuffer
+        {
+            std::vector<CollisionEvent> BeginEvents;
+            std::vector<CollisionEvent> EndEvents;
+            std::vector<PerceptionOverlapEvent> PerceptionEvents;
+        };
+        ContactEventBuffer* GetThreadContactEventBuffer();
+        void AppendCollisionEvent(const CollisionEvent& event, bool bIsBegin);
+        void AppendPerceptionEvent(const PerceptionOverlapEvent& event);
+        void GatherContactEvents();
+        void DiscardContactEvents();
+        void DispatchCollisionEvents(std::vector<CollisionEvent>& events, bool bIsBegin);
+        
         class MyContactListener : public JPH::ContactListener
         {
         public:
@@ -114,27 +169,14 @@ namespace HRealEngine
                 auto layer2 = inBody2.GetObjectLayer();
                 
                 bool bisPerceptionOverlap = (layer1 == Layers::PERCEPTION && layer2 == Layers::PERCEIVABLE) || (layer1 == Layers::PERCEIVABLE && layer2 == Layers::PERCEPTION);
-                /*if (entity1ID != 0 && entity2ID != 0)
-                {
-                    std::lock_guard<std::mutex> lock(m_JoltWorld->m_EventQueueMutex);
-                    m_JoltWorld->m_CollisionBeginEvents.push_back({ entity1ID, entity2ID });
-                }
-                std::cout << "A contact was added" << std::endl;*/
                 if (bisPerceptionOverlap)
                 {
                     UUID perceiverID = layer1 == Layers::PERCEPTION ? entity1ID : entity2ID;
                     UUID perceivedID = layer1 == Layers::PERCEPTION ? entity2ID : entity1ID;
-
-                    std::lock_guard<std::mutex> lock(m_JoltWorld->m_EventQueueMutex);
-                    m_JoltWorld->m_PerceptionOverlapEvents.push_back({ perceiverID, perceivedID, true });
-                    std::cout << "A contact was added for percaption system" << std::endl;
+                    m_JoltWorld->AppendPerceptionEvent({ perceiverID, perceivedID, true });
                 }
                 else
-                {
-                    std::lock_guard<std::mutex> lock(m_JoltWorld->m_EventQueueMutex);
-                    m_JoltWorld->m_CollisionBeginEvents.push_back({ entity1ID, entity2ID });
-                    std::cout << "A contact was added" << std::endl;
-                }
+                    m_JoltWorld->AppendCollisionEvent({ entity1ID, entity2ID }, true);
             }
 
             virtual void OnContactPersisted(const JPH::Body &inBody1, const JPH::Body &inBody2,
@@ -161,16 +203,6 @@ namespace HRealEngine
                 if (m_Scene->GetRegistry().valid(entity1) && m_Scene->GetRegistry().valid(entity2))
                     m_JoltWorld->m_CollisionEndEvents.push_back({ entity1,  entity2 });
                 std::cout << "A contact was removed" << std::endl;*/
-                /*const JPH::BodyInterface &bi = m_JoltWorld->physics_system.GetBodyInterfaceNoLock();
-    
-                UUID entity1ID = (UUID)bi.GetUserData(inSubShapePair.GetBody1ID());
-                UUID entity2ID = (UUID)bi.GetUserData(inSubShapePair.GetBody2ID());
-
-                if (entity1ID != 0 && entity2ID != 0)
-                {
-                    std::lock_guard<std::mutex> lock(m_JoltWorld->m_EventQueueMutex);
-                    m_JoltWorld->m_CollisionEndEvents.push_back({ entity1ID, entity2ID });
-                }*/
                 const JPH::BodyLockInterfaceNoLock &lockInterface = m_JoltWorld->physics_system.GetBodyLockInterfaceNoLock();
 
                 JPH::BodyLockRead lock1(lockInterface, inSubShapePair.GetBody1ID());
@@ -197,15 +229,10 @@ namespace HRealEngine
                 {
                     UUID perceiverID = (layer1 == Layers::PERCEPTION) ? entity1ID : entity2ID;
                     UUID perceivedID = (layer1 == Layers::PERCEPTION) ? entity2ID : entity1ID;
-
-                    std::lock_guard<std::mutex> lock(m_JoltWorld->m_EventQueueMutex);
-                    m_JoltWorld->m_PerceptionOverlapEvents.push_back({ perceiverID, perceivedID, false });
+                    m_JoltWorld->AppendPerceptionEvent({ perceiverID, perceivedID, false });
                 }
                 else
-                {
-                    std::lock_guard<std::mutex> lock(m_JoltWorld->m_EventQueueMutex);
-                    m_JoltWorld->m_CollisionEndEvents.push_back({ entity1ID, entity2ID });
-                }
+                    m_JoltWorld->AppendCollisionEvent({ entity1ID, entity2ID }, false);
             }
         private:
             Scene* m_Scene = nullptr;
@@ -213,7 +240,14 @@ namespace HRealEngine
         };
         std::vector<CollisionEvent> m_CollisionBeginEvents;
         std::vector<CollisionEvent> m_CollisionEndEvents;
-        std::mutex m_EventQueueMutex;
+        std::vector<ContactEventBuffer> m_ThreadContactEventBuffers;
+        std::atomic<uint32_t> m_NextContactEventBufferSlot = 0; // reset after every step, slots are handed out per step
+        uint64_t m_ContactEventStep = 0;
+        std::future<void> m_StepFuture;
+        uint64_t m_WorldID = 0;
+        // Only used if more threads report contacts than there are buffers, which the job system setup never does
+        ContactEventBuffer m_OverflowContactEventBuffer;
+        std::mutex m_OverflowContactEventMutex;
         float m_MaxIntervalForNoiseEvent = 0.5f;
         
         std::vector<PerceptionOverlapEvent> m_PerceptionOverlapEvents;
@@ -53,7 +53,6 @@ namespace HRealEngine
 
         physics_system.Init( cMaxBodies, cNumBodyMutexes, cMaxBodyPairs, cMaxContactConstraints,
             m_BPLayerInterface, m_ObjectVsBroadPhaseLayerFilter, m_ObjectLayerPairFilter);
-        physics_system.SetBodyActivationListener(&m_BodyActivationListener);
 
         m_Initialized = true;
     }
@@ -5,8 +5,9 @@
 #include "Jolt/Physics/PhysicsSystem.h"
 #include "Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h"
 #include "Jolt/Physics/Collision/ObjectLayer.h"
-#include "Jolt/Physics/Body/BodyActivationListener.h"
 #include "Jolt/Physics/Collision/ContactListener.h"
+#include "Jolt/Physics/Body/Body.h"
+#include "Jolt/Physics/Body/BodyFilter.h"
 
 namespace HRealEngine
 {
@@ -134,19 +135,47 @@ namespace HRealEngine
         }
     };
 
-    // An example activation listener
-    class MyBodyActivationListener : public JPH::BodyActivationListener
+    /// Class that determines which broadphase layers scene queries (raycasts, shape casts, overlaps) look at.
+    /// Perception sensors are skipped so sight/hearing spheres never block a query.
+    class SceneQueryBroadPhaseLayerFilter : public JPH::BroadPhaseLayerFilter
     {
     public:
-        virtual void		OnBodyActivated(const JPH::BodyID &inBodyID, JPH::uint64 inBodyUserData) override
+        virtual bool				ShouldCollide(JPH::BroadPhaseLayer inLayer) const override
         {
-            std::cout << "A body got activated" << std::endl;
+            return inLayer != BroadPhaseLayers::PERCEPTION;
         }
+    };
+
+    /// Class that determines which object layers scene queries can hit
+    class SceneQueryObjectLayerFilter : public JPH::ObjectLayerFilter
+    {
+    public:
+        virtual bool				ShouldCollide(JPH::ObjectLayer inLayer) const override
+        {
+            return inLayer != Layers::PERCEPTION;
+        }
+    };
 
-        virtual void		OnBodyDeactivated(const JPH::BodyID &inBodyID, JPH::uint64 inBodyUserData) override
+    /// Body filter that rejects bodies owned by ignored entities, the ignore list has to be sorted
+    class IgnoreEntitiesBodyFilter : public JPH::BodyFilter
+    {
+    public:
+        IgnoreEntitiesBodyFilter(const std::vector<uint64_t>& sortedIgnoreEntities, uint64_t extraIgnoreEntity = 0)
+            : m_IgnoreEntities(sortedIgnoreEntities), m_ExtraIgnoreEntity(extraIgnoreEntity) {}
+
+        virtual bool				ShouldCollideLocked(const JPH::Body& inBody) const override
         {
-            std::cout << "A body went to sleep" << std::endl;
+            uint64_t entityID = inBody.GetUserData();
+            if (entityID == 0)
+                return true;
+            if (entityID == m_ExtraIgnoreEntity)
+                return false;
+            return !std::binary_search(m_IgnoreEntities.begin(), m_IgnoreEntities.end(), entityID);
         }
+
+    private:
+        const std::vector<uint64_t>& m_IgnoreEntities;
+        uint64_t m_ExtraIgnoreEntity = 0;
     };
 
     class JoltWorldHelper
@@ -158,6 +187,8 @@ namespace HRealEngine
         void Initialize(JPH::PhysicsSystem& physics_system);
         void StepWorld(Timestep deltaTime, JPH::PhysicsSystem& physics_system);
 
+        JPH::JobSystem* GetJobSystem() const { return m_JobSystem.get(); }
+
     private:
         JoltWorld* m_JoltWorld = nullptr;
         
@@ -167,7 +198,6 @@ namespace HRealEngine
         BPLayerInterfaceImpl               m_BPLayerInterface;
         ObjectVsBroadPhaseLayerFilterImpl  m_ObjectVsBroadPhaseLayerFilter;
         ObjectLayerPairFilterImpl          m_ObjectLayerPairFilter;
-        MyBodyActivationListener           m_BodyActivationListener;
 
         bool m_Initialized = false;
     };
@@ -7,7 +7,7 @@
 
 namespace HRealEngine
 {
-    Ref<VertexBuffer> VertexBuffer::Create(float* vertices, uint32_t size)
+    Ref<VertexBuffer> VertexBuffer::Create(const void* vertices, uint32_t size)
     {
         switch (Renderer::GetAPI())
         {
@@ -35,9 +35,23 @@ namespace HRealEngine
         return nullptr;
     }
 
+    Ref<StreamingVertexBuffer> StreamingVertexBuffer::Create(uint32_t batchSize, uint32_t batchesPerRegion, uint32_t regionCount)
+    {
+        switch (Renderer::GetAPI())
+        {
+        case RendererAPI::API::None:
+            HREALENGINE_CORE_DEBUGBREAK(false, "RendererAPI::None is currently not supported!");
+            return nullptr;
+        case RendererAPI::API::OpenGL:
+            return CreateRef<OpenGLStreamingVertexBuffer>(batchSize, batchesPerRegion, regionCount);
+        }
+        HREALENGINE_CORE_DEBUGBREAK(false, "Unknown RendererAPI!");
+        return nullptr;
+    }
+
     //-----------------------------
 
-    Ref<IndexBuffer> IndexBuffer::Create(uint32_t* indices, uint32_t count)
+    Ref<IndexBuffer> IndexBuffer::Create(const uint32_t* indices, uint32_t count)
     {
         switch (Renderer::GetAPI())
         {
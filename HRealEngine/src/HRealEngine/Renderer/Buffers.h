@@ -14,7 +14,9 @@ namespace HRealEngine
         Float, Float2, Float3, Float4,
         Mat3, Mat4,
         Int, Int2, Int3, Int4,
-        Bool
+        Bool,
+        // Packed vertex inputs, read as floats by the shader (normalize the integer ones)
+        UShort4, Short2, Half2
     };
     static uint32_t ShaderDataTypeSize(ShaderDataType type)
     {
@@ -32,6 +34,9 @@ namespace HRealEngine
             case ShaderDataType::Int3: return 4 * 3;
             case ShaderDataType::Int4: return 4 * 4;
             case ShaderDataType::Bool: return sizeof(bool);
+            case ShaderDataType::UShort4: return 2 * 4;
+            case ShaderDataType::Short2: return 2 * 2;
+            case ShaderDataType::Half2: return 2 * 2;
         }
         HREALENGINE_CORE_DEBUGBREAK(false, "Unknown ShaderDataType!");
         return 0; 
@@ -61,6 +66,9 @@ namespace HRealEngine
                 case ShaderDataType::Int3: return 3;
                 case ShaderDataType::Int4: return 4;
                 case ShaderDataType::Bool: return 1;
+                case ShaderDataType::UShort4: return 4;
+                case ShaderDataType::Short2: return 2;
+                case ShaderDataType::Half2: return 2;
             }
             HREALENGINE_CORE_DEBUGBREAK(false, "Unknown ShaderDataType!");
             return 0; 
@@ -112,10 +120,28 @@ namespace HRealEngine
 
         virtual void SetData(const void* data, uint32_t size) = 0;
 
-        static Ref<VertexBuffer> Create(float* vertices, uint32_t size);
+        static Ref<VertexBuffer> Create(const void* vertices, uint32_t size);
         static Ref<VertexBuffer> Create(uint32_t size);
     };
 
+    // Vertex buffer the batch renderers write straight into through a persistent mapping. It is split into regions
+    // used round robin. Batches are packed back to back inside a region, which is fenced once when the buffer moves
+    // past it, so the CPU only waits when it laps the GPU no matter how many batches a frame flushes.
+    class StreamingVertexBuffer : public VertexBuffer
+    {
+    public:
+        // Where the next batch is written, with room for batchSize bytes. Moves to the next region when the current
+        // one is too full, blocking until the GPU has finished reading it
+        virtual void* Map() = 0;
+        // Call after the draw that reads the mapped batch, size is the number of bytes it wrote
+        virtual void Commit(uint32_t size) = 0;
+        // First vertex of the mapped batch, pass it to the draw as base vertex
+        virtual uint32_t GetBaseVertex() const = 0;
+
+        // batchSize should be a multiple of the layout stride, one batch must fit in it
+        static Ref<StreamingVertexBuffer> Create(uint32_t batchSize, uint32_t batchesPerRegion = 2, uint32_t regionCount = 3);
+    };
+
     class IndexBuffer
     {
     public:
@@ -125,6 +151,6 @@ namespace HRealEngine
         virtual void Unbind() const = 0;
         virtual uint32_t GetCount() const = 0;
 
-        static Ref<IndexBuffer> Create(uint32_t* indices, uint32_t count);
+        static Ref<IndexBuffer> Create(const uint32_t* indices, uint32_t count);
     };
 }
@@ -1,5 +1,11 @@
 #include "HRpch.h"
 #include "Font.h"
+#include "MSDFData.h"
+
+#include <fstream>
+
+#include "HRealEngine/Core/FileSystem.h"
+#include "HRealEngine/Core/Hash.h"
 
 #undef INFINITE
 #include "msdf-atlas-gen.h"
@@ -8,16 +14,196 @@
 
 namespace HRealEngine
 {
-    struct MSDFData
+    struct CharsetRange
+    {
+        uint32_t Begin, End;
+    };
+
+    // From imgui_draw.cpp
+    static const CharsetRange s_CharsetRanges[] =
     {
-        std::vector<msdf_atlas::GlyphGeometry> Glyphs;
-        msdf_atlas::FontGeometry FontGeometry;
+        { 0x0020, 0x00FF }
+    };
+    static constexpr double s_EmSize = 40.0;
+    static constexpr double s_PixelRange = 2.0;
+    static constexpr double s_MiterLimit = 1.0;
 
+    // Binary atlas cache: header, glyphs, kerning pairs, then the RGB8 atlas. The key covers the font file and every
+    // generation setting above, any change regenerates the atlas.
+    struct AtlasCacheHeader
+    {
+        uint32_t Magic = 0;
+        uint32_t Version = 0;
+        uint64_t Key = 0;
+        uint32_t Width = 0, Height = 0;
+        uint32_t GlyphCount = 0, KerningCount = 0;
+        MSDFFontMetrics Metrics;
+    };
+    struct AtlasCacheGlyph
+    {
+        uint32_t Codepoint = 0;
+        uint32_t Padding = 0;
+        MSDFGlyph Glyph;
+    };
+    struct AtlasCacheKerning
+    {
+        uint64_t Pair = 0;
+        double Advance = 0.0;
     };
+    static constexpr uint32_t s_AtlasCacheMagic = 0x43465248; // "HRFC"
+    static constexpr uint32_t s_AtlasCacheVersion = 1;
+
+    static uint64_t ComputeAtlasCacheKey(const MappedFile& fontFile)
+    {
+        uint64_t key = s_HashBytesSeed;
+        key = HashBytes(key, &s_AtlasCacheVersion, sizeof(s_AtlasCacheVersion));
+        key = HashBytes(key, fontFile.Data(), (size_t)fontFile.Size());
+        key = HashBytes(key, s_CharsetRanges, sizeof(s_CharsetRanges));
+        for (double setting : { s_EmSize, s_PixelRange, s_MiterLimit })
+            key = HashBytes(key, &setting, sizeof(setting));
+        return key;
+    }
+
+    static std::filesystem::path GetAtlasCachePath(const std::filesystem::path& fontPath)
+    {
+        // The path hash keeps fonts with the same file name in different folders apart
+        const std::string pathString = fontPath.generic_string();
+        char suffix[24];
+        snprintf(suffix, sizeof(suffix), "_%016llx", (unsigned long long)HashBytes(s_HashBytesSeed, pathString.data(), pathString.size()));
+        return std::filesystem::path("assets/cache/fonts") / (fontPath.stem().string() + suffix + ".msdfcache");
+    }
+
+    static Ref<Texture2D> CreateAtlasTexture(uint32_t width, uint32_t height, const void* pixels)
+    {
+        TextureSpecification spec;
+        spec.Width = width;
+        spec.Height = height;
+        spec.Format = ImageFormat::RGB8;
+        spec.GenerateMips = false;
+
+        Ref<Texture2D> texture = Texture2D::Create(spec);
+        texture->SetData(Buffer(pixels, (uint64_t)width * height * 3));
+        return texture;
+    }
+
+    // The atlas pixels are uploaded straight out of the mapping, nothing is copied on the way
+    static bool LoadAtlasCache(const std::filesystem::path& cachePath, uint64_t key, MSDFData& outData, Ref<Texture2D>& outAtlas)
+    {
+        MappedFile cacheFile;
+        if (!cacheFile.Open(cachePath))
+            return false;
+
+        const uint8_t* data = cacheFile.Data();
+        const uint64_t size = cacheFile.Size();
+        AtlasCacheHeader header;
+        if (size < sizeof(header))
+            return false;
+        memcpy(&header, data, sizeof(header));
+        if (header.Magic != s_AtlasCacheMagic || header.Version != s_AtlasCacheVersion || header.Key != key)
+            return false;
+
+        const uint64_t glyphsOffset = sizeof(AtlasCacheHeader);
+        const uint64_t kerningOffset = glyphsOffset + (uint64_t)header.GlyphCount * sizeof(AtlasCacheGlyph);
+        const uint64_t pixelsOffset = kerningOffset + (uint64_t)header.KerningCount * sizeof(AtlasCacheKerning);
+        if (size != pixelsOffset + (uint64_t)header.Width * header.Height * 3)
+        {
+            LOG_CORE_WARN("Font atlas cache '{}' is truncated, regenerating", cachePath.string());
+            return false;
+        }
+
+        outData.Metrics = header.Metrics;
+        outData.Glyphs.reserve(header.GlyphCount);
+        for (uint32_t i = 0; i < header.GlyphCount; i++)
+        {
+            AtlasCacheGlyph glyph;
+            memcpy(&glyph, data + glyphsOffset + i * sizeof(AtlasCacheGlyph), sizeof(glyph));
+            outData.Glyphs[glyph.Codepoint] = glyph.Glyph;
+        }
+        outData.Kerning.reserve(header.KerningCount);
+        for (uint32_t i = 0; i < header.KerningCount; i++)
+        {
+            AtlasCacheKerning kerning;
+            memcpy(&kerning, data + kerningOffset + i * sizeof(AtlasCacheKerning), sizeof(kerning));
+            outData.Kerning[kerning.Pair] = kerning.Advance;
+        }
+
+        outAtlas = CreateAtlasTexture(header.Width, header.Height, data + pixelsOffset);
+        return true;
+    }
+
+    static void SaveAtlasCache(const std::filesystem::path& cachePath, uint64_t key, const MSDFData& data, uint32_t width, uint32_t height, const void* pixels)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(cachePath.parent_path(), error);
+        std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            LOG_CORE_WARN("Could not write font atlas cache '{}'", cachePath.string());
+            return;
+        }
+
+        AtlasCacheHeader header;
+        header.Magic = s_AtlasCacheMagic;
+        header.Version = s_AtlasCacheVersion;
+        header.Key = key;
+        header.Width = width;
+        header.Height = height;
+        header.GlyphCount = (uint32_t)data.Glyphs.size();
+        header.KerningCount = (uint32_t)data.Kerning.size();
+        header.Metrics = data.Metrics;
+        out.write((const char*)&header, sizeof(header));
+
+        for (const auto& [codepoint, glyph] : data.Glyphs)
+        {
+            AtlasCacheGlyph entry;
+            entry.Codepoint = codepoint;
+            entry.Glyph = glyph;
+            out.write((const char*)&entry, sizeof(entry));
+        }
+        for (const auto& [pair, advance] : data.Kerning)
+        {
+            AtlasCacheKerning entry;
+            entry.Pair = pair;
+            entry.Advance = advance;
+            out.write((const char*)&entry, sizeof(entry));
+        }
+        out.write((const char*)pixels, (std::streamsize)width * height * 3);
+    }
+
+    // Copies what text layout needs out of the msdf-atlas-gen geometry, kerning is keyed by codepoint instead of glyph index
+    static void ExtractGlyphMetrics(const std::vector<msdf_atlas::GlyphGeometry>& glyphs, const msdf_atlas::FontGeometry& fontGeometry, MSDFData& outData)
+    {
+        const msdfgen::FontMetrics& metrics = fontGeometry.getMetrics();
+        outData.Metrics.EmSize = metrics.emSize;
+        outData.Metrics.AscenderY = metrics.ascenderY;
+        outData.Metrics.DescenderY = metrics.descenderY;
+        outData.Metrics.LineHeight = metrics.lineHeight;
+        outData.Metrics.UnderlineY = metrics.underlineY;
+        outData.Metrics.UnderlineThickness = metrics.underlineThickness;
+
+        std::unordered_map<int, uint32_t> indexToCodepoint;
+        outData.Glyphs.reserve(glyphs.size());
+        for (const msdf_atlas::GlyphGeometry& glyph : glyphs)
+        {
+            MSDFGlyph& out = outData.Glyphs[(uint32_t)glyph.getCodepoint()];
+            out.Advance = glyph.getAdvance();
+            glyph.getQuadPlaneBounds(out.PlaneLeft, out.PlaneBottom, out.PlaneRight, out.PlaneTop);
+            glyph.getQuadAtlasBounds(out.AtlasLeft, out.AtlasBottom, out.AtlasRight, out.AtlasTop);
+            indexToCodepoint[glyph.getIndex()] = (uint32_t)glyph.getCodepoint();
+        }
+
+        for (const auto& [indexPair, advance] : fontGeometry.getKerning())
+        {
+            auto first = indexToCodepoint.find(indexPair.first);
+            auto second = indexToCodepoint.find(indexPair.second);
+            if (first != indexToCodepoint.end() && second != indexToCodepoint.end())
+                outData.Kerning[((uint64_t)first->second << 32) | second->second] = advance;
+        }
+    }
 	
     template<typename T, typename S, int N, msdf_atlas::GeneratorFunction<S, N> GenFunc>
-    static Ref<Texture2D> CreateAndCacheAtlas(const std::string& fontName, float fontSize, const std::vector<msdf_atlas::GlyphGeometry>& glyphs,
-        const msdf_atlas::FontGeometry& fontGeometry, uint32_t width, uint32_t height)
+    static Ref<Texture2D> CreateAndCacheAtlas(const std::filesystem::path& cachePath, uint64_t cacheKey, const MSDFData& data,
+        const std::vector<msdf_atlas::GlyphGeometry>& glyphs, uint32_t width, uint32_t height)
     {
         msdf_atlas::GeneratorAttributes attributes;
         attributes.config.overlapSupport = true;
@@ -29,25 +215,29 @@ namespace HRealEngine
         generator.generate(glyphs.data(), (int)glyphs.size());
 
         msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>)generator.atlasStorage();
-
-        TextureSpecification spec;
-        spec.Width = bitmap.width;
-        spec.Height = bitmap.height;
-        spec.Format = ImageFormat::RGB8;
-        spec.GenerateMips = false;
-
-        Ref<Texture2D> texture = Texture2D::Create(spec);
-        texture->SetData({(void*)bitmap.pixels, (uint64_t)bitmap.width * bitmap.height * 3});
-        return texture;
+        SaveAtlasCache(cachePath, cacheKey, data, bitmap.width, bitmap.height, bitmap.pixels);
+        return CreateAtlasTexture(bitmap.width, bitmap.height, bitmap.pixels);
     }
     
     Font::Font(const std::filesystem::path& fontPath) : m_Data(new MSDFData())
     {
+        std::string fileString = fontPath.string();
+
+        MappedFile fontFile;
+        if (!fontFile.Open(fontPath))
+        {
+            LOG_CORE_ERROR("Failed to load font: {}", fileString);
+            return;
+        }
+        const uint64_t cacheKey = ComputeAtlasCacheKey(fontFile);
+        const std::filesystem::path cachePath = GetAtlasCachePath(fontPath);
+        if (LoadAtlasCache(cachePath, cacheKey, *m_Data, m_AtlasTexture))
+            return;
+        fontFile.Close();
+
         msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype();
 
         HREALENGINE_CORE_DEBUGBREAK(!ft, "Failed to initialize FreeType library!");
-
-        std::string fileString = fontPath.string();
         
         msdfgen::FontHandle* font = msdfgen::loadFont(ft, fileString.c_str());
         if (!font)
@@ -56,39 +246,30 @@ namespace HRealEngine
             return;
         }
 
-        struct CharsetRange
-        {
-            uint32_t Begin, End;
-        };
-
-        // From imgui_draw.cpp
-        static const CharsetRange charsetRanges[] =
-        {
-            { 0x0020, 0x00FF }
-        };
-
         msdf_atlas::Charset charset;
-        for (CharsetRange range : charsetRanges)
+        for (CharsetRange range : s_CharsetRanges)
         {
             for (uint32_t c = range.Begin; c <= range.End; c++)
                 charset.add(c);
         }
-		
+
+        // Only needed while generating, text layout reads the extracted metrics in m_Data
+        std::vector<msdf_atlas::GlyphGeometry> glyphs;
         double fontScale = 1.0;
-        m_Data->FontGeometry = msdf_atlas::FontGeometry(&m_Data->Glyphs);
-        int glyphsLoaded = m_Data->FontGeometry.loadCharset(font, fontScale, charset);
+        msdf_atlas::FontGeometry fontGeometry(&glyphs);
+        int glyphsLoaded = fontGeometry.loadCharset(font, fontScale, charset);
         LOG_CORE_INFO("Loaded {} glyphs from font (out of {})", glyphsLoaded, charset.size());
 
 
-        double emSize = 40.0;
+        double emSize = s_EmSize;
 
         msdf_atlas::TightAtlasPacker atlasPacker;
         // atlasPacker.setDimensionsConstraint()
-        atlasPacker.setPixelRange(2.0);
-        atlasPacker.setMiterLimit(1.0);
+        atlasPacker.setPixelRange(s_PixelRange);
+        atlasPacker.setMiterLimit(s_MiterLimit);
         atlasPacker.setPadding(0);
         atlasPacker.setScale(emSize);
-        int remaining = atlasPacker.pack(m_Data->Glyphs.data(), (int)m_Data->Glyphs.size());
+        int remaining = atlasPacker.pack(glyphs.data(), (int)glyphs.size());
         HREALENGINE_CORE_DEBUGBREAK(remaining == 0);
 
         int width, height;
@@ -105,22 +286,23 @@ namespace HRealEngine
         bool expensiveColoring = false;
         if (expensiveColoring)
         {
-            msdf_atlas::Workload([&glyphs = m_Data->Glyphs, &coloringSeed](int i, int threadNo) -> bool {
+            msdf_atlas::Workload([&glyphs, &coloringSeed](int i, int threadNo) -> bool {
                 unsigned long long glyphSeed = (LCG_MULTIPLIER * (coloringSeed ^ i) + LCG_INCREMENT) * !!coloringSeed;
                 glyphs[i].edgeColoring(msdfgen::edgeColoringInkTrap, DEFAULT_ANGLE_THRESHOLD, glyphSeed);
                 return true;
-                }, static_cast<int>(m_Data->Glyphs.size())).finish(THREAD_COUNT);
+                }, static_cast<int>(glyphs.size())).finish(THREAD_COUNT);
         }
         else {
             unsigned long long glyphSeed = coloringSeed;
-            for (msdf_atlas::GlyphGeometry& glyph : m_Data->Glyphs)
+            for (msdf_atlas::GlyphGeometry& glyph : glyphs)
             {
                 glyphSeed *= LCG_MULTIPLIER;
                 glyph.edgeColoring(msdfgen::edgeColoringInkTrap, DEFAULT_ANGLE_THRESHOLD, glyphSeed);
             }
         }
         
-        m_AtlasTexture = CreateAndCacheAtlas<uint8_t, float, 3, msdf_atlas::msdfGenerator>("Test", (float)emSize, m_Data->Glyphs, m_Data->FontGeometry, width, height);
+        ExtractGlyphMetrics(glyphs, fontGeometry, *m_Data);
+        m_AtlasTexture = CreateAndCacheAtlas<uint8_t, float, 3, msdf_atlas::msdfGenerator>(cachePath, cacheKey, *m_Data, glyphs, width, height);
 
 
 #if 0
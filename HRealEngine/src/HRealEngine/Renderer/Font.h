@@ -1,5 +1,7 @@
 #pragma once
 #include <filesystem>
+#include <string>
+#include <vector>
 
 #include "Texture.h"
 
@@ -21,4 +23,25 @@ namespace HRealEngine
         MSDFData* m_Data;
         Ref<Texture2D> m_AtlasTexture;
     };
+
+    // Glyph quads of one string in text space (atlas UVs already normalized), rebuilt only when the inputs below change
+    struct TextLayout
+    {
+        struct Glyph
+        {
+            glm::vec2 QuadMin, QuadMax;
+            glm::vec2 TexCoordMin, TexCoordMax;
+        };
+        std::vector<Glyph> Glyphs;
+
+        std::string Text;
+        Ref<Font> FontAsset;
+        float Kerning = 0.0f;
+        float LineSpacing = 0.0f;
+
+        bool IsValidFor(const std::string& text, const Ref<Font>& font, float kerning, float lineSpacing) const
+        {
+            return FontAsset == font && Kerning == kerning && LineSpacing == lineSpacing && Text == text;
+        }
+    };
 }
@@ -47,7 +47,14 @@ namespace HRealEngine
         virtual void Unbind() = 0;
 
         virtual void Resize(uint32_t width, uint32_t height) = 0;
+        // Synchronous, waits for the GPU to finish everything queued so far
         virtual int ReadPixel(uint32_t attachmentIndex, int x, int y) = 0;
+        // Queues a copy of a region of a color attachment without waiting (call while bound). Returns a ticket for TryGetReadback,
+        // when every readback slot is in flight the oldest request is dropped
+        virtual uint64_t RequestReadback(uint32_t attachmentIndex, int x, int y, uint32_t width, uint32_t height) = 0;
+        // Never blocks: false while the copy is still running or when the ticket was dropped. Results usually arrive one or two
+        // frames later, outData receives width * height pixels of 4 bytes (int for integer attachments, RGBA8 otherwise)
+        virtual bool TryGetReadback(uint64_t ticket, std::vector<uint8_t>& outData) = 0;
 
         virtual void ClearAttachment(uint32_t attachmentIndex, int value) = 0;
         
@@ -0,0 +1,171 @@
+#include "HRpch.h"
+#include "LightClusterGrid.h"
+
+namespace HRealEngine
+{
+    void LightClusterGrid::RebuildClusterBounds(const glm::mat4& projection)
+    {
+        m_CachedProjection = projection;
+        m_bLogDepth = projection[3][3] == 0.0f;
+        if (m_bLogDepth)
+        {
+            m_Near = projection[3][2] / (projection[2][2] - 1.0f);
+            m_Far = projection[3][2] / (projection[2][2] + 1.0f);
+        }
+        else
+        {
+            m_Near = (projection[3][2] + 1.0f) / projection[2][2];
+            m_Far = (projection[3][2] - 1.0f) / projection[2][2];
+        }
+        // Log slices keep clusters roughly cube shaped in perspective, ortho cameras use linear slices
+        if (m_bLogDepth)
+        {
+            m_Near = glm::max(m_Near, 0.0001f);
+            const float logRange = glm::log(m_Far / m_Near);
+            m_DepthScale = (float)Slices / logRange;
+            m_DepthBias = -(float)Slices * glm::log(m_Near) / logRange;
+        }
+        else
+        {
+            m_DepthScale = (float)Slices / glm::max(m_Far - m_Near, 0.0001f);
+            m_DepthBias = -m_Near * m_DepthScale;
+        }
+
+        auto sliceDepth = [&](uint32_t slice)
+        {
+            const float t = (float)slice / (float)Slices;
+            return m_bLogDepth ? m_Near * glm::pow(m_Far / m_Near, t) : m_Near + (m_Far - m_Near) * t;
+        };
+
+        m_ClusterMin.resize(ClusterCount);
+        m_ClusterMax.resize(ClusterCount);
+        const glm::mat4 invProjection = glm::inverse(projection);
+        for (uint32_t y = 0; y < TilesY; y++)
+            for (uint32_t x = 0; x < TilesX; x++)
+            {
+                // The four tile edges as view space lines between the near and far plane
+                glm::vec3 lineNear[4], lineFar[4];
+                for (int c = 0; c < 4; c++)
+                {
+                    const float ndcX = -1.0f + 2.0f * (float)(x + (c & 1)) / (float)TilesX;
+                    const float ndcY = -1.0f + 2.0f * (float)(y + (c >> 1)) / (float)TilesY;
+                    glm::vec4 n = invProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+                    glm::vec4 f = invProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+                    lineNear[c] = glm::vec3(n) / n.w;
+                    lineFar[c] = glm::vec3(f) / f.w;
+                }
+                for (uint32_t slice = 0; slice < Slices; slice++)
+                {
+                    const float depths[2] = { sliceDepth(slice), sliceDepth(slice + 1) };
+                    glm::vec3 minP(std::numeric_limits<float>::max());
+                    glm::vec3 maxP(std::numeric_limits<float>::lowest());
+                    for (int c = 0; c < 4; c++)
+                        for (float depth : depths)
+                        {
+                            const glm::vec3 edge = lineFar[c] - lineNear[c];
+                            const float t = glm::abs(edge.z) > 0.000001f ? (-depth - lineNear[c].z) / edge.z : 0.0f;
+                            const glm::vec3 p = lineNear[c] + edge * t;
+                            minP = glm::min(minP, p);
+                            maxP = glm::max(maxP, p);
+                        }
+                    const uint32_t index = GetClusterIndex(x, y, slice);
+                    m_ClusterMin[index] = minP;
+                    m_ClusterMax[index] = maxP;
+                }
+            }
+    }
+
+    uint32_t LightClusterGrid::GetSlice(float viewDepth) const
+    {
+        const float z = m_bLogDepth ? glm::log(glm::max(viewDepth, m_Near)) : viewDepth;
+        return (uint32_t)glm::clamp(z * m_DepthScale + m_DepthBias, 0.0f, (float)(Slices - 1));
+    }
+
+    void LightClusterGrid::Build(const glm::mat4& view, const glm::mat4& projection, const std::vector<glm::vec4>& lightSpheres)
+    {
+        if (projection != m_CachedProjection)
+            RebuildClusterBounds(projection);
+
+        m_Assignments.clear();
+        m_LightIndices.clear();
+        m_GlobalLightCount = 0;
+        for (uint32_t i = 0; i < (uint32_t)lightSpheres.size(); i++)
+        {
+            const glm::vec4& sphere = lightSpheres[i];
+            if (sphere.w <= 0.0f)
+            {
+                m_LightIndices.push_back(i);
+                m_GlobalLightCount++;
+                continue;
+            }
+
+            const glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(sphere), 1.0f));
+            const float radius = sphere.w;
+            const float minDepth = -center.z - radius;
+            const float maxDepth = -center.z + radius;
+            if (maxDepth < m_Near || minDepth > m_Far)
+                continue;
+
+            const uint32_t firstSlice = GetSlice(minDepth);
+            const uint32_t lastSlice = GetSlice(maxDepth);
+
+            // Narrow the tile range with the projected sphere bounds when the sphere is fully in front of the camera
+            uint32_t firstX = 0, lastX = TilesX - 1, firstY = 0, lastY = TilesY - 1;
+            if (minDepth > m_Near)
+            {
+                glm::vec2 ndcMin(1.0f), ndcMax(-1.0f);
+                for (int c = 0; c < 8; c++)
+                {
+                    const glm::vec3 corner = center + glm::vec3((c & 1) ? radius : -radius, (c & 2) ? radius : -radius, (c & 4) ? radius : -radius);
+                    const glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+                    const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                    ndcMin = glm::min(ndcMin, ndc);
+                    ndcMax = glm::max(ndcMax, ndc);
+                }
+                if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+                    continue;
+                auto toTile = [](float ndc, uint32_t tiles)
+                {
+                    return (uint32_t)glm::clamp((ndc * 0.5f + 0.5f) * (float)tiles, 0.0f, (float)(tiles - 1));
+                };
+                firstX = toTile(ndcMin.x, TilesX);
+                lastX = toTile(ndcMax.x, TilesX);
+                firstY = toTile(ndcMin.y, TilesY);
+                lastY = toTile(ndcMax.y, TilesY);
+            }
+
+            const float radiusSq = radius * radius;
+            for (uint32_t slice = firstSlice; slice <= lastSlice; slice++)
+                for (uint32_t y = firstY; y <= lastY; y++)
+                    for (uint32_t x = firstX; x <= lastX; x++)
+                    {
+                        const uint32_t index = GetClusterIndex(x, y, slice);
+                        const glm::vec3 closest = glm::clamp(center, m_ClusterMin[index], m_ClusterMax[index]);
+                        const glm::vec3 d = closest - center;
+                        if (glm::dot(d, d) <= radiusSq)
+                            m_Assignments.emplace_back(index, i);
+                    }
+        }
+
+        // Counting sort of the assignments by cluster gives every cluster a contiguous run in the index list
+        m_Clusters.assign(ClusterCount, ClusterRange{});
+        for (const auto& [cluster, light] : m_Assignments)
+            m_Clusters[cluster].Count++;
+
+        uint32_t offset = (uint32_t)m_LightIndices.size();
+        m_MaxLightsPerCluster = 0;
+        for (ClusterRange& range : m_Clusters)
+        {
+            range.Offset = offset;
+            offset += range.Count;
+            m_MaxLightsPerCluster = std::max(m_MaxLightsPerCluster, range.Count);
+            range.Count = 0;
+        }
+        m_LightIndices.resize(offset);
+        for (const auto& [cluster, light] : m_Assignments)
+        {
+            ClusterRange& range = m_Clusters[cluster];
+            m_LightIndices[range.Offset + range.Count++] = light;
+        }
+    }
+}
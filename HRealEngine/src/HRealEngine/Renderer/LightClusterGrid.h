@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace HRealEngine
+{
+    // Assigns lights to a view space froxel grid (screen tiles x depth slices) on the CPU.
+    // Pure math without any GPU state, the renderer uploads the results to storage buffers.
+    class LightClusterGrid
+    {
+    public:
+        static constexpr uint32_t TilesX = 16;
+        static constexpr uint32_t TilesY = 9;
+        static constexpr uint32_t Slices = 24;
+        static constexpr uint32_t ClusterCount = TilesX * TilesY * Slices;
+
+        // Offset into the light index list and number of lights for one cluster, mirrored by uvec2 in the shaders
+        struct ClusterRange
+        {
+            uint32_t Offset = 0;
+            uint32_t Count = 0;
+        };
+
+        // lightSpheres: xyz world position, w radius. A radius <= 0 marks a light that reaches every cluster (directional, unbounded)
+        void Build(const glm::mat4& view, const glm::mat4& projection, const std::vector<glm::vec4>& lightSpheres);
+
+        static uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t slice) { return (slice * TilesY + y) * TilesX + x; }
+        // Slice for a positive view depth, matches the lookup in the lit shaders
+        uint32_t GetSlice(float viewDepth) const;
+
+        const std::vector<ClusterRange>& GetClusters() const { return m_Clusters; }
+        // Global lights come first, followed by the per cluster lists
+        const std::vector<uint32_t>& GetLightIndices() const { return m_LightIndices; }
+        uint32_t GetGlobalLightCount() const { return m_GlobalLightCount; }
+        uint32_t GetMaxLightsPerCluster() const { return m_MaxLightsPerCluster; }
+
+        // slice = (bLogDepth ? log(depth) : depth) * scale + bias
+        float GetDepthScale() const { return m_DepthScale; }
+        float GetDepthBias() const { return m_DepthBias; }
+        bool IsLogDepth() const { return m_bLogDepth; }
+    private:
+        void RebuildClusterBounds(const glm::mat4& projection);
+
+        glm::mat4 m_CachedProjection = glm::mat4(0.0f);
+        std::vector<glm::vec3> m_ClusterMin;
+        std::vector<glm::vec3> m_ClusterMax;
+        float m_Near = 0.1f;
+        float m_Far = 1000.0f;
+        float m_DepthScale = 1.0f;
+        float m_DepthBias = 0.0f;
+        bool m_bLogDepth = true;
+
+        std::vector<ClusterRange> m_Clusters;
+        std::vector<uint32_t> m_LightIndices;
+        std::vector<std::pair<uint32_t, uint32_t>> m_Assignments; // (cluster, light), reused between builds
+        uint32_t m_GlobalLightCount = 0;
+        uint32_t m_MaxLightsPerCluster = 0;
+    };
+}
@@ -1,14 +1,49 @@
 #pragma once
-#include <vector>
-
-#undef INFINITE
-#include "msdf-atlas-gen.h"
+#include <cstdint>
+#include <unordered_map>
 
 namespace HRealEngine
 {
+    // Glyph metrics copied out of msdf-atlas-gen, a font loaded from the atlas cache never touches FreeType
+    struct MSDFGlyph
+    {
+        double Advance = 0.0;
+        double PlaneLeft = 0.0, PlaneBottom = 0.0, PlaneRight = 0.0, PlaneTop = 0.0; // quad in em units
+        double AtlasLeft = 0.0, AtlasBottom = 0.0, AtlasRight = 0.0, AtlasTop = 0.0; // quad in atlas pixels
+    };
+
+    struct MSDFFontMetrics
+    {
+        double EmSize = 0.0;
+        double AscenderY = 0.0, DescenderY = 0.0;
+        double LineHeight = 0.0;
+        double UnderlineY = 0.0, UnderlineThickness = 0.0;
+    };
+
     struct MSDFData
     {
-        std::vector<msdf_atlas::GlyphGeometry> Glyphs;
-        msdf_atlas::FontGeometry FontGeometry;
+        MSDFFontMetrics Metrics;
+        std::unordered_map<uint32_t, MSDFGlyph> Glyphs; // by codepoint
+        std::unordered_map<uint64_t, double> Kerning; // (first << 32 | second) -> advance adjustment, only pairs that have one
+
+        const MSDFGlyph* GetGlyph(uint32_t codepoint) const
+        {
+            auto it = Glyphs.find(codepoint);
+            return it != Glyphs.end() ? &it->second : nullptr;
+        }
+
+        // Advance from first to second including kerning, false when first has no glyph
+        bool GetAdvance(double& advance, uint32_t first, uint32_t second) const
+        {
+            const MSDFGlyph* glyph = GetGlyph(first);
+            if (!glyph)
+                return false;
+
+            advance = glyph->Advance;
+            auto it = Kerning.find(((uint64_t)first << 32) | second);
+            if (it != Kerning.end())
+                advance += it->second;
+            return true;
+        }
     };
 }
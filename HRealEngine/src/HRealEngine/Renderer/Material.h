@@ -25,56 +25,41 @@ namespace HRealEngine
         mutable Ref<Texture2D> SpecularTextureCache = nullptr;
         mutable Ref<Texture2D> NormalTextureCache   = nullptr;
 
-        void Apply(const Ref<Shader>& shader) const
+        // Selects the shader variant for the textures this material has together with the pass keywords, binds it and
+        // uploads the material. Missing textures are compiled out instead of branched on per pixel.
+        void Apply(const Ref<Shader>& shader, uint64_t passKeywords = ShaderKeyword::None) const
         {
+            const bool hasAlbedo = ResolveTexture(AlbedoTextureHandle, AlbedoTextureCache);
+            const bool hasSpec = ResolveTexture(SpecularTextureHandle, SpecularTextureCache);
+            const bool hasNormal = ResolveTexture(NormalTextureHandle, NormalTextureCache);
+
+            uint64_t keywords = passKeywords;
+            if (hasAlbedo)
+                keywords |= ShaderKeyword::Albedo;
+            if (hasSpec)
+                keywords |= ShaderKeyword::Specular;
+            if (hasNormal)
+                keywords |= ShaderKeyword::Normal;
+            shader->SetKeywords(keywords);
+            shader->Bind();
+
             shader->SetFloat4("u_Color", Color);
             shader->SetFloat("u_Shininess", Shininess);
-            
-            bool hasAlbedo = false;
-            if (AlbedoTextureHandle != 0 && AssetManager::IsAssetHandleValid(AlbedoTextureHandle))
+            if (hasAlbedo)
             {
-                if (!AlbedoTextureCache || !AlbedoTextureCache->IsLoaded())
-                    AlbedoTextureCache = AssetManager::GetAsset<Texture2D>(AlbedoTextureHandle);
-
-                if (AlbedoTextureCache && AlbedoTextureCache->IsLoaded())
-                {
-                    AlbedoTextureCache->Bind(0);
-                    shader->SetInt("u_Albedo", 0);
-                    hasAlbedo = true;
-                }
+                AlbedoTextureCache->Bind(0);
+                shader->SetInt("u_Albedo", 0);
             }
-            shader->SetInt("u_HasAlbedo", hasAlbedo ? 1 : 0);
-            
-            bool hasSpec = false;
-            if (SpecularTextureHandle != 0 && AssetManager::IsAssetHandleValid(SpecularTextureHandle))
+            if (hasSpec)
             {
-                if (!SpecularTextureCache || !SpecularTextureCache->IsLoaded())
-                    SpecularTextureCache = AssetManager::GetAsset<Texture2D>(SpecularTextureHandle);
-
-                if (SpecularTextureCache && SpecularTextureCache->IsLoaded())
-                {
-                    SpecularTextureCache->Bind(1);
-                    shader->SetInt("u_Specular", 1);
-                    hasSpec = true;
-                }
+                SpecularTextureCache->Bind(1);
+                shader->SetInt("u_Specular", 1);
             }
-            shader->SetInt("u_HasSpecular", hasSpec ? 1 : 0);
-
-            bool hasNormal = false;
-            if (NormalTextureHandle != 0 && AssetManager::IsAssetHandleValid(NormalTextureHandle))
+            if (hasNormal)
             {
-                if (!NormalTextureCache || !NormalTextureCache->IsLoaded())
-                    NormalTextureCache = AssetManager::GetAsset<Texture2D>(NormalTextureHandle);
-
-                if (NormalTextureCache && NormalTextureCache->IsLoaded())
-                {
-                    NormalTextureCache->Bind(2);
-                    shader->SetInt("u_Normal", 2);
-                    hasNormal = true;
-                }
+                NormalTextureCache->Bind(2);
+                shader->SetInt("u_Normal", 2);
             }
-            shader->SetInt("u_HasNormal", hasNormal ? 1 : 0);
-
         }
 
         static AssetType GetStaticType() { return AssetType::Material; }
@@ -82,6 +67,16 @@ namespace HRealEngine
 
         void SaveToFile();
         void LoadFromFile();
+    private:
+        static bool ResolveTexture(AssetHandle handle, Ref<Texture2D>& cache)
+        {
+            if (handle == 0 || !AssetManager::IsAssetHandleValid(handle))
+                return false;
+
+            if (!cache || !cache->IsLoaded())
+                cache = AssetManager::GetAsset<Texture2D>(handle);
+            return cache && cache->IsLoaded();
+        }
     };
 
     class MaterialLibrary
@@ -0,0 +1,241 @@
+#include "HRpch.h"
+#include "OcclusionCuller.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define HREALENGINE_OCCLUSION_SSE 1
+#endif
+
+namespace HRealEngine
+{
+    // Triangles and boxes reaching behind this clip w are not projected, they would wrap around the camera
+    static constexpr float s_MinClipW = 0.0001f;
+
+    OcclusionCuller::OcclusionCuller()
+    {
+        uint32_t width = Width, height = Height;
+        while (true)
+        {
+            m_Levels.push_back({ width, height, std::vector<float>((size_t)width * height, 1.0f) });
+            if (width == 1 && height == 1)
+                break;
+            width = std::max(1u, width / 2);
+            height = std::max(1u, height / 2);
+        }
+    }
+
+    void OcclusionCuller::Begin(const glm::mat4& viewProjection)
+    {
+        m_ViewProjection = viewProjection;
+        std::fill(m_Levels[0].Depth.begin(), m_Levels[0].Depth.end(), 1.0f);
+        m_bHasOccluders = false;
+        m_bHiZDirty = false;
+    }
+
+    void OcclusionCuller::RasterizeOccluder(const glm::mat4& transform, const glm::vec3* positions, const uint32_t* indices, size_t indexCount)
+    {
+        if (indexCount < 3)
+            return;
+
+        const glm::mat4 mvp = m_ViewProjection * transform;
+        uint32_t maxIndex = 0;
+        for (size_t i = 0; i < indexCount; i++)
+            maxIndex = std::max(maxIndex, indices[i]);
+        m_ClipPositions.resize((size_t)maxIndex + 1);
+        for (uint32_t i = 0; i <= maxIndex; i++)
+            m_ClipPositions[i] = mvp * glm::vec4(positions[i], 1.0f);
+
+        auto toScreen = [](const glm::vec4& clip)
+        {
+            const float invW = 1.0f / clip.w;
+            return glm::vec3((clip.x * invW * 0.5f + 0.5f) * (float)Width, (clip.y * invW * 0.5f + 0.5f) * (float)Height, clip.z * invW);
+        };
+
+        for (size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            const glm::vec4& c0 = m_ClipPositions[indices[i]];
+            const glm::vec4& c1 = m_ClipPositions[indices[i + 1]];
+            const glm::vec4& c2 = m_ClipPositions[indices[i + 2]];
+            // Skipping near plane crossers only loses occlusion, it never hides something visible
+            if (c0.w < s_MinClipW || c1.w < s_MinClipW || c2.w < s_MinClipW)
+                continue;
+            if ((c0.x > c0.w && c1.x > c1.w && c2.x > c2.w) || (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) ||
+                (c0.y > c0.w && c1.y > c1.w && c2.y > c2.w) || (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w) ||
+                (c0.z > c0.w && c1.z > c1.w && c2.z > c2.w))
+                continue;
+
+            RasterizeTriangle(toScreen(c0), toScreen(c1), toScreen(c2));
+        }
+        m_bHasOccluders = true;
+        m_bHiZDirty = true;
+    }
+
+    void OcclusionCuller::RasterizeTriangle(const glm::vec3& v0, const glm::vec3& inV1, const glm::vec3& inV2)
+    {
+        glm::vec3 v1 = inV1, v2 = inV2;
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+        if (glm::abs(area) < 0.00001f)
+            return;
+        // Occluders are drawn double sided, flipping makes every edge function positive inside
+        if (area < 0.0f)
+        {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        const int minX = std::max(0, (int)glm::floor(glm::min(v0.x, glm::min(v1.x, v2.x))));
+        const int maxX = std::min((int)Width - 1, (int)glm::ceil(glm::max(v0.x, glm::max(v1.x, v2.x))));
+        const int minY = std::max(0, (int)glm::floor(glm::min(v0.y, glm::min(v1.y, v2.y))));
+        const int maxY = std::min((int)Height - 1, (int)glm::ceil(glm::max(v0.y, glm::max(v1.y, v2.y))));
+        if (minX > maxX || minY > maxY)
+            return;
+
+        // Edge functions E(x, y) = A * x + B * y + C, each one is the barycentric weight of the opposite vertex times area
+        const float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v2.x * v1.y;
+        const float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v0.x * v2.y;
+        const float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v1.x * v0.y;
+        const float invArea = 1.0f / area;
+        const float za = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * invArea;
+        const float zb = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * invArea;
+        const float zc = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * invArea;
+
+        float* depth = m_Levels[0].Depth.data();
+        const int startX = minX & ~3;
+#ifdef HREALENGINE_OCCLUSION_SSE
+        const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 a0v = _mm_set1_ps(a0), a1v = _mm_set1_ps(a1), a2v = _mm_set1_ps(a2), zav = _mm_set1_ps(za);
+        for (int y = minY; y <= maxY; y++)
+        {
+            const float py = (float)y + 0.5f;
+            const __m128 row0 = _mm_set1_ps(b0 * py + c0);
+            const __m128 row1 = _mm_set1_ps(b1 * py + c1);
+            const __m128 row2 = _mm_set1_ps(b2 * py + c2);
+            const __m128 rowZ = _mm_set1_ps(zb * py + zc);
+            float* row = depth + (size_t)y * Width;
+            // Width is a multiple of four so a group starting at or before maxX never runs past the row
+            for (int x = startX; x <= maxX; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+                const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0v, px), row0);
+                const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1v, px), row1);
+                const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2v, px), row2);
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                const __m128 z = _mm_add_ps(_mm_mul_ps(zav, px), rowZ);
+                const __m128 old = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_min_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+        }
+#else
+        for (int y = minY; y <= maxY; y++)
+        {
+            const float py = (float)y + 0.5f;
+            float* row = depth + (size_t)y * Width;
+            for (int x = startX; x <= maxX; x++)
+            {
+                const float px = (float)x + 0.5f;
+                if (a0 * px + b0 * py + c0 < 0.0f || a1 * px + b1 * py + c1 < 0.0f || a2 * px + b2 * py + c2 < 0.0f)
+                    continue;
+                row[x] = std::min(row[x], za * px + zb * py + zc);
+            }
+        }
+#endif
+    }
+
+    void OcclusionCuller::BuildHiZ()
+    {
+        // Every texel keeps the farthest depth below it, so a box nearer than that is in front of everything it covers
+        for (size_t level = 1; level < m_Levels.size(); level++)
+        {
+            const HiZLevel& src = m_Levels[level - 1];
+            HiZLevel& dst = m_Levels[level];
+            for (uint32_t y = 0; y < dst.Height; y++)
+            {
+                const uint32_t sy0 = std::min(y * 2, src.Height - 1);
+                const uint32_t sy1 = std::min(y * 2 + 1, src.Height - 1);
+                for (uint32_t x = 0; x < dst.Width; x++)
+                {
+                    const uint32_t sx0 = std::min(x * 2, src.Width - 1);
+                    const uint32_t sx1 = std::min(x * 2 + 1, src.Width - 1);
+                    dst.Depth[(size_t)y * dst.Width + x] = std::max(
+                        std::max(src.Depth[(size_t)sy0 * src.Width + sx0], src.Depth[(size_t)sy0 * src.Width + sx1]),
+                        std::max(src.Depth[(size_t)sy1 * src.Width + sx0], src.Depth[(size_t)sy1 * src.Width + sx1]));
+                }
+            }
+        }
+        m_bHiZDirty = false;
+    }
+
+    float OcclusionCuller::GetDepth(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        const HiZLevel& l = m_Levels[std::min<size_t>(level, m_Levels.size() - 1)];
+        return l.Depth[(size_t)std::min(y, l.Height - 1) * l.Width + std::min(x, l.Width - 1)];
+    }
+
+    bool OcclusionCuller::IsVisible(const glm::mat4& transform, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        const glm::mat4 mvp = m_ViewProjection * transform;
+        glm::vec4 clip[8];
+        uint32_t outsideMask = 0x3F;// a bit stays set only if every corner is outside that plane
+        bool bCrossesCamera = false;
+        for (int i = 0; i < 8; i++)
+        {
+            const glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+            clip[i] = mvp * glm::vec4(corner, 1.0f);
+            const glm::vec4& c = clip[i];
+            uint32_t outside = 0;
+            if (c.x < -c.w) outside |= 1;
+            if (c.x > c.w)  outside |= 2;
+            if (c.y < -c.w) outside |= 4;
+            if (c.y > c.w)  outside |= 8;
+            if (c.z < -c.w) outside |= 16;
+            if (c.z > c.w)  outside |= 32;
+            outsideMask &= outside;
+            if (c.w < s_MinClipW)
+                bCrossesCamera = true;
+        }
+        if (outsideMask != 0)
+            return false;
+        if (bCrossesCamera || !m_bHasOccluders)
+            return true;
+
+        if (m_bHiZDirty)
+            BuildHiZ();
+
+        glm::vec2 ndcMin(std::numeric_limits<float>::max());
+        glm::vec2 ndcMax(std::numeric_limits<float>::lowest());
+        float nearestZ = std::numeric_limits<float>::max();
+        for (const glm::vec4& c : clip)
+        {
+            const glm::vec3 ndc = glm::vec3(c) / c.w;
+            ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+            ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+            nearestZ = std::min(nearestZ, ndc.z);
+        }
+
+        const int x0 = glm::clamp((int)((ndcMin.x * 0.5f + 0.5f) * (float)Width), 0, (int)Width - 1);
+        const int x1 = glm::clamp((int)((ndcMax.x * 0.5f + 0.5f) * (float)Width), 0, (int)Width - 1);
+        const int y0 = glm::clamp((int)((ndcMin.y * 0.5f + 0.5f) * (float)Height), 0, (int)Height - 1);
+        const int y1 = glm::clamp((int)((ndcMax.y * 0.5f + 0.5f) * (float)Height), 0, (int)Height - 1);
+
+        // Coarsest level where the rectangle still spans at most two texels per axis
+        uint32_t level = 0;
+        uint32_t extent = (uint32_t)std::max(x1 - x0, y1 - y0);
+        while (extent > 1 && level + 1 < m_Levels.size())
+        {
+            extent >>= 1;
+            level++;
+        }
+
+        const HiZLevel& hiZ = m_Levels[level];
+        for (uint32_t y = (uint32_t)y0 >> level; y <= std::min((uint32_t)y1 >> level, hiZ.Height - 1); y++)
+            for (uint32_t x = (uint32_t)x0 >> level; x <= std::min((uint32_t)x1 >> level, hiZ.Width - 1); x++)
+                if (nearestZ <= hiZ.Depth[(size_t)y * hiZ.Width + x])
+                    return true;
+        return false;
+    }
+}
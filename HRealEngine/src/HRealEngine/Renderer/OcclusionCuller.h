@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace HRealEngine
+{
+    // CPU occlusion culling: occluder triangles are rasterized into a small depth buffer, a max depth pyramid (Hi-Z) built
+    // from it is used to reject bounding boxes that are fully behind the occluders. No GPU state, so it also runs headless.
+    class OcclusionCuller
+    {
+    public:
+        static constexpr uint32_t Width = 256;
+        static constexpr uint32_t Height = 128;
+
+        OcclusionCuller();
+
+        // Clears the depth buffer, every following call uses this view projection
+        void Begin(const glm::mat4& viewProjection);
+        void RasterizeOccluder(const glm::mat4& transform, const glm::vec3* positions, const uint32_t* indices, size_t indexCount);
+        // False when the box is outside the view or hidden behind the rasterized occluders
+        bool IsVisible(const glm::mat4& transform, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+        bool HasOccluders() const { return m_bHasOccluders; }
+        // Depth of one pixel at the given pyramid level, NDC z in [-1, 1], 1 is empty
+        float GetDepth(uint32_t level, uint32_t x, uint32_t y) const;
+        uint32_t GetLevelCount() const { return (uint32_t)m_Levels.size(); }
+    private:
+        struct HiZLevel
+        {
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            std::vector<float> Depth;
+        };
+        void RasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+        void BuildHiZ();
+
+        glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+        std::vector<HiZLevel> m_Levels;// level 0 is the rasterized depth buffer
+        std::vector<glm::vec4> m_ClipPositions;
+        bool m_bHasOccluders = false;
+        bool m_bHiZDirty = false;
+    };
+}
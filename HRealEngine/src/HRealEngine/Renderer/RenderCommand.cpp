@@ -2,9 +2,9 @@
 
 #include "HRpch.h"
 #include "RenderCommand.h"
-#include "Platform/OpenGL/OpenGLRendererAPI.h"
 
 namespace HRealEngine
 {
-    Scope<RendererAPI> RenderCommand::m_RendererAPI = RendererAPI::Create();
+    // Created in Init so the API can still be switched (e.g. to headless) after static initialization
+    Scope<RendererAPI> RenderCommand::m_RendererAPI;
 }
@@ -10,6 +10,7 @@ namespace HRealEngine
     public:
         static void Init()
         {
+            m_RendererAPI = RendererAPI::Create();
             m_RendererAPI->Init();
         }
         static void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
@@ -28,18 +29,26 @@ namespace HRealEngine
         {
             m_RendererAPI->DrawIndexed(vertexArray, IndexCount);
         }
-        static void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset)
+        static void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset, uint32_t baseVertex = 0)
         {
-            m_RendererAPI->DrawIndexed(vertexArray, indexCount, indexOffset);
+            m_RendererAPI->DrawIndexed(vertexArray, indexCount, indexOffset, baseVertex);
         }
-        static void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount)
+        static void DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t baseInstance = 0)
         {
-            m_RendererAPI->DrawLines(vertexArray, vertexCount);
+            m_RendererAPI->DrawIndexedInstanced(vertexArray, indexCount, instanceCount, baseInstance);
+        }
+        static void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, uint32_t firstVertex = 0)
+        {
+            m_RendererAPI->DrawLines(vertexArray, vertexCount, firstVertex);
         }
         static void SetLineWidth(float width)
         {
             m_RendererAPI->SetLineWidth(width);
         }
+        static bool SupportsBindlessTextures()
+        {
+            return m_RendererAPI->SupportsBindlessTextures();
+        }
         
     private:
         static Scope<RendererAPI> m_RendererAPI;
@@ -17,12 +17,16 @@ namespace HRealEngine
     void Renderer::Init()
     {
         RenderCommand::Init();
+        if (GetAPI() == RendererAPI::API::None)
+            return;
         Renderer2D::Init();
         Renderer3D::Init();
     }
 
     void Renderer::Shutdown()
     {
+        if (GetAPI() == RendererAPI::API::None)
+            return;
         Renderer2D::Shutdown();
         Renderer3D::Shutdown();
     }
@@ -6,6 +6,7 @@
 #include "Shader.h"
 #include "VertexArray.h"
 #include "UniformBuffer.h"
+#include "StorageBuffer.h"
 #include "HRealEngine/Camera/Camera.h"
 
 #include <glm/gtc/type_ptr.hpp>
@@ -63,10 +64,18 @@ namespace HRealEngine
         static const uint32_t MaxVertices = MaxQuads * 4;
         static const uint32_t MaxIndices = MaxQuads * 6;
         static const uint32_t MaxTextureSlots = 32; 
+        static const uint32_t TextureHandleBinding = 3;
+        static const uint32_t MaxParticleInstances = 16384; // per streaming batch, bigger pools are drawn in chunks
 
         Ref<Texture2D> WhiteTexture;
-        std::array<Ref<Texture2D>, MaxTextureSlots> TextureSlots;
-        uint32_t TextureSlotIndex = 1; //0 = white texture
+        // Textures of the current batch, only capped at MaxTextureSlots when they are bound to slots
+        std::vector<Ref<Texture2D>> TextureSlots; //0 = white texture
+        std::unordered_map<uint32_t, uint32_t> TextureSlotLookup; // renderer id -> index in TextureSlots
+
+        // Bindless path, the quad shader reads TextureHandles[texIndex] from a storage buffer instead of a sampler slot
+        bool bBindlessTextures = false;
+        std::vector<uint64_t> TextureHandles;
+        Ref<StorageBuffer> TextureHandleBuffer;
 
         glm::vec4 QuadVertexPositions[4];
         
@@ -81,7 +90,7 @@ namespace HRealEngine
         
         //Quad
         Ref<VertexArray> QuadVertexArray;
-        Ref<VertexBuffer> QuadVertexBuffer;
+        Ref<StreamingVertexBuffer> QuadVertexBuffer;
         Ref<Shader> QuadShader;
 
         uint32_t QuadIndexCount = 0;
@@ -90,7 +99,7 @@ namespace HRealEngine
 
         //Circle
         Ref<VertexArray> CircleVertexArray;
-        Ref<VertexBuffer> CircleVertexBuffer;
+        Ref<StreamingVertexBuffer> CircleVertexBuffer;
         Ref<Shader> CircleShader;
 
         uint32_t CircleIndexCount = 0;
@@ -99,11 +108,11 @@ namespace HRealEngine
 
         //Line
         Ref<VertexArray> LineVertexArray;
-        Ref<VertexBuffer> LineVertexBuffer;
+        Ref<StreamingVertexBuffer> LineVertexBuffer;
         Ref<Shader> LineShader;
 
         Ref<VertexArray> TextVertexArray;
-        Ref<VertexBuffer> TextVertexBuffer;
+        Ref<StreamingVertexBuffer> TextVertexBuffer;
         Ref<Shader> TextShader;
 
         uint32_t LineVertexCount = 0;
@@ -115,16 +124,41 @@ namespace HRealEngine
         TextVertex* TextVertexBufferPtr = nullptr;
         Ref<Texture2D> FontAtlasTexture;
         
+        //Particles, a unit quad expanded per instance in the vertex shader
+        Ref<VertexArray> ParticleVertexArray;
+        Ref<VertexBuffer> ParticleQuadBuffer;
+        Ref<IndexBuffer> ParticleIndexBuffer;
+        Ref<StreamingVertexBuffer> ParticleInstanceBuffer;
+        uint32_t ParticleBatchesPerRegion = 0;
+        Ref<Shader> ParticleShader;
+
         float LineWidth = 2.0f;
         
     };
     static Renderer2DData s_Data;
+
+    // Rebuilt when a pool needs bigger regions, the old buffer is released once the GPU is done with it
+    static void CreateParticleInstanceBuffer(uint32_t batchesPerRegion)
+    {
+        s_Data.ParticleVertexArray = VertexArray::Create();
+        s_Data.ParticleVertexArray->AddVertexBuffer(s_Data.ParticleQuadBuffer);
+        s_Data.ParticleInstanceBuffer = StreamingVertexBuffer::Create(s_Data.MaxParticleInstances * sizeof(ParticleInstance), batchesPerRegion);
+        s_Data.ParticleInstanceBuffer->SetLayout({
+            {"a_Position", ShaderDataType::Float3, false},
+            {"a_Rotation", ShaderDataType::Float, false},
+            {"a_Color", ShaderDataType::Float4, false},
+            {"a_Size", ShaderDataType::Float, false}
+        });
+        s_Data.ParticleVertexArray->AddInstanceBuffer(s_Data.ParticleInstanceBuffer);
+        s_Data.ParticleVertexArray->SetIndexBuffer(s_Data.ParticleIndexBuffer);
+        s_Data.ParticleBatchesPerRegion = batchesPerRegion;
+    }
     
     void Renderer2D::Init()
     {
         //Quad
         s_Data.QuadVertexArray = VertexArray::Create();
-        s_Data.QuadVertexBuffer = VertexBuffer::Create(s_Data.MaxVertices * sizeof(QuadVertex));
+        s_Data.QuadVertexBuffer = StreamingVertexBuffer::Create(s_Data.MaxVertices * sizeof(QuadVertex));
         
         s_Data.QuadVertexBuffer->SetLayout({
             {"v_Position", ShaderDataType::Float3, false},
@@ -135,8 +169,6 @@ namespace HRealEngine
             {"v_EntityID", ShaderDataType::Int, false}
         });
         s_Data.QuadVertexArray->AddVertexBuffer(s_Data.QuadVertexBuffer);
-
-        s_Data.QuadVertexBufferBase = new QuadVertex[s_Data.MaxVertices];
         
         uint32_t* quadIndices = new uint32_t[s_Data.MaxIndices];
 
@@ -156,7 +188,7 @@ namespace HRealEngine
 
         //Circle        
         s_Data.CircleVertexArray = VertexArray::Create();
-        s_Data.CircleVertexBuffer = VertexBuffer::Create(s_Data.MaxVertices * sizeof(CircleVertex));
+        s_Data.CircleVertexBuffer = StreamingVertexBuffer::Create(s_Data.MaxVertices * sizeof(CircleVertex));
         s_Data.CircleVertexBuffer->SetLayout({
             {"v_WorldPosition", ShaderDataType::Float3, false},
             {"v_LocalPosition", ShaderDataType::Float3, false},
@@ -167,23 +199,21 @@ namespace HRealEngine
         });
         s_Data.CircleVertexArray->AddVertexBuffer(s_Data.CircleVertexBuffer);
         s_Data.CircleVertexArray->SetIndexBuffer(squareIndexBufferRef);
-        s_Data.CircleVertexBufferBase = new CircleVertex[s_Data.MaxVertices];
 
         //Line
         s_Data.LineVertexArray = VertexArray::Create();
-        s_Data.LineVertexBuffer = VertexBuffer::Create(s_Data.MaxVertices * sizeof(LineVertex));
+        s_Data.LineVertexBuffer = StreamingVertexBuffer::Create(s_Data.MaxVertices * sizeof(LineVertex));
         s_Data.LineVertexBuffer->SetLayout({
             {"v_Position", ShaderDataType::Float3, false},
             {"v_Color", ShaderDataType::Float4, false},
             {"v_EntityID", ShaderDataType::Int, false}
         });
         s_Data.LineVertexArray->AddVertexBuffer(s_Data.LineVertexBuffer);
-        s_Data.LineVertexBufferBase = new LineVertex[s_Data.MaxVertices];
 
         // Text
         s_Data.TextVertexArray = VertexArray::Create();
 
-        s_Data.TextVertexBuffer = VertexBuffer::Create(s_Data.MaxVertices * sizeof(TextVertex));
+        s_Data.TextVertexBuffer = StreamingVertexBuffer::Create(s_Data.MaxVertices * sizeof(TextVertex));
         s_Data.TextVertexBuffer->SetLayout({
             {"a_Position", ShaderDataType::Float3, false},
             {"a_Color", ShaderDataType::Float4, false},
@@ -192,7 +222,16 @@ namespace HRealEngine
         });
         s_Data.TextVertexArray->AddVertexBuffer(s_Data.TextVertexBuffer);
         s_Data.TextVertexArray->SetIndexBuffer(squareIndexBufferRef);
-        s_Data.TextVertexBufferBase = new TextVertex[s_Data.MaxVertices];
+
+        //Particles
+        constexpr float particleCorners[] = { -0.5f, -0.5f,  0.5f, -0.5f,  0.5f, 0.5f,  -0.5f, 0.5f };
+        s_Data.ParticleQuadBuffer = VertexBuffer::Create(particleCorners, sizeof(particleCorners));
+        s_Data.ParticleQuadBuffer->SetLayout({
+            {"a_Corner", ShaderDataType::Float2, false}
+        });
+        s_Data.ParticleIndexBuffer = squareIndexBufferRef;
+        // Small emitters pack together, DrawParticles grows the regions when a pool outgrows them
+        CreateParticleInstanceBuffer(4);
 
         //Textures
         s_Data.WhiteTexture = Texture2D::Create(TextureSpecification()/*1, 1*/);
@@ -208,8 +247,16 @@ namespace HRealEngine
         s_Data.CircleShader = Shader::Create("assets/shaders/Circle_Shader2D.glsl");
         s_Data.LineShader = Shader::Create("assets/shaders/Line_Shader2D.glsl");
         s_Data.TextShader = Shader::Create("assets/shaders/Renderer2D_Text.glsl");
+        s_Data.ParticleShader = Shader::Create("assets/shaders/Particle_Shader2D.glsl");
 
-        s_Data.TextureSlots[0] = s_Data.WhiteTexture;
+        s_Data.TextureSlots.reserve(s_Data.MaxTextureSlots);
+        s_Data.TextureSlots.push_back(s_Data.WhiteTexture);
+        s_Data.bBindlessTextures = RenderCommand::SupportsBindlessTextures();
+        if (s_Data.bBindlessTextures)
+        {
+            s_Data.TextureHandles.push_back(s_Data.WhiteTexture->GetBindlessHandle());
+            s_Data.TextureHandleBuffer = StorageBuffer::Create(sizeof(uint64_t) * 1024, s_Data.TextureHandleBinding);
+        }
 
         s_Data.QuadVertexPositions[0] = {-0.5f, -0.5f, 0.0f, 1.0f};
         s_Data.QuadVertexPositions[1] = { 0.5f, -0.5f, 0.0f, 1.0f};
@@ -250,24 +297,30 @@ namespace HRealEngine
     void Renderer2D::StartBatch()
     {
         s_Data.QuadIndexCount = 0;
+        s_Data.QuadVertexBufferBase = (QuadVertex*)s_Data.QuadVertexBuffer->Map();
         s_Data.QuadVertexBufferPtr = s_Data.QuadVertexBufferBase;
 
         s_Data.CircleIndexCount = 0;
+        s_Data.CircleVertexBufferBase = (CircleVertex*)s_Data.CircleVertexBuffer->Map();
         s_Data.CircleVertexBufferPtr = s_Data.CircleVertexBufferBase;
 
         s_Data.LineVertexCount = 0;
+        s_Data.LineVertexBufferBase = (LineVertex*)s_Data.LineVertexBuffer->Map();
         s_Data.LineVertexBufferPtr = s_Data.LineVertexBufferBase;
         
         s_Data.TextIndexCount = 0;
+        s_Data.TextVertexBufferBase = (TextVertex*)s_Data.TextVertexBuffer->Map();
         s_Data.TextVertexBufferPtr = s_Data.TextVertexBufferBase;
         
-        s_Data.TextureSlotIndex = 1;
+        s_Data.TextureSlots.resize(1);
+        s_Data.TextureSlotLookup.clear();
+        s_Data.TextureSlotLookup[s_Data.WhiteTexture->GetRendererID()] = 0;
+        if (s_Data.bBindlessTextures)
+            s_Data.TextureHandles.resize(1);
     }
 
     void Renderer2D::EndScene()
     {
-        uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.QuadVertexBufferPtr - (uint8_t*)s_Data.QuadVertexBufferBase);
-        s_Data.QuadVertexBuffer->SetData(s_Data.QuadVertexBufferBase, dataSize);
         Flush();
     }
 
@@ -277,38 +330,35 @@ namespace HRealEngine
             return;*/
         if (s_Data.QuadIndexCount)
         {
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.QuadVertexBufferPtr - (uint8_t*)s_Data.QuadVertexBufferBase);
-            s_Data.QuadVertexBuffer->SetData(s_Data.QuadVertexBufferBase, dataSize);
-            for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
-                s_Data.TextureSlots[i]->Bind(i);
+            if (s_Data.bBindlessTextures)
+                s_Data.TextureHandleBuffer->SetData(s_Data.TextureHandles.data(), (uint32_t)(s_Data.TextureHandles.size() * sizeof(uint64_t)));
+            else
+            {
+                for (uint32_t i = 0; i < (uint32_t)s_Data.TextureSlots.size(); i++)
+                    s_Data.TextureSlots[i]->Bind(i);
+            }
             s_Data.QuadShader->Bind();
-            RenderCommand::DrawIndexed(s_Data.QuadVertexArray, s_Data.QuadIndexCount);
+            RenderCommand::DrawIndexed(s_Data.QuadVertexArray, s_Data.QuadIndexCount, 0, s_Data.QuadVertexBuffer->GetBaseVertex());
+            s_Data.QuadVertexBuffer->Commit((uint32_t)((uint8_t*)s_Data.QuadVertexBufferPtr - (uint8_t*)s_Data.QuadVertexBufferBase));
             s_Data.stats.DrawCalls++;
         }
         if (s_Data.CircleIndexCount)
         {
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.CircleVertexBufferPtr - (uint8_t*)s_Data.CircleVertexBufferBase);
-            s_Data.CircleVertexBuffer->SetData(s_Data.CircleVertexBufferBase, dataSize);
-            
             s_Data.CircleShader->Bind();
-            RenderCommand::DrawIndexed(s_Data.CircleVertexArray, s_Data.CircleIndexCount);
+            RenderCommand::DrawIndexed(s_Data.CircleVertexArray, s_Data.CircleIndexCount, 0, s_Data.CircleVertexBuffer->GetBaseVertex());
+            s_Data.CircleVertexBuffer->Commit((uint32_t)((uint8_t*)s_Data.CircleVertexBufferPtr - (uint8_t*)s_Data.CircleVertexBufferBase));
             s_Data.stats.DrawCalls++;
         }
         if (s_Data.LineVertexCount)
         {
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.LineVertexBufferPtr - (uint8_t*)s_Data.LineVertexBufferBase);
-            s_Data.LineVertexBuffer->SetData(s_Data.LineVertexBufferBase, dataSize);
-            
             s_Data.LineShader->Bind();
             RenderCommand::SetLineWidth(s_Data.LineWidth);
-            RenderCommand::DrawLines(s_Data.LineVertexArray, s_Data.LineVertexCount);
+            RenderCommand::DrawLines(s_Data.LineVertexArray, s_Data.LineVertexCount, s_Data.LineVertexBuffer->GetBaseVertex());
+            s_Data.LineVertexBuffer->Commit((uint32_t)((uint8_t*)s_Data.LineVertexBufferPtr - (uint8_t*)s_Data.LineVertexBufferBase));
             s_Data.stats.DrawCalls++;
         }
         if (s_Data.TextIndexCount)
         {
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.TextVertexBufferPtr - (uint8_t*)s_Data.TextVertexBufferBase);
-            s_Data.TextVertexBuffer->SetData(s_Data.TextVertexBufferBase, dataSize);
-
             // Make sure we have a valid font atlas texture
             if (s_Data.FontAtlasTexture)
             {
@@ -320,7 +370,8 @@ namespace HRealEngine
             }
 
             s_Data.TextShader->Bind();
-            RenderCommand::DrawIndexed(s_Data.TextVertexArray, s_Data.TextIndexCount);
+            RenderCommand::DrawIndexed(s_Data.TextVertexArray, s_Data.TextIndexCount, 0, s_Data.TextVertexBuffer->GetBaseVertex());
+            s_Data.TextVertexBuffer->Commit((uint32_t)((uint8_t*)s_Data.TextVertexBufferPtr - (uint8_t*)s_Data.TextVertexBufferBase));
             s_Data.stats.DrawCalls++;
         }
     }
@@ -331,6 +382,23 @@ namespace HRealEngine
         StartBatch();
     }
 
+    float Renderer2D::GetTextureIndex(const Ref<Texture2D>& texture)
+    {
+        auto it = s_Data.TextureSlotLookup.find(texture->GetRendererID());
+        if (it != s_Data.TextureSlotLookup.end())
+            return (float)it->second;
+
+        if (!s_Data.bBindlessTextures && s_Data.TextureSlots.size() >= s_Data.MaxTextureSlots)
+            FlushAndReset();
+
+        const uint32_t index = (uint32_t)s_Data.TextureSlots.size();
+        s_Data.TextureSlots.push_back(texture);
+        if (s_Data.bBindlessTextures)
+            s_Data.TextureHandles.push_back(texture->GetBindlessHandle());
+        s_Data.TextureSlotLookup[texture->GetRendererID()] = index;
+        return (float)index;
+    }
+
     void Renderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
     {
         DrawQuad({position.x, position.y, 0.0f}, size, color);
@@ -370,21 +438,7 @@ namespace HRealEngine
         if (s_Data.QuadIndexCount >= s_Data.MaxIndices)
             FlushAndReset();
         
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
-        {
-            if (*s_Data.TextureSlots[i].get() == *textureRef.get())
-            {
-                textureIndex = (float)i;
-                break;
-            }
-        }
-        if (textureIndex == 0.f)
-        {
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = textureRef;
-            s_Data.TextureSlotIndex++;
-        }
+        const float textureIndex = GetTextureIndex(textureRef);
 
         glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
 
@@ -437,24 +491,7 @@ namespace HRealEngine
         if (s_Data.QuadIndexCount >= s_Data.MaxIndices)
             FlushAndReset();
         
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
-        {
-            if (*s_Data.TextureSlots[i].get() == *texture.get())
-            {
-                textureIndex = (float)i;
-                break;
-            }
-        }
-        if (textureIndex == 0.f)
-        {
-            if (s_Data.TextureSlotIndex >= s_Data.MaxTextureSlots)
-                FlushAndReset();
-            
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-            s_Data.TextureSlotIndex++;
-        }
+        const float textureIndex = GetTextureIndex(texture);
 
         for (size_t i = 0; i < quadVertexCount; i++)
         {
@@ -488,21 +525,7 @@ namespace HRealEngine
         
         constexpr glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f};
 
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
-        {
-            if (*s_Data.TextureSlots[i].get() == *textureRef.get())
-            {
-                textureIndex = (float)i;
-                break;
-            }
-        }
-        if (textureIndex == 0.f)
-        {
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = textureRef;
-            s_Data.TextureSlotIndex++;
-        }
+        const float textureIndex = GetTextureIndex(textureRef);
 
         glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::rotate(glm::mat4(1.0f),
             rotation, {0.0f, 0.0f, 1.0f}) * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
@@ -579,28 +602,52 @@ namespace HRealEngine
 
     void Renderer2D::DrawString(const std::string& string, Ref<Font> font, const glm::mat4& transform, const TextParams& textParams, int entityID)
     {
-        const auto& fontGeometry = font->GetMSDFData()->FontGeometry;
-        const auto& metrics = fontGeometry.getMetrics();
-        Ref<Texture2D> fontAtlas = font->GetAtlasTexture();
+        TextLayout layout;
+        BuildTextLayout(string, font, textParams.Kerning, textParams.LineSpacing, layout);
+        DrawTextLayout(layout, transform, textParams.Color, entityID);
+    }
 
-        s_Data.FontAtlasTexture = fontAtlas;
+    void Renderer2D::DrawString(const std::string& string, const glm::mat4& transform, TextComponent& component,
+        int entityID)
+    {
+        if (!component.Layout.IsValidFor(string, component.FontAsset, component.Kerning, component.LineSpacing))
+            BuildTextLayout(string, component.FontAsset, component.Kerning, component.LineSpacing, component.Layout);
+        DrawTextLayout(component.Layout, transform, component.Color, entityID);
+    }
+
+    void Renderer2D::BuildTextLayout(const std::string& string, const Ref<Font>& font, float kerning, float lineSpacing, TextLayout& outLayout)
+    {
+        outLayout.Glyphs.clear();
+        outLayout.Text = string;
+        outLayout.FontAsset = font;
+        outLayout.Kerning = kerning;
+        outLayout.LineSpacing = lineSpacing;
+
+        const MSDFData* fontData = font->GetMSDFData();
+        const MSDFFontMetrics& metrics = fontData->Metrics;
+        Ref<Texture2D> fontAtlas = font->GetAtlasTexture();
+        if (!fontAtlas)
+            return;
 
         double x = 0.0;
-        double fsScale = 1.0 / (metrics.ascenderY - metrics.descenderY);
+        double fsScale = 1.0 / (metrics.AscenderY - metrics.DescenderY);
         double y = 0.0;
 
-        const float spaceGlyphAdvance = static_cast<float>(fontGeometry.getGlyph(' ')->getAdvance());
+        const MSDFGlyph* spaceGlyph = fontData->GetGlyph(' ');
+        const float spaceGlyphAdvance = spaceGlyph ? static_cast<float>(spaceGlyph->Advance) : 0.0f;
+        const glm::vec2 texelSize(1.0f / fontAtlas->GetWidth(), 1.0f / fontAtlas->GetHeight());
 
+        outLayout.Glyphs.reserve(string.size());
         for (size_t i = 0; i < string.size(); i++)
         {
-            char character = string[i];
+            const uint32_t character = (unsigned char)string[i];
             if (character == '\r')
                 continue;
 
             if (character == '\n')
             {
                 x = 0;
-                y -= fsScale * metrics.lineHeight + textParams.LineSpacing;
+                y -= fsScale * metrics.LineHeight + lineSpacing;
                 continue;
             }
 
@@ -609,91 +656,99 @@ namespace HRealEngine
                 float advance = spaceGlyphAdvance;
                 if (i < string.size() - 1)
                 {
-                    char nextCharacter = string[i + 1];
-                    double dAdvance;
-                    fontGeometry.getAdvance(dAdvance, character, nextCharacter);
+                    const uint32_t nextCharacter = (unsigned char)string[i + 1];
+                    double dAdvance = advance;
+                    fontData->GetAdvance(dAdvance, character, nextCharacter);
                     advance = (float)dAdvance;
                 }
 
-                x += fsScale * advance + textParams.Kerning;
+                x += fsScale * advance + kerning;
                 continue;
             }
 
             if (character == '\t')
             {
-                x += 4.0f * (fsScale * spaceGlyphAdvance + textParams.Kerning);
+                x += 4.0f * (fsScale * spaceGlyphAdvance + kerning);
                 continue;
             }
 
-            auto glyph = fontGeometry.getGlyph(character);
+            const MSDFGlyph* glyph = fontData->GetGlyph(character);
             if (!glyph)
-                glyph = fontGeometry.getGlyph('?');
+                glyph = fontData->GetGlyph('?');
             if (!glyph)
                 return;
 
-            double al, ab, ar, at;
-            glyph->getQuadAtlasBounds(al, ab, ar, at);
-            glm::vec2 texCoordMin((float)al, (float)ab);
-            glm::vec2 texCoordMax((float)ar, (float)at);
-
-            double pl, pb, pr, pt;
-            glyph->getQuadPlaneBounds(pl, pb, pr, pt);
-            glm::vec2 quadMin((float)pl, (float)pb);
-            glm::vec2 quadMax((float)pr, (float)pt);
-
-            quadMin *= fsScale, quadMax *= fsScale;
-            quadMin += glm::vec2(x, y);
-            quadMax += glm::vec2(x, y);
-
-            float texelWidth = 1.0f / fontAtlas->GetWidth();
-            float texelHeight = 1.0f / fontAtlas->GetHeight();
-            texCoordMin *= glm::vec2(texelWidth, texelHeight);
-            texCoordMax *= glm::vec2(texelWidth, texelHeight);
-
-            // render here
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMin, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textParams.Color;
-            s_Data.TextVertexBufferPtr->TexCoord = texCoordMin;
+            TextLayout::Glyph& quad = outLayout.Glyphs.emplace_back();
+            quad.QuadMin = glm::vec2((float)glyph->PlaneLeft, (float)glyph->PlaneBottom) * (float)fsScale + glm::vec2(x, y);
+            quad.QuadMax = glm::vec2((float)glyph->PlaneRight, (float)glyph->PlaneTop) * (float)fsScale + glm::vec2(x, y);
+            quad.TexCoordMin = glm::vec2((float)glyph->AtlasLeft, (float)glyph->AtlasBottom) * texelSize;
+            quad.TexCoordMax = glm::vec2((float)glyph->AtlasRight, (float)glyph->AtlasTop) * texelSize;
+
+            if (i < string.size() - 1)
+            {
+                double advance = glyph->Advance;
+                const uint32_t nextCharacter = (unsigned char)string[i + 1];
+                fontData->GetAdvance(advance, character, nextCharacter);
+                x += fsScale * advance + kerning;
+            }
+        }
+    }
+
+    void Renderer2D::DrawTextLayout(const TextLayout& layout, const glm::mat4& transform, const glm::vec4& color, int entityID)
+    {
+        if (layout.Glyphs.empty())
+            return;
+
+        // One atlas per text batch
+        Ref<Texture2D> fontAtlas = layout.FontAsset->GetAtlasTexture();
+        if (s_Data.TextIndexCount > 0 && s_Data.FontAtlasTexture != fontAtlas)
+            FlushAndReset();
+        s_Data.FontAtlasTexture = fontAtlas;
+
+        // Entity transforms are affine, so each corner is the origin plus the scaled X and Y axes
+        const glm::vec3 origin = transform[3];
+        const glm::vec3 axisX = transform[0];
+        const glm::vec3 axisY = transform[1];
+        for (const TextLayout::Glyph& glyph : layout.Glyphs)
+        {
+            if (s_Data.TextIndexCount >= s_Data.MaxIndices)
+            {
+                FlushAndReset();
+                s_Data.FontAtlasTexture = fontAtlas;
+            }
+
+            const glm::vec3 xMin = axisX * glyph.QuadMin.x, xMax = axisX * glyph.QuadMax.x;
+            const glm::vec3 yMin = origin + axisY * glyph.QuadMin.y, yMax = origin + axisY * glyph.QuadMax.y;
+
+            s_Data.TextVertexBufferPtr->Position = yMin + xMin;
+            s_Data.TextVertexBufferPtr->Color = color;
+            s_Data.TextVertexBufferPtr->TexCoord = glyph.TexCoordMin;
             s_Data.TextVertexBufferPtr->EntityID = entityID;
             s_Data.TextVertexBufferPtr++;
 
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMax.x, quadMin.y, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textParams.Color;
-            s_Data.TextVertexBufferPtr->TexCoord = {texCoordMax.x, texCoordMin.y};
+            s_Data.TextVertexBufferPtr->Position = yMin + xMax;
+            s_Data.TextVertexBufferPtr->Color = color;
+            s_Data.TextVertexBufferPtr->TexCoord = { glyph.TexCoordMax.x, glyph.TexCoordMin.y };
             s_Data.TextVertexBufferPtr->EntityID = entityID;
             s_Data.TextVertexBufferPtr++;
 
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMax, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textParams.Color;
-            s_Data.TextVertexBufferPtr->TexCoord = texCoordMax;
+            s_Data.TextVertexBufferPtr->Position = yMax + xMax;
+            s_Data.TextVertexBufferPtr->Color = color;
+            s_Data.TextVertexBufferPtr->TexCoord = glyph.TexCoordMax;
             s_Data.TextVertexBufferPtr->EntityID = entityID;
             s_Data.TextVertexBufferPtr++;
 
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMin.x, quadMax.y, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textParams.Color;
-            s_Data.TextVertexBufferPtr->TexCoord = {texCoordMin.x, texCoordMax.y};
+            s_Data.TextVertexBufferPtr->Position = yMax + xMin;
+            s_Data.TextVertexBufferPtr->Color = color;
+            s_Data.TextVertexBufferPtr->TexCoord = { glyph.TexCoordMin.x, glyph.TexCoordMax.y };
             s_Data.TextVertexBufferPtr->EntityID = entityID;
             s_Data.TextVertexBufferPtr++;
 
             s_Data.TextIndexCount += 6;
             s_Data.stats.QuadCount++;
-
-            if (i < string.size() - 1)
-            {
-                double advance = glyph->getAdvance();
-                char nextCharacter = string[i + 1];
-                fontGeometry.getAdvance(advance, character, nextCharacter);
-                x += fsScale * advance + textParams.Kerning;
-            }
         }
     }
 
-    void Renderer2D::DrawString(const std::string& string, const glm::mat4& transform, const TextComponent& component,
-        int entityID)
-    {
-        DrawString(string, component.FontAsset, transform, { component.Color, component.Kerning, component.LineSpacing }, entityID);
-    }
-
     float Renderer2D::GetLineWidth()
     {
         return s_Data.LineWidth;
@@ -750,21 +805,7 @@ namespace HRealEngine
         
         constexpr glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f};
 
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
-        {
-            if (*s_Data.TextureSlots[i].get() == *texture.get())
-            {
-                textureIndex = (float)i;
-                break;
-            }
-        }
-        if (textureIndex == 0.f)
-        {
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-            s_Data.TextureSlotIndex++;
-        }
+        const float textureIndex = GetTextureIndex(texture);
 
         glm::mat4 transform = glm::translate(glm::mat4(1.0f), position) * glm::rotate(glm::mat4(1.0f),
             rotation, {0.0f, 0.0f, 1.0f}) * glm::scale(glm::mat4(1.0f), {size.x, size.y, 1.0f});
@@ -801,6 +842,34 @@ namespace HRealEngine
         }
     }
 
+    void Renderer2D::DrawParticles(const ParticlePool& pool, const ParticleEmitterProps& props, int entityID)
+    {
+        const uint32_t aliveCount = pool.GetAliveCount();
+        if (aliveCount == 0)
+            return;
+
+        // A region holds the largest pool, so a full pool never waits on the fence of its own earlier chunks
+        const uint32_t batchesPerPool = (pool.GetCapacity() + s_Data.MaxParticleInstances - 1) / s_Data.MaxParticleInstances;
+        if (batchesPerPool > s_Data.ParticleBatchesPerRegion)
+            CreateParticleInstanceBuffer(batchesPerPool);
+
+        // Keep the draw order, everything batched before the emitter lands below its particles
+        if (s_Data.QuadIndexCount || s_Data.CircleIndexCount || s_Data.LineVertexCount || s_Data.TextIndexCount)
+            FlushAndReset();
+
+        s_Data.ParticleShader->Bind();
+        s_Data.ParticleShader->SetInt("u_EntityID", entityID);
+        for (uint32_t first = 0; first < aliveCount; first += s_Data.MaxParticleInstances)
+        {
+            const uint32_t count = std::min(aliveCount - first, s_Data.MaxParticleInstances);
+            pool.WriteInstances(props, first, count, (ParticleInstance*)s_Data.ParticleInstanceBuffer->Map());
+            RenderCommand::DrawIndexedInstanced(s_Data.ParticleVertexArray, 6, count, s_Data.ParticleInstanceBuffer->GetBaseVertex());
+            s_Data.ParticleInstanceBuffer->Commit(count * sizeof(ParticleInstance));
+            s_Data.stats.DrawCalls++;
+            s_Data.stats.QuadCount += count;
+        }
+    }
+
     Renderer2D::Statistics Renderer2D::GetStats()
     {
         return s_Data.stats;
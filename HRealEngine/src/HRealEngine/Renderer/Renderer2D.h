@@ -49,6 +49,9 @@ namespace HRealEngine
         
         static void DrawSprite(const glm::mat4& transform, SpriteRendererComponent& src, int entityID = -1);
 
+        // Draws every alive particle of the pool as one instanced quad stream, the pending batch is flushed first
+        static void DrawParticles(const ParticlePool& pool, const ParticleEmitterProps& props, int entityID = -1);
+
         struct TextParams
         {
             glm::vec4 Color{ 1.0f };
@@ -56,7 +59,9 @@ namespace HRealEngine
             float LineSpacing = 0.0f;
         };
         static void DrawString(const std::string& string, Ref<Font> font, const glm::mat4& transform, const TextParams& textParams, int entityID = -1);
-        static void DrawString(const std::string& string, const glm::mat4& transform, const TextComponent& component, int entityID = -1);
+        static void DrawString(const std::string& string, const glm::mat4& transform, TextComponent& component, int entityID = -1);
+        static void BuildTextLayout(const std::string& string, const Ref<Font>& font, float kerning, float lineSpacing, TextLayout& outLayout);
+        static void DrawTextLayout(const TextLayout& layout, const glm::mat4& transform, const glm::vec4& color, int entityID = -1);
 
         static float GetLineWidth();
         static void SetLineWidth(float width);
@@ -73,5 +78,7 @@ namespace HRealEngine
         static void ResetStats();
     private:
         static void FlushAndReset();
+        // Index of the texture in the current batch, flushes first when the slots are full
+        static float GetTextureIndex(const Ref<Texture2D>& texture);
     };
 }
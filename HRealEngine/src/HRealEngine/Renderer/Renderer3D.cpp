@@ -5,11 +5,15 @@
 #include "RenderCommand.h"
 #include "Renderer.h"
 #include "Renderer2D.h"
+#include "LightClusterGrid.h"
+#include "OcclusionCuller.h"
 #include "Shader.h"
+#include "StorageBuffer.h"
 #include "UniformBuffer.h"
 #include "VertexArray.h"
 #include "glad/glad.h"
 #include "HRealEngine/Asset/AssetManager.h"
+#include "HRealEngine/Core/Hash.h"
 #include "HRealEngine/Core/MeshLoader.h"
 
 namespace HRealEngine
@@ -25,6 +29,14 @@ namespace HRealEngine
         
         int EntityID;
     };
+    // std430 layout of one light in the light storage buffer
+    struct LightStorageData
+    {
+        glm::vec4 PositionType;//xyz position, w type
+        glm::vec4 DirectionRadius;
+        glm::vec4 ColorIntensity;
+        glm::ivec4 Flags;//x cast shadows, y point shadow slot or -1
+    };
     struct Renderer3DData
     {
         static const uint32_t MaxCubes = 1000;
@@ -36,12 +48,19 @@ namespace HRealEngine
         static const uint32_t ReservedDirShadowSlot = 31;
         static const uint32_t MaxUserTextureSlots = 30; // 0..29 (slot 0 is white)
 
+        static const uint32_t TextureHandleBinding = 4;
+
         Ref<Texture2D> WhiteTexture;
-        std::array<Ref<Texture2D>, MaxTextureSlots> TextureSlots;
-        uint32_t TextureSlotIndex = 1; //0 = white texture
+        // Textures of the cube batch, only capped at MaxUserTextureSlots when they are bound to slots
+        std::vector<Ref<Texture2D>> TextureSlots; //0 = white texture
+        std::unordered_map<uint32_t, uint32_t> TextureSlotLookup; // renderer id -> index in TextureSlots
+
+        bool bBindlessTextures = false;
+        std::vector<uint64_t> TextureHandles;
+        Ref<StorageBuffer> TextureHandleBuffer;
         
         Ref<VertexArray> CubeVertexArray;
-        Ref<VertexBuffer> CubeVertexBuffer;
+        Ref<StreamingVertexBuffer> CubeVertexBuffer;
         Ref<Shader> CubeShader;
 
         uint32_t CubeIndexCount = 0;
@@ -59,21 +78,52 @@ namespace HRealEngine
         glm::vec2 VertexUV[24];
         glm::vec3 VertexNormal[24];
 
-        std::array<Renderer3D::LightGPU, 16> Lights;
-        int LightCount = 0;
+        std::vector<Renderer3D::LightGPU> Lights;
+        std::vector<int> LightShadowSlot;//point shadow slot per light, -1 without one
+        std::vector<LightStorageData> LightStorage;
+        std::vector<glm::vec4> LightSpheres;
+
+        // Clustered forward lighting, lights are bucketed into view space froxels every BeginScene
+        LightClusterGrid LightClusters;
+        Ref<StorageBuffer> LightStorageBuffer;
+        Ref<StorageBuffer> ClusterStorageBuffer;
+        Ref<StorageBuffer> LightIndexStorageBuffer;
+        glm::mat4 ViewMatrix = glm::mat4(1.0f);
+        glm::vec4 ClusterViewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
         glm::vec3 ViewPos{0.0f};
-        bool LightsDirty = true;
+        // Uniforms live in each program, lights and shadows go to every variant that draws once per stamp
+        uint32_t FrameUniformStamp = 1;
+        std::map<std::pair<const Shader*, uint64_t>, uint32_t> VariantUniformStamps;
+
+        // CPU Hi-Z occlusion, rebuilt from the submitted occluders every BeginScene
+        OcclusionCuller Occlusion;
+        bool bOcclusionCulling = true;
 
-        // Shadow mapping
+        // Mesh LOD selection, LodBias above 1 switches to coarser levels sooner
+        glm::mat4 ProjectionMatrix = glm::mat4(1.0f);
+        float LodBias = 1.0f;
+
+        // Shadow mapping, one depth layer per cascade
         uint32_t ShadowFBO = 0;
         uint32_t ShadowDepthTexture = 0;
-        uint32_t ShadowMapSize = 2048;
+        uint32_t ShadowMapSize = 1024;
+        // Static casters are cached here and copied into ShadowDepthTexture before the dynamic casters are drawn
+        uint32_t StaticShadowFBO = 0;
+        uint32_t StaticShadowDepthTexture = 0;
 
         Ref<Shader> ShadowDepthShader;
 
         bool ShadowValid = false;
-        glm::mat4 LightSpaceMatrix = glm::mat4(1.0f);
+        std::array<glm::mat4, Renderer3D::ShadowCascadeCount> CascadeMatrices{};
+        std::array<glm::mat4, Renderer3D::ShadowCascadeCount> StaticCascadeMatrices{};
         glm::vec3 ShadowLightDir = glm::vec3(0.0f, -1.0f, 0.0f);
+        glm::vec3 StaticShadowLightDir = glm::vec3(0.0f);
+        uint32_t StaleStaticCascadeMask = 0;
+        bool bStaticShadowsDirty = true;
+
+        float ShadowDistance = 150.0f;
+        float CascadeSplitLambda = 0.75f;//0 = uniform splits, 1 = logarithmic splits
+        float ShadowCasterDepthPadding = 200.0f;//casters behind the cascade toward the light still have to land in the depth range
 
         float ShadowBias = 0.0008f;//MVP default
         int OldViewport[4] = { 0,0,0,0 };
@@ -85,46 +135,216 @@ namespace HRealEngine
         uint32_t PointShadowFBO = 0;
         uint32_t PointShadowDepthCubemap = 0;
         uint32_t PointShadowMapSize = 1024;
-        uint32_t MaxPointShadowCasters = 8;
         uint32_t PointShadowDepthCubemapArray = 0;
+        // Per caster slot and cube face, the signature of what was last rendered into that layer
+        std::array<std::array<size_t, 6>, Renderer3D::MaxPointShadowCasters> PointShadowFaceSignatures{};
+        std::array<bool, Renderer3D::MaxPointShadowCasters> PointShadowSlotValid{};
+        std::array<uint64_t, Renderer3D::MaxPointShadowCasters> PointShadowSlotLightID{}; // light drawn into the slot by the last shadow pass, 0 if none
+        uint32_t CurrentPointShadowCaster = 0;
+        uint32_t PointShadowDirtyFaces = 0;
         
-        std::array<int, 16> PointShadowIndex{};
-        std::array<glm::vec3, 16> PointShadowLightPos{};
-        std::array<float, 16> PointShadowFarPlane{};
+        std::array<glm::vec3, Renderer3D::MaxPointShadowCasters> PointShadowLightPos{};
+        std::array<float, Renderer3D::MaxPointShadowCasters> PointShadowFarPlane{};
 
         bool PointShadowValid = false;
+
+        Renderer3D::Statistics Stats;
     };
     static Renderer3DData s_Data;
 
-    static void CreateShadowResources()
+    static void BeginSceneSubmission(const glm::mat4& projection)
     {
-        if (s_Data.ShadowFBO != 0)
-            return;
+        s_Data.ProjectionMatrix = projection;
+        s_Data.Occlusion.Begin(s_Data.CameraBuffer.ViewProjectionMatrix);
+        s_Data.Stats.OccluderCount = 0;
+        s_Data.Stats.CulledMeshes = 0;
+        s_Data.Stats.VisibleMeshes = 0;
+        s_Data.Stats.MeshTriangles = 0;
+    }
 
-        glGenFramebuffers(1, &s_Data.ShadowFBO);
+    // Frustum and occlusion test for one draw, finalTransform already includes the pivot
+    static bool IsMeshVisible(const glm::mat4& finalTransform, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        if (!s_Data.bOcclusionCulling)
+            return true;
+        if (!s_Data.Occlusion.IsVisible(finalTransform, boundsMin, boundsMax))
+        {
+            s_Data.Stats.CulledMeshes++;
+            return false;
+        }
+        s_Data.Stats.VisibleMeshes++;
+        return true;
+    }
 
-        glGenTextures(1, &s_Data.ShadowDepthTexture);
-        glBindTexture(GL_TEXTURE_2D, s_Data.ShadowDepthTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, (GLsizei)s_Data.ShadowMapSize, (GLsizei)s_Data.ShadowMapSize,
-            0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // Maps quantized [0, 1] positions back into the mesh bounds, identity for float vertices
+    static glm::mat4 GetDequantizeTransform(const MeshGPU& mesh)
+    {
+        if (mesh.VertexFormat != HMeshBinVertexFormat::Quantized)
+            return glm::mat4(1.0f);
+        return glm::translate(glm::mat4(1.0f), mesh.BoundsMin) * glm::scale(glm::mat4(1.0f), mesh.BoundsMax - mesh.BoundsMin);
+    }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        
+    // Coarsest level whose screen size threshold the projected bounds fall under, 0 is the full mesh
+    static uint32_t SelectMeshLod(const MeshGPU& mesh, const glm::mat4& finalTransform)
+    {
+        if (mesh.Lods.empty())
+            return 0;
+
+        const float maxScale = glm::max(glm::length(glm::vec3(finalTransform[0])), glm::max(glm::length(glm::vec3(finalTransform[1])), glm::length(glm::vec3(finalTransform[2]))));
+        const glm::vec3 center = glm::vec3(finalTransform * glm::vec4((mesh.BoundsMin + mesh.BoundsMax) * 0.5f, 1.0f));
+        const float radius = glm::length(mesh.BoundsMax - mesh.BoundsMin) * 0.5f * maxScale;
+
+        // Fraction of the screen height covered by the bounding sphere diameter
+        float screenSize = radius * s_Data.ProjectionMatrix[1][1];
+        if (s_Data.ProjectionMatrix[3][3] == 0.0f)
+            screenSize /= glm::max(glm::distance(center, s_Data.ViewPos), radius);
+        screenSize /= s_Data.LodBias;
+
+        uint32_t level = 0;
+        for (uint32_t i = 0; i < (uint32_t)mesh.Lods.size(); i++)
+            if (screenSize < mesh.Lods[i].ScreenSize)
+                level = i + 1;
+        return level;
+    }
+
+    static void CreateShadowCascadeTarget(uint32_t& fbo, uint32_t& depthTexture)
+    {
+        glGenFramebuffers(1, &fbo);
+
+        glGenTextures(1, &depthTexture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, (GLsizei)s_Data.ShadowMapSize, (GLsizei)s_Data.ShadowMapSize,
+            (GLsizei)Renderer3D::ShadowCascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
         float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-        
-        glBindFramebuffer(GL_FRAMEBUFFER, s_Data.ShadowFBO);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, s_Data.ShadowDepthTexture, 0);
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+        // Layered attachment, the shadow depth geometry shader picks the cascade with gl_Layer
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0);
 
         glDrawBuffer(GL_NONE);
         glReadBuffer(GL_NONE);
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+    static void CreateShadowResources()
+    {
+        if (s_Data.ShadowFBO != 0)
+            return;
+
+        CreateShadowCascadeTarget(s_Data.ShadowFBO, s_Data.ShadowDepthTexture);
+        CreateShadowCascadeTarget(s_Data.StaticShadowFBO, s_Data.StaticShadowDepthTexture);
+        s_Data.bStaticShadowsDirty = true;
+    }
+    static void UploadDirShadowToShader(const Ref<Shader>& shader)
+    {
+        if (s_Data.ShadowValid && s_Data.ShadowDepthTexture != 0)
+        {
+            shader->SetInt("u_CascadeCount", (int)Renderer3D::ShadowCascadeCount);
+            for (uint32_t i = 0; i < Renderer3D::ShadowCascadeCount; i++)
+                shader->SetMat4("u_LightSpaceMatrices[" + std::to_string(i) + "]", s_Data.CascadeMatrices[i]);
+            shader->SetFloat("u_ShadowBias", s_Data.ShadowBias);
+
+            const int slot = Renderer3DData::ReservedDirShadowSlot; // 31
+            shader->SetInt("u_ShadowMap", slot);
+            glActiveTexture(GL_TEXTURE0 + slot);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, s_Data.ShadowDepthTexture);
+        }
+    }
+    static void UploadCascadesToShadowShader(uint32_t cascadeMask)
+    {
+        s_Data.ShadowDepthShader->Bind();
+        s_Data.ShadowDepthShader->SetInt("u_CascadeCount", (int)Renderer3D::ShadowCascadeCount);
+        s_Data.ShadowDepthShader->SetInt("u_CascadeMask", (int)cascadeMask);
+        for (uint32_t i = 0; i < Renderer3D::ShadowCascadeCount; i++)
+            s_Data.ShadowDepthShader->SetMat4("u_LightSpaceMatrices[" + std::to_string(i) + "]", s_Data.CascadeMatrices[i]);
+    }
+    // Splits the camera frustum (clamped to ShadowDistance) and fits a light space ortho box around every slice.
+    // The box size only depends on the slice shape and its center is snapped to a texel grid, so a moving camera
+    // neither shimmers the shadow edges nor changes the matrix until the center crosses a grid cell.
+    static void ComputeShadowCascades(const glm::vec3& lightDir, const glm::mat4& cameraView, const glm::mat4& cameraProjection)
+    {
+        const glm::mat4 invViewProj = glm::inverse(cameraProjection * cameraView);
+        const glm::vec2 ndcCorners[4] = { {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f} };
+        glm::vec3 nearCorners[4];
+        glm::vec3 farCorners[4];
+        for (int i = 0; i < 4; i++)
+        {
+            glm::vec4 n = invViewProj * glm::vec4(ndcCorners[i], -1.0f, 1.0f);
+            glm::vec4 f = invViewProj * glm::vec4(ndcCorners[i], 1.0f, 1.0f);
+            nearCorners[i] = glm::vec3(n) / n.w;
+            farCorners[i] = glm::vec3(f) / f.w;
+        }
+
+        const bool bPerspective = cameraProjection[3][3] == 0.0f;
+        float nearPlane, farPlane;
+        if (bPerspective)
+        {
+            nearPlane = cameraProjection[3][2] / (cameraProjection[2][2] - 1.0f);
+            farPlane = cameraProjection[3][2] / (cameraProjection[2][2] + 1.0f);
+        }
+        else
+        {
+            nearPlane = (cameraProjection[3][2] + 1.0f) / cameraProjection[2][2];
+            farPlane = (cameraProjection[3][2] - 1.0f) / cameraProjection[2][2];
+        }
+        const float depthRange = glm::max(farPlane - nearPlane, 0.0001f);
+        const float shadowFar = glm::min(farPlane, nearPlane + s_Data.ShadowDistance);
+
+        const glm::vec3 up = (glm::abs(lightDir.y) > 0.99f) ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+        const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, up);
+
+        float previousSplit = 0.0f;
+        for (uint32_t cascade = 0; cascade < Renderer3D::ShadowCascadeCount; cascade++)
+        {
+            const float p = (float)(cascade + 1) / (float)Renderer3D::ShadowCascadeCount;
+            const float uniformSplit = nearPlane + (shadowFar - nearPlane) * p;
+            float splitDepth = uniformSplit;
+            if (bPerspective && nearPlane > 0.0f)
+            {
+                const float logSplit = nearPlane * glm::pow(shadowFar / nearPlane, p);
+                splitDepth = glm::mix(uniformSplit, logSplit, s_Data.CascadeSplitLambda);
+            }
+            const float split = (splitDepth - nearPlane) / depthRange;
+
+            glm::vec3 sliceCorners[8];
+            glm::vec3 center(0.0f);
+            for (int i = 0; i < 4; i++)
+            {
+                const glm::vec3 edge = farCorners[i] - nearCorners[i];
+                sliceCorners[i] = nearCorners[i] + edge * previousSplit;
+                sliceCorners[i + 4] = nearCorners[i] + edge * split;
+                center += sliceCorners[i] + sliceCorners[i + 4];
+            }
+            center /= 8.0f;
+
+            float radius = 0.0f;
+            for (const glm::vec3& corner : sliceCorners)
+                radius = glm::max(radius, glm::length(corner - center));
+            radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+            // Pad the box so the center can sit anywhere inside a grid cell and the slice still fits
+            const float extent = radius * 1.5f;
+            const float texelSize = 2.0f * extent / (float)s_Data.ShadowMapSize;
+            const float gridStep = texelSize * glm::floor((float)s_Data.ShadowMapSize / 6.0f);
+
+            glm::vec3 lightSpaceCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+            lightSpaceCenter = glm::round(lightSpaceCenter / gridStep) * gridStep;
+
+            const glm::mat4 lightProj = glm::ortho(lightSpaceCenter.x - extent, lightSpaceCenter.x + extent,
+                lightSpaceCenter.y - extent, lightSpaceCenter.y + extent,
+                -lightSpaceCenter.z - extent - s_Data.ShadowCasterDepthPadding, -lightSpaceCenter.z + extent);
+            s_Data.CascadeMatrices[cascade] = lightProj * lightView;
+
+            previousSplit = split;
+        }
     }
     static void CreatePointShadowResources()
     {
@@ -136,7 +356,7 @@ namespace HRealEngine
         glGenTextures(1, &s_Data.PointShadowDepthCubemapArray);
         glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, s_Data.PointShadowDepthCubemapArray);
         
-        const GLsizei depthLayers = (GLsizei)(6 * s_Data.MaxPointShadowCasters);
+        const GLsizei depthLayers = (GLsizei)(6 * Renderer3D::MaxPointShadowCasters);
 
         glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT24,
             (GLsizei)s_Data.PointShadowMapSize, (GLsizei)s_Data.PointShadowMapSize, depthLayers,
@@ -162,53 +382,97 @@ namespace HRealEngine
     {
         if (s_Data.PointShadowValid && s_Data.PointShadowDepthCubemapArray != 0)
         {
-            shader->SetInt("u_HasPointShadowMap", 1);
-
             const int slot = Renderer3DData::ReservedPointShadowSlot; // 30
             shader->SetInt("u_PointShadowMaps", slot);
 
             glActiveTexture(GL_TEXTURE0 + slot);
             glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, s_Data.PointShadowDepthCubemapArray);
 
-            for (int i = 0; i < 16; i++)
+            for (uint32_t i = 0; i < Renderer3D::MaxPointShadowCasters; i++)
             {
-                shader->SetInt   ("u_PointShadowIndex[" + std::to_string(i) + "]", s_Data.PointShadowIndex[i]);
                 shader->SetFloat3("u_PointShadowLightPos[" + std::to_string(i) + "]", s_Data.PointShadowLightPos[i]);
                 shader->SetFloat ("u_PointShadowFarPlane[" + std::to_string(i) + "]", s_Data.PointShadowFarPlane[i]);
             }
         }
-        else
-        {
-            shader->SetInt("u_HasPointShadowMap", 0);
-            for (int i = 0; i < 16; i++)
-                shader->SetInt("u_PointShadowIndex[" + std::to_string(i) + "]", -1);
-        }
     }
     
     static void UploadLightsToShader(const Ref<Shader>& shader)
     {
         shader->SetFloat3("u_ViewPos", s_Data.ViewPos);
-        shader->SetInt("u_LightCount", s_Data.LightCount);
         shader->SetFloat("u_Shininess", 32.0f);
 
-        for (int i = 0; i < s_Data.LightCount; i++)
+        // The light data itself lives in the storage buffers, only the cluster lookup parameters are uniforms
+        const LightClusterGrid& grid = s_Data.LightClusters;
+        shader->SetInt("u_GlobalLightCount", (int)grid.GetGlobalLightCount());
+        shader->SetMat4("u_View", s_Data.ViewMatrix);
+        shader->SetFloat4("u_ClusterViewport", s_Data.ClusterViewport);
+        shader->SetFloat3("u_ClusterDepthParams", glm::vec3(grid.GetDepthScale(), grid.GetDepthBias(), grid.IsLogDepth() ? 1.0f : 0.0f));
+    }
+    // Keywords of the lit shaders that follow from the pass state rather than the material
+    static uint64_t GetPassKeywords()
+    {
+        uint64_t keywords = ShaderKeyword::None;
+        if (s_Data.ShadowValid && s_Data.ShadowDepthTexture != 0)
+            keywords |= ShaderKeyword::ShadowMap;
+        if (s_Data.PointShadowValid && s_Data.PointShadowDepthCubemapArray != 0)
+            keywords |= ShaderKeyword::PointShadowMap;
+        if (Renderer::GetDebugView() != 0)
+            keywords |= ShaderKeyword::DebugView;
+        return keywords;
+    }
+    // Lights and shadows of the bound variant, skipped when it already has this frame's values
+    static void UploadFrameUniforms(const Ref<Shader>& shader)
+    {
+        uint32_t& stamp = s_Data.VariantUniformStamps[{ shader.get(), shader->GetKeywords() }];
+        if (stamp == s_Data.FrameUniformStamp)
+            return;
+        stamp = s_Data.FrameUniformStamp;
+
+        UploadLightsToShader(shader);
+        UploadDirShadowToShader(shader);
+        UploadPointShadowArrayToShader(shader);
+        shader->SetInt("u_DebugView", Renderer::GetDebugView());
+    }
+    // Packs the lights, assigns them to clusters for the given camera and uploads everything the lit shaders read
+    static void UploadLightClusters(const glm::mat4& view, const glm::mat4& projection)
+    {
+        s_Data.ViewMatrix = view;
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        s_Data.ClusterViewport = glm::vec4((float)viewport[0], (float)viewport[1], (float)std::max(viewport[2], 1), (float)std::max(viewport[3], 1));
+
+        const size_t lightCount = s_Data.Lights.size();
+        s_Data.LightStorage.resize(lightCount);
+        s_Data.LightSpheres.resize(lightCount);
+        for (size_t i = 0; i < lightCount; i++)
         {
             const auto& L = s_Data.Lights[i];
-            std::string p = "u_Lights[" + std::to_string(i) + "].";
-            shader->SetInt   (p + "Type", L.Type);
-            shader->SetFloat3(p + "Position", L.Position);
-            shader->SetFloat3(p + "Direction", L.Direction);
-            shader->SetFloat3(p + "Color", L.Color);
-            shader->SetFloat (p + "Intensity", L.Intensity);
-            shader->SetFloat (p + "Radius", L.Radius);
-            shader->SetInt   (p + "CastShadows", L.CastShadows);
+            LightStorageData& data = s_Data.LightStorage[i];
+            data.PositionType = glm::vec4(L.Position, (float)L.Type);
+            data.DirectionRadius = glm::vec4(L.Direction, L.Radius);
+            data.ColorIntensity = glm::vec4(L.Color, L.Intensity);
+            data.Flags = glm::ivec4(L.CastShadows, s_Data.PointShadowValid ? s_Data.LightShadowSlot[i] : -1, 0, 0);
+            // Directional lights and lights without a radius light every cluster
+            s_Data.LightSpheres[i] = glm::vec4(L.Position, L.Type == 0 ? 0.0f : L.Radius);
         }
+        s_Data.LightClusters.Build(view, projection, s_Data.LightSpheres);
+
+        const auto& clusters = s_Data.LightClusters.GetClusters();
+        const auto& indices = s_Data.LightClusters.GetLightIndices();
+        s_Data.LightStorageBuffer->SetData(s_Data.LightStorage.data(), (uint32_t)(s_Data.LightStorage.size() * sizeof(LightStorageData)));
+        s_Data.ClusterStorageBuffer->SetData(clusters.data(), (uint32_t)(clusters.size() * sizeof(LightClusterGrid::ClusterRange)));
+        s_Data.LightIndexStorageBuffer->SetData(indices.data(), (uint32_t)(indices.size() * sizeof(uint32_t)));
+
+        s_Data.Stats.LightCount = (uint32_t)lightCount;
+        s_Data.Stats.MaxLightsPerCluster = s_Data.LightClusters.GetMaxLightsPerCluster();
+        s_Data.FrameUniformStamp++;
     }
     
     void Renderer3D::Init()
     {
         s_Data.CubeVertexArray = VertexArray::Create();
-        s_Data.CubeVertexBuffer = VertexBuffer::Create(sizeof(CubeVertex) * s_Data.MaxVertices);
+        // The shadow passes flush the cube batch several times a frame, give them room to pack into one region
+        s_Data.CubeVertexBuffer = StreamingVertexBuffer::Create(sizeof(CubeVertex) * s_Data.MaxVertices, 4);
         s_Data.CubeVertexBuffer->SetLayout({
         {"v_Position", ShaderDataType::Float3, false},
         {"v_Normal", ShaderDataType::Float3, false},
@@ -219,7 +483,6 @@ namespace HRealEngine
         {"v_EntityID", ShaderDataType::Int, false}
         });
         s_Data.CubeVertexArray->AddVertexBuffer(s_Data.CubeVertexBuffer);
-        s_Data.CubeVertexBufferBase = new CubeVertex[s_Data.MaxVertices];
         
         uint32_t* cubeIndices = new uint32_t[s_Data.MaxIndices];
         uint32_t offset = 0;
@@ -254,9 +517,19 @@ namespace HRealEngine
         s_Data.CubeShader = Shader::Create("assets/shaders/Cube_Shader3D.glsl");
         
         
-        s_Data.TextureSlots[0] = s_Data.WhiteTexture;
+        s_Data.TextureSlots.reserve(s_Data.MaxUserTextureSlots);
+        s_Data.TextureSlots.push_back(s_Data.WhiteTexture);
+        s_Data.bBindlessTextures = RenderCommand::SupportsBindlessTextures();
+        if (s_Data.bBindlessTextures)
+        {
+            s_Data.TextureHandles.push_back(s_Data.WhiteTexture->GetBindlessHandle());
+            s_Data.TextureHandleBuffer = StorageBuffer::Create(sizeof(uint64_t) * 256, s_Data.TextureHandleBinding);
+        }
 
         s_Data.CameraUniformBuffer = UniformBuffer::Create(sizeof(Renderer3DData::CameraData), 0);
+        s_Data.LightStorageBuffer = StorageBuffer::Create(sizeof(LightStorageData) * 64, 0);
+        s_Data.ClusterStorageBuffer = StorageBuffer::Create(sizeof(LightClusterGrid::ClusterRange) * LightClusterGrid::ClusterCount, 1);
+        s_Data.LightIndexStorageBuffer = StorageBuffer::Create(sizeof(uint32_t) * 1024, 2);
         
         // Front Face (Z = 0.5)
         s_Data.VertexPos[0] = {-0.5f, -0.5f,  0.5f, 1.0f}; s_Data.VertexUV[0] = {0, 0};
@@ -317,7 +590,11 @@ namespace HRealEngine
 
     void Renderer3D::Shutdown()
     {
-        delete[] s_Data.CubeVertexBufferBase;
+        s_Data.CubeVertexBuffer = nullptr;
+
+        s_Data.LightStorageBuffer = nullptr;
+        s_Data.ClusterStorageBuffer = nullptr;
+        s_Data.LightIndexStorageBuffer = nullptr;
 
         if (s_Data.ShadowDepthTexture)
         {
@@ -329,6 +606,16 @@ namespace HRealEngine
             glDeleteFramebuffers(1, &s_Data.ShadowFBO);
             s_Data.ShadowFBO = 0;
         }
+        if (s_Data.StaticShadowDepthTexture)
+        {
+            glDeleteTextures(1, &s_Data.StaticShadowDepthTexture);
+            s_Data.StaticShadowDepthTexture = 0;
+        }
+        if (s_Data.StaticShadowFBO)
+        {
+            glDeleteFramebuffers(1, &s_Data.StaticShadowFBO);
+            s_Data.StaticShadowFBO = 0;
+        }
         s_Data.ShadowDepthShader = nullptr;
         s_Data.ShadowValid = false;
         
@@ -384,7 +671,9 @@ namespace HRealEngine
         
         glm::vec3 camPos = glm::vec3(transform[3]);
         SetViewPosition(camPos);
+        UploadLightClusters(glm::inverse(transform), camera.GetProjectionMatrix());
         
+        BeginSceneSubmission(camera.GetProjectionMatrix());
         StartBatch();
     }
 
@@ -394,7 +683,9 @@ namespace HRealEngine
         s_Data.CameraUniformBuffer->SetData(&s_Data.CameraBuffer, sizeof(Renderer3DData::CameraData));
 
         SetViewPosition(camera.GetPosition());
+        UploadLightClusters(camera.GetViewMatrix(), camera.GetProjectionMatrix());
         
+        BeginSceneSubmission(camera.GetProjectionMatrix());
         StartBatch();
     }
 
@@ -406,8 +697,34 @@ namespace HRealEngine
     void Renderer3D::StartBatch()
     {
         s_Data.CubeIndexCount = 0;
+        s_Data.CubeVertexBufferBase = (CubeVertex*)s_Data.CubeVertexBuffer->Map();
         s_Data.CubeVertexBufferPtr = s_Data.CubeVertexBufferBase;
-        s_Data.TextureSlotIndex = 1;
+        s_Data.TextureSlots.resize(1);
+        s_Data.TextureSlotLookup.clear();
+        s_Data.TextureSlotLookup[s_Data.WhiteTexture->GetRendererID()] = 0;
+        if (s_Data.bBindlessTextures)
+            s_Data.TextureHandles.resize(1);
+    }
+
+    // Index of the texture in the cube batch, flushes first when the slots are full
+    static float GetCubeTextureIndex(const Ref<Texture2D>& texture)
+    {
+        auto it = s_Data.TextureSlotLookup.find(texture->GetRendererID());
+        if (it != s_Data.TextureSlotLookup.end())
+            return (float)it->second;
+
+        if (!s_Data.bBindlessTextures && s_Data.TextureSlots.size() >= s_Data.MaxUserTextureSlots)
+        {
+            Renderer3D::Flush();
+            Renderer3D::StartBatch();
+        }
+
+        const uint32_t index = (uint32_t)s_Data.TextureSlots.size();
+        s_Data.TextureSlots.push_back(texture);
+        if (s_Data.bBindlessTextures)
+            s_Data.TextureHandles.push_back(texture->GetBindlessHandle());
+        s_Data.TextureSlotLookup[texture->GetRendererID()] = index;
+        return (float)index;
     }
     
     void Renderer3D::Flush()
@@ -415,60 +732,55 @@ namespace HRealEngine
         if (s_Data.CubeIndexCount == 0)
             return;
 
-        const uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.CubeVertexBufferPtr - (uint8_t*)s_Data.CubeVertexBufferBase);
-        s_Data.CubeVertexBuffer->SetData(s_Data.CubeVertexBufferBase, dataSize);
+        const uint32_t baseVertex = s_Data.CubeVertexBuffer->GetBaseVertex();
+        const uint32_t usedSize = (uint32_t)((uint8_t*)s_Data.CubeVertexBufferPtr - (uint8_t*)s_Data.CubeVertexBufferBase);
 
         GLint currentFBOi = 0;
         glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &currentFBOi);
         const uint32_t currentFBO = (uint32_t)currentFBOi;
 
-        const bool dirShadowPass = s_Data.ShadowValid && currentFBO == s_Data.ShadowFBO;
+        const bool dirShadowPass = s_Data.ShadowValid && (currentFBO == s_Data.ShadowFBO || currentFBO == s_Data.StaticShadowFBO);
         const bool pointShadowPass = s_Data.PointShadowValid && currentFBO == s_Data.PointShadowFBO;
 
         if (dirShadowPass)
         {
+            // Batched cube vertices are already in world space
             s_Data.ShadowDepthShader->Bind();
-            RenderCommand::DrawIndexed(s_Data.CubeVertexArray, s_Data.CubeIndexCount);
+            s_Data.ShadowDepthShader->SetMat4("u_Transform", glm::mat4(1.0f));
+            RenderCommand::DrawIndexed(s_Data.CubeVertexArray, s_Data.CubeIndexCount, 0, baseVertex);
+            s_Data.CubeVertexBuffer->Commit(usedSize);
             return;
         }
         if (pointShadowPass)
         {
             s_Data.PointShadowDepthShader->Bind();
-            RenderCommand::DrawIndexed(s_Data.CubeVertexArray, s_Data.CubeIndexCount);
+            s_Data.PointShadowDepthShader->SetMat4("u_Model", glm::mat4(1.0f));
+            s_Data.PointShadowDepthShader->SetInt("u_FaceMask", (int)s_Data.PointShadowDirtyFaces);
+            RenderCommand::DrawIndexed(s_Data.CubeVertexArray, s_Data.CubeIndexCount, 0, baseVertex);
+            s_Data.CubeVertexBuffer->Commit(usedSize);
             return;
         }
         
-        for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
-            s_Data.TextureSlots[i]->Bind(i);
-
+        s_Data.CubeShader->SetKeywords(GetPassKeywords());
         s_Data.CubeShader->Bind();
 
-        int32_t samplers[30];
-        for (int i = 0; i < 30; i++)
-            samplers[i] = i;
-        s_Data.CubeShader->SetIntArray("u_textureSamplers", samplers, 30);
-
-        s_Data.CubeShader->SetInt("u_DebugView", Renderer::GetDebugView());
-
-        UploadLightsToShader(s_Data.CubeShader);
-        
-        if (s_Data.ShadowValid && s_Data.ShadowDepthTexture != 0)
+        if (s_Data.bBindlessTextures)
+            s_Data.TextureHandleBuffer->SetData(s_Data.TextureHandles.data(), (uint32_t)(s_Data.TextureHandles.size() * sizeof(uint64_t)));
+        else
         {
-            s_Data.CubeShader->SetInt("u_HasShadowMap", 1);
-            s_Data.CubeShader->SetMat4("u_LightSpaceMatrix", s_Data.LightSpaceMatrix);
-
-            const int shadowMapSlot = Renderer3DData::ReservedDirShadowSlot;
-            s_Data.CubeShader->SetInt("u_ShadowMap", shadowMapSlot);
+            for (uint32_t i = 0; i < (uint32_t)s_Data.TextureSlots.size(); i++)
+                s_Data.TextureSlots[i]->Bind(i);
 
-            glActiveTexture(GL_TEXTURE0 + shadowMapSlot);
-            glBindTexture(GL_TEXTURE_2D, s_Data.ShadowDepthTexture);
+            int32_t samplers[30];
+            for (int i = 0; i < 30; i++)
+                samplers[i] = i;
+            s_Data.CubeShader->SetIntArray("u_textureSamplers", samplers, 30);
         }
-        else
-            s_Data.CubeShader->SetInt("u_HasShadowMap", 0);
 
-        UploadPointShadowArrayToShader(s_Data.CubeShader);
+        UploadFrameUniforms(s_Data.CubeShader);
 
-        RenderCommand::DrawIndexed(s_Data.CubeVertexArray, s_Data.CubeIndexCount);
+        RenderCommand::DrawIndexed(s_Data.CubeVertexArray, s_Data.CubeIndexCount, 0, baseVertex);
+        s_Data.CubeVertexBuffer->Commit(usedSize);
         // s_Data.Stats.DrawCalls++;
     }
 
@@ -502,54 +814,72 @@ namespace HRealEngine
     void Renderer3D::SetViewPosition(const glm::vec3& pos)
     {
         s_Data.ViewPos = pos;
-        s_Data.LightsDirty = true;
+        s_Data.FrameUniformStamp++;
     }
 
     void Renderer3D::SetLights(const std::vector<LightGPU>& lights)
     {
-        s_Data.LightCount = (int)std::min<size_t>(lights.size(), 16);
-        for (int i = 0; i < s_Data.LightCount; i++)
-            s_Data.Lights[i] = lights[i];
-        s_Data.LightsDirty = true;
+        s_Data.Lights = lights;
+        // Slots follow the light IDs, the shadow pass may be skipped this frame and lights can be reordered or removed meanwhile
+        s_Data.LightShadowSlot.assign(lights.size(), -1);
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            if (lights[i].ID == 0)
+                continue;
+            for (uint32_t slot = 0; slot < MaxPointShadowCasters; slot++)
+                if (s_Data.PointShadowSlotLightID[slot] == lights[i].ID)
+                {
+                    s_Data.LightShadowSlot[i] = (int)slot;
+                    break;
+                }
+        }
+        s_Data.FrameUniformStamp++;
     }
 
 
     Ref<MeshGPU> Renderer3D::BuildStaticMeshGPU(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices, const Ref<Shader>& shader, glm::vec3& inMin, glm::vec3& inMax)
+    {
+        return BuildStaticMeshGPU(vertices.data(), (uint32_t)vertices.size(), HMeshBinVertexFormat::Float, indices.data(), (uint32_t)indices.size(),
+            shader, inMin, inMax);
+    }
+
+    Ref<MeshGPU> Renderer3D::BuildStaticMeshGPU(const void* vertexData, uint32_t vertexCount, HMeshBinVertexFormat vertexFormat, const uint32_t* indices, uint32_t indexCount,
+        const Ref<Shader>& shader, glm::vec3& inMin, glm::vec3& inMax)
     {
         Ref<MeshGPU> mesh = CreateRef<MeshGPU>();
         mesh->VAO = VertexArray::Create();
         mesh->Shader = shader;
         mesh->BoundsMax = inMax;
         mesh->BoundsMin = inMin;
+        mesh->VertexFormat = vertexFormat;
 
-        constexpr uint32_t kFloatsPerVertex = 14;
-
-        std::vector<float> packed;
-        packed.reserve(vertices.size() * kFloatsPerVertex);
+        const uint32_t vbSizeBytes = vertexCount * MeshLoader::GetVertexStride(vertexFormat);
+        Ref<VertexBuffer> vbo = VertexBuffer::Create(vertexData, vbSizeBytes);
 
-        for (const MeshVertex& v : vertices)
+        // Same attribute locations for both formats, the shader decodes the quantized ones
+        if (vertexFormat == HMeshBinVertexFormat::Quantized)
         {
-            packed.push_back(v.Position.x); packed.push_back(v.Position.y); packed.push_back(v.Position.z);
-            packed.push_back(v.Normal.x);   packed.push_back(v.Normal.y);   packed.push_back(v.Normal.z);
-            packed.push_back(v.UV.x);       packed.push_back(v.UV.y);
+            vbo->SetLayout({
+                { "a_Position", ShaderDataType::UShort4, true },
+                { "a_Normal",   ShaderDataType::Short2,  true },
+                { "a_TexCoord", ShaderDataType::Half2,   false }
+            });
+        }
+        else
+        {
+            vbo->SetLayout({
+                { "a_Position", ShaderDataType::Float3, false },
+                { "a_Normal",   ShaderDataType::Float3, false },
+                { "a_TexCoord", ShaderDataType::Float2, false }
+            });
         }
-
-        const uint32_t vbSizeBytes = (uint32_t)(packed.size() * sizeof(float));
-        Ref<VertexBuffer> vbo = VertexBuffer::Create(packed.data(), vbSizeBytes);
-
-        BufferLayout layout = {
-            { "a_Position", ShaderDataType::Float3, false },
-            { "a_Normal",   ShaderDataType::Float3, false },
-            { "a_TexCoord", ShaderDataType::Float2, false }
-        };
-        vbo->SetLayout(layout);
 
         mesh->VAO->AddVertexBuffer(vbo);
 
-        Ref<IndexBuffer> ibo = IndexBuffer::Create((uint32_t*)indices.data(), (uint32_t)indices.size());
+        Ref<IndexBuffer> ibo = IndexBuffer::Create(indices, indexCount);
         mesh->VAO->SetIndexBuffer(ibo);
 
-        mesh->IndexCount = (uint32_t)indices.size();
+        mesh->IndexCount = indexCount;
         return mesh;
     }
     
@@ -564,54 +894,44 @@ namespace HRealEngine
 
             glm::mat4 pivotMat = glm::translate(glm::mat4(1.0f), -meshRenderer.PivotOffset);
             glm::mat4 finalTransform = transform * pivotMat;
+            if (!IsMeshVisible(finalTransform, meshGPU->BoundsMin, meshGPU->BoundsMax))
+                return;
+
+            const uint32_t lod = SelectMeshLod(*meshGPU, finalTransform);
+            const std::vector<HMeshBinSubmesh>& submeshes = lod > 0 ? meshGPU->Lods[lod - 1].Submeshes : meshGPU->Submeshes;
+            const uint32_t indexCount = lod > 0 ? meshGPU->Lods[lod - 1].IndexCount : meshGPU->IndexCount;
+            const uint32_t indexOffset = lod > 0 ? meshGPU->Lods[lod - 1].IndexOffset : 0;
+            s_Data.Stats.MeshTriangles += indexCount / 3;
             
-            meshGPU->Shader->Bind();
-            meshGPU->Shader->SetInt("u_EntityID", entityID);
-            //meshRenderer.Mesh->Shader->SetFloat4("u_Color", meshRenderer.Color);
-            meshGPU->Shader->SetMat4("u_ViewProjection", s_Data.CameraBuffer.ViewProjectionMatrix);
-            meshGPU->Shader->SetMat4("u_Transform", finalTransform);
-            meshGPU->Shader->SetInt("u_DebugView", Renderer::GetDebugView());
-            
-            if (s_Data.LightsDirty)
+            const Ref<Shader>& shader = meshGPU->Shader;
+            uint64_t passKeywords = GetPassKeywords();
+            if (meshGPU->VertexFormat == HMeshBinVertexFormat::Quantized)
+                passKeywords |= ShaderKeyword::QuantizedVertices;
+
+            // Submeshes can pick different variants, the draw uniforms go to each variant once
+            uint64_t uploadedKeywords = ~0ull;
+            auto uploadDrawUniforms = [&]()
             {
-                UploadLightsToShader(meshGPU->Shader);
-                s_Data.LightsDirty = false;
-            }
-            
-            if (s_Data.ShadowValid && s_Data.ShadowDepthTexture != 0)
+                if (shader->GetKeywords() == uploadedKeywords)
+                    return;
+                uploadedKeywords = shader->GetKeywords();
+                shader->SetInt("u_EntityID", entityID);
+                shader->SetMat4("u_ViewProjection", s_Data.CameraBuffer.ViewProjectionMatrix);
+                shader->SetMat4("u_Transform", finalTransform);
+                shader->SetFloat3("u_PositionMin", meshGPU->BoundsMin);
+                shader->SetFloat3("u_PositionExtent", meshGPU->BoundsMax - meshGPU->BoundsMin);
+                UploadFrameUniforms(shader);
+            };
+            auto applyDefaultMaterial = [&]()
             {
-                meshGPU->Shader->SetInt("u_HasShadowMap", 1);
-                meshGPU->Shader->SetMat4("u_LightSpaceMatrix", s_Data.LightSpaceMatrix);
-                meshGPU->Shader->SetFloat("u_ShadowBias", s_Data.ShadowBias);
-                
-                meshGPU->Shader->SetInt("u_ShadowMap", 31);
-                glActiveTexture(GL_TEXTURE0 + 31);
-                glBindTexture(GL_TEXTURE_2D, s_Data.ShadowDepthTexture);
-            }
-            else
-                meshGPU->Shader->SetInt("u_HasShadowMap", 0);
-            /*if (HasPointShadowMap())
-            {
-                meshGPU->Shader->SetInt("u_HasPointShadowMap", 1);
-                meshGPU->Shader->SetFloat3("u_PointShadowLightPos", GetPointShadowLightPos());
-                meshGPU->Shader->SetFloat("u_PointShadowFarPlane", GetPointShadowFarPlane());
-
-                const int pointShadowSlot = 30; // pick a free slot (you used 15 for 2D shadow map)
-                meshGPU->Shader->SetInt("u_PointShadowMap", pointShadowSlot);
-
-                glActiveTexture(GL_TEXTURE0 + pointShadowSlot);
-                glBindTexture(GL_TEXTURE_CUBE_MAP, GetPointShadowMapRendererID());
-            }
-            else
-            {
-                meshGPU->Shader->SetInt("u_HasPointShadowMap", 0);
-            }*/
-            UploadPointShadowArrayToShader(meshGPU->Shader);
+                shader->SetKeywords(passKeywords);
+                shader->Bind();
+                shader->SetFloat4("u_Color", meshRenderer.Color);
+            };
 
-            
-            if (!meshGPU->Submeshes.empty())
+            if (!submeshes.empty())
             {
-                for (const auto& sm : meshGPU->Submeshes)
+                for (const auto& sm : submeshes)
                 {
                     if (sm.IndexCount == 0)
                         continue;
@@ -621,35 +941,30 @@ namespace HRealEngine
                     AssetHandle matHandle = 0;
                     if (slot < meshRenderer.MaterialHandleOverrides.size())
                         matHandle = meshRenderer.MaterialHandleOverrides[slot];
-                    if (matHandle != 0)
-                    {
-                        Ref<HMaterial> mat = AssetManager::GetAsset<HMaterial>(matHandle);
-                        if (mat)
-                            mat->Apply(meshGPU->Shader);
-                        else
-                        {
-                            meshGPU->Shader->SetInt("u_HasAlbedo", 0);
-                            meshGPU->Shader->SetFloat4("u_Color", meshRenderer.Color);
-                        }
-                    }
+                    Ref<HMaterial> mat = matHandle != 0 ? AssetManager::GetAsset<HMaterial>(matHandle) : nullptr;
+                    if (mat)
+                        mat->Apply(shader, passKeywords);
                     else
-                    {
-                        meshGPU->Shader->SetInt("u_HasAlbedo", 0);
-                        meshGPU->Shader->SetFloat4("u_Color", meshRenderer.Color);
-                    }
+                        applyDefaultMaterial();
+                    uploadDrawUniforms();
 
                     RenderCommand::DrawIndexed(meshGPU->VAO, sm.IndexCount, sm.IndexOffset);
                 }
             }
             else
             {
-                meshGPU->Shader->SetInt("u_HasAlbedo", 0);
-                meshGPU->Shader->SetFloat4("u_Color", meshRenderer.Color);
-                RenderCommand::DrawIndexed(meshGPU->VAO, meshGPU->IndexCount);
+                applyDefaultMaterial();
+                uploadDrawUniforms();
+                RenderCommand::DrawIndexed(meshGPU->VAO, indexCount, indexOffset);
             }
             return;
         }
 
+        glm::mat4 pivotMat = glm::translate(glm::mat4(1.0f), -meshRenderer.PivotOffset);
+        glm::mat4 finalTransform = transform * pivotMat;
+        if (!IsMeshVisible(finalTransform, glm::vec3(-0.5f), glm::vec3(0.5f)))
+            return;
+
         if (s_Data.CubeIndexCount >= s_Data.MaxIndices)
         {
             Flush();
@@ -660,29 +975,9 @@ namespace HRealEngine
         if(meshRenderer.Texture)
         {
             Ref<Texture2D> texture = AssetManager::GetAsset<Texture2D>(meshRenderer.Texture);
-            for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
-            {
-                if (*s_Data.TextureSlots[i] == *texture)
-                {
-                    textureIndex = (float)i;
-                    break;
-                }
-            }
-            if (textureIndex == 0.0f)
-            {
-                if (s_Data.TextureSlotIndex >= s_Data.MaxUserTextureSlots/*MaxTextureSlots*/)
-                {
-                    Flush();
-                    StartBatch();
-                }
-                textureIndex = (float)s_Data.TextureSlotIndex;
-                s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-                s_Data.TextureSlotIndex++;
-            }
+            textureIndex = GetCubeTextureIndex(texture);
         }
         
-        glm::mat4 pivotMat = glm::translate(glm::mat4(1.0f), -meshRenderer.PivotOffset);
-        glm::mat4 finalTransform = transform * pivotMat;
         const glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(finalTransform)));
         for (size_t i = 0; i < 24; i++)
         {
@@ -703,7 +998,54 @@ namespace HRealEngine
         // s_Data.Stats.CubeCount++;
     }
 
-    void Renderer3D::BeginShadowPass(const glm::vec3& lightDirection, const glm::vec3& focusPosition)
+    void Renderer3D::SubmitOccluder(const glm::mat4& transform, const MeshRendererComponent& meshRenderer)
+    {
+        if (!s_Data.bOcclusionCulling)
+            return;
+
+        const glm::mat4 finalTransform = transform * glm::translate(glm::mat4(1.0f), -meshRenderer.PivotOffset);
+        if (meshRenderer.Mesh)
+        {
+            auto meshGPU = AssetManager::GetAsset<MeshGPU>(meshRenderer.Mesh);
+            if (!meshGPU || !MeshLoader::BuildOccluder(*meshGPU))
+                return;
+            s_Data.Occlusion.RasterizeOccluder(finalTransform, meshGPU->OccluderPositions.data(), meshGPU->OccluderIndices.data(), meshGPU->OccluderIndices.size());
+        }
+        else
+        {
+            static const uint32_t s_FaceIndices[6] = { 0, 1, 2, 2, 3, 0 };
+            glm::vec3 positions[24];
+            uint32_t indices[36];
+            for (uint32_t i = 0; i < 24; i++)
+                positions[i] = glm::vec3(s_Data.VertexPos[i]);
+            for (uint32_t i = 0; i < 36; i++)
+                indices[i] = (i / 6) * 4 + s_FaceIndices[i % 6];
+            s_Data.Occlusion.RasterizeOccluder(finalTransform, positions, indices, 36);
+        }
+        s_Data.Stats.OccluderCount++;
+    }
+
+    void Renderer3D::SetLodBias(float bias)
+    {
+        s_Data.LodBias = glm::max(bias, 0.01f);
+    }
+
+    float Renderer3D::GetLodBias()
+    {
+        return s_Data.LodBias;
+    }
+
+    void Renderer3D::SetOcclusionCullingEnabled(bool enabled)
+    {
+        s_Data.bOcclusionCulling = enabled;
+    }
+
+    bool Renderer3D::IsOcclusionCullingEnabled()
+    {
+        return s_Data.bOcclusionCulling;
+    }
+
+    void Renderer3D::BeginShadowPass(const glm::vec3& lightDirection, const glm::mat4& cameraView, const glm::mat4& cameraProjection)
     {
         CreateShadowResources();
             
@@ -716,38 +1058,69 @@ namespace HRealEngine
             
         const glm::vec3 dir = glm::normalize(lightDirection);
         s_Data.ShadowLightDir = dir;
-            
-        const float orthoRange = 120.0f;
-        const float nearPlane = -200.0f;
-        const float farPlane = 200.0f;
-        
-        const glm::vec3 up = (glm::abs(dir.y) > 0.99f) ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
-            
-        const glm::vec3 lightPos = focusPosition - dir * 30.0f;
-
-        const glm::mat4 lightView = glm::lookAt(lightPos, focusPosition, up);
-        const glm::mat4 lightProj = glm::ortho(-orthoRange, orthoRange, -orthoRange, orthoRange, nearPlane, farPlane);
-
-        s_Data.LightSpaceMatrix = lightProj * lightView;
+        ComputeShadowCascades(dir, cameraView, cameraProjection);
+
+        // A cached static layer stays valid as long as its cascade window and the light did not move
+        uint32_t staleMask = 0;
+        const bool bAllStale = s_Data.bStaticShadowsDirty || dir != s_Data.StaticShadowLightDir;
+        for (uint32_t i = 0; i < ShadowCascadeCount; i++)
+            if (bAllStale || s_Data.CascadeMatrices[i] != s_Data.StaticCascadeMatrices[i])
+                staleMask |= 1u << i;
+        s_Data.StaleStaticCascadeMask = staleMask;
             
         glViewport(0, 0, (GLsizei)s_Data.ShadowMapSize, (GLsizei)s_Data.ShadowMapSize);
-        glBindFramebuffer(GL_FRAMEBUFFER, s_Data.ShadowFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
-            
         glEnable(GL_CULL_FACE);
         glCullFace(GL_FRONT);
-            
-        s_Data.ShadowDepthShader->Bind();
-        s_Data.ShadowDepthShader->SetMat4("u_LightSpaceMatrix", s_Data.LightSpaceMatrix);
 
         s_Data.ShadowValid = true;
-            
-        s_Data.CameraBuffer.ViewProjectionMatrix = s_Data.LightSpaceMatrix;
-        s_Data.CameraUniformBuffer->SetData(&s_Data.CameraBuffer, sizeof(Renderer3DData::CameraData));
+    }
 
+    bool Renderer3D::BeginStaticShadowCasters()
+    {
+        if (!s_Data.ShadowValid || s_Data.StaleStaticCascadeMask == 0)
+            return false;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, s_Data.StaticShadowFBO);
+        const float clearDepth = 1.0f;
+        for (uint32_t i = 0; i < ShadowCascadeCount; i++)
+            if (s_Data.StaleStaticCascadeMask & (1u << i))
+                glClearTexSubImage(s_Data.StaticShadowDepthTexture, 0, 0, 0, (GLint)i,
+                    (GLsizei)s_Data.ShadowMapSize, (GLsizei)s_Data.ShadowMapSize, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
+
+        UploadCascadesToShadowShader(s_Data.StaleStaticCascadeMask);
         StartBatch();
+        return true;
+    }
+
+    void Renderer3D::EndStaticShadowCasters()
+    {
+        Flush();
+
+        for (uint32_t i = 0; i < ShadowCascadeCount; i++)
+            if (s_Data.StaleStaticCascadeMask & (1u << i))
+                s_Data.StaticCascadeMatrices[i] = s_Data.CascadeMatrices[i];
+        s_Data.StaticShadowLightDir = s_Data.ShadowLightDir;
+        s_Data.StaleStaticCascadeMask = 0;
+        s_Data.bStaticShadowsDirty = false;
     }
 
+    void Renderer3D::BeginDynamicShadowCasters()
+    {
+        if (!s_Data.ShadowValid)
+            return;
+
+        // Stale layers nobody refreshed this frame are cleared so old static casters do not linger
+        if (BeginStaticShadowCasters())
+            EndStaticShadowCasters();
+
+        glCopyImageSubData(s_Data.StaticShadowDepthTexture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+            s_Data.ShadowDepthTexture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+            (GLsizei)s_Data.ShadowMapSize, (GLsizei)s_Data.ShadowMapSize, (GLsizei)ShadowCascadeCount);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, s_Data.ShadowFBO);
+        UploadCascadesToShadowShader((1u << ShadowCascadeCount) - 1);
+        StartBatch();
+    }
 
     void Renderer3D::EndShadowPass()
     {
@@ -759,6 +1132,11 @@ namespace HRealEngine
         glCullFace(GL_BACK);
     }
 
+    void Renderer3D::InvalidateStaticShadows()
+    {
+        s_Data.bStaticShadowsDirty = true;
+    }
+
     void Renderer3D::DrawMeshShadow(const glm::mat4& transform, MeshRendererComponent& meshRenderer)
     {
         if (!s_Data.ShadowValid)
@@ -770,8 +1148,9 @@ namespace HRealEngine
             if (!meshGPU || !meshGPU->VAO)
                 return;
 
+            glm::mat4 pivotMat = glm::translate(glm::mat4(1.0f), -meshRenderer.PivotOffset);
             s_Data.ShadowDepthShader->Bind();
-            s_Data.ShadowDepthShader->SetMat4("u_Transform", transform);
+            s_Data.ShadowDepthShader->SetMat4("u_Transform", transform * pivotMat * GetDequantizeTransform(*meshGPU));
 
             if (!meshGPU->Submeshes.empty())
                 for (const auto& sm : meshGPU->Submeshes)
@@ -785,7 +1164,7 @@ namespace HRealEngine
             return;
         }
         
-        /*if (s_Data.CubeIndexCount >= s_Data.MaxIndices)*/if (s_Data.TextureSlotIndex >= s_Data.MaxTextureSlots)
+        if (s_Data.CubeIndexCount >= s_Data.MaxIndices)
         {
             Flush();
             StartBatch();
@@ -798,9 +1177,7 @@ namespace HRealEngine
             glm::vec4 worldPos4 = transform * s_Data.VertexPos[i];
             
             s_Data.CubeVertexBufferPtr->Position = glm::vec3(worldPos4);
-            
-            glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(transform)));
-            s_Data.CubeVertexBufferPtr->Normal = glm::normalize(normalMat * s_Data.VertexNormal[i]);
+            s_Data.CubeVertexBufferPtr->Normal = s_Data.VertexNormal[i];// depth only, the normal is never read
 
             s_Data.CubeVertexBufferPtr->Color = meshRenderer.Color;
             s_Data.CubeVertexBufferPtr->TexCoord = s_Data.VertexUV[i];
@@ -814,13 +1191,14 @@ namespace HRealEngine
         s_Data.CubeIndexCount += 36;
     }
     
-    void Renderer3D::DrawMeshPointShadow(const glm::mat4& transform, MeshRendererComponent& meshRenderer)
+    void Renderer3D::DrawMeshPointShadow(const glm::mat4& transform, MeshRendererComponent& meshRenderer, uint32_t faceMask)
     {
         if (!s_Data.PointShadowValid)
             return;
-
-        s_Data.PointShadowDepthShader->Bind();
-        s_Data.PointShadowDepthShader->SetMat4("u_Model", transform); 
+        faceMask &= s_Data.PointShadowDirtyFaces;
+        if (faceMask == 0)
+            return;
+        s_Data.Stats.PointShadowCasterCounts[s_Data.CurrentPointShadowCaster]++;
         
         if (meshRenderer.Mesh)
         {
@@ -828,6 +1206,11 @@ namespace HRealEngine
             if (!meshGPU || !meshGPU->VAO)
                 return;
 
+            glm::mat4 pivotMat = glm::translate(glm::mat4(1.0f), -meshRenderer.PivotOffset);
+            s_Data.PointShadowDepthShader->Bind();
+            s_Data.PointShadowDepthShader->SetMat4("u_Model", transform * pivotMat * GetDequantizeTransform(*meshGPU));
+            s_Data.PointShadowDepthShader->SetInt("u_FaceMask", (int)faceMask);
+
             if (!meshGPU->Submeshes.empty())
             {
                 for (const auto& sm : meshGPU->Submeshes)
@@ -843,25 +1226,72 @@ namespace HRealEngine
             return; 
         }
         
-        CubeVertex* ptr = s_Data.CubeVertexBufferBase;
+        // Cubes go into the batch in world space and are drawn to every dirty face when the caster ends
+        if (s_Data.CubeIndexCount >= s_Data.MaxIndices)
+        {
+            Flush();
+            StartBatch();
+        }
         for (size_t i = 0; i < 24; i++)
         {
             glm::vec4 wp = transform * s_Data.VertexPos[i];
-            ptr->Position = glm::vec3(wp);
+            s_Data.CubeVertexBufferPtr->Position = glm::vec3(wp);
 
-            ptr->Normal = glm::vec3(0.0f); 
-            ptr->Color = glm::vec4(0.0f);
-            ptr->TexCoord = glm::vec2(0.0f);
-            ptr->TexIndex = 0.0f;
-            ptr->TilingFactor = 1.0f;
-            ptr->EntityID = -1;
+            s_Data.CubeVertexBufferPtr->Normal = glm::vec3(0.0f); 
+            s_Data.CubeVertexBufferPtr->Color = glm::vec4(0.0f);
+            s_Data.CubeVertexBufferPtr->TexCoord = glm::vec2(0.0f);
+            s_Data.CubeVertexBufferPtr->TexIndex = 0.0f;
+            s_Data.CubeVertexBufferPtr->TilingFactor = 1.0f;
+            s_Data.CubeVertexBufferPtr->EntityID = -1;
+
+            s_Data.CubeVertexBufferPtr++;
+        }
+        s_Data.CubeIndexCount += 36;
+    }
 
-            ptr++;
+    bool Renderer3D::GetWorldBoundingSphere(const glm::mat4& transform, const MeshRendererComponent& meshRenderer, glm::vec3& outCenter, float& outRadius)
+    {
+        glm::vec3 localMin(-0.5f), localMax(0.5f);
+        if (meshRenderer.Mesh)
+        {
+            auto meshGPU = AssetManager::GetAsset<MeshGPU>(meshRenderer.Mesh);
+            if (!meshGPU)
+                return false;
+            localMin = meshGPU->BoundsMin - meshRenderer.PivotOffset;
+            localMax = meshGPU->BoundsMax - meshRenderer.PivotOffset;
         }
+        const float maxScale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        outCenter = glm::vec3(transform * glm::vec4((localMin + localMax) * 0.5f, 1.0f));
+        outRadius = glm::length(localMax - localMin) * 0.5f * maxScale;
+        return true;
+    }
 
-        s_Data.CubeVertexBuffer->SetData(s_Data.CubeVertexBufferBase, 24 * sizeof(CubeVertex));
+    uint32_t Renderer3D::GetPointShadowFaceMask(const glm::vec3& lightPosition, float farPlane, const glm::vec3& center, float radius)
+    {
+        const glm::vec3 c = center - lightPosition;
+        if (glm::length(c) - radius > farPlane)
+            return 0;
+
+        // Each face frustum is bounded by the four 45 degree planes around its axis, same face order as the shadow matrices
+        const float slack = radius * glm::root_two<float>();
+        uint32_t mask = 0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const int b = (axis + 1) % 3;
+            const int d = (axis + 2) % 3;
+            for (int side = 0; side < 2; side++)
+            {
+                const float a = side == 0 ? c[axis] : -c[axis];
+                if (a - c[b] >= -slack && a + c[b] >= -slack && a - c[d] >= -slack && a + c[d] >= -slack)
+                    mask |= 1u << (axis * 2 + side);
+            }
+        }
+        return mask;
+    }
 
-        RenderCommand::DrawIndexed(s_Data.CubeVertexArray, 36);
+    Renderer3D::Statistics Renderer3D::GetStats()
+    {
+        return s_Data.Stats;
     }
     
     void Renderer3D::BeginPointShadowAtlas()
@@ -869,11 +1299,12 @@ namespace HRealEngine
         CreatePointShadowResources();
 
         // reset
-        for (int i = 0; i < 16; i++)
+        std::fill(s_Data.LightShadowSlot.begin(), s_Data.LightShadowSlot.end(), -1);
+        for (uint32_t i = 0; i < MaxPointShadowCasters; i++)
         {
-            s_Data.PointShadowIndex[i] = -1;
             s_Data.PointShadowLightPos[i] = glm::vec3(0.0f);
             s_Data.PointShadowFarPlane[i] = 1.0f;
+            s_Data.PointShadowSlotLightID[i] = 0;
         }
 
         glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &s_Data.OldFBO);
@@ -883,6 +1314,11 @@ namespace HRealEngine
         glDepthMask(GL_TRUE);
         glDisable(GL_BLEND);
 
+        s_Data.Stats.PointShadowLights = 0;
+        s_Data.Stats.PointShadowCasterCounts.fill(0);
+        s_Data.Stats.PointShadowFacesRendered = 0;
+        s_Data.Stats.PointShadowFacesCached = 0;
+
         glViewport(0, 0, (GLsizei)s_Data.PointShadowMapSize, (GLsizei)s_Data.PointShadowMapSize);
         glBindFramebuffer(GL_FRAMEBUFFER, s_Data.PointShadowFBO);
 
@@ -893,22 +1329,40 @@ namespace HRealEngine
     }
 
 
-    void Renderer3D::BeginPointShadowCaster(uint32_t casterIndex, int lightIndex,
-        const glm::vec3& lightPosition, float farPlane)
+    uint32_t Renderer3D::BeginPointShadowCaster(uint32_t casterIndex, int lightIndex,
+        const glm::vec3& lightPosition, float farPlane, const size_t faceSignatures[6])
     {
-        if (casterIndex >= s_Data.MaxPointShadowCasters)
-            return;
-        if (lightIndex < 0 || lightIndex >= 16)
-            return;
+        if (casterIndex >= MaxPointShadowCasters)
+            return 0;
+        if (lightIndex < 0 || lightIndex >= (int)s_Data.Lights.size())
+            return 0;
 
         const int layerOffset = (int)casterIndex * 6;
 
-        // Clear only this caster’s 6 layers
+        // A face only has to be re-rendered when its casters or the light changed since it was last drawn
+        uint32_t dirtyFaces = 0;
+        auto& slotSignatures = s_Data.PointShadowFaceSignatures[casterIndex];
+        for (int face = 0; face < 6; face++)
+        {
+            size_t signature = faceSignatures[face];
+            for (int i = 0; i < 3; i++)
+                HashCombine(signature, std::hash<float>()(lightPosition[i]));
+            HashCombine(signature, std::hash<float>()(farPlane));
+
+            if (!s_Data.PointShadowSlotValid[casterIndex] || slotSignatures[face] != signature)
+                dirtyFaces |= 1u << face;
+            slotSignatures[face] = signature;
+        }
+        s_Data.PointShadowSlotValid[casterIndex] = true;
+
+        // Clear only the dirty layers of this caster
         const float clearDepth = 1.0f;
-        glClearTexSubImage(s_Data.PointShadowDepthCubemapArray, 0,
-            0, 0, layerOffset,
-            (GLsizei)s_Data.PointShadowMapSize, (GLsizei)s_Data.PointShadowMapSize, 6,
-            GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
+        for (int face = 0; face < 6; face++)
+            if (dirtyFaces & (1u << face))
+                glClearTexSubImage(s_Data.PointShadowDepthCubemapArray, 0,
+                    0, 0, layerOffset + face,
+                    (GLsizei)s_Data.PointShadowMapSize, (GLsizei)s_Data.PointShadowMapSize, 1,
+                    GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
 
         // Build shadow matrices
         glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, farPlane);
@@ -928,13 +1382,27 @@ namespace HRealEngine
         s_Data.PointShadowDepthShader->SetFloat3("u_LightPos", lightPosition);
         s_Data.PointShadowDepthShader->SetFloat("u_FarPlane", farPlane);
         s_Data.PointShadowDepthShader->SetInt("u_LayerOffset", layerOffset);
+        s_Data.PointShadowDepthShader->SetInt("u_FaceMask", (int)dirtyFaces);
 
         // Store per-light lookup for shading
-        s_Data.PointShadowIndex[lightIndex] = (int)casterIndex;
-        s_Data.PointShadowLightPos[lightIndex] = lightPosition;
-        s_Data.PointShadowFarPlane[lightIndex] = farPlane;
+        s_Data.LightShadowSlot[lightIndex] = (int)casterIndex;
+        s_Data.PointShadowSlotLightID[casterIndex] = s_Data.Lights[lightIndex].ID;
+        s_Data.PointShadowLightPos[casterIndex] = lightPosition;
+        s_Data.PointShadowFarPlane[casterIndex] = farPlane;
+
+        s_Data.CurrentPointShadowCaster = casterIndex;
+        s_Data.PointShadowDirtyFaces = dirtyFaces;
+        s_Data.Stats.PointShadowLights++;
+        for (int face = 0; face < 6; face++)
+        {
+            if (dirtyFaces & (1u << face))
+                s_Data.Stats.PointShadowFacesRendered++;
+            else
+                s_Data.Stats.PointShadowFacesCached++;
+        }
 
         StartBatch();
+        return dirtyFaces;
     }
 
     void Renderer3D::EndPointShadowAtlas()
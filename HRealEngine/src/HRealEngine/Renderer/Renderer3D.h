@@ -30,26 +30,67 @@ namespace HRealEngine
             float Intensity;
             float Radius;
             int CastShadows;
+            uint64_t ID = 0; // stable across frames, a light keeps its point shadow slot by it while shadow refreshes are skipped
         };
 
         static void SetLights(const std::vector<LightGPU>& lights);
         static void SetViewPosition(const glm::vec3& pos);
         
         static Ref<MeshGPU> BuildStaticMeshGPU(const std::vector<MeshVertex>& vertices, const std::vector<uint32_t>& indices,const Ref<Shader>& shader, glm::vec3& inMin, glm::vec3& inMax);
+        // Uploads vertexData and indices as they are (straight from a mapped HMeshBin), vertexData laid out as vertexFormat
+        static Ref<MeshGPU> BuildStaticMeshGPU(const void* vertexData, uint32_t vertexCount, HMeshBinVertexFormat vertexFormat, const uint32_t* indices, uint32_t indexCount,
+            const Ref<Shader>& shader, glm::vec3& inMin, glm::vec3& inMax);
         static void DrawMesh(const glm::mat4& transform, MeshRendererComponent& meshRenderer, int entityID = -1);
+        // Occluders go into the CPU depth buffer, submit them after BeginScene and before the DrawMesh calls they should hide
+        static void SubmitOccluder(const glm::mat4& transform, const MeshRendererComponent& meshRenderer);
+        // Above 1 meshes switch to their coarser LOD levels sooner, below 1 later
+        static void SetLodBias(float bias);
+        static float GetLodBias();
+        static void SetOcclusionCullingEnabled(bool enabled);
+        static bool IsOcclusionCullingEnabled();
         
-        static void BeginShadowPass(const glm::vec3& lightDirection, const glm::vec3& focusPosition);
+        static constexpr uint32_t ShadowCascadeCount = 4;
+        // Directional shadows use cascades fitted to the camera frustum. Static casters live in cached layers:
+        // submit them between Begin/EndStaticShadowCasters only when BeginStaticShadowCasters returns true,
+        // then submit the dynamic casters after BeginDynamicShadowCasters every frame.
+        static void BeginShadowPass(const glm::vec3& lightDirection, const glm::mat4& cameraView, const glm::mat4& cameraProjection);
+        static bool BeginStaticShadowCasters();
+        static void EndStaticShadowCasters();
+        static void BeginDynamicShadowCasters();
         static void EndShadowPass();
+        static void InvalidateStaticShadows();
         static void DrawMeshShadow(const glm::mat4& transform, MeshRendererComponent& meshRenderer);
         
-        // Renderer3D.h
-        static void DrawMeshPointShadow(const glm::mat4& transform, MeshRendererComponent& meshRenderer);
+        static constexpr uint32_t MaxPointShadowCasters = 8;
+        // faceMask limits the draw to the cube faces the caster touches, see GetPointShadowFaceMask
+        static void DrawMeshPointShadow(const glm::mat4& transform, MeshRendererComponent& meshRenderer, uint32_t faceMask = 0x3F);
         static void BeginPointShadowAtlas();
-        static void BeginPointShadowCaster(uint32_t casterIndex, int lightIndex, const glm::vec3& lightPosition, float farPlane);
+        // faceSignatures identify what each cube face would contain, returns the faces that changed and have to be drawn
+        static uint32_t BeginPointShadowCaster(uint32_t casterIndex, int lightIndex, const glm::vec3& lightPosition, float farPlane, const size_t faceSignatures[6]);
+        static uint32_t GetPointShadowFaceMask(const glm::vec3& lightPosition, float farPlane, const glm::vec3& center, float radius);
+        static bool GetWorldBoundingSphere(const glm::mat4& transform, const MeshRendererComponent& meshRenderer, glm::vec3& outCenter, float& outRadius);
 
         static void EndPointShadowAtlas();
         static void EndPointShadowCaster();
         
         static void DrawWireSphere(const glm::vec3& center, float radius, const glm::vec4& color, int segments = 32);
+
+        // Point shadow numbers describe the last point shadow update, light and culling numbers the last BeginScene
+        struct Statistics
+        {
+            uint32_t PointShadowLights = 0;
+            std::array<uint32_t, MaxPointShadowCasters> PointShadowCasterCounts{};
+            uint32_t PointShadowFacesRendered = 0;
+            uint32_t PointShadowFacesCached = 0;
+
+            uint32_t LightCount = 0;
+            uint32_t MaxLightsPerCluster = 0;
+
+            uint32_t OccluderCount = 0;
+            uint32_t CulledMeshes = 0;
+            uint32_t VisibleMeshes = 0;
+            uint32_t MeshTriangles = 0;
+        };
+        static Statistics GetStats();
     };
 }
@@ -1,6 +1,7 @@
 
 #include "HRpch.h"
 #include "RendererAPI.h"
+#include "Platform/Null/NullRendererAPI.h"
 #include "Platform/OpenGL/OpenGLRendererAPI.h"
 
 namespace HRealEngine
@@ -11,7 +12,7 @@ namespace HRealEngine
     {
         switch (m_CurrentAPI)
         {
-            case API::None:    HREALENGINE_CORE_DEBUGBREAK(false, "RendererAPI::None is currently not supported!"); return nullptr;
+            case API::None:    return CreateScope<NullRendererAPI>();
             case API::OpenGL:  return CreateScope<OpenGLRendererAPI>();
         }
         HREALENGINE_CORE_DEBUGBREAK(false, "Unknown RendererAPI!");
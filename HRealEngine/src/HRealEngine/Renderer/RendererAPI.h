@@ -24,12 +24,20 @@ namespace HRealEngine
         virtual void Clear() = 0;
 
         virtual void DrawIndexed(const Ref<class VertexArray>& vertexArray, uint32_t IndexCount = 0) = 0;
-        virtual void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset) = 0;
+        // baseVertex is added to every index, used to draw from a region of a StreamingVertexBuffer
+        virtual void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset, uint32_t baseVertex = 0) = 0;
+        // baseInstance offsets the instance attributes, used to draw from a region of a streamed instance buffer
+        virtual void DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t baseInstance = 0) = 0;
 
-        virtual void DrawLines(const Ref<class VertexArray>& vertexArray, uint32_t vertexCount) = 0;
+        virtual void DrawLines(const Ref<class VertexArray>& vertexArray, uint32_t vertexCount, uint32_t firstVertex = 0) = 0;
         virtual void SetLineWidth(float width) = 0;
 
+        // Batches can then reference any number of textures through Texture2D::GetBindlessHandle
+        virtual bool SupportsBindlessTextures() const = 0;
+
         static API GetAPI() { return m_CurrentAPI; }
+        // Must be called before Renderer::Init, API::None selects the headless backend
+        static void SetAPI(API api) { m_CurrentAPI = api; }
         static Scope<RendererAPI> Create();
     private:
         static API m_CurrentAPI;
@@ -7,6 +7,22 @@
 
 namespace HRealEngine
 {
+    // Compile time shader features. Each one maps to a #define in the shader source, a mask of them selects a variant
+    namespace ShaderKeyword
+    {
+        enum : uint64_t
+        {
+            None              = 0,
+            QuantizedVertices = 1ull << 0, // QUANTIZED_VERTICES
+            Albedo            = 1ull << 1, // HAS_ALBEDO
+            Specular          = 1ull << 2, // HAS_SPECULAR
+            Normal            = 1ull << 3, // HAS_NORMAL
+            ShadowMap         = 1ull << 4, // HAS_SHADOW_MAP
+            PointShadowMap    = 1ull << 5, // HAS_POINT_SHADOW_MAP
+            DebugView         = 1ull << 6, // DEBUG_VIEW
+        };
+    }
+
     class Shader
     {
     public:
@@ -24,6 +40,11 @@ namespace HRealEngine
 
         virtual const std::string& GetName() const = 0;
 
+        // Switches to the variant compiled for the ShaderKeyword mask, it is compiled on first use. Bind afterwards,
+        // uniforms are per variant.
+        virtual void SetKeywords(uint64_t keywords) = 0;
+        virtual uint64_t GetKeywords() const = 0;
+
         static Ref<Shader> Create(const std::string& filePath);
         static Ref<Shader> Create(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource);
     };
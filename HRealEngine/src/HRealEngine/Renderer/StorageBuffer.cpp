@@ -0,0 +1,18 @@
+#include "HRpch.h"
+#include "StorageBuffer.h"
+#include "Renderer.h"
+#include "Platform/OpenGL/OpenGLStorageBuffer.h"
+
+namespace HRealEngine
+{
+    Ref<StorageBuffer> StorageBuffer::Create(uint32_t size, uint32_t binding)
+    {
+        switch (Renderer::GetAPI())
+        {
+            case RendererAPI::API::None:    HREALENGINE_CORE_DEBUGBREAK(false, "RendererAPI::None is currently not supported!"); return nullptr;
+            case RendererAPI::API::OpenGL:  return CreateRef<OpenGLStorageBuffer>(size, binding);
+        }
+        HREALENGINE_CORE_DEBUGBREAK(false, "Unknown RendererAPI!");
+        return nullptr;
+    }
+}
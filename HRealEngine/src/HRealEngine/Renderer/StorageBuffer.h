@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+#include "HRealEngine/Core/Core.h"
+
+namespace HRealEngine
+{
+    // Shader storage buffer bound to a fixed binding point, grows when SetData is given more than it holds
+    class StorageBuffer
+    {
+    public:
+        virtual ~StorageBuffer() {}
+        virtual void SetData(const void* data, uint32_t size) = 0;
+
+        static Ref<StorageBuffer> Create(uint32_t size, uint32_t binding);
+    };
+}
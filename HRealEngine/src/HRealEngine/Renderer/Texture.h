@@ -15,7 +15,9 @@ namespace HRealEngine
         R8,
         RGB8,
         RGBA8,
-        RGBA32F
+        RGBA32F,
+        BC1, // RGB, 4x4 blocks of 8 bytes
+        BC3  // RGBA, 4x4 blocks of 16 bytes
     };
 
     enum class TextureFilter
@@ -32,6 +34,8 @@ namespace HRealEngine
         ImageFormat Format = ImageFormat::RGBA8;
         
         bool GenerateMips = true;
+        // Set when the initial data already holds the mip chain, MipLevels levels back to back, largest first
+        uint32_t MipLevels = 0;
         TextureFilter MinFilter = TextureFilter::Linear;
         TextureFilter MagFilter = TextureFilter::Linear;
     };
@@ -65,5 +69,7 @@ namespace HRealEngine
         virtual AssetType GetType() const override { return GetStaticAssetType(); }
 
         virtual void ApplySampling(bool enableMipmaps, int minFilter, int magFilter) = 0;
+        // Resident handle for shaders that read textures from a buffer, 0 when RenderCommand::SupportsBindlessTextures is false
+        virtual uint64_t GetBindlessHandle() = 0;
     };
 }
@@ -0,0 +1,235 @@
+#include "HRpch.h"
+#include "TextureCompressor.h"
+
+#include <cfloat>
+#include <climits>
+#include <cstring>
+#include <glm/glm.hpp>
+
+namespace HRealEngine
+{
+    static uint16_t PackRGB565(const glm::vec3& color)
+    {
+        const glm::vec3 c = glm::clamp(color, glm::vec3(0.0f), glm::vec3(255.0f));
+        const uint32_t r = (uint32_t)(c.r * 31.0f / 255.0f + 0.5f);
+        const uint32_t g = (uint32_t)(c.g * 63.0f / 255.0f + 0.5f);
+        const uint32_t b = (uint32_t)(c.b * 31.0f / 255.0f + 0.5f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+    static glm::vec3 UnpackRGB565(uint16_t color)
+    {
+        const uint32_t r = (color >> 11) & 31;
+        const uint32_t g = (color >> 5) & 63;
+        const uint32_t b = color & 31;
+        return glm::vec3((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)));
+    }
+
+    // Blocks on the right and bottom edge repeat the last column and row
+    static void FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t outPixels[16][4])
+    {
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            const uint32_t sy = std::min(blockY * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                const uint32_t sx = std::min(blockX * 4 + x, width - 1);
+                std::memcpy(outPixels[y * 4 + x], rgba + ((size_t)sy * width + sx) * 4, 4);
+            }
+        }
+    }
+
+    // Endpoints span the block along its principal axis, every pixel takes the nearest of the four palette colors
+    static void EncodeColorBlock(const uint8_t pixels[16][4], uint8_t* out)
+    {
+        glm::vec3 colors[16];
+        glm::vec3 mean(0.0f);
+        for (int i = 0; i < 16; i++)
+        {
+            colors[i] = glm::vec3(pixels[i][0], pixels[i][1], pixels[i][2]);
+            mean += colors[i];
+        }
+        mean /= 16.0f;
+
+        float cov[6] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            const glm::vec3 d = colors[i] - mean;
+            cov[0] += d.r * d.r; cov[1] += d.r * d.g; cov[2] += d.r * d.b;
+            cov[3] += d.g * d.g; cov[4] += d.g * d.b; cov[5] += d.b * d.b;
+        }
+        glm::vec3 axis(1.0f);
+        for (int i = 0; i < 8; i++)
+        {
+            const glm::vec3 next(cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+                                 cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+                                 cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b);
+            const float length = glm::length(next);
+            if (length < 1e-6f)
+                break;
+            axis = next / length;
+        }
+
+        float minT = FLT_MAX, maxT = -FLT_MAX;
+        for (int i = 0; i < 16; i++)
+        {
+            const float t = glm::dot(colors[i] - mean, axis);
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+        // Pull the endpoints in a little, 565 rounding pushes them out anyway
+        const float inset = (maxT - minT) / 16.0f;
+        uint16_t c0 = PackRGB565(mean + axis * (maxT - inset));
+        uint16_t c1 = PackRGB565(mean + axis * (minT + inset));
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            glm::vec3 palette[4];
+            palette[0] = UnpackRGB565(c0);
+            palette[1] = UnpackRGB565(c1);
+            palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+            palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                uint32_t best = 0;
+                float bestDistance = FLT_MAX;
+                for (uint32_t p = 0; p < 4; p++)
+                {
+                    const glm::vec3 d = colors[i] - palette[p];
+                    const float distance = glm::dot(d, d);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        best = p;
+                    }
+                }
+                indices |= best << (i * 2);
+            }
+        }
+
+        out[0] = (uint8_t)(c0 & 0xFF); out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)(c1 & 0xFF); out[3] = (uint8_t)(c1 >> 8);
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = (uint8_t)(indices >> (i * 8));
+    }
+
+    static void EncodeAlphaBlock(const uint8_t pixels[16][4], uint8_t* out)
+    {
+        uint8_t a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++)
+        {
+            a0 = std::max(a0, pixels[i][3]);
+            a1 = std::min(a1, pixels[i][3]);
+        }
+
+        // a0 > a1 selects the eight value ramp
+        uint64_t indices = 0;
+        if (a0 != a1)
+        {
+            int palette[8];
+            palette[0] = a0;
+            palette[1] = a1;
+            for (int p = 1; p < 7; p++)
+                palette[p + 1] = ((7 - p) * a0 + p * a1 + 3) / 7;
+            for (int i = 0; i < 16; i++)
+            {
+                uint64_t best = 0;
+                int bestDistance = INT_MAX;
+                for (int p = 0; p < 8; p++)
+                {
+                    const int distance = std::abs(pixels[i][3] - palette[p]);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        best = (uint64_t)p;
+                    }
+                }
+                indices |= best << (i * 3);
+            }
+        }
+
+        out[0] = a0;
+        out[1] = a1;
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (uint8_t)(indices >> (i * 8));
+    }
+
+    void TextureCompressor::Compress(ImageFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out)
+    {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        uint8_t pixels[16][4];
+        for (uint32_t by = 0; by < blocksY; by++)
+        {
+            for (uint32_t bx = 0; bx < blocksX; bx++)
+            {
+                FetchBlock(rgba, width, height, bx, by, pixels);
+                if (format == ImageFormat::BC3)
+                {
+                    EncodeAlphaBlock(pixels, out);
+                    out += 8;
+                }
+                EncodeColorBlock(pixels, out);
+                out += 8;
+            }
+        }
+    }
+
+    std::vector<uint8_t> TextureCompressor::Downsample(const uint8_t* rgba, uint32_t width, uint32_t height)
+    {
+        const uint32_t outWidth = std::max(width / 2, 1u);
+        const uint32_t outHeight = std::max(height / 2, 1u);
+        std::vector<uint8_t> result((size_t)outWidth * outHeight * 4);
+        for (uint32_t y = 0; y < outHeight; y++)
+        {
+            const uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < outWidth; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                const uint8_t* p00 = rgba + ((size_t)y0 * width + x0) * 4;
+                const uint8_t* p01 = rgba + ((size_t)y0 * width + x1) * 4;
+                const uint8_t* p10 = rgba + ((size_t)y1 * width + x0) * 4;
+                const uint8_t* p11 = rgba + ((size_t)y1 * width + x1) * 4;
+                uint8_t* dst = &result[((size_t)y * outWidth + x) * 4];
+                for (int c = 0; c < 4; c++)
+                    dst[c] = (uint8_t)((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+            }
+        }
+        return result;
+    }
+
+    bool TextureCompressor::IsCompressed(ImageFormat format)
+    {
+        return format == ImageFormat::BC1 || format == ImageFormat::BC3;
+    }
+
+    uint64_t TextureCompressor::GetLevelSize(ImageFormat format, uint32_t width, uint32_t height)
+    {
+        const uint64_t blocks = (uint64_t)((width + 3) / 4) * ((height + 3) / 4);
+        switch (format)
+        {
+            case ImageFormat::BC1:     return blocks * 8;
+            case ImageFormat::BC3:     return blocks * 16;
+            case ImageFormat::R8:      return (uint64_t)width * height;
+            case ImageFormat::RGB8:    return (uint64_t)width * height * 3;
+            case ImageFormat::RGBA8:   return (uint64_t)width * height * 4;
+            case ImageFormat::RGBA32F: return (uint64_t)width * height * 16;
+            case ImageFormat::None:    return 0;
+        }
+        return 0;
+    }
+
+    uint32_t TextureCompressor::GetMipCount(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        while (width > 1 || height > 1)
+        {
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+            levels++;
+        }
+        return levels;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Texture.h"
+
+namespace HRealEngine
+{
+    // CPU side of the texture cook: box filtered mips and BC1/BC3 block compression of RGBA8 images
+    class TextureCompressor
+    {
+    public:
+        // rgba holds width * height pixels, out receives GetLevelSize(format, width, height) bytes
+        static void Compress(ImageFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out);
+        // Next mip level, each side halves and stops at 1
+        static std::vector<uint8_t> Downsample(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+        static bool IsCompressed(ImageFormat format);
+        static uint64_t GetLevelSize(ImageFormat format, uint32_t width, uint32_t height);
+        static uint32_t GetMipCount(uint32_t width, uint32_t height);
+    };
+}
@@ -0,0 +1,36 @@
+#include "HRpch.h"
+#include "Prefab.h"
+
+#include "HRealEngine/Core/Entity.h"
+
+namespace HRealEngine
+{
+    Prefab::Prefab(const Ref<Scene>& scene) : m_Scene(scene)
+    {
+        auto& registry = m_Scene->GetRegistry();
+        auto view = registry.view<EntityIDComponent>();
+        m_Entities.reserve(view.size());
+        m_ParentIndices.reserve(view.size());
+
+        for (auto e : view)
+        {
+            Entity entity{e, m_Scene.get()};
+            if (!m_Scene->GetParent(entity))
+            {
+                m_Entities.push_back(e);
+                m_ParentIndices.push_back(-1);
+            }
+        }
+        m_RootCount = m_Entities.size();
+
+        // Breadth first from the roots, which keeps every parent ahead of its children
+        for (size_t i = 0; i < m_Entities.size(); i++)
+        {
+            for (Entity child : m_Scene->GetChildren(Entity{m_Entities[i], m_Scene.get()}))
+            {
+                m_Entities.push_back(child);
+                m_ParentIndices.push_back((int32_t)i);
+            }
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "HRealEngine/Asset/Asset.h"
+#include "HRealEngine/Scene/Scene.h"
+
+namespace HRealEngine
+{
+    // An entity hierarchy kept in a private scene, ready to be cloned into other scenes by Scene::InstantiatePrefab.
+    // The entity order is resolved once on load: parents come before their children, so a clone can remap hierarchy
+    // links in a single pass.
+    class Prefab : public Asset
+    {
+    public:
+        Prefab(const Ref<Scene>& scene);
+
+        virtual AssetType GetType() const override { return AssetType::Prefab; }
+        static AssetType GetStaticType() { return AssetType::Prefab; }
+
+        const Ref<Scene>& GetScene() const { return m_Scene; }
+        const std::vector<entt::entity>& GetEntities() const { return m_Entities; }
+        // Index into GetEntities() of every entity's parent, -1 for roots
+        const std::vector<int32_t>& GetParentIndices() const { return m_ParentIndices; }
+        size_t GetRootCount() const { return m_RootCount; }
+    private:
+        Ref<Scene> m_Scene;
+        std::vector<entt::entity> m_Entities;
+        std::vector<int32_t> m_ParentIndices;
+        size_t m_RootCount = 0;
+    };
+}
@@ -4,6 +4,7 @@
 #include "HRealEngine/Core/Components.h"
 #include "ScriptableEntity.h"
 #include "HRealEngine/Core/Entity.h"
+#include "HRealEngine/Renderer/Renderer.h"
 #include "HRealEngine/Renderer/Renderer2D.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -12,35 +13,59 @@
 #include "BehaviorTreeThings/Core/BTSerializer.h"
 #include "BehaviorTreeThings/Core/Tree.h"
 #include "HRealEngine/Asset/AssetManager.h"
+#include "HRealEngine/Core/FrameGovernor.h"
+#include "HRealEngine/Core/Hash.h"
 #include "HRealEngine/Physics/Box2DWorld.h"
 #include "HRealEngine/Physics/JoltWorld.h"
 #include "HRealEngine/Project/Project.h"
+#include "HRealEngine/Scene/Prefab.h"
 #include "HRealEngine/Renderer/Renderer3D.h"
 #include "HRealEngine/Scripting/ScriptEngine.h"
+#include "HRealEngine/Utils/PlatformUtils.h"
 
 
 namespace HRealEngine
 {
     Scene::Scene()
     {
-
+        // Only membership changes rebuild the sprite list, key changes are picked up by the per frame order check
+        m_Registry.on_construct<SpriteRendererComponent>().connect<&Scene::OnSpriteRendererChanged>(*this);
+        m_Registry.on_destroy<SpriteRendererComponent>().connect<&Scene::OnSpriteRendererChanged>(*this);
+
+        m_Registry.on_construct<EntityNameComponent>().connect<&Scene::IndexEntityName>(*this);
+        m_Registry.on_update<EntityNameComponent>().connect<&Scene::ReindexEntityName>(*this);
+        m_Registry.on_destroy<EntityNameComponent>().connect<&Scene::UnindexEntityName>(*this);
+        m_Registry.on_construct<TagComponent>().connect<&Scene::IndexEntityTags>(*this);
+        m_Registry.on_update<TagComponent>().connect<&Scene::ReindexEntityTags>(*this);
+        m_Registry.on_destroy<TagComponent>().connect<&Scene::UnindexEntityTags>(*this);
+
+        // Keeps the cached static shadow layers current, transform edits have to go through registry.patch to show up here
+        m_Registry.on_update<TransformComponent>().connect<&Scene::OnShadowCasterChanged>(*this);
+        m_Registry.on_construct<MeshRendererComponent>().connect<&Scene::OnShadowCasterChanged>(*this);
+        m_Registry.on_update<MeshRendererComponent>().connect<&Scene::OnShadowCasterChanged>(*this);
+        m_Registry.on_destroy<MeshRendererComponent>().connect<&Scene::OnShadowCasterChanged>(*this);
+        m_Registry.on_construct<Rigidbody3DComponent>().connect<&Scene::OnShadowCasterBodyChanged>(*this);
+        m_Registry.on_update<Rigidbody3DComponent>().connect<&Scene::OnShadowCasterBodyChanged>(*this);
+        m_Registry.on_destroy<Rigidbody3DComponent>().connect<&Scene::OnShadowCasterBodyChanged>(*this);
     }
     Scene::~Scene()
     {
     }
 
-    template<typename Component>
-    static void CopyComponent(entt::registry& dst, entt::registry& src, std::unordered_map<UUID, entt::entity>& entityMap)
+    // Copies whole pools with one reserve and a range insert each. Only valid when both registries use the same entity
+    // identifiers, which Scene::Copy guarantees by creating every destination entity from its source handle.
+    template<typename... Component>
+    static void CopyComponentStorage(entt::registry& dst, entt::registry& src)
     {
-        auto view = src.view<Component>();
-        for (auto e : view)
+        ([&]()
         {
-            UUID uuid = src.get<EntityIDComponent>(e).ID;
-            entt::entity dstEntt = entityMap.at(uuid);
-
-            auto& component = src.get<Component>(e);
-            dst.emplace_or_replace<Component>(dstEntt, component); 
-        }
+            auto& srcStorage = src.storage<Component>();
+            if (srcStorage.empty())
+                return;
+            const entt::sparse_set& srcEntities = srcStorage;
+            dst.storage<Component>().reserve(srcStorage.size());
+            dst.insert<Component>(srcEntities.begin(), srcEntities.end(), srcStorage.begin());
+        }(), ...);
     }
     template<typename... Component>
     static void CopyComponentIfExists(Entity dst, Entity src)
@@ -57,6 +82,29 @@ namespace HRealEngine
         CopyComponentIfExists<Component...>(dst, src);
     }
 
+    // Clones of prefab entity i are clones[i * instanceCount, (i + 1) * instanceCount), so every prefab entity that has
+    // the component fills all of its clones with one range insert
+    template<typename... Component>
+    static void InsertPrefabComponents(ComponentGroup<Component...>, entt::registry& dst, entt::registry& src,
+        const std::vector<entt::entity>& prefabEntities, const std::vector<entt::entity>& clones, size_t instanceCount)
+    {
+        ([&]()
+        {
+            auto& srcStorage = src.storage<Component>();
+            if (srcStorage.empty())
+                return;
+            auto& dstStorage = dst.storage<Component>();
+            dstStorage.reserve(dstStorage.size() + srcStorage.size() * instanceCount);
+            for (size_t i = 0; i < prefabEntities.size(); i++)
+            {
+                if (!srcStorage.contains(prefabEntities[i]))
+                    continue;
+                const entt::entity* first = clones.data() + i * instanceCount;
+                dst.insert<Component>(first, first + instanceCount, srcStorage.get(prefabEntities[i]));
+            }
+        }(), ...);
+    }
+
     static int LightTypeToGPU(LightComponent::LightType t)
     {
         switch (t)
@@ -70,6 +118,26 @@ namespace HRealEngine
         }
         return 0;
     }
+    // Casters without a moving rigidbody go into the cached static cascade layers
+    static bool IsStaticShadowCaster(const entt::registry& registry, entt::entity entity)
+    {
+        const auto* rb3d = registry.try_get<Rigidbody3DComponent>(entity);
+        return !rb3d || rb3d->Type == Rigidbody3DComponent::BodyType::Static;
+    }
+    // Changes whenever anything that affects how the caster lands in a shadow map changes
+    static size_t HashShadowCaster(entt::entity entity, const MeshRendererComponent& meshRenderer, const glm::mat4& worldTransform)
+    {
+        size_t hash = 0;
+        HashCombine(hash, std::hash<uint32_t>()((uint32_t)entity));
+        HashCombine(hash, std::hash<uint64_t>()((uint64_t)meshRenderer.Mesh));
+        HashCombine(hash, meshRenderer.Mesh && AssetManager::IsAssetLoaded(meshRenderer.Mesh) ? 1 : 0);
+        for (int i = 0; i < 3; i++)
+            HashCombine(hash, std::hash<float>()(meshRenderer.PivotOffset[i]));
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                HashCombine(hash, std::hash<float>()(worldTransform[c][r]));
+        return hash;
+    }
 
 
     Ref<Scene> Scene::Copy(Ref<Scene> other)
@@ -78,38 +146,24 @@ namespace HRealEngine
         newScene->viewportWidth = other->viewportWidth;
         newScene->viewportHeight = other->viewportHeight;
 
-        std::unordered_map<UUID, entt::entity> entityMap;
         auto& srcRegistry = other->m_Registry;
         auto& dstRegistry = newScene->m_Registry;
 
-        auto idView = srcRegistry.view<EntityIDComponent>();
-        for (auto e : idView)
-        {
-            UUID uuid = srcRegistry.get<EntityIDComponent>(e).ID;
-            const auto& name = srcRegistry.get<EntityNameComponent>(e).Name;
-            Entity newEntity = newScene->CreateEntityWithUUID(uuid, name);
-            entityMap[uuid] = (entt::entity)newEntity;
-        }
-
-        CopyComponent<ChildrenManagerComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<TransformComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<TagComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<TextComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<LightComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<CameraComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<ScriptComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<SpriteRendererComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<MeshRendererComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<BehaviorTreeComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<AIControllerComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<PerceivableComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<CircleRendererComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<NativeScriptComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<Rigidbody2DComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<Rigidbody3DComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<BoxCollider3DComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<BoxCollider2DComponent>(dstRegistry, srcRegistry, entityMap);
-        CopyComponent<CircleCollider2DComponent>(dstRegistry, srcRegistry, entityMap);
+        // Same handles on both sides, so the UUID map carries over as is and no per component lookup is needed
+        auto& srcEntities = srcRegistry.storage<entt::entity>();
+        dstRegistry.storage<entt::entity>().reserve(srcEntities.size());
+        for (auto [e] : srcEntities.each())
+        {
+            [[maybe_unused]] entt::entity created = dstRegistry.create(e);
+            HREALENGINE_CORE_DEBUGBREAK(created == e, "Scene copy could not reuse an entity handle");
+        }
+        newScene->m_EntityMap = other->m_EntityMap;
+
+        CopyComponentStorage<EntityIDComponent, EntityNameComponent, ChildrenManagerComponent, TransformComponent, TagComponent,
+            TextComponent, LightComponent, CameraComponent, ScriptComponent, SpriteRendererComponent, MeshRendererComponent,
+            BehaviorTreeComponent, AIControllerComponent, PerceivableComponent, CircleRendererComponent, ParticleEmitterComponent,
+            NativeScriptComponent, Rigidbody2DComponent, Rigidbody3DComponent, BoxCollider3DComponent, BoxCollider2DComponent,
+            CircleCollider2DComponent>(dstRegistry, srcRegistry);
         
         return newScene;
     }
@@ -124,8 +178,7 @@ namespace HRealEngine
         Entity entity = {m_Registry.create(),this};
         entity.AddComponent<EntityIDComponent>(uuid);
         entity.AddComponent<TransformComponent>();
-        auto& tag = entity.AddComponent<EntityNameComponent>();
-        tag.Name = name.empty() ? "Entity" : name;
+        entity.AddComponent<EntityNameComponent>(name.empty() ? "Entity" : name);
         m_EntityMap[uuid] = entity;
         return entity;
     }
@@ -336,8 +389,23 @@ namespace HRealEngine
             m_Box2DWorld->UpdateSimulation2D(deltaTime, m_StepFrames);
         else 
             m_JoltWorld->UpdateSimulation3D(deltaTime, m_StepFrames);
+        UpdateParticles(deltaTime);
         RenderScene(camera);
+        TickBehaviorTrees(deltaTime);
+    }
+
+    void Scene::TickBehaviorTrees(Timestep deltaTime)
+    {
+        // Under load the frame governor spreads BT ticks over several frames, scripts inside the trees then see the time since the last tick
+        m_BehaviorTreeTimeSinceTick += deltaTime;
+        if (++m_BehaviorTreeFramesSinceTick < FrameGovernor::GetBehaviorTreeTickInterval())
+            return;
+
+        m_BehaviorTreeDeltaTime = m_BehaviorTreeTimeSinceTick;
         Root::RootTick();
+
+        m_BehaviorTreeTimeSinceTick = 0.0f;
+        m_BehaviorTreeFramesSinceTick = 0;
     }
 
 
@@ -348,43 +416,111 @@ namespace HRealEngine
 
     void Scene::OnUpdateRuntime(Timestep deltaTime)
     {
-        if (!m_bIsPaused || m_StepFrames-- > 0)
+        // Headless runs only simulate, there is nothing to render into
+        if (Renderer::GetAPI() == RendererAPI::API::None)
+        {
+            SimulateRuntime(deltaTime);
+            return;
+        }
+        // The 3D physics step runs while the frame is submitted, so the frame shows the transforms from before the step.
+        // The registry is the render copy of the body state and Jolt the simulation copy, EndSimulateRuntime syncs the two.
+        BeginSimulateRuntime(deltaTime);
+        RenderRuntime();
+        EndSimulateRuntime();
+    }
+
+    void Scene::SimulateRuntime(Timestep deltaTime)
+    {
+        BeginSimulateRuntime(deltaTime, false);
+    }
+
+    void Scene::BeginSimulateRuntime(Timestep deltaTime, bool bAsyncPhysicsStep)
+    {
+        const bool bStep = !m_bIsPaused || m_StepFrames-- > 0;
+        if (bStep)
         {
+            auto view = m_Registry.view<ScriptComponent>();
+            for (auto e : view)
             {
-                auto view = m_Registry.view<ScriptComponent>();
-                for (auto e : view)
-                {
-                    Entity entity = {e, this};
-                    ScriptEngine::OnUpdateEntity(entity, deltaTime);
-                }
-                m_Registry.view<NativeScriptComponent>().each([&](auto entity, auto& nativeScript)
-                {
-                   if (!nativeScript.Instance)
-                   {
-                       nativeScript.Instance = nativeScript.InstantiateScript();
-                       nativeScript.Instance->m_Entity = Entity{entity, this};
-                       nativeScript.Instance->OnCreate();
-                   }
-                    nativeScript.Instance->OnUpdate(Timestep(deltaTime));
-                });
-
-                if (m_b2PhysicsEnabled)
-                    m_Box2DWorld->UpdateRuntime2D();
-                else
-                    m_JoltWorld->UpdateRuntime3D();
+                Entity entity = {e, this};
+                ScriptEngine::OnUpdateEntity(entity, deltaTime);
             }
+            m_Registry.view<NativeScriptComponent>().each([&](auto entity, auto& nativeScript)
+            {
+               if (!nativeScript.Instance)
+               {
+                   nativeScript.Instance = nativeScript.InstantiateScript();
+                   nativeScript.Instance->m_Entity = Entity{entity, this};
+                   nativeScript.Instance->OnCreate();
+               }
+                nativeScript.Instance->OnUpdate(Timestep(deltaTime));
+            });
+
+            if (m_b2PhysicsEnabled)
+                m_Box2DWorld->UpdateRuntime2D();
+            else
+                m_JoltWorld->UpdateRuntime3D();
+        }
+        // BT scripts may query physics, so the trees tick before the step starts
+        TickBehaviorTrees(deltaTime);
+        if (bStep)
+        {
+            // The Box2D contact listener calls into scripts, its step stays on this thread
+            if (m_b2PhysicsEnabled)
+                m_Box2DWorld->Step2DWorld(deltaTime);
+            else
             {
-                if (m_b2PhysicsEnabled)
-                    m_Box2DWorld->Step2DWorld(deltaTime);
+                if (bAsyncPhysicsStep)
+                    m_JoltWorld->BeginStep3DWorld(deltaTime);
                 else
-                {
                     m_JoltWorld->Step3DWorld(deltaTime);
-                    m_JoltWorld->UpdateDebugLines(deltaTime);
-                }
+                m_JoltWorld->UpdateDebugLines(deltaTime);
             }
+            UpdateParticles(deltaTime);
         }
+    }
 
-        
+    void Scene::EndSimulateRuntime()
+    {
+        if (!m_b2PhysicsEnabled)
+            m_JoltWorld->EndStep3DWorld();
+    }
+
+    void Scene::UpdateParticles(Timestep deltaTime)
+    {
+        auto view = m_Registry.view<ParticleEmitterComponent>();
+        for (auto entity : view)
+        {
+            auto& emitter = view.get<ParticleEmitterComponent>(entity);
+            if (!emitter.Pool || emitter.Pool->GetCapacity() != emitter.Props.MaxParticles)
+                emitter.Pool = CreateRef<ParticlePool>(emitter.Props.MaxParticles);
+
+            // Fractional particles carry over, low emission rates still spawn at high frame rates
+            emitter.EmitAccumulator += emitter.Props.EmissionRate * deltaTime;
+            const uint32_t emitCount = (uint32_t)emitter.EmitAccumulator;
+            if (emitCount > 0)
+            {
+                emitter.EmitAccumulator -= (float)emitCount;
+                const glm::vec3 origin = GetWorldTransform(Entity{entity, this})[3];
+                emitter.Pool->Emit(emitter.Props, origin, emitCount);
+            }
+            emitter.Pool->Update(emitter.Props, deltaTime);
+        }
+    }
+
+    void Scene::RenderParticles()
+    {
+        auto view = m_Registry.view<ParticleEmitterComponent>();
+        for (auto entity : view)
+        {
+            auto& emitter = view.get<ParticleEmitterComponent>(entity);
+            if (emitter.Pool)
+                Renderer2D::DrawParticles(*emitter.Pool, emitter.Props, (int)entity);
+        }
+    }
+
+    void Scene::RenderRuntime()
+    {
         Camera* mainCamera = nullptr;
         glm::mat4 cameraTransform;
         {
@@ -404,9 +540,10 @@ namespace HRealEngine
         if (!mainCamera)
             return;
         
-        LightningAndShadowSetup(glm::vec3(cameraTransform[3]));
+        LightningAndShadowSetup(glm::inverse(cameraTransform), mainCamera->GetProjectionMatrix());
         
         Renderer3D::BeginScene(mainCamera->GetProjectionMatrix(), cameraTransform);
+        SubmitOccluders();
         {
             auto view = m_Registry.view<TransformComponent, MeshRendererComponent>();
             for (auto entity : view)
@@ -425,10 +562,10 @@ namespace HRealEngine
         {
             auto group = m_Registry.group<TransformComponent>(entt::get<SpriteRendererComponent>);
             RecalculateRenderListSprite();
-            for (auto entity : m_RenderList)
+            for (const SpriteRenderEntry& entry : m_RenderList)
             {
-                auto [transform, sprite] = group.get<TransformComponent, SpriteRendererComponent>(entity);
-                Renderer2D::DrawSprite(transform.GetTransform(), sprite, (int)entity);
+                auto [transform, sprite] = group.get<TransformComponent, SpriteRendererComponent>(entry.Entity);
+                Renderer2D::DrawSprite(transform.GetTransform(), sprite, (int)entry.Entity);
             }
         }
         {
@@ -439,6 +576,7 @@ namespace HRealEngine
                 Renderer2D::DrawCircle(transform.GetTransform(), circle.Color, circle.Thickness, circle.Fade, (int)entity);
             }
         }
+        RenderParticles();
         {
             auto view = m_Registry.view<TransformComponent, TextComponent>();
             for (auto entity : view)
@@ -450,8 +588,6 @@ namespace HRealEngine
             }
         }
         Renderer2D::EndScene();
-
-        Root::RootTick();
     }
 
     void Scene::OnViewportResize(uint32_t width, uint32_t height)
@@ -493,16 +629,88 @@ namespace HRealEngine
 
     Entity Scene::FindEntityByName(std::string_view name)
     {
-        auto view = m_Registry.view<EntityNameComponent>();
-        for (auto entity : view)
+        auto [begin, end] = m_NameIndex.equal_range(std::hash<std::string_view>()(name));
+        for (auto it = begin; it != end; ++it)
         {
-            const EntityNameComponent& nameComponent = view.get<EntityNameComponent>(entity);
-            if (nameComponent.Name == name)
-                return Entity{entity, this};
+            if (m_Registry.get<EntityNameComponent>(it->second).Name == name)
+                return Entity{it->second, this};
         }
         return {};
     }
 
+    std::vector<Entity> Scene::GetEntitiesWithTag(std::string_view tag)
+    {
+        std::vector<Entity> entities;
+        auto it = m_TagIndex.find(TagRegistry::Find(tag));
+        if (it == m_TagIndex.end())
+            return entities;
+
+        entities.reserve(it->second.size());
+        for (entt::entity entity : it->second)
+            entities.emplace_back(entity, this);
+        return entities;
+    }
+
+    void Scene::IndexEntityName(entt::registry& registry, entt::entity entity)
+    {
+        size_t hash = std::hash<std::string_view>()(registry.get<EntityNameComponent>(entity).Name);
+        m_NameIndex.emplace(hash, entity);
+        m_IndexedNameHashes[entity] = hash;
+    }
+
+    void Scene::UnindexEntityName(entt::registry& registry, entt::entity entity)
+    {
+        auto indexed = m_IndexedNameHashes.find(entity);
+        if (indexed == m_IndexedNameHashes.end())
+            return;
+
+        auto [begin, end] = m_NameIndex.equal_range(indexed->second);
+        for (auto it = begin; it != end; ++it)
+        {
+            if (it->second == entity)
+            {
+                m_NameIndex.erase(it);
+                break;
+            }
+        }
+        m_IndexedNameHashes.erase(indexed);
+    }
+
+    void Scene::ReindexEntityName(entt::registry& registry, entt::entity entity)
+    {
+        UnindexEntityName(registry, entity);
+        IndexEntityName(registry, entity);
+    }
+
+    void Scene::IndexEntityTags(entt::registry& registry, entt::entity entity)
+    {
+        const std::vector<TagID>& tags = registry.get<TagComponent>(entity).Tags;
+        for (TagID tag : tags)
+            m_TagIndex[tag].insert(entity);
+        m_IndexedTags[entity] = tags;
+    }
+
+    void Scene::UnindexEntityTags(entt::registry& registry, entt::entity entity)
+    {
+        auto indexed = m_IndexedTags.find(entity);
+        if (indexed == m_IndexedTags.end())
+            return;
+
+        for (TagID tag : indexed->second)
+        {
+            auto it = m_TagIndex.find(tag);
+            if (it != m_TagIndex.end())
+                it->second.erase(entity);
+        }
+        m_IndexedTags.erase(indexed);
+    }
+
+    void Scene::ReindexEntityTags(entt::registry& registry, entt::entity entity)
+    {
+        UnindexEntityTags(registry, entity);
+        IndexEntityTags(registry, entity);
+    }
+
     void Scene::DuplicateEntity(Entity entity)
     {
         Entity newEntity = CreateEntity(entity.GetName());
@@ -518,6 +726,147 @@ namespace HRealEngine
         CopyComponentIfExist<CircleCollider2DComponent>(newEntity, entity);*/
     }
 
+    Ref<Prefab> Scene::CreatePrefab(Entity root)
+    {
+        Ref<Scene> prefabScene = CreateRef<Scene>();
+        prefabScene->SetSceneName(root.GetName());
+        prefabScene->m_b2PhysicsEnabled = m_b2PhysicsEnabled;
+
+        std::unordered_map<UUID, UUID> prefabUUIDs;
+        std::vector<std::pair<Entity, Entity>> copied;
+        std::vector<Entity> pending = { root };
+        while (!pending.empty())
+        {
+            Entity source = pending.back();
+            pending.pop_back();
+
+            Entity copy = prefabScene->CreateEntity(source.GetName());
+            CopyComponentIfExists(AllComponents{}, copy, source);
+            prefabUUIDs[source.GetUUID()] = copy.GetUUID();
+            copied.emplace_back(source, copy);
+            for (Entity child : GetChildren(source))
+                pending.push_back(child);
+        }
+
+        for (auto& [source, copy] : copied)
+        {
+            if (source.HasComponent<ScriptComponent>())
+                ScriptEngine::GetScriptFieldMap(copy) = ScriptEngine::GetScriptFieldMap(source);
+            if (!copy.HasComponent<ChildrenManagerComponent>())
+                continue;
+
+            // The root drops its parent, it is not part of the prefab
+            auto& relation = copy.GetComponent<ChildrenManagerComponent>();
+            auto parent = prefabUUIDs.find(relation.ParentHandle);
+            relation.ParentHandle = parent != prefabUUIDs.end() ? parent->second : UUID(0);
+            std::vector<UUID> children;
+            children.reserve(relation.Children.size());
+            for (UUID child : relation.Children)
+            {
+                auto it = prefabUUIDs.find(child);
+                if (it != prefabUUIDs.end())
+                    children.push_back(it->second);
+            }
+            relation.Children = std::move(children);
+        }
+        return CreateRef<Prefab>(prefabScene);
+    }
+
+    std::vector<Entity> Scene::InstantiatePrefab(const Ref<Prefab>& prefab, const std::vector<TransformComponent>& transforms)
+    {
+        std::vector<Entity> roots;
+        if (!prefab || transforms.empty() || prefab->GetEntities().empty())
+            return roots;
+
+        const std::vector<entt::entity>& prefabEntities = prefab->GetEntities();
+        const std::vector<int32_t>& parentIndices = prefab->GetParentIndices();
+        Scene* prefabScene = prefab->GetScene().get();
+        entt::registry& prefabRegistry = prefabScene->GetRegistry();
+        const size_t instanceCount = transforms.size();
+        const size_t entityCount = prefabEntities.size();
+
+        std::vector<entt::entity> clones(entityCount * instanceCount);
+        m_Registry.create(clones.begin(), clones.end());
+
+        std::vector<EntityIDComponent> ids(clones.size()); // default constructed ids are fresh random UUIDs
+        m_EntityMap.reserve(m_EntityMap.size() + clones.size());
+        for (size_t i = 0; i < clones.size(); i++)
+            m_EntityMap[ids[i].ID] = clones[i];
+        m_Registry.insert<EntityIDComponent>(clones.begin(), clones.end(), ids.begin());
+
+        InsertPrefabComponents(AllComponents{}, m_Registry, prefabRegistry, prefabEntities, clones, instanceCount);
+
+        // Hierarchy links still name prefab entities, rebuild them per instance. Parents precede children in the prefab
+        // order, so pushing in that order keeps the original child order.
+        auto& relations = m_Registry.storage<ChildrenManagerComponent>();
+        for (size_t i = 0; i < clones.size(); i++)
+        {
+            if (relations.contains(clones[i]))
+                relations.get(clones[i]).Children.clear();
+        }
+        for (size_t i = 0; i < entityCount; i++)
+        {
+            const int32_t parent = parentIndices[i];
+            for (size_t n = 0; n < instanceCount; n++)
+            {
+                entt::entity clone = clones[i * instanceCount + n];
+                if (relations.contains(clone))
+                    relations.get(clone).ParentHandle = parent >= 0 ? ids[parent * instanceCount + n].ID : UUID(0);
+                if (parent >= 0)
+                {
+                    entt::entity parentClone = clones[parent * instanceCount + n];
+                    if (!relations.contains(parentClone))
+                        m_Registry.emplace<ChildrenManagerComponent>(parentClone);
+                    relations.get(parentClone).Children.push_back(ids[i * instanceCount + n].ID);
+                }
+            }
+        }
+
+        const size_t rootCount = prefab->GetRootCount();
+        roots.reserve(rootCount * instanceCount);
+        for (size_t n = 0; n < instanceCount; n++)
+        {
+            for (size_t i = 0; i < rootCount; i++)
+            {
+                entt::entity clone = clones[i * instanceCount + n];
+                m_Registry.get<TransformComponent>(clone) = transforms[n];
+                roots.emplace_back(clone, this);
+            }
+        }
+
+        std::vector<Entity> scripted;
+        for (size_t i = 0; i < entityCount; i++)
+        {
+            if (!prefabRegistry.all_of<ScriptComponent>(prefabEntities[i]))
+                continue;
+            const ScriptFieldMap& fields = ScriptEngine::GetScriptFieldMap(Entity{prefabEntities[i], prefabScene});
+            for (size_t n = 0; n < instanceCount; n++)
+            {
+                Entity clone{clones[i * instanceCount + n], this};
+                if (!fields.empty())
+                    ScriptEngine::GetScriptFieldMap(clone) = fields;
+                scripted.push_back(clone);
+            }
+        }
+
+        if (!m_bIsRunning)
+            return roots;
+
+        // Box2D bodies are only built when the simulation starts, runtime spawns get Jolt bodies only
+        if (!m_b2PhysicsEnabled && m_JoltWorld)
+        {
+            std::vector<Entity> bodies;
+            for (entt::entity clone : clones)
+            {
+                if (m_Registry.any_of<Rigidbody3DComponent, BoxCollider3DComponent>(clone))
+                    bodies.emplace_back(clone, this);
+            }
+            m_JoltWorld->CreateBodiesForEntities(bodies);
+        }
+        ScriptEngine::OnCreateEntities(scripted);
+        return roots;
+    }
+
     bool Scene::DecomposeTransform(const glm::mat4& transform, glm::vec3& outPosition, glm::vec3& rotation, glm::vec3& scale)
     {
         glm::mat4 LocalMatrix(transform);
@@ -581,6 +930,8 @@ namespace HRealEngine
             parent.AddComponent<ChildrenManagerComponent>();
         auto& parentRel = parent.GetComponent<ChildrenManagerComponent>();
         parentRel.Children.push_back(child.GetUUID());
+        // The child's world transform changed with its parent
+        child.PatchComponent<TransformComponent>();
     }
 
     void Scene::RemoveParent(Entity child)
@@ -601,6 +952,7 @@ namespace HRealEngine
         }
 
         childRel.ParentHandle = 0;
+        child.PatchComponent<TransformComponent>();
     }
 
     Entity Scene::GetParent(Entity entity)
@@ -691,10 +1043,24 @@ namespace HRealEngine
         m_PhysicsWorld2D = nullptr;*/
     }
 
+    void Scene::SubmitOccluders()
+    {
+        auto view = m_Registry.view<TransformComponent, MeshRendererComponent>();
+        for (auto entity : view)
+        {
+            auto& meshRenderer = view.get<MeshRendererComponent>(entity);
+            if (!meshRenderer.bOccluder)
+                continue;
+            Entity e{entity, this};
+            Renderer3D::SubmitOccluder(GetWorldTransform(e), meshRenderer);
+        }
+    }
+
     void Scene::RenderScene(EditorCamera& camera)
     {
-        LightningAndShadowSetup(camera.GetPosition());
+        LightningAndShadowSetup(camera.GetViewMatrix(), camera.GetProjectionMatrix());
         Renderer3D::BeginScene(camera);
+        SubmitOccluders();
         {
             auto view = m_Registry.view<TransformComponent, MeshRendererComponent>();
             for (auto entity : view)
@@ -713,11 +1079,11 @@ namespace HRealEngine
         {
             auto group = m_Registry.group<TransformComponent>(entt::get<SpriteRendererComponent>);
             RecalculateRenderListSprite();
-            for (auto entity : m_RenderList)
+            for (const SpriteRenderEntry& entry : m_RenderList)
             {
-                auto [transform, sprite] = group.get<TransformComponent, SpriteRendererComponent>(entity);
+                auto [transform, sprite] = group.get<TransformComponent, SpriteRendererComponent>(entry.Entity);
                 //Renderer2D::DrawQuad(transform.GetTransform(), sprite.Color);
-                Renderer2D::DrawSprite(transform.GetTransform(), sprite, (int)entity);
+                Renderer2D::DrawSprite(transform.GetTransform(), sprite, (int)entry.Entity);
             }
         }
         {
@@ -728,30 +1094,30 @@ namespace HRealEngine
                 Renderer2D::DrawCircle(transform.GetTransform(), circle.Color, circle.Thickness, circle.Fade, (int)entity);
             }
         }
+        RenderParticles();
 
         {
             auto view = m_Registry.view<TransformComponent, TextComponent>();
             for (auto entity : view)
             {
                 auto [transform, text] = view.get<TransformComponent, TextComponent>(entity);
-                Renderer2D::DrawString(text.TextString, transform.GetTransform(), text, (int)entity);
+                if (!text.TextString.empty())
+                    Renderer2D::DrawString(text.TextString, transform.GetTransform(), text, (int)entity);
             }
         }
         Renderer2D::EndScene();
     }
 
-    void Scene::LightningAndShadowSetup(const glm::vec3& cameraPosition)
+    void Scene::LightningAndShadowSetup(const glm::mat4& cameraView, const glm::mat4& cameraProjection)
     {
-        Renderer3D::SetViewPosition(cameraPosition);
+        Renderer3D::SetViewPosition(glm::vec3(glm::inverse(cameraView)[3]));
         std::vector<Renderer3D::LightGPU> lights;
-        lights.reserve(16);
 
         // Directional shadow
         bool doDirShadows = false;
         glm::vec3 dirShadowDir(0.0f, -1.0f, 0.0f);
 
         std::vector<std::tuple<int, glm::vec3, float>> pointShadowCasters; // (gpuLightIndex, pos, farPlane)
-        pointShadowCasters.reserve(16);
         
         auto lightView = m_Registry.view<TransformComponent, LightComponent>();
         for (auto e : lightView)
@@ -766,8 +1132,6 @@ namespace HRealEngine
                     /*doShadows*/doDirShadows = true;
                 }
             }
-            if ((int)lights.size() >= 16)
-                continue;
 
             Renderer3D::LightGPU gpu{};
             gpu.Type = LightTypeToGPU(lc.Type);
@@ -777,6 +1141,7 @@ namespace HRealEngine
             gpu.Intensity = lc.Intensity;
             gpu.Radius = lc.Radius;
             gpu.CastShadows = lc.CastShadows ? 1 : 0;
+            gpu.ID = (uint64_t)Entity{e, this}.GetUUID();
 
             lights.push_back(gpu);
             
@@ -789,16 +1154,59 @@ namespace HRealEngine
             }
         }
         Renderer3D::SetLights(lights);
+
+        // The governor can refresh shadow maps only every few frames, the renderer keeps the last maps and matrices meanwhile.
+        // Any change in which lights cast shadows forces a refresh so the kept maps never belong to other lights.
+        size_t pointShadowLightsSignature = pointShadowCasters.size();
+        for (auto& [lightIndex, pos, farPlane] : pointShadowCasters)
+            HashCombine(pointShadowLightsSignature, std::hash<uint64_t>()(lights[lightIndex].ID));
+        const bool bShadowCastersChanged = doDirShadows != m_bLastDirShadows || pointShadowLightsSignature != m_LastPointShadowLightsSignature;
+        const bool bUpdateShadows = bShadowCastersChanged || FrameGovernor::ShouldUpdateShadows();
+        m_bLastDirShadows = doDirShadows;
+        m_LastPointShadowLightsSignature = pointShadowLightsSignature;
+        if (!bUpdateShadows)
+            return;
         
         if (doDirShadows/*doShadows*/)
         {
-            Renderer3D::BeginShadowPass(/*shadowDir*/dirShadowDir, cameraPosition);
-            auto viewShadow = m_Registry.view<TransformComponent, MeshRendererComponent>();
-            for (auto entity : viewShadow)
+            // A static caster whose mesh has streamed in since the layers were drawn is missing from them
+            for (entt::entity entity : m_PendingStaticShadowCasters)
             {
-                auto [transform, meshRenderer] = viewShadow.get<TransformComponent, MeshRendererComponent>(entity);
-                Renderer3D::DrawMeshShadow(transform.GetTransform(), meshRenderer);
+                const auto* meshRenderer = m_Registry.valid(entity) ? m_Registry.try_get<MeshRendererComponent>(entity) : nullptr;
+                if (!meshRenderer || AssetManager::IsAssetLoaded(meshRenderer->Mesh))
+                {
+                    m_bStaticShadowCastersDirty = true;
+                    break;
+                }
             }
+            if (m_bStaticShadowCastersDirty)
+            {
+                Renderer3D::InvalidateStaticShadows();
+                m_bStaticShadowCastersDirty = false;
+            }
+
+            Renderer3D::BeginShadowPass(/*shadowDir*/dirShadowDir, cameraView, cameraProjection);
+            // Static casters are only walked when the cached layers are redrawn
+            if (Renderer3D::BeginStaticShadowCasters())
+            {
+                m_PendingStaticShadowCasters.clear();
+                auto viewStatic = m_Registry.view<TransformComponent, MeshRendererComponent>();
+                for (auto entity : viewStatic)
+                {
+                    if (!IsStaticShadowCaster(m_Registry, entity))
+                        continue;
+                    auto& meshRenderer = viewStatic.get<MeshRendererComponent>(entity);
+                    if (meshRenderer.Mesh && !AssetManager::IsAssetLoaded(meshRenderer.Mesh))
+                        m_PendingStaticShadowCasters.push_back(entity);
+                    Renderer3D::DrawMeshShadow(GetWorldTransform(Entity{entity, this}), meshRenderer);
+                }
+                Renderer3D::EndStaticShadowCasters();
+            }
+            Renderer3D::BeginDynamicShadowCasters();
+            auto viewDynamic = m_Registry.view<TransformComponent, MeshRendererComponent, Rigidbody3DComponent>();
+            for (auto entity : viewDynamic)
+                if (!IsStaticShadowCaster(m_Registry, entity))
+                    Renderer3D::DrawMeshShadow(GetWorldTransform(Entity{entity, this}), viewDynamic.get<MeshRendererComponent>(entity));
             Renderer3D::EndShadowPass();
         }
         
@@ -806,20 +1214,51 @@ namespace HRealEngine
         {
             Renderer3D::BeginPointShadowAtlas();
 
+            struct PointShadowCaster
+            {
+                entt::entity Entity;
+                glm::mat4 WorldTransform;
+                glm::vec3 Center;
+                float Radius;
+                size_t Hash;
+            };
             auto viewShadow = m_Registry.view<TransformComponent, MeshRendererComponent>();
+            std::vector<PointShadowCaster> casters;
+            for (auto entity : viewShadow)
+            {
+                PointShadowCaster caster{ entity, GetWorldTransform(Entity{entity, this}) };
+                auto& meshRenderer = viewShadow.get<MeshRendererComponent>(entity);
+                if (!Renderer3D::GetWorldBoundingSphere(caster.WorldTransform, meshRenderer, caster.Center, caster.Radius))
+                    continue;
+                caster.Hash = HashShadowCaster(entity, meshRenderer, caster.WorldTransform);
+                casters.push_back(caster);
+            }
 
-            for (uint32_t casterIndex = 0; casterIndex < pointShadowCasters.size() && casterIndex < 8; casterIndex++)
+            std::vector<std::pair<const PointShadowCaster*, uint32_t>> inRange; // (caster, face mask)
+            for (uint32_t casterIndex = 0; casterIndex < pointShadowCasters.size() && casterIndex < Renderer3D::MaxPointShadowCasters; casterIndex++)
             {
                 auto [lightIndex, pos, farPlane] = pointShadowCasters[casterIndex];
 
-                Renderer3D::BeginPointShadowCaster(casterIndex, lightIndex, pos, farPlane);
-
-                for (auto entity : viewShadow)
+                // Only casters inside the light sphere are considered, each one only for the cube faces it overlaps
+                inRange.clear();
+                size_t faceSignatures[6] = {};
+                for (const PointShadowCaster& caster : casters)
                 {
-                    auto [transform, meshRenderer] = viewShadow.get<TransformComponent, MeshRendererComponent>(entity);
-                    Renderer3D::DrawMeshPointShadow(transform.GetTransform(), meshRenderer);
+                    const uint32_t faceMask = Renderer3D::GetPointShadowFaceMask(pos, farPlane, caster.Center, caster.Radius);
+                    if (faceMask == 0)
+                        continue;
+                    for (int face = 0; face < 6; face++)
+                        if (faceMask & (1u << face))
+                            HashCombine(faceSignatures[face], caster.Hash);
+                    inRange.emplace_back(&caster, faceMask);
                 }
 
+                const uint32_t dirtyFaces = Renderer3D::BeginPointShadowCaster(casterIndex, lightIndex, pos, farPlane, faceSignatures);
+                if (dirtyFaces != 0)
+                    for (auto& [caster, faceMask] : inRange)
+                        if (faceMask & dirtyFaces)
+                            Renderer3D::DrawMeshPointShadow(caster->WorldTransform, viewShadow.get<MeshRendererComponent>(caster->Entity), faceMask);
+
                 Renderer3D::EndPointShadowCaster();
             }
 
@@ -829,19 +1268,60 @@ namespace HRealEngine
 
     void Scene::RecalculateRenderListSprite()
     {
-        m_RenderList.clear();
-        
+        auto drawsBefore = [](const SpriteRenderEntry& a, const SpriteRenderEntry& b)
+        {
+            if (a.OrderInLayer != b.OrderInLayer)
+                return a.OrderInLayer > b.OrderInLayer;
+            if (a.Texture != b.Texture)
+                return (uint64_t)a.Texture < (uint64_t)b.Texture;
+            return a.Entity < b.Entity;
+        };
+
         auto view = m_Registry.view<SpriteRendererComponent>();
-        for (auto entity : view)
-            m_RenderList.push_back(entity);
+        if (m_bRenderListDirty)
+        {
+            m_RenderList.clear();
+            m_RenderList.reserve(view.size());
+            for (auto entity : view)
+                m_RenderList.push_back({ 0, 0, entity });
+            m_bRenderListDirty = false;
+        }
 
-        std::sort(m_RenderList.begin(), m_RenderList.end(),
-            [&](entt::entity a, entt::entity b)
-            {
-                auto& sa = view.get<SpriteRendererComponent>(a);
-                auto& sb = view.get<SpriteRendererComponent>(b);
-                return sa.OrderInLayer > sb.OrderInLayer;
-            });
+        // Refresh the keys (the editor and scripts write them directly) and only sort when the old order no longer holds
+        bool bSorted = true;
+        for (size_t i = 0; i < m_RenderList.size(); i++)
+        {
+            SpriteRenderEntry& entry = m_RenderList[i];
+            const auto& sprite = view.get<SpriteRendererComponent>(entry.Entity);
+            entry.OrderInLayer = sprite.OrderInLayer;
+            entry.Texture = sprite.Texture;
+            if (bSorted && i > 0 && drawsBefore(entry, m_RenderList[i - 1]))
+                bSorted = false;
+        }
+        if (!bSorted)
+            std::sort(m_RenderList.begin(), m_RenderList.end(), drawsBefore);
+    }
+
+    void Scene::OnShadowCasterChanged(entt::registry& registry, entt::entity entity)
+    {
+        // Moving bodies are drawn into the dynamic layer every frame. Entities with children count, the children move along.
+        const auto* children = registry.try_get<ChildrenManagerComponent>(entity);
+        const bool bHasChildren = children && !children->Children.empty();
+        if (!bHasChildren && (!registry.all_of<MeshRendererComponent>(entity) || !IsStaticShadowCaster(registry, entity)))
+            return;
+        m_bStaticShadowCastersDirty = true;
+    }
+
+    void Scene::OnShadowCasterBodyChanged(entt::registry& registry, entt::entity entity)
+    {
+        // The body type decides which layer the caster goes into, any change can move it in or out of the static layers
+        if (registry.all_of<MeshRendererComponent>(entity))
+            m_bStaticShadowCastersDirty = true;
+    }
+
+    void Scene::OnSpriteRendererChanged(entt::registry& registry, entt::entity entity)
+    {
+        m_bRenderListDirty = true;
     }
 
     template <typename T>
@@ -939,4 +1419,8 @@ namespace HRealEngine
     void Scene::OnComponentAdded<CircleRendererComponent>(Entity entity, CircleRendererComponent& component)
     {
     }
+    template<>
+    void Scene::OnComponentAdded<ParticleEmitterComponent>(Entity entity, ParticleEmitterComponent& component)
+    {
+    }
 }
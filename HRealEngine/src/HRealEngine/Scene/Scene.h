@@ -19,6 +19,7 @@ namespace HRealEngine
 {
     class JoltWorld;
     class Entity;
+    class Prefab;
     class Box2DWorld;
     
     class Scene : public Asset
@@ -50,19 +51,36 @@ namespace HRealEngine
         
         void OnUpdateEditor(Timestep deltaTime, EditorCamera& camera);
         void OnUpdateRuntime(Timestep deltaTime);
+        // The phases of OnUpdateRuntime, simulation (scripts, physics, BTs) never touches the renderer. BeginSimulateRuntime
+        // leaves the 3D physics step running on a worker thread and EndSimulateRuntime writes its results back, only rendering
+        // may run in between.
+        void SimulateRuntime(Timestep deltaTime);
+        void BeginSimulateRuntime(Timestep deltaTime, bool bAsyncPhysicsStep = true);
+        void EndSimulateRuntime();
+        void RenderRuntime();
         void OnUpdateSimulation(Timestep deltaTime, EditorCamera& camera);
         void OnViewportResize(uint32_t width, uint32_t height);
         Entity GetEntityByUUID(UUID uuid);
         Entity GetPrimaryCameraEntity();
+        // O(1) through the name index, any one of them when several entities share the name
         Entity FindEntityByName(std::string_view name);
+        std::vector<Entity> GetEntitiesWithTag(std::string_view tag);
         JoltWorld* GetJoltWorld() { return m_JoltWorld.get(); }
         bool IsRunning() const { return m_bIsRunning; }
         bool IsPaused() const { return m_bIsPaused; }
         void SetPaused(bool paused) { m_bIsPaused = paused; }
+        // Time since the behavior trees last ticked, BT scripts read this instead of the frame delta
+        float GetBehaviorTreeDeltaTime() const { return m_BehaviorTreeDeltaTime; }
         void Step(int frames = 1) { m_StepFrames = frames; }
         void Set2DPhysicsEnabled(bool enabled) { m_b2PhysicsEnabled = enabled; }
         bool Is2DPhysicsEnabled() const { return m_b2PhysicsEnabled; }
         void DuplicateEntity(Entity entity);
+        // Copies root and its descendants into a new prefab with fresh UUIDs, the source entities are left untouched
+        Ref<Prefab> CreatePrefab(Entity root);
+        // Clones the prefab once per transform, every root of a clone takes that transform. Components are inserted in
+        // bulk, physics bodies are added in one batch and script instances are created in one pass when the scene runs.
+        // Returns the cloned roots, instance by instance.
+        std::vector<Entity> InstantiatePrefab(const Ref<Prefab>& prefab, const std::vector<TransformComponent>& transforms);
 
         bool DecomposeTransform(const glm::mat4& transform, glm::vec3& outPosition, glm::vec3& rotation, glm::vec3& scale);
 
@@ -81,10 +99,39 @@ namespace HRealEngine
         void OnPhysicsStart();
         void OnPhysicsStop();
         void RenderScene(EditorCamera& camera);
-        void LightningAndShadowSetup(const glm::vec3& cameraPosition);
+        void LightningAndShadowSetup(const glm::mat4& cameraView, const glm::mat4& cameraProjection);
+        void SubmitOccluders();
+        void TickBehaviorTrees(Timestep deltaTime);
+        void UpdateParticles(Timestep deltaTime);
+        void RenderParticles();
 
         void RecalculateRenderListSprite();
-        std::vector<entt::entity> m_RenderList;
+        void OnSpriteRendererChanged(entt::registry& registry, entt::entity entity);
+        // Sprites in draw order: OrderInLayer descending, then texture so sprites sharing one stay in the same batch
+        struct SpriteRenderEntry
+        {
+            int OrderInLayer = 0;
+            AssetHandle Texture = 0;
+            entt::entity Entity = entt::null;
+        };
+        std::vector<SpriteRenderEntry> m_RenderList;
+        bool m_bRenderListDirty = true;
+
+        // Static shadow caster tracking, transform edits only reach these through registry.patch
+        void OnShadowCasterChanged(entt::registry& registry, entt::entity entity);
+        void OnShadowCasterBodyChanged(entt::registry& registry, entt::entity entity);
+
+        // Name and tag indices, kept current by the registry signals connected in the constructor
+        void IndexEntityName(entt::registry& registry, entt::entity entity);
+        void UnindexEntityName(entt::registry& registry, entt::entity entity);
+        void ReindexEntityName(entt::registry& registry, entt::entity entity);
+        void IndexEntityTags(entt::registry& registry, entt::entity entity);
+        void UnindexEntityTags(entt::registry& registry, entt::entity entity);
+        void ReindexEntityTags(entt::registry& registry, entt::entity entity);
+        std::unordered_multimap<size_t, entt::entity> m_NameIndex; // keyed by the name hash, lookups compare the name
+        std::unordered_map<entt::entity, size_t> m_IndexedNameHashes; // what each entity was indexed under
+        std::unordered_map<TagID, std::unordered_set<entt::entity>> m_TagIndex;
+        std::unordered_map<entt::entity, std::vector<TagID>> m_IndexedTags;
 
         bool m_bIsRunning = false;
         bool m_bIsPaused = false;
@@ -96,6 +143,15 @@ namespace HRealEngine
 
         std::unordered_map<AssetHandle, YAML::Node> m_BehaviorTreeCache;
         std::unordered_map<AssetHandle, UUID> m_BTOwnerUUIDs;
+        float m_BehaviorTreeTimeSinceTick = 0.0f;
+        uint32_t m_BehaviorTreeFramesSinceTick = 0;
+        float m_BehaviorTreeDeltaTime = 0.0f;
+        
+        bool m_bLastDirShadows = false;
+        size_t m_LastPointShadowLightsSignature = 0;
+        // Set by the shadow caster signals, the cached static cascade layers are only redrawn when it is
+        bool m_bStaticShadowCastersDirty = true;
+        std::vector<entt::entity> m_PendingStaticShadowCasters; // drawn into the static layers before their mesh was loaded
         
         entt::registry m_Registry;
         uint32_t viewportWidth = 0, viewportHeight = 0;
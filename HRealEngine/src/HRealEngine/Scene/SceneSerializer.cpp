@@ -173,8 +173,8 @@ namespace HRealEngine
             out << YAML::BeginMap;
             auto& tags = entity.GetComponent<TagComponent>().Tags;
             out << YAML::Key << "Tags" << YAML::Value << YAML::BeginSeq;
-            for (const std::string& tag : tags)
-                out << tag;
+            for (TagID tag : tags)
+                out << TagRegistry::GetName(tag);
             out << YAML::EndSeq;
             out << YAML::EndMap;
         }
@@ -250,6 +250,7 @@ namespace HRealEngine
                 out << YAML::Key << "TexturePath" << YAML::Value << mesh.Texture->GetPath();*/
             out << YAML::Key << "TextureHandle" << YAML::Value << mesh.Texture;
             out << YAML::Key << "TilingFactor" << YAML::Value << mesh.TilingFactor;
+            out << YAML::Key << "Occluder" << YAML::Value << mesh.bOccluder;
 
             out << YAML::Key << "MaterialHandleOverrides";
             out << YAML::Value << YAML::BeginSeq;
@@ -339,6 +340,25 @@ namespace HRealEngine
             out << YAML::Key << "Fade" << YAML::Value << circle.Fade;
             out << YAML::EndMap;
         }
+        if (entity.HasComponent<ParticleEmitterComponent>())
+        {
+            auto& props = entity.GetComponent<ParticleEmitterComponent>().Props;
+            out << YAML::Key << "ParticleEmitterComponent";
+            out << YAML::BeginMap;
+            out << YAML::Key << "MaxParticles" << YAML::Value << props.MaxParticles;
+            out << YAML::Key << "EmissionRate" << YAML::Value << props.EmissionRate;
+            out << YAML::Key << "LifeTime" << YAML::Value << props.LifeTime;
+            out << YAML::Key << "Velocity" << YAML::Value << props.Velocity;
+            out << YAML::Key << "VelocityVariation" << YAML::Value << props.VelocityVariation;
+            out << YAML::Key << "Acceleration" << YAML::Value << props.Acceleration;
+            out << YAML::Key << "AngularVelocity" << YAML::Value << props.AngularVelocity;
+            out << YAML::Key << "ColorBegin" << YAML::Value << props.ColorBegin;
+            out << YAML::Key << "ColorEnd" << YAML::Value << props.ColorEnd;
+            out << YAML::Key << "SizeBegin" << YAML::Value << props.SizeBegin;
+            out << YAML::Key << "SizeEnd" << YAML::Value << props.SizeEnd;
+            out << YAML::Key << "SizeVariation" << YAML::Value << props.SizeVariation;
+            out << YAML::EndMap;
+        }
         if (entity.HasComponent<CameraComponent>())
         {
             out << YAML::Key << "CameraComponent";
@@ -561,10 +581,11 @@ namespace HRealEngine
                 Entity deserializedEntity = sceneRef->CreateEntityWithUUID(uuid,name);
                 if (auto tagComponent = entity["TagComponent"])
                 {
-                    auto& tag = deserializedEntity.AddComponent<TagComponent>();
-                    auto tags = tagComponent["Tags"];
-                    for (auto tagNode : tags)
-                        tag.Tags.push_back(tagNode.as<std::string>());
+                    // Filled before adding so the tag index sees the whole set on construct
+                    std::vector<TagID> tags;
+                    for (auto tagNode : tagComponent["Tags"])
+                        tags.push_back(TagRegistry::Intern(tagNode.as<std::string>()));
+                    deserializedEntity.AddComponent<TagComponent>(tags);
                 }
                 if (auto transformComponent = entity["TransformComponent"])
                 {
@@ -695,6 +716,9 @@ namespace HRealEngine
                 
                     if (meshRendererComponent["TilingFactor"])
                         mesh.TilingFactor = meshRendererComponent["TilingFactor"].as<float>();
+
+                    if (meshRendererComponent["Occluder"])
+                        mesh.bOccluder = meshRendererComponent["Occluder"].as<bool>();
                     
                     if (meshRendererComponent["MeshHandle"])
                     {
@@ -794,6 +818,22 @@ namespace HRealEngine
                     circle.Thickness = circleRendererComponent["Thickness"].as<float>();
                     circle.Fade = circleRendererComponent["Fade"].as<float>();
                 }
+                if (auto particleEmitterComponent = entity["ParticleEmitterComponent"])
+                {
+                    auto& props = deserializedEntity.AddComponent<ParticleEmitterComponent>().Props;
+                    props.MaxParticles = particleEmitterComponent["MaxParticles"].as<uint32_t>();
+                    props.EmissionRate = particleEmitterComponent["EmissionRate"].as<float>();
+                    props.LifeTime = particleEmitterComponent["LifeTime"].as<float>();
+                    props.Velocity = particleEmitterComponent["Velocity"].as<glm::vec3>();
+                    props.VelocityVariation = particleEmitterComponent["VelocityVariation"].as<glm::vec3>();
+                    props.Acceleration = particleEmitterComponent["Acceleration"].as<glm::vec3>();
+                    props.AngularVelocity = particleEmitterComponent["AngularVelocity"].as<float>();
+                    props.ColorBegin = particleEmitterComponent["ColorBegin"].as<glm::vec4>();
+                    props.ColorEnd = particleEmitterComponent["ColorEnd"].as<glm::vec4>();
+                    props.SizeBegin = particleEmitterComponent["SizeBegin"].as<float>();
+                    props.SizeEnd = particleEmitterComponent["SizeEnd"].as<float>();
+                    props.SizeVariation = particleEmitterComponent["SizeVariation"].as<float>();
+                }
                 if (auto rb2dComponent = entity["Rigidbody2DComponent"])
                 {
                     auto& rb2d = deserializedEntity.AddComponent<Rigidbody2DComponent>();
@@ -491,29 +491,48 @@ namespace HRealEngine
         return s_Data->EntityClasses.find(className) != s_Data->EntityClasses.end();
     }
 
-    void ScriptEngine::OnCreateEntity(Entity entity)
+    Ref<ScriptInstance> ScriptEngine::CreateEntityInstance(Entity entity)
     {
         const auto& scriptComponent = entity.GetComponent<ScriptComponent>();
-        if (ScriptEngine::IsEntityClassExist(scriptComponent.ClassName))
+        if (!IsEntityClassExist(scriptComponent.ClassName))
+            return nullptr;
+
+        Ref<ScriptInstance> instance = CreateRef<ScriptInstance>(s_Data->EntityClasses[scriptComponent.ClassName], entity);
+        s_Data->EntityInstances[entity.GetUUID()] = instance;
+        if (s_Data->EntityScriptFieldMaps.find(entity.GetUUID()) != s_Data->EntityScriptFieldMaps.end())
         {
-            Ref<ScriptInstance> instance = CreateRef<ScriptInstance>(s_Data->EntityClasses[scriptComponent.ClassName], entity);
-            s_Data->EntityInstances[entity.GetUUID()] = instance;
-            if (s_Data->EntityScriptFieldMaps.find(entity.GetUUID()) != s_Data->EntityScriptFieldMaps.end())
+            const ScriptFieldMap& fieldMap = s_Data->EntityScriptFieldMaps.at(entity.GetUUID());
+            for (const auto& [name, field] : fieldMap)
             {
-                const ScriptFieldMap& fieldMap = s_Data->EntityScriptFieldMaps.at(entity.GetUUID());
-                for (const auto& [name, field] : fieldMap)
+                if (field.Field.Type == ScriptFieldType::String)
                 {
-                    if (field.Field.Type == ScriptFieldType::String)
-                    {
-                        MonoString* monoString = mono_string_new(s_Data->AppDomain, field.m_StringStorage.c_str());
-                        instance->SetFieldValueInternal(name, monoString);
-                    }
-                    else
-                        instance->SetFieldValueInternal(name, field.m_Buffer);
+                    MonoString* monoString = mono_string_new(s_Data->AppDomain, field.m_StringStorage.c_str());
+                    instance->SetFieldValueInternal(name, monoString);
                 }
+                else
+                    instance->SetFieldValueInternal(name, field.m_Buffer);
             }
+        }
+        return instance;
+    }
+
+    void ScriptEngine::OnCreateEntity(Entity entity)
+    {
+        if (Ref<ScriptInstance> instance = CreateEntityInstance(entity))
             instance->InvokeBeginPlay();
+    }
+
+    void ScriptEngine::OnCreateEntities(const std::vector<Entity>& entities)
+    {
+        std::vector<Ref<ScriptInstance>> instances;
+        instances.reserve(entities.size());
+        for (Entity entity : entities)
+        {
+            if (Ref<ScriptInstance> instance = CreateEntityInstance(entity))
+                instances.push_back(instance);
         }
+        for (const Ref<ScriptInstance>& instance : instances)
+            instance->InvokeBeginPlay();
     }
 
     void ScriptEngine::OnDestroyEntity(Entity entity)
@@ -564,6 +583,36 @@ namespace HRealEngine
             instanceB->InvokeOnCollisionExit(idA);
     }
 
+    void ScriptEngine::OnCollisionBeginBatch(const std::vector<std::pair<UUID, UUID>>& pairs)
+    {
+        if (!s_Data)
+            return;
+        for (const auto& [idA, idB] : pairs)
+        {
+            auto itA = s_Data->EntityInstances.find(idA);
+            if (itA != s_Data->EntityInstances.end() && itA->second)
+                itA->second->InvokeOnCollisionEnter(idB);
+            auto itB = s_Data->EntityInstances.find(idB);
+            if (itB != s_Data->EntityInstances.end() && itB->second)
+                itB->second->InvokeOnCollisionEnter(idA);
+        }
+    }
+
+    void ScriptEngine::OnCollisionEndBatch(const std::vector<std::pair<UUID, UUID>>& pairs)
+    {
+        if (!s_Data)
+            return;
+        for (const auto& [idA, idB] : pairs)
+        {
+            auto itA = s_Data->EntityInstances.find(idA);
+            if (itA != s_Data->EntityInstances.end() && itA->second)
+                itA->second->InvokeOnCollisionExit(idB);
+            auto itB = s_Data->EntityInstances.find(idB);
+            if (itB != s_Data->EntityInstances.end() && itB->second)
+                itB->second->InvokeOnCollisionExit(idA);
+        }
+    }
+
     void ScriptEngine::OpenScene(const std::string& path)
     {
         LOG_CORE_INFO("Opening scene {0} from script", path);
@@ -1435,7 +1484,7 @@ namespace HRealEngine
                         char* str = monoStr ? mono_string_to_utf8(monoStr) : nullptr;
                         
                         char buffer[256];
-                        strncpy_s(buffer, str ? str : "", sizeof(buffer));
+                        std::snprintf(buffer, sizeof(buffer), "%s", str ? str : "");
                         
                         if (ImGui::InputText(label.c_str(), buffer, sizeof(buffer)))
                         {
@@ -207,10 +207,16 @@ namespace HRealEngine
 
         static bool IsEntityClassExist(const std::string& className);
         static void OnCreateEntity(Entity entity);
+        // Creates every instance and applies its fields first, then runs BeginPlay, so each BeginPlay can already
+        // reach the other spawned entities' scripts
+        static void OnCreateEntities(const std::vector<Entity>& entities);
         static void OnDestroyEntity(Entity entity);
         static void OnUpdateEntity(Entity entity, Timestep ts);
         static void OnCollisionBegin(Entity entityA, Entity entityB);
         static void OnCollisionEnd(Entity entityA, Entity entityB);
+        // Both entities of every pair get notified once, pairs are expected to be unique
+        static void OnCollisionBeginBatch(const std::vector<std::pair<UUID, UUID>>& pairs);
+        static void OnCollisionEndBatch(const std::vector<std::pair<UUID, UUID>>& pairs);
         static void OpenScene(const std::string& path);
         static MonoString* CreateString(const char* string);
 
@@ -227,6 +233,8 @@ namespace HRealEngine
         static void ShutdownMono();
 
         static MonoObject* InstantiateClass(MonoClass* monoClass);
+        // Creates and registers the instance with its field values applied, BeginPlay is left to the caller
+        static Ref<ScriptInstance> CreateEntityInstance(Entity entity);
         friend class ScriptClass;
         friend class ScriptGlue;
 
@@ -17,6 +17,8 @@
 #include "HRealEngine/Core/MouseButtonCodes.h"
 #include "HRealEngine/Physics/JoltWorld.h"
 #include "HRealEngine/Project/Project.h"
+#include "HRealEngine/Asset/AssetManager.h"
+#include "HRealEngine/Scene/Prefab.h"
 #include "HRealEngine/Utils/PlatformUtils.h"
 #include "Physics/Body/Body.h"
 #include "Physics/Body/BodyInterface.h"
@@ -36,6 +38,9 @@ namespace HRealEngine
 #define HRE_ADD_INTERNAL_CALL_GAMEMODEDATA(Name) mono_add_internal_call("HRealEngine.Calls.InternalCalls_GameModeData::" #Name, Name)
 #define HRE_ADD_INTERNAL_CALL_TEXTCOMPONENT(Name) mono_add_internal_call("HRealEngine.Calls.InternalCalls_TextComponent::" #Name, Name)	
     static std::unordered_map<MonoType*, std::function<bool(Entity)>> s_EntityHasComponentFunctions;
+	// Resolved once per assembly load, looking them up on every call is expensive
+	static MonoClass* s_RaycastHitClass = nullptr;
+	static MonoClass* s_PerceptionResultClass = nullptr;
     
 	static void OpenScene(MonoString* scenePath)
 	{
@@ -64,16 +69,15 @@ namespace HRealEngine
 		scene->DestroyEntity(entity);
 	}
 
-	static uint64_t SpawnEntity(MonoString* name)
+	static uint64_t SpawnEntity(MonoString* name, MonoString* tag, glm::vec3* translation, glm::vec3* rotation, glm::vec3* scale)
 	{
-		auto nameCStr = mono_string_to_utf8(name);
 		Scene* scene = ScriptEngine::GetSceneContext();
 		if (!scene)
 		{
 			LOG_CORE_ERROR("SpawnEntity: Scene context is null!");
-			mono_free(nameCStr);
 			return 0;
 		}
+		char* nameCStr = mono_string_to_utf8(name);
 		Entity entity = scene->CreateEntity(nameCStr);
 		mono_free(nameCStr);
 		if (!entity)
@@ -81,9 +85,62 @@ namespace HRealEngine
 			LOG_CORE_ERROR("SpawnEntity: Failed to create entity!");
 			return 0;
 		}
-		UUID entityID = entity.GetUUID();
-		LOG_CORE_INFO("Spawned entity with name '{}' and ID {}", mono_string_to_utf8(name), (uint64_t)entityID);
-		return entityID;
+
+		auto& transform = entity.GetComponent<TransformComponent>();
+		transform.Position = *translation;
+		transform.Rotation = *rotation;
+		transform.Scale = *scale;
+		if (tag)
+		{
+			char* tagCStr = mono_string_to_utf8(tag);
+			if (tagCStr[0] != '\0')
+				entity.AddTag(tagCStr);
+			mono_free(tagCStr);
+		}
+		return entity.GetUUID();
+	}
+
+	// One call for any number of clones, positions decides the count, rotations and scales may be null or shorter
+	static MonoArray* InstantiatePrefab(MonoString* prefabPath, MonoArray* positions, MonoArray* rotations, MonoArray* scales)
+	{
+		Scene* scene = ScriptEngine::GetSceneContext();
+		if (!scene)
+		{
+			LOG_CORE_ERROR("InstantiatePrefab: Scene context is null!");
+			return nullptr;
+		}
+		if (!positions)
+			return nullptr;
+
+		char* pathCStr = mono_string_to_utf8(prefabPath);
+		AssetHandle handle = Project::GetActive()->GetEditorAssetManager()->GetHandleFromPath(pathCStr);
+		if (handle == 0 || AssetManager::GetAssetType(handle) != AssetType::Prefab)
+		{
+			LOG_CORE_ERROR("InstantiatePrefab: {} is not a prefab asset", pathCStr);
+			mono_free(pathCStr);
+			return nullptr;
+		}
+		mono_free(pathCStr);
+		Ref<Prefab> prefab = AssetManager::GetAsset<Prefab>(handle);
+
+		const uintptr_t count = mono_array_length(positions);
+		const uintptr_t rotationCount = rotations ? mono_array_length(rotations) : 0;
+		const uintptr_t scaleCount = scales ? mono_array_length(scales) : 0;
+		std::vector<TransformComponent> transforms(count);
+		for (uintptr_t i = 0; i < count; i++)
+		{
+			transforms[i].Position = mono_array_get(positions, glm::vec3, i);
+			if (i < rotationCount)
+				transforms[i].Rotation = mono_array_get(rotations, glm::vec3, i);
+			if (i < scaleCount)
+				transforms[i].Scale = mono_array_get(scales, glm::vec3, i);
+		}
+
+		std::vector<Entity> roots = scene->InstantiatePrefab(prefab, transforms);
+		MonoArray* array = mono_array_new(mono_domain_get(), mono_get_uint64_class(), (uintptr_t)roots.size());
+		for (size_t i = 0; i < roots.size(); i++)
+			mono_array_set(array, uint64_t, i, (uint64_t)roots[i].GetUUID());
+		return array;
 	}
 
 	static uint64_t FindEntityByName(MonoString* name)
@@ -97,12 +154,30 @@ namespace HRealEngine
 		return entity.GetUUID();
 	}
 
+	static MonoArray* FindEntitiesWithTag(MonoString* tag)
+	{
+		Scene* scene = ScriptEngine::GetSceneContext();
+		if (!scene)
+		{
+			LOG_CORE_ERROR("FindEntitiesWithTag: Scene context is null!");
+			return nullptr;
+		}
+		char* tagCStr = mono_string_to_utf8(tag);
+		std::vector<Entity> entities = scene->GetEntitiesWithTag(tagCStr);
+		mono_free(tagCStr);
+
+		MonoArray* array = mono_array_new(mono_domain_get(), mono_get_uint64_class(), (uintptr_t)entities.size());
+		for (size_t i = 0; i < entities.size(); i++)
+			mono_array_set(array, uint64_t, i, (uint64_t)entities[i].GetUUID());
+		return array;
+	}
+
     static MonoObject* GetScriptInstance(UUID entityID)
     {
         return ScriptEngine::GetManagedInstance(entityID);
     }
 
-	static bool Raycast3D(glm::vec3* origin, glm::vec3* direction, float maxDistance, MonoArray* ignoreEntitiesIDs,
+	static bool Raycast3D(glm::vec3* origin, glm::vec3* direction, MonoArray* ignoreEntitiesIDs, float maxDistance,
 		uint64_t* outEntityID, glm::vec3* outPoint, glm::vec3* outNormal, float* outDistance, bool debugDraw, float debugLifetime)
 	{
 		std::vector<uint64_t> ignoreList;
@@ -186,15 +261,13 @@ namespace HRealEngine
 		if (results.empty())
 			return nullptr;
 		
-		MonoClass* hitClass = mono_class_from_name(ScriptEngine::GetCoreAssemblyImage(), "HRealEngine", "RaycastHit");
-    
-		if (!hitClass)
+		if (!s_RaycastHitClass)
 		{
 			LOG_CORE_ERROR("Raycast3DArray: Could not find RaycastHit class!");
 			return nullptr;
 		}
 
-		MonoArray* array = mono_array_new(mono_domain_get(), hitClass, (uintptr_t)results.size());
+		MonoArray* array = mono_array_new(mono_domain_get(), s_RaycastHitClass, (uintptr_t)results.size());
 
 		for (size_t i = 0; i < results.size(); i++)
 		{
@@ -209,6 +282,54 @@ namespace HRealEngine
 		}
 		return array;
 	}
+
+	static int PhysicsQueryBatch3D(MonoArray* queries, MonoArray* ignoreEntitiesIDs, MonoArray* outHits)
+	{
+		if (!queries || !outHits)
+			return 0;
+		
+		uintptr_t count = mono_array_length(queries);
+		if (count == 0)
+			return 0;
+		if (mono_array_length(outHits) < count)
+		{
+			LOG_CORE_ERROR("PhysicsQueryBatch3D: Result buffer holds {} hits but {} queries were given!", (uint64_t)mono_array_length(outHits), (uint64_t)count);
+			return 0;
+		}
+		
+		Scene* scene = ScriptEngine::GetSceneContext();
+		if (!scene)
+		{
+			LOG_CORE_ERROR("PhysicsQueryBatch3D: Scene context is null!");
+			return 0;
+		}
+		JoltWorld* joltWorld = scene->GetJoltWorld();
+		if (scene->Is2DPhysicsEnabled() || !joltWorld)
+		{
+			LOG_CORE_ERROR("PhysicsQueryBatch3D: Jolt physics world is not available!");
+			return 0;
+		}
+
+		std::vector<uint64_t> ignoreList;
+		if (ignoreEntitiesIDs != nullptr)
+		{
+			uintptr_t length = mono_array_length(ignoreEntitiesIDs);
+			ignoreList.resize(length);
+			if (length > 0)
+				memcpy(ignoreList.data(), mono_array_addr_with_size(ignoreEntitiesIDs, (int)sizeof(uint64_t), 0), length * sizeof(uint64_t));
+		}
+
+		// Both arrays are blittable structs, read and write them in place
+		const auto* queryData = (const PhysicsQuery3D*)mono_array_addr_with_size(queries, (int)sizeof(PhysicsQuery3D), 0);
+		auto* hitData = (PhysicsQueryHit3D*)mono_array_addr_with_size(outHits, (int)sizeof(PhysicsQueryHit3D), 0);
+		joltWorld->QueryBatch(queryData, (size_t)count, hitData, ignoreList);
+
+		int hitCount = 0;
+		for (uintptr_t i = 0; i < count; i++)
+			if (hitData[i].Hit)
+				hitCount++;
+		return hitCount;
+	}
 	
 	static void ReportNoiseEvent(UUID entityID, glm::vec3* position, float loudness, float maxRange, int sourceType)
 	{
@@ -292,7 +413,7 @@ namespace HRealEngine
 		    return nullptr;
 	    }
 	    
-	    MonoClass* resultClass = mono_class_from_name(ScriptEngine::GetCoreAssemblyImage(), "HRealEngine", "PerceptionResult");
+	    MonoClass* resultClass = s_PerceptionResultClass;
 	    if (!resultClass)
 	    {
 		    LOG_CORE_ERROR("AIController_GetCurrentPerceptions: Could not find PerceptionResult class!");
@@ -338,7 +459,7 @@ namespace HRealEngine
 			return nullptr;
 		}
 	    
-		MonoClass* resultClass = mono_class_from_name(ScriptEngine::GetCoreAssemblyImage(), "HRealEngine", "PerceptionResult");
+		MonoClass* resultClass = s_PerceptionResultClass;
 		if (!resultClass)
 		{
 			LOG_CORE_ERROR("AIController_GetForgottenPerceptions: Could not find PerceptionResult class!");
@@ -467,6 +588,12 @@ namespace HRealEngine
 	    return AIController_GetBlackboard(entityID);
 	}
 	
+	static float BehaviorTree_GetDeltaTime()
+	{
+	    Scene* scene = ScriptEngine::GetSceneContext();
+	    return scene ? scene->GetBehaviorTreeDeltaTime() : Time::GetDeltaTime();
+	}
+
 	static void Blackboard_NotifyValuesChanged(UUID entityID)
 	{
 		Scene* scene = ScriptEngine::GetSceneContext();
@@ -803,6 +930,7 @@ namespace HRealEngine
 		}
 		auto tagCStr = mono_string_to_utf8(tag);
 		entity.RemoveTag(tagCStr);
+		mono_free(tagCStr);
 	}
 
     static uint64_t Entity_FindEntityByName(MonoString* name)
@@ -832,7 +960,7 @@ namespace HRealEngine
 		if (!entity)
 			return;
 		char* nameCStr = mono_string_to_utf8(name);
-		entity.GetComponent<EntityNameComponent>().Name = nameCStr;
+		entity.SetName(nameCStr);
 		mono_free(nameCStr);
 	}
 
@@ -930,7 +1058,7 @@ namespace HRealEngine
     {
         Scene* scene = ScriptEngine::GetSceneContext();
         Entity entity = scene->GetEntityByUUID(entityID);
-        entity.GetComponent<TransformComponent>().Position = *position;
+        entity.PatchComponent<TransformComponent>([position](TransformComponent& transform) { transform.Position = *position; });
     }
 
     static void TransformComponent_GetRotation(UUID entityID, glm::vec3* outRotation)
@@ -944,7 +1072,7 @@ namespace HRealEngine
     {
         Scene* scene = ScriptEngine::GetSceneContext();
         Entity entity = scene->GetEntityByUUID(entityID);
-        entity.GetComponent<TransformComponent>().Rotation = *rotation;
+        entity.PatchComponent<TransformComponent>([rotation](TransformComponent& transform) { transform.Rotation = *rotation; });
     }
 
 	    static void Rigidbody2DComponent_ApplyLinearImpulse(UUID entityID, glm::vec2* impulse, glm::vec2* point, bool wake)
@@ -1644,8 +1772,19 @@ namespace HRealEngine
     {
         s_EntityHasComponentFunctions.clear();
         RegisterComponent(AllComponents{});
+        RegisterManagedClasses();
     }
 
+	void ScriptGlue::RegisterManagedClasses()
+	{
+		s_RaycastHitClass = mono_class_from_name(ScriptEngine::GetCoreAssemblyImage(), "HRealEngine", "RaycastHit");
+		s_PerceptionResultClass = mono_class_from_name(ScriptEngine::GetCoreAssemblyImage(), "HRealEngine", "PerceptionResult");
+		if (!s_RaycastHitClass)
+			LOG_CORE_ERROR("Could not find managed class HRealEngine.RaycastHit");
+		if (!s_PerceptionResultClass)
+			LOG_CORE_ERROR("Could not find managed class HRealEngine.PerceptionResult");
+	}
+
     void ScriptGlue::RegisterFunctions()
     {
         HRE_ADD_INTERNAL_CALL_GLOBAL(OpenScene);
@@ -1653,9 +1792,12 @@ namespace HRealEngine
         HRE_ADD_INTERNAL_CALL_GLOBAL(DestroyEntity);
     	HRE_ADD_INTERNAL_CALL_GLOBAL(SpawnEntity);
 		HRE_ADD_INTERNAL_CALL_GLOBAL(FindEntityByName);
+		HRE_ADD_INTERNAL_CALL_GLOBAL(FindEntitiesWithTag);
+		HRE_ADD_INTERNAL_CALL_GLOBAL(InstantiatePrefab);
         HRE_ADD_INTERNAL_CALL_GLOBAL(GetScriptInstance);
 		HRE_ADD_INTERNAL_CALL_GLOBAL(Raycast3D);
 		HRE_ADD_INTERNAL_CALL_GLOBAL(Raycast3DArray);
+		HRE_ADD_INTERNAL_CALL_GLOBAL(PhysicsQueryBatch3D);
 		HRE_ADD_INTERNAL_CALL_GLOBAL(ReportNoiseEvent);
 		
 		HRE_ADD_INTERNAL_CALL_AICONTROLLER(AIController_GetCurrentPerceptionCount);
@@ -1669,6 +1811,7 @@ namespace HRealEngine
 		
 		HRE_ADD_INTERNAL_CALL_BEHAVIORTREECOMPONENT(BehaviorTreeComponent_GetBlackboard);
 		HRE_ADD_INTERNAL_CALL_BEHAVIORTREECOMPONENT(Blackboard_NotifyValuesChanged);
+		HRE_ADD_INTERNAL_CALL_BEHAVIORTREECOMPONENT(BehaviorTree_GetDeltaTime);
 		
 		HRE_ADD_INTERNAL_CALL_PERCEIVABLE(PerceivableComponent_GetType);
 		HRE_ADD_INTERNAL_CALL_PERCEIVABLE(PerceivableComponent_SetType);
@@ -7,6 +7,7 @@ namespace HRealEngine
     {
     public:
         static void RegisterComponents();
+        static void RegisterManagedClasses();
         static void RegisterFunctions();
         static MonoObject* InstantiateClass(MonoClass* monoClass);
         static void NotifyBlackboardValuesChanged(HBlackboard& blackboard);
@@ -1,6 +1,6 @@
 
-#include "hrpch.h"
-#include "WindowsInput.h"
+#include "HRpch.h"
+#include "GLFWInput.h"
 
 #include <GLFW/glfw3.h>
 #include "HRealEngine/Core/Application.h"
@@ -8,37 +8,44 @@
 
 namespace HRealEngine
 {
-	Input* Input::s_InstanceOfInput = new WindowsInput();
+	Input* Input::s_InstanceOfInput = new GLFWInput();
 	glm::vec2 Input::s_ViewportMousePos = { 0.f, 0.f };
 	Entity* Input::s_HoveredEntity = nullptr;
 	CursorMode Input::s_CursorMode = CursorMode::Normal;
 
-	bool WindowsInput::IsKeyPressedImpl(int keyCode)
+	bool GLFWInput::IsKeyPressedImpl(int keyCode)
 	{
 		auto window = static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
+		if (!window)
+			return false;
 		auto state = glfwGetKey(window, keyCode);
 		return state == GLFW_PRESS;
 	}
-	bool WindowsInput::IsMouseButtonPressedImpl(int button)
+	bool GLFWInput::IsMouseButtonPressedImpl(int button)
 	{
 		auto window = static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
+		if (!window)
+			return false;
 		auto state = glfwGetMouseButton(window, button);
 		return state == GLFW_PRESS;
 	}
-	std::pair<float, float> WindowsInput::GetMousePositionImpl()
+	std::pair<float, float> GLFWInput::GetMousePositionImpl()
 	{
 		auto window = static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
+		if (!window)
+			return { 0.0f, 0.0f };
 		double xPos, yPos;
 		glfwGetCursorPos(window, &xPos, &yPos);
 		return { (float)xPos, (float)yPos };
 	}
 
-	void WindowsInput::SetCursorModeImpl(CursorMode mode)
+	void GLFWInput::SetCursorModeImpl(CursorMode mode)
 	{
 		auto window = static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
 		if (!window)
 		{
-			LOG_CORE_ERROR("No window found when trying to set cursor mode!");
+			if (!Application::Get().IsHeadless())
+				LOG_CORE_ERROR("No window found when trying to set cursor mode!");
 			return;
 		}
 		switch (mode)
@@ -62,20 +69,14 @@ namespace HRealEngine
 		}
 	}
 
-	float WindowsInput::GetMouseXImpl()
+	float GLFWInput::GetMouseXImpl()
 	{
-		//auto window = static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
-		//double xPos, yPos;
-		//glfwGetCursorPos(window, &xPos, &yPos);
 		auto [x, y] = GetMousePositionImpl();
-		return /*(float)xPos*/ x;
+		return x;
 	}
-	float WindowsInput::GetMouseYImpl()
+	float GLFWInput::GetMouseYImpl()
 	{
-		//auto window = static_cast<GLFWwindow*>(Application::Get().GetWindow().GetNativeWindow());
-		//double xPos, yPos;
-		//glfwGetCursorPos(window, &xPos, &yPos);
 		auto [x, y] = GetMousePositionImpl();
-		return /*(float)yPos*/y;
+		return y;
 	}
 }
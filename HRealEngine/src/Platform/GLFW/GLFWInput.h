@@ -5,7 +5,7 @@
 
 namespace HRealEngine
 {
-	class WindowsInput : public Input
+	class GLFWInput : public Input
 	{
 	protected:
 		bool IsKeyPressedImpl(int keyCode) override;
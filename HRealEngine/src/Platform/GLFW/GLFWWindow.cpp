@@ -1,7 +1,7 @@
 
-//WindowsWindow.cpp
+//GLFWWindow.cpp
 #include "HRpch.h"
-#include "WindowsWindow.h"
+#include "GLFWWindow.h"
 
 #include <filesystem>
 
@@ -24,26 +24,26 @@ namespace HRealEngine
 
 	Scope<Window> Window::Create(const WindowSettings& settings)
 	{
-		return CreateScope<WindowsWindow>(settings);
+		return CreateScope<GLFWWindow>(settings);
 	}
 
-	WindowsWindow::WindowsWindow(const WindowSettings& settings)
+	GLFWWindow::GLFWWindow(const WindowSettings& settings)
 	{
 		Init(settings);
 	}
 
-	WindowsWindow::~WindowsWindow()
+	GLFWWindow::~GLFWWindow()
 	{
 		Shutdown();
 	}
 
-	void WindowsWindow::OnUpdate()
+	void GLFWWindow::OnUpdate()
 	{
 		glfwPollEvents();
 		m_Context->SwapBuffers();
 	}
 
-	void WindowsWindow::SetVSync(bool enabled)
+	void GLFWWindow::SetVSync(bool enabled)
 	{
 		if(enabled)
 		{
@@ -58,12 +58,12 @@ namespace HRealEngine
 		m_WindowData.VSync = enabled;
 	}
 
-	bool WindowsWindow::IsVSync() const
+	bool GLFWWindow::IsVSync() const
 	{
 		return m_WindowData.VSync;
 	}
 
-	void WindowsWindow::Init(const WindowSettings& settings)
+	void GLFWWindow::Init(const WindowSettings& settings)
 	{
 		m_WindowData.Height = settings.Height;
 		m_WindowData.Width = settings.Width;
@@ -88,7 +88,7 @@ namespace HRealEngine
 		SetupGLFWCallbacks();
 	}
 
-	void WindowsWindow::SetupGLFWCallbacks()
+	void GLFWWindow::SetupGLFWCallbacks()
 	{
 		glfwSetWindowSizeCallback(m_Window, [](GLFWwindow* window, int width, int height)
 		{
@@ -179,7 +179,7 @@ namespace HRealEngine
 		});
 	}
 
-	void WindowsWindow::Shutdown()
+	void GLFWWindow::Shutdown()
 	{
 		glfwDestroyWindow(m_Window);
 	}
@@ -1,5 +1,5 @@
 
-//WindowsWindow.h
+//GLFWWindow.h
 #pragma once
 #include <GLFW/glfw3.h>
 #include "HRealEngine/Core/Window.h"
@@ -7,11 +7,11 @@
 
 namespace HRealEngine
 {
-	class WindowsWindow : public Window
+	class GLFWWindow : public Window
 	{
 	public:
-		WindowsWindow(const WindowSettings& settings);
-		virtual ~WindowsWindow();
+		GLFWWindow(const WindowSettings& settings);
+		virtual ~GLFWWindow();
 
 		void OnUpdate() override;
 
@@ -0,0 +1,50 @@
+#include "HRpch.h"
+#include "HRealEngine/Core/FileSystem.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace HRealEngine
+{
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    bool MappedFile::Open(const std::filesystem::path& filepath)
+    {
+        Close();
+
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file referenced
+        close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+        m_Data = (const uint8_t*)data;
+        m_Size = (uint64_t)info.st_size;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_Data)
+            munmap((void*)m_Data, (size_t)m_Size);
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+}
@@ -0,0 +1,99 @@
+#include "HRpch.h"
+#include "HRealEngine/Utils/PlatformUtils.h"
+#include "HRealEngine/Core/Application.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sys/wait.h>
+#include <time.h>
+
+namespace HRealEngine
+{
+    float Time::s_DeltaTime = 0.f;
+    float Time::GetTime()
+    {
+        static const timespec s_Start = [] { timespec start; clock_gettime(CLOCK_MONOTONIC, &start); return start; }();
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (float)((double)(now.tv_sec - s_Start.tv_sec) + (double)(now.tv_nsec - s_Start.tv_nsec) * 1e-9);
+    }
+
+    // Turns a Windows style filter ("Name\0*.ext;*.ext2\0...\0") into zenity --file-filter arguments
+    static std::string BuildZenityFilters(const char* filter, std::string& outDefaultExtension)
+    {
+        std::string args;
+        while (filter && *filter)
+        {
+            std::string name = filter;
+            filter += name.size() + 1;
+            if (!*filter)
+                break;
+            std::string patterns = filter;
+            filter += patterns.size() + 1;
+
+            std::replace(patterns.begin(), patterns.end(), ';', ' ');
+            if (outDefaultExtension.empty() && patterns.rfind("*.", 0) == 0)
+                outDefaultExtension = patterns.substr(1, patterns.find(' ') == std::string::npos ? std::string::npos : patterns.find(' ') - 1);
+            args += " --file-filter='" + name + " | " + patterns + "'";
+        }
+        return args;
+    }
+
+    // Returns false if no dialog could be shown (no display or zenity is not installed), cancelling still counts as shown
+    static bool RunZenity(const std::string& args, std::string& outPath)
+    {
+        if (!std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY"))
+            return false;
+
+        std::string command = "zenity --file-selection" + args + " 2>/dev/null";
+        FILE* pipe = popen(command.c_str(), "r");
+        if (!pipe)
+            return false;
+
+        char buffer[4096];
+        std::string result;
+        while (fgets(buffer, sizeof(buffer), pipe))
+            result += buffer;
+        int status = pclose(pipe);
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0 && WEXITSTATUS(status) != 1))
+            return false;
+
+        while (!result.empty() && (result.back() == '\n' || result.back() == '\r'))
+            result.pop_back();
+        outPath = WEXITSTATUS(status) == 0 ? result : std::string();
+        return true;
+    }
+
+    // Fallback for machines without a desktop, the path is passed on the command line ("--open-file <path>" / "--save-file <path>")
+    static std::string GetPathFromCommandLine(const char* flag)
+    {
+        const AppCommandLineArgs& args = Application::Get().GetSpecification().CommandLineArgs;
+        for (int i = 1; i + 1 < args.Count; i++)
+            if (std::strcmp(args[i], flag) == 0)
+                return args[i + 1];
+        LOG_CORE_WARN("No file dialog available, pass the path with {} <path>", flag);
+        return std::string();
+    }
+
+    std::string FileDialogs::OpenFile(const char* filter)
+    {
+        std::string defaultExtension;
+        std::string path;
+        if (RunZenity(BuildZenityFilters(filter, defaultExtension), path))
+            return path;
+        return GetPathFromCommandLine("--open-file");
+    }
+    std::string FileDialogs::SaveFile(const char* filter)
+    {
+        std::string defaultExtension;
+        std::string path;
+        if (!RunZenity(" --save --confirm-overwrite" + BuildZenityFilters(filter, defaultExtension), path))
+            path = GetPathFromCommandLine("--save-file");
+        
+        if (!path.empty() && !defaultExtension.empty() && std::filesystem::path(path).extension().empty())
+            path += defaultExtension;
+        return path;
+    }
+}
@@ -0,0 +1,10 @@
+#include "HRpch.h"
+#include "NullRendererAPI.h"
+
+namespace HRealEngine
+{
+    void NullRendererAPI::Init()
+    {
+        LOG_CORE_INFO("Renderer running headless, no graphics context will be created");
+    }
+}
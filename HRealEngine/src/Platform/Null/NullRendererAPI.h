@@ -0,0 +1,23 @@
+#pragma once
+#include "HRealEngine/Renderer/RendererAPI.h"
+
+namespace HRealEngine
+{
+    // Backend for RendererAPI::API::None, every command is a no-op so headless applications never touch a GPU
+    class NullRendererAPI : public RendererAPI
+    {
+    public:
+        void Init() override;
+        void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override {}
+        
+        void SetClearColor(const glm::vec4& color) override {}
+        void Clear() override {}
+
+        void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t IndexCount = 0) override {}
+        void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset, uint32_t baseVertex = 0) override {}
+        void DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t baseInstance = 0) override {}
+        void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, uint32_t firstVertex = 0) override {}
+        void SetLineWidth(float width) override {}
+        bool SupportsBindlessTextures() const override { return false; }
+    };
+}
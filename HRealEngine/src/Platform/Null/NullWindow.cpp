@@ -0,0 +1,13 @@
+#include "HRpch.h"
+#include "NullWindow.h"
+
+namespace HRealEngine
+{
+	NullWindow::NullWindow(const WindowSettings& settings)
+	{
+		m_WindowData.Width = settings.Width;
+		m_WindowData.Height = settings.Height;
+		m_WindowData.Title = settings.Title;
+		LOG_CORE_INFO("Creating headless window: {0} ({1}, {2})", m_WindowData.Title, m_WindowData.Width, m_WindowData.Height);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "HRealEngine/Core/Window.h"
+
+namespace HRealEngine
+{
+	// Window used by headless applications, there is no OS window, no GLFW and no graphics context behind it
+	class NullWindow : public Window
+	{
+	public:
+		NullWindow(const WindowSettings& settings);
+		virtual ~NullWindow() = default;
+
+		void OnUpdate() override {}
+
+		unsigned int GetWidth() const override { return m_WindowData.Width; }
+		unsigned int GetHeight() const override { return m_WindowData.Height; }
+
+		void SetEventCallback(const EventCallbackFn& callback) override { m_WindowData.EventCallback = callback; }
+		void SetVSync(bool enabled) override { m_WindowData.VSync = enabled; }
+		bool IsVSync() const override { return m_WindowData.VSync; }
+
+		void* GetNativeWindow() const override { return nullptr; }
+	private:
+		struct WindowData
+		{
+			unsigned int Width;
+			unsigned int Height;
+			std::string Title;
+			bool VSync = false;
+			EventCallbackFn EventCallback;
+		};
+		WindowData m_WindowData;
+	};
+}
@@ -0,0 +1,60 @@
+#include "HRpch.h"
+#include "OpenGLBindlessTexture.h"
+
+namespace HRealEngine
+{
+    typedef GLuint64 (APIENTRYP GetTextureSamplerHandleProc)(GLuint texture, GLuint sampler);
+    typedef void (APIENTRYP MakeTextureHandleResidentProc)(GLuint64 handle);
+    typedef void (APIENTRYP MakeTextureHandleNonResidentProc)(GLuint64 handle);
+
+    static GetTextureSamplerHandleProc s_GetTextureSamplerHandle = nullptr;
+    static MakeTextureHandleResidentProc s_MakeTextureHandleResident = nullptr;
+    static MakeTextureHandleNonResidentProc s_MakeTextureHandleNonResident = nullptr;
+
+    bool OpenGLBindlessTexture::s_bSupported = false;
+
+    static bool HasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    void OpenGLBindlessTexture::Load(GLADloadproc loader)
+    {
+        s_bSupported = false;
+        if (!HasExtension("GL_ARB_bindless_texture"))
+        {
+            LOG_CORE_INFO("GL_ARB_bindless_texture not available, batches fall back to texture slots");
+            return;
+        }
+
+        s_GetTextureSamplerHandle = (GetTextureSamplerHandleProc)loader("glGetTextureSamplerHandleARB");
+        s_MakeTextureHandleResident = (MakeTextureHandleResidentProc)loader("glMakeTextureHandleResidentARB");
+        s_MakeTextureHandleNonResident = (MakeTextureHandleNonResidentProc)loader("glMakeTextureHandleNonResidentARB");
+        s_bSupported = s_GetTextureSamplerHandle && s_MakeTextureHandleResident && s_MakeTextureHandleNonResident;
+        if (!s_bSupported)
+            LOG_CORE_WARN("GL_ARB_bindless_texture is advertised but its entry points could not be loaded");
+    }
+
+    uint64_t OpenGLBindlessTexture::GetTextureSamplerHandle(uint32_t texture, uint32_t sampler)
+    {
+        return s_GetTextureSamplerHandle(texture, sampler);
+    }
+
+    void OpenGLBindlessTexture::MakeResident(uint64_t handle)
+    {
+        s_MakeTextureHandleResident(handle);
+    }
+
+    void OpenGLBindlessTexture::MakeNonResident(uint64_t handle)
+    {
+        s_MakeTextureHandleNonResident(handle);
+    }
+}
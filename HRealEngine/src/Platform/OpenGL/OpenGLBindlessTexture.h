@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include "glad/glad.h"
+
+namespace HRealEngine
+{
+    // GL_ARB_bindless_texture entry points, glad here is generated core only so they are loaded by hand after it
+    class OpenGLBindlessTexture
+    {
+    public:
+        static void Load(GLADloadproc loader);
+        static bool IsSupported() { return s_bSupported; }
+
+        // The handle pins the sampling state of both objects, neither may be changed afterwards
+        static uint64_t GetTextureSamplerHandle(uint32_t texture, uint32_t sampler);
+        static void MakeResident(uint64_t handle);
+        static void MakeNonResident(uint64_t handle);
+    private:
+        static bool s_bSupported;
+    };
+}
@@ -5,7 +5,7 @@
 
 namespace HRealEngine
 {
-    OpenGLVertexBuffer::OpenGLVertexBuffer(float* vertices, uint32_t size)
+    OpenGLVertexBuffer::OpenGLVertexBuffer(const void* vertices, uint32_t size)
     {
         glCreateBuffers(1, &m_RendererID);
         glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
@@ -42,7 +42,82 @@ namespace HRealEngine
 
     //-------------------------------------------
 
-    OpenGLIndexBuffer::OpenGLIndexBuffer(uint32_t* indices, uint32_t count) : m_Count(count)
+    OpenGLStreamingVertexBuffer::OpenGLStreamingVertexBuffer(uint32_t batchSize, uint32_t batchesPerRegion, uint32_t regionCount)
+        : m_BatchSize(batchSize), m_RegionSize(batchSize * batchesPerRegion), m_RegionFences(regionCount, nullptr)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr totalSize = (GLsizeiptr)m_RegionSize * regionCount;
+
+        glCreateBuffers(1, &m_RendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glNamedBufferStorage(m_RendererID, totalSize, nullptr, flags);
+        m_MappedData = (uint8_t*)glMapNamedBufferRange(m_RendererID, 0, totalSize, flags);
+        HREALENGINE_CORE_DEBUGBREAK(m_MappedData, "Failed to map streaming vertex buffer!");
+    }
+
+    OpenGLStreamingVertexBuffer::~OpenGLStreamingVertexBuffer()
+    {
+        for (void* fence : m_RegionFences)
+            if (fence)
+                glDeleteSync((GLsync)fence);
+        glUnmapNamedBuffer(m_RendererID);
+        glDeleteBuffers(1, &m_RendererID);
+    }
+
+    void OpenGLStreamingVertexBuffer::Bind() const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    }
+
+    void OpenGLStreamingVertexBuffer::Unbind() const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void OpenGLStreamingVertexBuffer::SetData(const void* data, uint32_t size)
+    {
+        HREALENGINE_CORE_DEBUGBREAK(size <= m_BatchSize, "Data does not fit in a streaming batch!");
+        memcpy(Map(), data, size);
+    }
+
+    void* OpenGLStreamingVertexBuffer::Map()
+    {
+        if (m_RegionOffset + m_BatchSize > m_RegionSize)
+        {
+            // Every draw reading the region has been issued, one fence covers all of them
+            m_RegionFences[m_CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            m_CurrentRegion = (m_CurrentRegion + 1) % (uint32_t)m_RegionFences.size();
+            m_RegionOffset = 0;
+        }
+
+        void*& fence = m_RegionFences[m_CurrentRegion];
+        if (fence)
+        {
+            GLenum status = glClientWaitSync((GLsync)fence, 0, 0);
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync((GLsync)fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            glDeleteSync((GLsync)fence);
+            fence = nullptr;
+        }
+        return m_MappedData + (size_t)m_CurrentRegion * m_RegionSize + m_RegionOffset;
+    }
+
+    void OpenGLStreamingVertexBuffer::Commit(uint32_t size)
+    {
+        HREALENGINE_CORE_DEBUGBREAK(size <= m_BatchSize, "Batch overran its streaming space!");
+        m_RegionOffset += size;
+    }
+
+    uint32_t OpenGLStreamingVertexBuffer::GetBaseVertex() const
+    {
+        const uint32_t stride = m_Layout.GetStride();
+        HREALENGINE_CORE_DEBUGBREAK(stride && m_BatchSize % stride == 0 && m_RegionOffset % stride == 0, "Streaming batches must be a multiple of the vertex stride!");
+        return (m_CurrentRegion * m_RegionSize + m_RegionOffset) / stride;
+    }
+
+    //-------------------------------------------
+
+    OpenGLIndexBuffer::OpenGLIndexBuffer(const uint32_t* indices, uint32_t count) : m_Count(count)
     {
         glCreateBuffers(1, &m_RendererID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
@@ -9,7 +9,7 @@ namespace HRealEngine
     class OpenGLVertexBuffer : public VertexBuffer
     {
     public:
-        OpenGLVertexBuffer(float* vertices, uint32_t size);
+        OpenGLVertexBuffer(const void* vertices, uint32_t size);
         OpenGLVertexBuffer(uint32_t size);
         ~OpenGLVertexBuffer() override;
 
@@ -25,10 +25,39 @@ namespace HRealEngine
         BufferLayout m_Layout;
     };
 
+    class OpenGLStreamingVertexBuffer : public StreamingVertexBuffer
+    {
+    public:
+        OpenGLStreamingVertexBuffer(uint32_t batchSize, uint32_t batchesPerRegion, uint32_t regionCount);
+        ~OpenGLStreamingVertexBuffer() override;
+
+        void Bind() const override;
+        void Unbind() const override;
+
+        const BufferLayout& GetLayout() const override { return m_Layout; }
+        void SetLayout(const BufferLayout& layout) override { m_Layout = layout; }
+
+        // Copies into the mapped region, for callers that still build their vertices elsewhere
+        void SetData(const void* data, uint32_t size) override;
+
+        void* Map() override;
+        void Commit(uint32_t size) override;
+        uint32_t GetBaseVertex() const override;
+    private:
+        uint32_t m_RendererID;
+        BufferLayout m_Layout;
+        uint8_t* m_MappedData = nullptr;
+        uint32_t m_BatchSize;
+        uint32_t m_RegionSize;
+        uint32_t m_CurrentRegion = 0;
+        uint32_t m_RegionOffset = 0;//bytes already committed in the current region
+        std::vector<void*> m_RegionFences;//GLsync per region, null once the GPU is done with it
+    };
+
     class OpenGLIndexBuffer : public IndexBuffer
     {
     public:
-        OpenGLIndexBuffer(uint32_t* indices, uint32_t count);
+        OpenGLIndexBuffer(const uint32_t* indices, uint32_t count);
         ~OpenGLIndexBuffer() override;
 
         void Bind() const override;
@@ -3,6 +3,7 @@
 #include "HRpch.h"
 #include "OpenGLContext.h"
 #include "glad/glad.h"
+#include "OpenGLBindlessTexture.h"
 
 namespace HRealEngine
 {
@@ -16,6 +17,7 @@ namespace HRealEngine
         glfwMakeContextCurrent(windowRef);
         int status = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
         HREALENGINE_CORE_DEBUGBREAK(status, "Failed to initialize GLAD");
+        OpenGLBindlessTexture::Load((GLADloadproc)glfwGetProcAddress);
     }
 
     void OpenGLContext::SwapBuffers()
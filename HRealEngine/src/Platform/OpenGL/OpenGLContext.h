@@ -1,7 +1,7 @@
 
 
 #pragma once
-#include "Platform/Windows/WindowsWindow.h"
+#include "Platform/GLFW/GLFWWindow.h"
 
 namespace HRealEngine
 {
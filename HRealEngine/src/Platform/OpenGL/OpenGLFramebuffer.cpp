@@ -101,6 +101,12 @@ namespace HRealEngine
         glDeleteFramebuffers(1, &m_rendererID);
         glDeleteTextures(static_cast<GLsizei>(m_ColorAttachments.size()), m_ColorAttachments.data());
         glDeleteTextures(1, &m_DepthAttachment);
+        for (PixelReadback& readback : m_Readbacks)
+        {
+            if (readback.Fence)
+                glDeleteSync((GLsync)readback.Fence);
+            glDeleteBuffers(1, &readback.Buffer);
+        }
     }
 
     void OpenGLFramebuffer::Invalidate()
@@ -200,6 +206,65 @@ namespace HRealEngine
         return pixelData;
     }
 
+    uint64_t OpenGLFramebuffer::RequestReadback(uint32_t attachmentIndex, int x, int y, uint32_t width, uint32_t height)
+    {
+        PixelReadback* slot = nullptr;
+        for (PixelReadback& readback : m_Readbacks)
+        {
+            if (readback.Ticket == 0)
+            {
+                slot = &readback;
+                break;
+            }
+            if (!slot || readback.Ticket < slot->Ticket)
+                slot = &readback;
+        }
+        if (slot->Fence)
+            glDeleteSync((GLsync)slot->Fence);
+
+        const bool bInteger = m_ColorAttachmentSpecs[attachmentIndex].TextureFormat == FramebufferTextureFormat::RED_INTEGER;
+        const uint64_t size = (uint64_t)width * height * 4;
+        if (!slot->Buffer)
+            glCreateBuffers(1, &slot->Buffer);
+        if (slot->Capacity < size)
+        {
+            glNamedBufferData(slot->Buffer, (GLsizeiptr)size, nullptr, GL_STREAM_READ);
+            slot->Capacity = size;
+        }
+
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentIndex);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->Buffer);
+        glReadPixels(x, y, width, height, bInteger ? GL_RED_INTEGER : GL_RGBA, bInteger ? GL_INT : GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot->Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot->Size = size;
+        slot->Ticket = m_NextReadbackTicket++;
+        return slot->Ticket;
+    }
+
+    bool OpenGLFramebuffer::TryGetReadback(uint64_t ticket, std::vector<uint8_t>& outData)
+    {
+        for (PixelReadback& readback : m_Readbacks)
+        {
+            if (readback.Ticket != ticket || ticket == 0)
+                continue;
+
+            // Zero timeout only polls the fence
+            const GLenum status = glClientWaitSync((GLsync)readback.Fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                return false;
+
+            outData.resize(readback.Size);
+            glGetNamedBufferSubData(readback.Buffer, 0, (GLsizeiptr)readback.Size, outData.data());
+            glDeleteSync((GLsync)readback.Fence);
+            readback.Fence = nullptr;
+            readback.Ticket = 0;
+            return true;
+        }
+        return false;
+    }
+
     void OpenGLFramebuffer::ClearAttachment(uint32_t attachmentIndex, int value)
     {
         auto& spec = m_ColorAttachmentSpecs[attachmentIndex];
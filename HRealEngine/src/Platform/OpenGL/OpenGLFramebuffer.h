@@ -18,6 +18,8 @@ namespace HRealEngine
 
         void Resize(uint32_t width, uint32_t height) override;
         int ReadPixel(uint32_t attachmentIndex, int x, int y) override;
+        uint64_t RequestReadback(uint32_t attachmentIndex, int x, int y, uint32_t width, uint32_t height) override;
+        bool TryGetReadback(uint64_t ticket, std::vector<uint8_t>& outData) override;
 
         void ClearAttachment(uint32_t attachmentIndex, int value) override;
 
@@ -32,5 +34,18 @@ namespace HRealEngine
 
         std::vector<uint32_t> m_ColorAttachments;
         uint32_t m_DepthAttachment = 0;
+
+        // Pixel pack buffers in flight, a slot is free again once its result is taken or it gets recycled
+        struct PixelReadback
+        {
+            uint32_t Buffer = 0;
+            uint64_t Capacity = 0;
+            uint64_t Size = 0;
+            void* Fence = nullptr;
+            uint64_t Ticket = 0;
+        };
+        static constexpr uint32_t s_ReadbackSlotCount = 3;
+        PixelReadback m_Readbacks[s_ReadbackSlotCount];
+        uint64_t m_NextReadbackTicket = 1;
     };
 }
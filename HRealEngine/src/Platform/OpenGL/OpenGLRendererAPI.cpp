@@ -4,6 +4,8 @@
 #include "HRealEngine/Renderer/VertexArray.h"
 #include <glad/glad.h>
 
+#include "OpenGLBindlessTexture.h"
+
 namespace HRealEngine
 {
     void OpenGLRendererAPI::Init()
@@ -37,7 +39,7 @@ namespace HRealEngine
         glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
     }
 
-    void OpenGLRendererAPI::DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset)
+    void OpenGLRendererAPI::DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset, uint32_t baseVertex)
     {
         vertexArray->Bind();
 
@@ -45,17 +47,32 @@ namespace HRealEngine
         
         const uintptr_t byteOffset = (uintptr_t)indexOffset * sizeof(uint32_t);
 
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)byteOffset);
+        if (baseVertex)
+            glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)byteOffset, (GLint)baseVertex);
+        else
+            glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)byteOffset);
     }
 
-    void OpenGLRendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount)
+    void OpenGLRendererAPI::DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t baseInstance)
     {
         vertexArray->Bind();
-        glDrawArrays(GL_LINES, 0, vertexCount);
+        const uint32_t count = indexCount ? indexCount : vertexArray->GetIndexBuffer()->GetCount();
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, instanceCount, baseInstance);
+    }
+
+    void OpenGLRendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, uint32_t firstVertex)
+    {
+        vertexArray->Bind();
+        glDrawArrays(GL_LINES, (GLint)firstVertex, vertexCount);
     }
 
     void OpenGLRendererAPI::SetLineWidth(float width)
     {
         glLineWidth(width);
     }
+
+    bool OpenGLRendererAPI::SupportsBindlessTextures() const
+    {
+        return OpenGLBindlessTexture::IsSupported();
+    }
 }
@@ -15,9 +15,11 @@ namespace HRealEngine
         void Clear() override;
 
         void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t IndexCount = 0) override;
-        void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset) override;
-        void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount) override;
+        void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t indexOffset, uint32_t baseVertex = 0) override;
+        void DrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t baseInstance = 0) override;
+        void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, uint32_t firstVertex = 0) override;
         void SetLineWidth(float width) override;
+        bool SupportsBindlessTextures() const override;
     };
     
 }
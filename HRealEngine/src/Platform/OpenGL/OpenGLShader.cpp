@@ -2,7 +2,10 @@
 #include "HRpch.h"
 #include "OpenGLShader.h"
 #include "HRealEngine/Core/Core.h"
+#include "HRealEngine/Core/Hash.h"
+#include "OpenGLBindlessTexture.h"
 
+#include <filesystem>
 #include <fstream>
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -21,27 +24,122 @@ namespace HRealEngine
 		return 0;
 	}
 
+	static const char* GetCacheDirectory()
+	{
+		return "assets/cache/shader/opengl";
+	}
+
+	struct ProgramBinaryHeader
+	{
+		uint32_t Magic = 0;
+		uint32_t BinaryFormat = 0;
+		uint64_t SourceHash = 0;
+		uint32_t BinarySize = 0;
+	};
+	static constexpr uint32_t s_ProgramBinaryMagic = 0x48525042; // "HRPB"
+
+	// Binaries are driver specific, the driver strings go into the hash so an update recompiles from source
+	static uint64_t HashShaderSources(const std::unordered_map<GLenum, std::string>& shaderSources)
+	{
+		uint64_t hash = s_HashBytesSeed;
+		for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+		{
+			const char* value = (const char*)glGetString(name);
+			if (value)
+				hash = HashBytes(hash, value, strlen(value));
+		}
+
+		std::vector<GLenum> stages;
+		for (auto& [stage, source] : shaderSources)
+			stages.push_back(stage);
+		std::sort(stages.begin(), stages.end());
+		for (GLenum stage : stages)
+		{
+			const std::string& source = shaderSources.at(stage);
+			hash = HashBytes(hash, &stage, sizeof(stage));
+			hash = HashBytes(hash, source.data(), source.size());
+		}
+		return hash;
+	}
+
+	// Indexed by keyword bit, see ShaderKeyword
+	static const char* s_KeywordDefines[] = {
+		"QUANTIZED_VERTICES", "HAS_ALBEDO", "HAS_SPECULAR", "HAS_NORMAL", "HAS_SHADOW_MAP", "HAS_POINT_SHADOW_MAP", "DEBUG_VIEW"
+	};
+
+	// The defines go right after #version, which has to stay the first statement of every stage.
+	// USE_BINDLESS follows OpenGLBindlessTexture::IsSupported() so the shaders agree with what the renderers upload
+	static std::unordered_map<GLenum, std::string> InjectKeywordDefines(const std::unordered_map<GLenum, std::string>& shaderSources, uint64_t keywords)
+	{
+		std::string defines;
+		if (OpenGLBindlessTexture::IsSupported())
+			defines += "#define USE_BINDLESS\n";
+		for (uint32_t bit = 0; bit < (uint32_t)(sizeof(s_KeywordDefines) / sizeof(s_KeywordDefines[0])); bit++)
+		{
+			if (keywords & (1ull << bit))
+				defines += std::string("#define ") + s_KeywordDefines[bit] + "\n";
+		}
+
+		std::unordered_map<GLenum, std::string> result = shaderSources;
+		for (auto& [stage, source] : result)
+		{
+			size_t insertPos = 0;
+			size_t versionPos = source.find("#version");
+			if (versionPos != std::string::npos)
+			{
+				size_t eol = source.find('\n', versionPos);
+				insertPos = eol == std::string::npos ? source.size() : eol + 1;
+			}
+			source.insert(insertPos, defines);
+		}
+		return result;
+	}
+
     OpenGLShader::OpenGLShader(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource) : m_ShaderName(name)
     {
-		std::unordered_map<GLenum, std::string> shaderSources;
-		shaderSources[GL_VERTEX_SHADER] = vertexSource;
-		shaderSources[GL_FRAGMENT_SHADER] = fragmentSource;
-		Compile(shaderSources);
+		m_ShaderSources[GL_VERTEX_SHADER] = vertexSource;
+		m_ShaderSources[GL_FRAGMENT_SHADER] = fragmentSource;
+		m_RendererID = Compile(InjectKeywordDefines(m_ShaderSources, 0), m_ShaderName);
+		m_Variants[0] = m_RendererID;
     }
 
     OpenGLShader::OpenGLShader(const std::string& filePath)
     {
-		std::string source = ReadFile(filePath);
-		auto shaderSource = PreProcess(source);
-		Compile(shaderSource);
-
 		auto lastSlash = filePath.find_last_of("/\\");
 		lastSlash = lastSlash == std::string::npos ? 0 : lastSlash + 1;
 		auto lastDot = filePath.rfind('.');
 		auto count = lastDot == std::string::npos ? filePath.size() - lastSlash : lastDot - lastSlash;
 		m_ShaderName = filePath.substr(lastSlash, count);
+
+		std::string source = ReadFile(filePath);
+		m_ShaderSources = PreProcess(source);
+		m_RendererID = Compile(InjectKeywordDefines(m_ShaderSources, 0), m_ShaderName);
+		m_Variants[0] = m_RendererID;
     }
 
+	void OpenGLShader::SetKeywords(uint64_t keywords)
+	{
+		if (keywords == m_Keywords)
+			return;
+
+		auto it = m_Variants.find(keywords);
+		if (it == m_Variants.end())
+		{
+			char suffix[24];
+			snprintf(suffix, sizeof(suffix), "_%llx", (unsigned long long)keywords);
+			uint32_t program = Compile(InjectKeywordDefines(m_ShaderSources, keywords), m_ShaderName + suffix);
+			if (program == 0)
+				LOG_CORE_ERROR("Shader '{0}' variant {1} failed to compile, using the base variant", m_ShaderName, keywords);
+			// A failed variant is stored as 0 so it is not compiled again
+			it = m_Variants.emplace(keywords, program).first;
+		}
+		if (it->second == 0)
+			it = m_Variants.find(0);
+		// The keywords of the bound program, so per variant uniform state follows what is actually drawn
+		m_Keywords = it->first;
+		m_RendererID = it->second;
+	}
+
 	std::string OpenGLShader::ReadFile(const std::string& filePath)
 	{
     	std::string result;
@@ -84,9 +182,14 @@ namespace HRealEngine
 		return shaderSources;
 	}
 
-	void OpenGLShader::Compile(const std::unordered_map<GLenum,std::string>& shaderSources)
+	uint32_t OpenGLShader::Compile(const std::unordered_map<GLenum,std::string>& shaderSources, const std::string& cacheName)
     {
+		const uint64_t sourceHash = HashShaderSources(shaderSources);
+		if (uint32_t cachedProgram = LoadProgramBinary(cacheName, sourceHash))
+			return cachedProgram;
+
 		GLuint program = glCreateProgram();
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		/*HREALENGINE_CORE_DEBUGBREAK(shaderSources.size() <= 2, "only 2 shaders are supported (vertex and fragment)");*/
 		HREALENGINE_CORE_DEBUGBREAK(shaderSources.find(GL_VERTEX_SHADER) != shaderSources.end(), "Missing vertex shader!");
 		HREALENGINE_CORE_DEBUGBREAK(shaderSources.find(GL_FRAGMENT_SHADER) != shaderSources.end(), "Missing fragment shader!");
@@ -94,17 +197,17 @@ namespace HRealEngine
 		std::vector<GLuint> glShaderIDs;
 		//int glShaderIDIndex = 0;
 		glShaderIDs.reserve(shaderSources.size());
+		// Every stage is submitted before the first status query, drivers with threaded compilers then build them side by side
 		for (auto& shaderSource : shaderSources)
 		{
-			GLenum shaderType = shaderSource.first;
-			const std::string& source = shaderSource.second;
-
-			GLuint shader = glCreateShader(shaderType);
-			
-			const GLchar* sourceCStr = source.c_str();
+			GLuint shader = glCreateShader(shaderSource.first);
+			const GLchar* sourceCStr = shaderSource.second.c_str();
 			glShaderSource(shader, 1, &sourceCStr, nullptr);
 			glCompileShader(shader);
-
+			glShaderIDs.push_back(shader);
+		}
+		for (GLuint shader : glShaderIDs)
+		{
 			GLint isCompiled = 0;
 			glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
 			if(isCompiled == GL_FALSE)
@@ -115,17 +218,13 @@ namespace HRealEngine
 				std::vector<GLchar> infoLog(maxLength);
 				glGetShaderInfoLog(shader, maxLength, &maxLength, &infoLog[0]);
 				LOG_CORE_ERROR("Shader Compile Error: {0}", infoLog.data());
-			
-				glDeleteShader(shader);
 
 				for (auto shaderID : glShaderIDs)
 					glDeleteShader(shaderID);
-				
-				return;
+				glDeleteProgram(program);
+				return 0;
 			}
 			glAttachShader(program, shader);
-			//glShaderIDs[glShaderIDIndex++] = shader;
-			glShaderIDs.push_back(shader);
 		}
 		//m_RendererID = program;
         glLinkProgram(program);
@@ -144,7 +243,7 @@ namespace HRealEngine
             glDeleteProgram(program);
         	for (auto shaderID : glShaderIDs)
         		glDeleteShader(shaderID);
-            return;
+            return 0;
         }
 		for (auto shaderID : glShaderIDs)
 		{
@@ -152,13 +251,82 @@ namespace HRealEngine
 
 			glDeleteShader(shaderID);
 		}
-		m_RendererID = program;
+		SaveProgramBinary(program, cacheName, sourceHash);
+		return program;
     }
 
+	uint32_t OpenGLShader::LoadProgramBinary(const std::string& cacheName, uint64_t sourceHash)
+	{
+		if (cacheName.empty())
+			return 0;
+
+		std::filesystem::path cachePath = std::filesystem::path(GetCacheDirectory()) / (cacheName + ".glprog");
+		std::ifstream in(cachePath, std::ios::binary);
+		if (!in)
+			return 0;
+
+		ProgramBinaryHeader header;
+		in.read((char*)&header, sizeof(header));
+		if (!in || header.Magic != s_ProgramBinaryMagic || header.SourceHash != sourceHash || header.BinarySize == 0)
+			return 0;
+
+		std::vector<uint8_t> binary(header.BinarySize);
+		in.read((char*)binary.data(), binary.size());
+		if (!in)
+			return 0;
+
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header.BinaryFormat, binary.data(), (GLsizei)binary.size());
+		GLint isLinked = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+		if (isLinked == GL_FALSE)
+		{
+			// The driver rejected the format, the binary is replaced after compiling from source
+			LOG_CORE_WARN("Cached program binary for shader '{0}' was rejected, compiling from source", cacheName);
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	void OpenGLShader::SaveProgramBinary(uint32_t program, const std::string& cacheName, uint64_t sourceHash)
+	{
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		if (formatCount == 0 || cacheName.empty())
+			return;
+
+		GLint binaryLength = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		if (binaryLength <= 0)
+			return;
+
+		ProgramBinaryHeader header;
+		header.Magic = s_ProgramBinaryMagic;
+		header.SourceHash = sourceHash;
+		std::vector<uint8_t> binary(binaryLength);
+		GLenum binaryFormat = 0;
+		glGetProgramBinary(program, binaryLength, &binaryLength, &binaryFormat, binary.data());
+		header.BinaryFormat = binaryFormat;
+		header.BinarySize = (uint32_t)binaryLength;
+
+		std::error_code error;
+		std::filesystem::create_directories(GetCacheDirectory(), error);
+		std::ofstream out(std::filesystem::path(GetCacheDirectory()) / (cacheName + ".glprog"), std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			LOG_CORE_WARN("Could not write program binary cache for shader '{0}'", cacheName);
+			return;
+		}
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)binary.data(), header.BinarySize);
+	}
+
 
     OpenGLShader::~OpenGLShader()
     {
-    	glDeleteProgram(m_RendererID);
+		for (auto& [keywords, program] : m_Variants)
+			glDeleteProgram(program);
     }
 
     void OpenGLShader::Bind() const
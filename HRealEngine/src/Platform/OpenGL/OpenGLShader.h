@@ -25,6 +25,9 @@ namespace HRealEngine
         void SetMat4(const std::string& name,const glm::mat4& value) override;
 
         const std::string& GetName() const override { return m_ShaderName; }
+
+        void SetKeywords(uint64_t keywords) override;
+        uint64_t GetKeywords() const override { return m_Keywords; }
         
         void UploadUniformFloat(const std::string& uniformName, float values);
         void UploadUniformFloat2(const std::string& uniformName, const glm::vec2& values);
@@ -39,9 +42,17 @@ namespace HRealEngine
     private:
         std::string ReadFile(const std::string& filePath);
         std::unordered_map<GLenum,std::string> PreProcess(const std::string& source);
-        void Compile(const std::unordered_map<GLenum,std::string>& shaderSources);
+        // Returns the linked program, 0 when compiling or linking failed
+        uint32_t Compile(const std::unordered_map<GLenum,std::string>& shaderSources, const std::string& cacheName);
+        // Program binary cache, a binary is only used when the source hash it was built from still matches
+        uint32_t LoadProgramBinary(const std::string& cacheName, uint64_t sourceHash);
+        void SaveProgramBinary(uint32_t program, const std::string& cacheName, uint64_t sourceHash);
 
-        uint32_t m_RendererID;
+        uint32_t m_RendererID = 0; // program of the selected variant
         std::string m_ShaderName;
+
+        std::unordered_map<GLenum, std::string> m_ShaderSources; // kept to compile variants on demand
+        std::unordered_map<uint64_t, uint32_t> m_Variants; // keyword mask -> program, 0 when the variant failed to compile
+        uint64_t m_Keywords = 0;
     };
 }
@@ -0,0 +1,32 @@
+#include "HRpch.h"
+#include "OpenGLStorageBuffer.h"
+#include <glad/glad.h>
+
+namespace HRealEngine
+{
+    OpenGLStorageBuffer::OpenGLStorageBuffer(uint32_t size, uint32_t binding) : m_Binding(binding), m_Capacity(std::max(size, 16u))
+    {
+        glCreateBuffers(1, &m_RendererID);
+        glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Binding, m_RendererID);
+    }
+
+    OpenGLStorageBuffer::~OpenGLStorageBuffer()
+    {
+        glDeleteBuffers(1, &m_RendererID);
+    }
+
+    void OpenGLStorageBuffer::SetData(const void* data, uint32_t size)
+    {
+        if (size == 0)
+            return;
+        if (size > m_Capacity)
+        {
+            // Grow geometrically so a slowly rising light count does not reallocate every frame
+            m_Capacity = std::max(size, m_Capacity * 2);
+            glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Binding, m_RendererID);
+        }
+        glNamedBufferSubData(m_RendererID, 0, size, data);
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "HRealEngine/Renderer/StorageBuffer.h"
+
+namespace HRealEngine
+{
+    class OpenGLStorageBuffer : public StorageBuffer
+    {
+    public:
+        OpenGLStorageBuffer(uint32_t size, uint32_t binding);
+        virtual ~OpenGLStorageBuffer();
+
+        void SetData(const void* data, uint32_t size) override;
+    private:
+        uint32_t m_RendererID = 0;
+        uint32_t m_Binding = 0;
+        uint32_t m_Capacity = 0;
+    };
+}
@@ -6,6 +6,17 @@
 #include <stb_image.h>
 #include <glad/glad.h>
 
+#include "OpenGLBindlessTexture.h"
+#include "HRealEngine/Renderer/TextureCompressor.h"
+
+// S3TC is an extension, the loader headers do not always carry its enums
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 namespace HRealEngine
 {
     /*OpenGLTexture2D::OpenGLTexture2D(uint32_t width, uint32_t height) : m_Width(width), m_Height(height)
@@ -67,6 +78,8 @@ namespace HRealEngine
         {
         case ImageFormat::RGB8:  return GL_RGB;
         case ImageFormat::RGBA8: return GL_RGBA;
+        case ImageFormat::BC1:   return GL_RGB;
+        case ImageFormat::BC3:   return GL_RGBA;
         }
 
         HREALENGINE_CORE_DEBUGBREAK(false);
@@ -79,29 +92,22 @@ namespace HRealEngine
         {
         case ImageFormat::RGB8:  return GL_RGB8;
         case ImageFormat::RGBA8: return GL_RGBA8;
+        case ImageFormat::BC1:   return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case ImageFormat::BC3:   return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
         }
 
         HREALENGINE_CORE_DEBUGBREAK(false);
         return 0;
     }
 
-    static uint32_t CalculateMipCount(uint32_t width, uint32_t height)
-    {
-        uint32_t levels = 1;
-        while (width > 1 || height > 1)
-        {
-            width  = width  > 1 ? width  / 2 : 1;
-            height = height > 1 ? height / 2 : 1;
-            levels++;
-        }
-        return levels;
-    }
-
     OpenGLTexture2D::OpenGLTexture2D(const TextureSpecification& spec, Buffer initialData) : m_Specification(spec), m_Width(spec.Width), m_Height(spec.Height)
     {
         m_InternalFormat = ImageFormatToGLInternalFormat(m_Specification.Format);
         m_DataFormat = ImageFormatToGLDataFormat(m_Specification.Format);
-        m_MipLevels = m_Specification.GenerateMips ? CalculateMipCount(m_Width, m_Height) : 1;
+        if (m_Specification.MipLevels > 0)
+            m_MipLevels = m_Specification.MipLevels;
+        else
+            m_MipLevels = m_Specification.GenerateMips ? TextureCompressor::GetMipCount(m_Width, m_Height) : 1;
 
         glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID);
         glTextureStorage2D(m_RendererID, m_MipLevels, m_InternalFormat, m_Width, m_Height);
@@ -109,7 +115,7 @@ namespace HRealEngine
         GLint mag = m_Specification.MagFilter == TextureFilter::Nearest ? GL_NEAREST : GL_LINEAR;
 
         GLint min = 0;
-        if (m_Specification.GenerateMips && m_MipLevels > 1)
+        if (m_MipLevels > 1)
             min = m_Specification.MinFilter == TextureFilter::Nearest ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_LINEAR;
         else
             min = m_Specification.MinFilter == TextureFilter::Nearest ? GL_NEAREST : GL_LINEAR;
@@ -125,6 +131,27 @@ namespace HRealEngine
 
     void OpenGLTexture2D::SetData(Buffer data)
     {
+        if (m_Specification.MipLevels > 0)
+        {
+            // Cooked chain, every level comes from the data and nothing is generated here
+            const bool bCompressed = TextureCompressor::IsCompressed(m_Specification.Format);
+            uint64_t offset = 0;
+            for (uint32_t level = 0; level < m_MipLevels; level++)
+            {
+                const uint32_t width = std::max(m_Width >> level, 1u);
+                const uint32_t height = std::max(m_Height >> level, 1u);
+                const uint64_t size = TextureCompressor::GetLevelSize(m_Specification.Format, width, height);
+                HREALENGINE_CORE_DEBUGBREAK(offset + size <= data.Size, "Data must hold the whole mip chain!");
+                if (bCompressed)
+                    glCompressedTextureSubImage2D(m_RendererID, level, 0, 0, width, height, m_InternalFormat, (GLsizei)size, data.Data + offset);
+                else
+                    glTextureSubImage2D(m_RendererID, level, 0, 0, width, height, m_DataFormat, GL_UNSIGNED_BYTE, data.Data + offset);
+                offset += size;
+            }
+            m_bIsLoaded = true;
+            return;
+        }
+
         uint32_t bpp = m_DataFormat == GL_RGBA ? 4 : 3;
         HREALENGINE_CORE_DEBUGBREAK(data.Size == m_Width * m_Height * bpp, "Data must be entire texture!");
         glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, m_DataFormat, GL_UNSIGNED_BYTE, data.Data);
@@ -138,22 +165,65 @@ namespace HRealEngine
     void OpenGLTexture2D::ApplySampling(bool enableMipmaps, int minFilter, int magFilter)
     {
         m_Specification.GenerateMips = enableMipmaps;
-        
-        glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, (GLint)minFilter);
-        glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, (GLint)magFilter);
 
-        if (enableMipmaps)
+        if (m_BindlessHandle)
+        {
+            // The handle froze the texture parameters, replace the sampler (and with it the handle) instead
+            OpenGLBindlessTexture::MakeNonResident(m_BindlessHandle);
+            glDeleteSamplers(1, &m_BindlessSampler);
+            CreateBindlessHandle((GLint)minFilter, (GLint)magFilter);
+        }
+        else
+        {
+            glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, (GLint)minFilter);
+            glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, (GLint)magFilter);
+        }
+
+        // Cooked textures already have their chain (and compressed ones cannot be generated)
+        if (enableMipmaps && m_Specification.MipLevels == 0)
             glGenerateTextureMipmap(m_RendererID);
     }
 
+    uint64_t OpenGLTexture2D::GetBindlessHandle()
+    {
+        if (m_BindlessHandle || !OpenGLBindlessTexture::IsSupported())
+            return m_BindlessHandle;
+
+        GLint minFilter = 0, magFilter = 0;
+        glGetTextureParameteriv(m_RendererID, GL_TEXTURE_MIN_FILTER, &minFilter);
+        glGetTextureParameteriv(m_RendererID, GL_TEXTURE_MAG_FILTER, &magFilter);
+        CreateBindlessHandle(minFilter, magFilter);
+        return m_BindlessHandle;
+    }
+
+    void OpenGLTexture2D::CreateBindlessHandle(GLint minFilter, GLint magFilter)
+    {
+        glCreateSamplers(1, &m_BindlessSampler);
+        glSamplerParameteri(m_BindlessSampler, GL_TEXTURE_MIN_FILTER, minFilter);
+        glSamplerParameteri(m_BindlessSampler, GL_TEXTURE_MAG_FILTER, magFilter);
+        glSamplerParameteri(m_BindlessSampler, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glSamplerParameteri(m_BindlessSampler, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        m_BindlessHandle = OpenGLBindlessTexture::GetTextureSamplerHandle(m_RendererID, m_BindlessSampler);
+        OpenGLBindlessTexture::MakeResident(m_BindlessHandle);
+    }
+
     OpenGLTexture2D::~OpenGLTexture2D()
     {
+        if (m_BindlessHandle)
+        {
+            OpenGLBindlessTexture::MakeNonResident(m_BindlessHandle);
+            glDeleteSamplers(1, &m_BindlessSampler);
+        }
         glDeleteTextures(1, &m_RendererID);
     }
 
     void OpenGLTexture2D::Bind(uint32_t slot) const
     {
         glBindTextureUnit(slot, m_RendererID);
+        // Slot binds must see the same filtering as the handle, 0 also clears whatever sampler the last texture left here
+        if (OpenGLBindlessTexture::IsSupported())
+            glBindSampler(slot, m_BindlessSampler);
     }
 
     /*void OpenGLTexture2D::SetData(void* data, uint32_t size)
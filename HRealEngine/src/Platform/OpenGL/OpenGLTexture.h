@@ -21,6 +21,7 @@ namespace HRealEngine
         //void SetData(void* data, uint32_t size) override;
         void SetData(Buffer data) override;
         void ApplySampling(bool enableMipmaps, int minFilter, int magFilter) override;
+        uint64_t GetBindlessHandle() override;
 
         uint32_t GetWidth() const override { return m_Width; }
         uint32_t GetHeight() const override { return m_Height; }
@@ -28,6 +29,8 @@ namespace HRealEngine
         const std::string& GetPath() const override { return m_FilePath; }
 
         bool operator==(const Texture& other) const override {return m_RendererID == other.GetRendererID(); }
+    private:
+        void CreateBindlessHandle(GLint minFilter, GLint magFilter);
     private:
         TextureSpecification m_Specification;
         
@@ -37,5 +40,8 @@ namespace HRealEngine
         uint32_t m_Width, m_Height;
         GLenum m_InternalFormat, m_DataFormat;
         uint32_t m_MipLevels = 1;
+        // Once a handle exists the texture parameters are frozen and sampling goes through this sampler instead
+        uint32_t m_BindlessSampler = 0;
+        uint64_t m_BindlessHandle = 0;
     };
 }
@@ -22,6 +22,9 @@ namespace HRealEngine
         case ShaderDataType::Int3:     return GL_INT;
         case ShaderDataType::Int4:     return GL_INT;
         case ShaderDataType::Bool:     return GL_BOOL;
+        case ShaderDataType::UShort4:  return GL_UNSIGNED_SHORT;
+        case ShaderDataType::Short2:   return GL_SHORT;
+        case ShaderDataType::Half2:    return GL_HALF_FLOAT;
         }
         HREALENGINE_CORE_DEBUGBREAK(false, "Unknown ShaderDataType!");
         return 0; 
@@ -49,6 +52,16 @@ namespace HRealEngine
     }
 
     void OpenGLVertexArray::AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer)
+    {
+        AddAttributes(vertexBuffer, 0);
+    }
+
+    void OpenGLVertexArray::AddInstanceBuffer(const Ref<VertexBuffer>& instanceBuffer)
+    {
+        AddAttributes(instanceBuffer, 1);
+    }
+
+    void OpenGLVertexArray::AddAttributes(const Ref<VertexBuffer>& vertexBuffer, uint32_t divisor)
     {
         HREALENGINE_CORE_DEBUGBREAK(vertexBuffer->GetLayout().GetElements().size(), "VertexBuffer has no layout!");
         glBindVertexArray(m_RendererID);
@@ -63,10 +76,14 @@ namespace HRealEngine
                 case ShaderDataType::Float2:
                 case ShaderDataType::Float3:
                 case ShaderDataType::Float4:
+                case ShaderDataType::UShort4:
+                case ShaderDataType::Short2:
+                case ShaderDataType::Half2:
                 {
                     glEnableVertexAttribArray(m_VertexBufferIndex);
                     glVertexAttribPointer(m_VertexBufferIndex, element.GetComponentCount(), ShaderDataTypeToOpenGLBaseType(element.Type),
                         element.Normalized ? GL_TRUE : GL_FALSE, layout.GetStride(), (const void*)(uintptr_t)element.Offset);
+                    glVertexAttribDivisor(m_VertexBufferIndex, divisor);
                     m_VertexBufferIndex++;
                     break;
                 }
@@ -79,6 +96,7 @@ namespace HRealEngine
                     glEnableVertexAttribArray(m_VertexBufferIndex);
                     glVertexAttribIPointer(m_VertexBufferIndex, static_cast<GLint>(element.GetComponentCount()), ShaderDataTypeToOpenGLBaseType(element.Type),
                         static_cast<GLsizei>(layout.GetStride()), (const void*)(uintptr_t)element.Offset);
+                    glVertexAttribDivisor(m_VertexBufferIndex, divisor);
                     m_VertexBufferIndex++;
                     break;
                 }
@@ -15,10 +15,13 @@ namespace HRealEngine
         void Unbind() const override;
 
         void AddVertexBuffer(const Ref<VertexBuffer>& vertexBuffer) override;
+        void AddInstanceBuffer(const Ref<VertexBuffer>& instanceBuffer) override;
         void SetIndexBuffer(const Ref<IndexBuffer>& indexBuffer) override;
 
         const std::vector<Ref<VertexBuffer>>& GetVertexBuffers() const override { return m_VertexBuffers;}
         const Ref<IndexBuffer>& GetIndexBuffer() const override{ return m_IndexBuffer;}
+    private:
+        void AddAttributes(const Ref<VertexBuffer>& vertexBuffer, uint32_t divisor);
     private:
         std::vector<Ref<VertexBuffer>> m_VertexBuffers;
         Ref<IndexBuffer> m_IndexBuffer;
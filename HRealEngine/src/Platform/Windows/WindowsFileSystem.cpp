@@ -0,0 +1,55 @@
+#include "HRpch.h"
+#include "HRealEngine/Core/FileSystem.h"
+
+namespace HRealEngine
+{
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    bool MappedFile::Open(const std::filesystem::path& filepath)
+    {
+        Close();
+
+        HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        // The mapping object keeps the file referenced
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        m_Data = (const uint8_t*)data;
+        m_Size = (uint64_t)size.QuadPart;
+        m_MappingHandle = mapping;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_Data)
+            UnmapViewOfFile(m_Data);
+        if (m_MappingHandle)
+            CloseHandle((HANDLE)m_MappingHandle);
+        m_Data = nullptr;
+        m_Size = 0;
+        m_MappingHandle = nullptr;
+    }
+}
@@ -14,7 +14,12 @@ namespace HRealEngine
     float Time::s_DeltaTime = 0.f;
     float Time::GetTime()
     {
-        return (float)glfwGetTime();
+        // Performance counter instead of glfwGetTime, headless applications never initialize GLFW
+        static const LARGE_INTEGER s_Frequency = [] { LARGE_INTEGER frequency; QueryPerformanceFrequency(&frequency); return frequency; }();
+        static const LARGE_INTEGER s_Start = [] { LARGE_INTEGER start; QueryPerformanceCounter(&start); return start; }();
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return (float)((double)(now.QuadPart - s_Start.QuadPart) / (double)s_Frequency.QuadPart);
     }
 
     std::string FileDialogs::OpenFile(const char* filter)
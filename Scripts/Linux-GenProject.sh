@@ -0,0 +1,8 @@
+#!/bin/sh
+# Generates GNU makefiles, build with "make config=release" from the repository root
+cd "$(dirname "$0")/.."
+if [ -x vendor/bin/premake/premake5 ]; then
+    vendor/bin/premake/premake5 gmake2
+else
+    premake5 gmake2
+fi
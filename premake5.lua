@@ -5,6 +5,10 @@ workspace "HRealEngine"
     configurations { "Debug", "Release", "Dist" }
     startproject "HRealEngine Editor"
     
+    filter "system:linux"
+        startproject "HRealEngine Runtime"
+    filter {}
+    
     	--solution_items{".editorconfig"}
     	flags{"MultiProcessorCompile"}
     	outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
@@ -20,15 +24,19 @@ workspace "HRealEngine"
         include "HRealEngine/vendor/msdf-atlas-gen"
     	include "HRealEngine/vendor/imgui"
     	include "HRealEngine/vendor/yaml-cpp"
-    	include "HRealEngine/vendor/Box2D"
+    	include "HRealEngine/vendor/box2d"
         include "HRealEngine/vendor/JoltPhysics"
         include "HRealEngine/vendor/assimp"
         include "HRealEngine/BehaviorTreeLibrary_premake5.lua"
     group ""
     include "HRealEngine"
-    include "HRealEngine Editor"
     include "HRealEngine Runtime"
-    include "HRealEngine-ScriptCore"
+    include "HRealEngine Tests"
+    -- The editor and the C# script core are only generated for Windows, Linux builds use the prebuilt ScriptCore assembly
+    if os.istarget("windows") then
+        include "HRealEngine Editor"
+        include "HRealEngine-ScriptCore"
+    end
     
     
     
\ No newline at end of file